@@ -1,7 +1,16 @@
+#include <atomic>
 #include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <numeric>
+#include <pcp/common/plane3d.hpp>
+#include <pcp/common/points/point_view.hpp>
 #include <pcp/kdtree/kdtree.hpp>
 #include <pcp/octree/octree.hpp>
 #include <random>
+#include <shared_mutex>
+#include <thread>
 
 auto const default_point_map = [](pcp::point_t const& p) {
     return p;
@@ -42,6 +51,59 @@ get_vector_of_points(std::uint64_t num_points, float const min, float const max)
     return points;
 }
 
+static std::vector<pcp::point_t>
+get_vector_of_clustered_points(std::uint64_t num_points, float const min, float const max)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::uint64_t const num_clusters = 64u;
+    std::uniform_real_distribution<float> coordinate_distribution(min, max);
+    std::uniform_int_distribution<std::uint64_t> cluster_distribution(0u, num_clusters - 1u);
+    std::normal_distribution<float> offset_distribution(0.f, (max - min) / 200.f);
+
+    std::vector<pcp::point_t> centers;
+    centers.reserve(num_clusters);
+    for (std::uint64_t i = 0; i < num_clusters; ++i)
+    {
+        centers.push_back(pcp::point_t{
+            coordinate_distribution(gen),
+            coordinate_distribution(gen),
+            coordinate_distribution(gen)});
+    }
+
+    std::vector<pcp::point_t> points;
+    std::uint64_t const size = num_points;
+    points.reserve(size);
+    for (std::uint64_t i = 0; i < size; ++i)
+    {
+        auto const& center = centers[cluster_distribution(gen)];
+        points.push_back(pcp::point_t{
+            std::clamp(center.x() + offset_distribution(gen), min, max),
+            std::clamp(center.y() + offset_distribution(gen), min, max),
+            std::clamp(center.z() + offset_distribution(gen), min, max)});
+    }
+
+    return points;
+}
+
+static pcp::point_t get_clustered_reference_point(
+    std::vector<pcp::point_t> const& points,
+    float const min,
+    float const max)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::uniform_int_distribution<std::size_t> index_distribution(0u, points.size() - 1u);
+    std::normal_distribution<float> offset_distribution(0.f, (max - min) / 2000.f);
+    auto const& p = points[index_distribution(gen)];
+    return pcp::point_t{
+        p.x() + offset_distribution(gen),
+        p.y() + offset_distribution(gen),
+        p.z() + offset_distribution(gen)};
+}
+
 static pcp::axis_aligned_bounding_box_t<pcp::point_t> get_range(float const min, float const max)
 {
     std::random_device rd;
@@ -59,6 +121,15 @@ static pcp::axis_aligned_bounding_box_t<pcp::point_t> get_range(float const min,
         pcp::point_t{min_bound(gen) + x, min_bound(gen) + y, min_bound(gen) + z},
         pcp::point_t{max_bound(gen) + x, max_bound(gen) + y, max_bound(gen) + z}};
 }
+static pcp::axis_aligned_bounding_box_t<pcp::point_t>
+get_large_range(float const min, float const max)
+{
+    // a box holding an eighth of the uniformly distributed points
+    auto const quarter = .25f * (max - min);
+    return pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min + quarter, min + quarter, min + quarter},
+        pcp::point_t{max - quarter, max - quarter, max - quarter}};
+}
 static pcp::kd_axis_aligned_bounding_box_t<float, 3>
 get_range_kdtree(float const min, float const max)
 {
@@ -80,6 +151,68 @@ get_range_kdtree(float const min, float const max)
     return aabb;
 }
 
+static pcp::sphere_t<pcp::point_t> get_sphere_range(float const min, float const max)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::uniform_real_distribution<float> coordinate_distribution(min + 10.f, max - 10.f);
+
+    pcp::sphere_t<pcp::point_t> sphere;
+    sphere.position = pcp::point_t{
+        coordinate_distribution(gen),
+        coordinate_distribution(gen),
+        coordinate_distribution(gen)};
+    sphere.radius = 10.f;
+
+    return sphere;
+}
+
+static pcp::sphere_a<float> get_sphere_range_kdtree(float const min, float const max)
+{
+    auto const sphere = get_sphere_range(min, max);
+    return pcp::sphere_a<float>{
+        {sphere.position.x(), sphere.position.y(), sphere.position.z()},
+        sphere.radius};
+}
+
+/*
+ * View frustum with a 90 degrees field of view looking down the z axis
+ * from a random eye, whose first plane is its near plane
+ */
+static std::array<pcp::common::plane3d_t, 6u> get_frustum(float const min, float const max)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::uniform_real_distribution<float> coordinate_distribution(min, max);
+    pcp::point_t const eye{
+        coordinate_distribution(gen),
+        coordinate_distribution(gen),
+        coordinate_distribution(gen)};
+
+    float const inverse_sqrt2 = 1.f / std::sqrt(2.f);
+    return std::array<pcp::common::plane3d_t, 6u>{
+        pcp::common::plane3d_t{eye + pcp::point_t{0.f, 0.f, 1.f}, pcp::normal_t{0.f, 0.f, 1.f}},
+        pcp::common::plane3d_t{eye + pcp::point_t{0.f, 0.f, 20.f}, pcp::normal_t{0.f, 0.f, -1.f}},
+        pcp::common::plane3d_t{eye, pcp::normal_t{inverse_sqrt2, 0.f, inverse_sqrt2}},
+        pcp::common::plane3d_t{eye, pcp::normal_t{-inverse_sqrt2, 0.f, inverse_sqrt2}},
+        pcp::common::plane3d_t{eye, pcp::normal_t{0.f, inverse_sqrt2, inverse_sqrt2}},
+        pcp::common::plane3d_t{eye, pcp::normal_t{0.f, -inverse_sqrt2, inverse_sqrt2}}};
+}
+
+static pcp::point_t get_ray_direction()
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::normal_distribution<float> coordinate_distribution(0.f, 1.f);
+    return pcp::point_t{
+        coordinate_distribution(gen),
+        coordinate_distribution(gen),
+        coordinate_distribution(gen)};
+}
+
 static pcp::point_t get_reference_point(float const min, float const max)
 {
     std::random_device rd;
@@ -92,6 +225,46 @@ static pcp::point_t get_reference_point(float const min, float const max)
         coordinate_distribution(gen)};
 }
 
+/*
+ * Reports the number of nodes of an octree, the size of a node record,
+ * and the number of bytes used per node, counting both the node records
+ * and the element storage.
+ */
+static void report_octree_footprint(benchmark::State& state, pcp::linked_octree_t const& octree)
+{
+    using node_type   = pcp::linked_octree_t::octree_node_type;
+    std::size_t nodes = 0u;
+    std::size_t bytes = 0u;
+    for (auto bucket = octree.bucket_begin(); bucket != octree.bucket_end(); ++bucket)
+    {
+        ++nodes;
+        bytes += sizeof(node_type) + bucket->capacity() * sizeof(pcp::point_t);
+    }
+    state.counters["nodes"]          = static_cast<double>(nodes);
+    state.counters["node_bytes"]     = static_cast<double>(sizeof(node_type));
+    state.counters["bytes_per_node"] = static_cast<double>(bytes) / static_cast<double>(nodes);
+}
+
+static void report_octree_footprint(benchmark::State& state, pcp::linear_octree_t const& octree)
+{
+    using node_type  = pcp::linear_octree_t::node_type;
+    auto const nodes = octree.nodes().size();
+    auto const bytes = nodes * sizeof(node_type) + octree.size() * sizeof(pcp::point_t);
+    state.counters["nodes"]          = static_cast<double>(nodes);
+    state.counters["node_bytes"]     = static_cast<double>(sizeof(node_type));
+    state.counters["bytes_per_node"] = static_cast<double>(bytes) / static_cast<double>(nodes);
+}
+
+static void report_octree_footprint(benchmark::State& state, pcp::frozen_octree_t const& octree)
+{
+    using node_type  = pcp::frozen_octree_t::node_type;
+    auto const nodes = octree.nodes().size();
+    auto const bytes = nodes * sizeof(node_type) + octree.size() * sizeof(pcp::point_t);
+    state.counters["nodes"]          = static_cast<double>(nodes);
+    state.counters["node_bytes"]     = static_cast<double>(sizeof(node_type));
+    state.counters["bytes_per_node"] = static_cast<double>(bytes) / static_cast<double>(nodes);
+}
+
 static void bm_vector_construction(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
@@ -125,69 +298,2163 @@ static void bm_linked_octree_construction(benchmark::State& state)
     }
 }
 
-static void bm_linked_kdtree_construction(benchmark::State& state)
+static void bm_linked_octree_parallel_construction(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
     std::vector<pcp::point_t> const points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
-
-    pcp::kdtree::construction_params_t params;
-    params.max_depth    = static_cast<std::size_t>(state.range(1));
-    params.construction = pcp::kdtree::construction_t::nth_element;
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
 
     for (auto _ : state)
     {
-        pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
-            points.begin(),
-            points.end(),
-            default_coordinate_map,
-            params};
-        benchmark::DoNotOptimize(kdtree.size());
+        pcp::linked_octree_t octree(
+            std::execution::par,
+            points.cbegin(),
+            points.cend(),
+            default_point_map,
+            params);
+        benchmark::DoNotOptimize(octree.size());
     }
 }
 
-static void bm_vector_range_search(benchmark::State& state)
+static void bm_linked_octree_concurrent_insertion(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
-    std::vector<pcp::point_t> points =
+    std::vector<pcp::point_t> const points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    auto const num_threads = static_cast<std::size_t>(state.range(3));
     for (auto _ : state)
     {
-        auto const range = get_range(min, max);
-        std::vector<pcp::point_t> found_points;
-        for (auto const& p : points)
+        pcp::linked_octree_t octree(params);
+
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0u; t < num_threads; ++t)
         {
-            if (range.contains(p))
-                found_points.push_back(p);
+            threads.emplace_back([&, t]() {
+                for (std::size_t i = t; i < points.size(); i += num_threads)
+                    octree.concurrent_insert(points[i], default_point_map);
+            });
         }
+        for (auto& thread : threads)
+            thread.join();
+
+        benchmark::DoNotOptimize(octree.size());
+    }
+}
+
+static void bm_linked_octree_crop(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    for (auto _ : state)
+    {
+        pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+        pcp::axis_aligned_bounding_box_t range = get_range(min, max);
+        std::vector<pcp::point_t> found_points = octree.range_search(range, default_point_map);
         benchmark::DoNotOptimize(found_points.data());
     }
 }
 
-static void bm_linked_octree_range_search(benchmark::State& state)
+static void bm_linked_octree_lazy_crop(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::lazy_octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    for (auto _ : state)
+    {
+        pcp::basic_linked_octree_t<pcp::point_t, decltype(params)> octree(
+            points.cbegin(),
+            points.cend(),
+            default_point_map,
+            params);
+        pcp::axis_aligned_bounding_box_t range = get_range(min, max);
+        std::vector<pcp::point_t> found_points = octree.range_search(range, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+
+static void bm_linked_octree_erase(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    auto constexpr threshold = min + 0.8f * (max - min);
+    auto const is_point_to_remove = [threshold](pcp::point_t const& p) {
+        return p.x() < threshold;
+    };
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+        state.ResumeTiming();
+        for (auto it = octree.cbegin(); it != octree.cend();)
+        {
+            if (is_point_to_remove(*it))
+                it = octree.erase(it);
+            else
+                ++it;
+        }
+        benchmark::DoNotOptimize(octree.size());
+    }
+}
+
+static void bm_linked_octree_erase_if(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    auto constexpr threshold = min + 0.8f * (max - min);
+    auto const is_point_to_remove = [threshold](pcp::point_t const& p) {
+        return p.x() < threshold;
+    };
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+        state.ResumeTiming();
+        octree.erase_if(is_point_to_remove, default_point_map);
+        benchmark::DoNotOptimize(octree.size());
+    }
+}
+
+static std::vector<pcp::point_t> get_vector_of_displacements(std::uint64_t num_points)
+{
+    std::random_device rd;
+    std::mt19937 gen(rd());
+
+    std::uniform_real_distribution<float> displacement_distribution(-1.f, 1.f);
+
+    std::vector<pcp::point_t> displacements;
+    displacements.reserve(num_points);
+    for (std::uint64_t i = 0; i < num_points; ++i)
+    {
+        displacements.push_back(pcp::point_t{
+            displacement_distribution(gen),
+            displacement_distribution(gen),
+            displacement_distribution(gen)});
+    }
+
+    return displacements;
+}
+
+/*
+ * Moves the points back and forth along their displacement,
+ * so that they stay in the benchmarks' voxel grid.
+ */
+static void move_points(
+    std::vector<pcp::point_t>& points,
+    std::vector<pcp::point_t> const& displacements,
+    float const sign)
+{
+    for (std::size_t i = 0u; i < points.size(); ++i)
+        points[i] = points[i] + sign * displacements[i];
+}
+
+static void bm_linked_octree_moved_points_construction(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
     std::vector<pcp::point_t> points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    std::vector<pcp::point_t> const displacements = get_vector_of_displacements(points.size());
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min - 1.f, min - 1.f, min - 1.f},
+        pcp::point_t{max + 1.f, max + 1.f, max + 1.f}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    float sign = 1.f;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        move_points(points, displacements, sign);
+        sign = -sign;
+        state.ResumeTiming();
+        pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+        benchmark::DoNotOptimize(octree.size());
+    }
+}
 
+static void bm_linked_octree_update(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    std::vector<pcp::point_t> const displacements = get_vector_of_displacements(points.size());
     pcp::octree_parameters_t<pcp::point_t> params;
-    params.voxel_grid =
-        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min - 1.f, min - 1.f, min - 1.f},
+        pcp::point_t{max + 1.f, max + 1.f, max + 1.f}};
     params.node_capacity = static_cast<std::uint32_t>(state.range(1));
     params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
     pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
 
+    float sign = 1.f;
     for (auto _ : state)
     {
-        pcp::axis_aligned_bounding_box_t range = get_range(min, max);
-        std::vector<pcp::point_t> found_points = octree.range_search(range, default_point_map);
-        benchmark::DoNotOptimize(found_points.data());
+        for (std::size_t i = 0u; i < points.size(); ++i)
+        {
+            auto const old_position = points[i];
+            points[i]               = points[i] + sign * displacements[i];
+            octree.update(points[i], old_position, default_point_map);
+        }
+        sign = -sign;
+        benchmark::DoNotOptimize(octree.size());
+    }
+}
+
+static void bm_linked_octree_refit(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    std::vector<pcp::point_t> const displacements = get_vector_of_displacements(points.size());
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min - 1.f, min - 1.f, min - 1.f},
+        pcp::point_t{max + 1.f, max + 1.f, max + 1.f}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    std::vector<pcp::point_view_t> views;
+    views.reserve(points.size());
+    for (auto& p : points)
+        views.push_back(pcp::point_view_t{&p});
+
+    auto const point_view_map = [](pcp::point_view_t const& p) {
+        return p;
+    };
+    pcp::basic_linked_octree_t<pcp::point_view_t, decltype(params)> octree(
+        views.cbegin(),
+        views.cend(),
+        point_view_map,
+        params);
+
+    float sign = 1.f;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        move_points(points, displacements, sign);
+        sign = -sign;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(octree.refit(point_view_map));
+    }
+}
+
+static void bm_linked_octree_pool_construction(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    using allocator_type = pcp::node_pool_allocator_t<pcp::point_t>;
+    pcp::node_pool_t pool;
+    allocator_type const allocator(pool);
+
+    for (auto _ : state)
+    {
+        {
+            pcp::basic_linked_octree_t<pcp::point_t, decltype(params), allocator_type> octree(
+                points.cbegin(),
+                points.cend(),
+                default_point_map,
+                params,
+                allocator);
+            benchmark::DoNotOptimize(octree.size());
+        }
+        pool.reset();
+    }
+}
+
+static void bm_linked_octree_teardown(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+        benchmark::DoNotOptimize(octree.size());
+        state.ResumeTiming();
+    }
+}
+
+static void bm_linked_octree_pool_teardown(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    using allocator_type = pcp::node_pool_allocator_t<pcp::point_t>;
+    pcp::node_pool_t pool;
+    allocator_type const allocator(pool);
+
+    for (auto _ : state)
+    {
+        {
+            state.PauseTiming();
+            pcp::basic_linked_octree_t<pcp::point_t, decltype(params), allocator_type> octree(
+                points.cbegin(),
+                points.cend(),
+                default_point_map,
+                params,
+                allocator);
+            benchmark::DoNotOptimize(octree.size());
+            state.ResumeTiming();
+        }
+        pool.reset();
+    }
+}
+
+static void bm_linear_octree_construction(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    for (auto _ : state)
+    {
+        pcp::linear_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+        benchmark::DoNotOptimize(octree.size());
+    }
+}
+
+static void bm_frozen_octree_construction(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{min, min, min},
+        pcp::point_t{max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t const octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    for (auto _ : state)
+    {
+        pcp::frozen_octree_t const frozen = octree.freeze();
+        benchmark::DoNotOptimize(frozen.size());
+    }
+}
+
+static void bm_linked_kdtree_pool_construction(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    using allocator_type = pcp::node_pool_allocator_t<pcp::point_t>;
+    pcp::node_pool_t pool;
+    allocator_type const allocator(pool);
+
+    for (auto _ : state)
+    {
+        {
+            pcp::basic_linked_kdtree_t<
+                pcp::point_t,
+                3u,
+                decltype(default_coordinate_map),
+                allocator_type>
+                kdtree{points.begin(), points.end(), default_coordinate_map, params, allocator};
+            benchmark::DoNotOptimize(kdtree.size());
+        }
+        pool.reset();
+    }
+}
+
+static void bm_linked_kdtree_pool_teardown(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    using allocator_type = pcp::node_pool_allocator_t<pcp::point_t>;
+    pcp::node_pool_t pool;
+    allocator_type const allocator(pool);
+
+    for (auto _ : state)
+    {
+        {
+            state.PauseTiming();
+            pcp::basic_linked_kdtree_t<
+                pcp::point_t,
+                3u,
+                decltype(default_coordinate_map),
+                allocator_type>
+                kdtree{points.begin(), points.end(), default_coordinate_map, params, allocator};
+            benchmark::DoNotOptimize(kdtree.size());
+            state.ResumeTiming();
+        }
+        pool.reset();
+    }
+}
+
+static void bm_linked_kdtree_construction(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    for (auto _ : state)
+    {
+        pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+            points.begin(),
+            points.end(),
+            default_coordinate_map,
+            params};
+        benchmark::DoNotOptimize(kdtree.size());
+    }
+}
+
+static void bm_linked_kdtree_teardown(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> const points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+            points.begin(),
+            points.end(),
+            default_coordinate_map,
+            params};
+        benchmark::DoNotOptimize(kdtree.size());
+        state.ResumeTiming();
+    }
+}
+
+static void bm_vector_range_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    for (auto _ : state)
+    {
+        auto const range = get_range(min, max);
+        std::vector<pcp::point_t> found_points;
+        for (auto const& p : points)
+        {
+            if (range.contains(p))
+                found_points.push_back(p);
+        }
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+
+static void bm_linked_octree_range_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    for (auto _ : state)
+    {
+        pcp::axis_aligned_bounding_box_t range = get_range(min, max);
+        std::vector<pcp::point_t> found_points = octree.range_search(range, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+static void bm_linear_octree_range_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linear_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    for (auto _ : state)
+    {
+        pcp::axis_aligned_bounding_box_t range = get_range(min, max);
+        std::vector<pcp::point_t> found_points = octree.range_search(range, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+static void bm_frozen_octree_range_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::frozen_octree_t const octree =
+        pcp::linked_octree_t(points.cbegin(), points.cend(), default_point_map, params).freeze();
+
+    for (auto _ : state)
+    {
+        pcp::axis_aligned_bounding_box_t range = get_range(min, max);
+        std::vector<pcp::point_t> found_points = octree.range_search(range, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+static void bm_linked_kdtree_range_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+
+    for (auto _ : state)
+    {
+        pcp::kd_axis_aligned_bounding_box_t range = get_range_kdtree(min, max);
+        std::vector<pcp::point_t> found_points    = kdtree.range_search(range);
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+
+static void bm_vector_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    std::int64_t const k = state.range(1);
+    for (auto _ : state)
+    {
+        pcp::point_t const reference = get_reference_point(min, max);
+
+        auto const distance = [](pcp::point_t const& p1, pcp::point_t const& p2) -> float {
+            auto const dx = p2.x() - p1.x();
+            auto const dy = p2.y() - p1.y();
+            auto const dz = p2.z() - p1.z();
+            return dx * dx + dy * dy + dz * dz;
+        };
+        auto const less_than = [reference,
+                                distance](pcp::point_t const& p1, pcp::point_t const& p2) -> bool {
+            return distance(p1, reference) < distance(p2, reference);
+        };
+
+        std::sort(points.begin(), points.end(), less_than);
+        std::vector<pcp::point_t> knn(points.cbegin(), points.cbegin() + k);
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linked_octree_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(3));
+    for (auto _ : state)
+    {
+        auto const reference          = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn = octree.nearest_neighbours(reference, k, default_point_map);
+        benchmark::DoNotOptimize(knn.data());
+    }
+    report_octree_footprint(state, octree);
+}
+
+/*
+ * Squared radius of the sphere expected to hold a given number of the
+ * uniformly distributed benchmark points, used as the stopping criterion
+ * of searches which do not know their number of neighbours up front
+ */
+static float get_squared_radius_holding(std::uint64_t num_points, std::uint64_t expected_count)
+{
+    auto constexpr min    = get_bm_min();
+    auto constexpr max    = get_bm_max();
+    auto constexpr volume = (max - min) * (max - min) * (max - min);
+    float const radius    = std::cbrt(
+        3.f * static_cast<float>(expected_count) * volume /
+        (4.f * 3.14159265f * static_cast<float>(num_points)));
+    return radius * radius;
+}
+
+static void bm_linked_octree_growing_k_knn_search(benchmark::State& state)
+{
+    auto constexpr min    = get_bm_min();
+    auto constexpr max    = get_bm_max();
+    auto const num_points = static_cast<std::uint64_t>(state.range(0));
+    std::vector<pcp::point_t> points = get_vector_of_points(num_points, min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    auto const squared_radius =
+        get_squared_radius_holding(num_points, static_cast<std::uint64_t>(state.range(3)));
+    for (auto _ : state)
+    {
+        auto const reference = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn;
+        for (std::size_t k = 8u;; k *= 2u)
+        {
+            knn = octree.nearest_neighbours(reference, k, default_point_map);
+            if (knn.size() < k ||
+                pcp::common::squared_distance(reference, knn.back()) > squared_radius)
+                break;
+        }
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linked_octree_incremental_knn_search(benchmark::State& state)
+{
+    auto constexpr min    = get_bm_min();
+    auto constexpr max    = get_bm_max();
+    auto const num_points = static_cast<std::uint64_t>(state.range(0));
+    std::vector<pcp::point_t> points = get_vector_of_points(num_points, min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    auto const squared_radius =
+        get_squared_radius_holding(num_points, static_cast<std::uint64_t>(state.range(3)));
+    for (auto _ : state)
+    {
+        auto const reference = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn;
+        for (auto const& neighbour :
+             octree.incremental_nearest_neighbours(reference, default_point_map))
+        {
+            if (neighbour.squared_distance > squared_radius)
+                break;
+
+            knn.push_back(*neighbour.element);
+        }
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linear_octree_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linear_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(3));
+    for (auto _ : state)
+    {
+        auto const reference          = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn = octree.nearest_neighbours(reference, k, default_point_map);
+        benchmark::DoNotOptimize(knn.data());
+    }
+    report_octree_footprint(state, octree);
+}
+
+static void bm_frozen_octree_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::frozen_octree_t const octree =
+        pcp::linked_octree_t(points.cbegin(), points.cend(), default_point_map, params).freeze();
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(3));
+    for (auto _ : state)
+    {
+        auto const reference          = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn = octree.nearest_neighbours(reference, k, default_point_map);
+        benchmark::DoNotOptimize(knn.data());
+    }
+    report_octree_footprint(state, octree);
+}
+
+/*
+ * Runs writer on a background thread, when state.range(3) is not 0,
+ * for as long as the benchmark runs. The writer inserts and erases
+ * batches of points, so that the size of the octree stays the same.
+ */
+template <class Writer>
+static std::thread
+start_ingest(benchmark::State const& state, std::atomic<bool>& is_ingesting, Writer writer)
+{
+    is_ingesting.store(state.range(3) != 0);
+    if (!is_ingesting.load())
+        return std::thread{};
+
+    return std::thread([&is_ingesting, writer]() mutable {
+        while (is_ingesting.load(std::memory_order_relaxed))
+            writer();
+    });
+}
+
+static void stop_ingest(std::atomic<bool>& is_ingesting, std::thread& writer)
+{
+    is_ingesting.store(false);
+    if (writer.joinable())
+        writer.join();
+}
+
+/*
+ * Reports the tail of the query latencies, which the mean hides
+ * when readers are blocked by the writer.
+ */
+static void report_latency_percentiles(benchmark::State& state, std::vector<double>& latencies)
+{
+    if (latencies.empty())
+        return;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto const percentile = [&latencies](double q) {
+        auto const last = static_cast<double>(latencies.size() - 1u);
+        return latencies[static_cast<std::size_t>(q * last)];
+    };
+    state.counters["p50_us"] = percentile(.5);
+    state.counters["p99_us"] = percentile(.99);
+    state.counters["max_us"] = latencies.back();
+}
+
+static void bm_locked_linked_octree_knn_search_during_ingest(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    std::vector<pcp::point_t> const batch = get_vector_of_points(4'096u, min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    std::shared_mutex mutex;
+
+    std::atomic<bool> is_ingesting{false};
+    auto writer = start_ingest(state, is_ingesting, [&]() {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        octree.insert(batch.cbegin(), batch.cend(), default_point_map);
+        for (auto const& p : batch)
+            octree.erase(octree.find(p, default_point_map));
+    });
+
+    std::vector<double> latencies;
+    for (auto _ : state)
+    {
+        auto const reference = get_reference_point(min, max);
+        auto const begin     = std::chrono::steady_clock::now();
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        std::vector<pcp::point_t> knn =
+            octree.nearest_neighbours(reference, 10u, default_point_map);
+        benchmark::DoNotOptimize(knn.data());
+        latencies.push_back(std::chrono::duration<double, std::micro>(
+                                std::chrono::steady_clock::now() - begin)
+                                .count());
+    }
+    stop_ingest(is_ingesting, writer);
+    report_latency_percentiles(state, latencies);
+}
+
+static void bm_persistent_octree_knn_search_during_ingest(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    std::vector<pcp::point_t> const batch = get_vector_of_points(4'096u, min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::persistent_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    std::atomic<bool> is_ingesting{false};
+    auto writer = start_ingest(state, is_ingesting, [&]() {
+        octree.insert(batch.cbegin(), batch.cend(), default_point_map);
+        octree.publish();
+        for (auto const& p : batch)
+            octree.erase(p, default_point_map);
+        octree.publish();
+    });
+
+    std::vector<double> latencies;
+    for (auto _ : state)
+    {
+        auto const reference = get_reference_point(min, max);
+        auto const begin     = std::chrono::steady_clock::now();
+        auto const snapshot  = octree.snapshot();
+        std::vector<pcp::point_t> knn =
+            snapshot.nearest_neighbours(reference, 10u, default_point_map);
+        benchmark::DoNotOptimize(knn.data());
+        latencies.push_back(std::chrono::duration<double, std::micro>(
+                                std::chrono::steady_clock::now() - begin)
+                                .count());
+    }
+    stop_ingest(is_ingesting, writer);
+    report_latency_percentiles(state, latencies);
+}
+
+static std::size_t constexpr get_bm_window_size()
+{
+    return 16u;
+}
+
+static std::vector<std::vector<pcp::point_t>>
+get_vector_of_frames(std::uint64_t frame_size, float const min, float const max)
+{
+    // twice as many frames as the window holds, streamed in a loop
+    std::vector<std::vector<pcp::point_t>> frames;
+    for (std::size_t f = 0u; f < 2u * get_bm_window_size(); ++f)
+        frames.push_back(get_vector_of_points(frame_size, min, max));
+    return frames;
+}
+
+static void bm_linked_octree_sliding_window_stream(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    auto const frames  = get_vector_of_frames(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(params);
+    std::size_t f = 0u;
+    for (; f < get_bm_window_size(); ++f)
+        octree.insert(frames[f].cbegin(), frames[f].cend(), default_point_map);
+
+    for (auto _ : state)
+    {
+        auto const& oldest = frames[(f - get_bm_window_size()) % frames.size()];
+        for (auto const& p : oldest)
+            octree.erase(octree.find(p, default_point_map));
+
+        auto const& newest = frames[f % frames.size()];
+        octree.insert(newest.cbegin(), newest.cend(), default_point_map);
+        ++f;
+        benchmark::DoNotOptimize(octree.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void bm_sliding_window_octree_stream(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    auto const frames  = get_vector_of_frames(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::sliding_window_octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    params.max_frames    = get_bm_window_size();
+
+    pcp::sliding_window_octree_t octree(params);
+    std::size_t f = 0u;
+    for (; f < get_bm_window_size(); ++f)
+    {
+        auto const timestamp = static_cast<double>(f);
+        octree.push_frame(frames[f].cbegin(), frames[f].cend(), default_point_map, timestamp);
+    }
+
+    for (auto _ : state)
+    {
+        auto const& newest   = frames[f % frames.size()];
+        auto const timestamp = static_cast<double>(f);
+        octree.push_frame(newest.cbegin(), newest.cend(), default_point_map, timestamp);
+        ++f;
+        benchmark::DoNotOptimize(octree.size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void bm_out_of_core_octree_construction(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::out_of_core_octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity    = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth        = static_cast<decltype(params.max_depth)>(state.range(2));
+    params.max_cached_pages = static_cast<std::size_t>(state.range(3));
+
+    for (auto _ : state)
+    {
+        pcp::out_of_core_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+        octree.flush();
+        benchmark::DoNotOptimize(octree.size());
+    }
+}
+
+/*
+ * KNN searches on an out-of-core octree whose page cache holds
+ * max_cached_pages pages, reporting the page faults per search
+ */
+static void bm_out_of_core_octree_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::out_of_core_octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity    = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth        = static_cast<decltype(params.max_depth)>(state.range(2));
+    params.max_cached_pages = static_cast<std::size_t>(state.range(3));
+
+    pcp::out_of_core_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    octree.flush();
+
+    std::uint64_t const k  = 10u;
+    auto const page_faults = octree.page_faults();
+    for (auto _ : state)
+    {
+        auto const reference          = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn = octree.nearest_neighbours(reference, k, default_point_map);
+        benchmark::DoNotOptimize(knn.data());
+    }
+    state.counters["pages"]                  = static_cast<double>(octree.page_count());
+    state.counters["page_faults_per_search"] = benchmark::Counter(
+        static_cast<double>(octree.page_faults() - page_faults),
+        benchmark::Counter::kAvgIterations);
+}
+
+static void bm_linked_octree_clustered_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_clustered_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(3));
+    for (auto _ : state)
+    {
+        auto const reference          = get_clustered_reference_point(points, min, max);
+        std::vector<pcp::point_t> knn = octree.nearest_neighbours(reference, k, default_point_map);
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+static void bm_linked_octree_all_points_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(3));
+    std::vector<std::vector<pcp::point_t>> knn(points.size());
+    for (auto _ : state)
+    {
+        std::transform(
+            std::execution::par,
+            points.cbegin(),
+            points.cend(),
+            knn.begin(),
+            [&](pcp::point_t const& p) {
+                return octree.nearest_neighbours(p, k, default_point_map);
+            });
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linked_octree_batch_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(3));
+    std::vector<std::vector<pcp::point_t>> knn(points.size());
+    for (auto _ : state)
+    {
+        octree.batch_nearest_neighbours(
+            std::execution::par,
+            points.cbegin(),
+            points.cend(),
+            k,
+            default_point_map,
+            knn.begin());
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linked_kdtree_all_points_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(2));
+    std::vector<std::vector<pcp::point_t>> knn(points.size());
+    for (auto _ : state)
+    {
+        std::transform(
+            std::execution::par,
+            points.cbegin(),
+            points.cend(),
+            knn.begin(),
+            [&](pcp::point_t const& p) { return kdtree.nearest_neighbours(p, k); });
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linked_kdtree_batch_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(2));
+    std::vector<std::array<float, 3u>> targets(points.size());
+    std::transform(points.cbegin(), points.cend(), targets.begin(), default_coordinate_map);
+    std::vector<std::vector<pcp::point_t>> knn(points.size());
+    for (auto _ : state)
+    {
+        kdtree.batch_nearest_neighbours(
+            std::execution::par,
+            targets.cbegin(),
+            targets.cend(),
+            k,
+            knn.begin());
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linked_kdtree_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(2));
+    for (auto _ : state)
+    {
+        auto const reference          = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn = kdtree.nearest_neighbours(reference, k);
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static pcp::approximate_knn_parameters_t
+get_approximation(std::int64_t const epsilon_percent, std::int64_t const max_visited_leaves)
+{
+    // epsilon is given in percent, and a leaf budget of 0 is unlimited
+    pcp::approximate_knn_parameters_t approximation;
+    approximation.epsilon = static_cast<double>(epsilon_percent) / 100.;
+    if (max_visited_leaves > 0)
+        approximation.max_visited_leaves = static_cast<std::size_t>(max_visited_leaves);
+    return approximation;
+}
+template <class Neighbours>
+static double
+get_recall(std::vector<Neighbours> const& exact, std::vector<Neighbours> const& approximate)
+{
+    // fraction of the exact neighbours found by the approximate searches
+    std::size_t found = 0u;
+    std::size_t total = 0u;
+    for (std::size_t i = 0u; i < exact.size(); ++i)
+    {
+        total += exact[i].size();
+        for (auto const& neighbour : approximate[i])
+            found += static_cast<std::size_t>(std::count_if(
+                exact[i].cbegin(),
+                exact[i].cend(),
+                [&](auto const& other) { return other.element == neighbour.element; }));
+    }
+    return total == 0u ? 1. : static_cast<double>(found) / static_cast<double>(total);
+}
+static void bm_linked_octree_approximate_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    std::size_t const k = static_cast<std::size_t>(state.range(3));
+    auto const approximation = get_approximation(state.range(4), state.range(5));
+
+    // neighbourhoods of points of the cloud, as in normal estimation
+    std::size_t const num_targets = std::min<std::size_t>(points.size(), 1u << 10);
+    pcp::linked_octree_t::knn_scratch_type scratch;
+    std::vector<std::vector<pcp::linked_octree_t::neighbour_type>> exact(num_targets);
+    std::vector<std::vector<pcp::linked_octree_t::neighbour_type>> approximate(num_targets);
+    for (std::size_t i = 0u; i < num_targets; ++i)
+        octree.nearest_neighbours(
+            points[i],
+            k,
+            default_point_map,
+            scratch,
+            std::back_inserter(exact[i]));
+
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0u; i < num_targets; ++i)
+        {
+            approximate[i].clear();
+            octree.approximate_nearest_neighbours(
+                points[i],
+                k,
+                default_point_map,
+                approximation,
+                scratch,
+                std::back_inserter(approximate[i]));
+        }
+        benchmark::DoNotOptimize(approximate.data());
+    }
+    state.counters["recall"] = get_recall(exact, approximate);
+}
+static void bm_linked_kdtree_approximate_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    using kdtree_type =
+        pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)>;
+    kdtree_type kdtree{points.begin(), points.end(), default_coordinate_map, params};
+
+    std::size_t const k = static_cast<std::size_t>(state.range(2));
+    auto const approximation = get_approximation(state.range(3), state.range(4));
+
+    // neighbourhoods of points of the cloud, as in normal estimation
+    std::size_t const num_targets = std::min<std::size_t>(points.size(), 1u << 10);
+    typename kdtree_type::knn_scratch_type scratch;
+    std::vector<std::vector<typename kdtree_type::neighbour_type>> exact(num_targets);
+    std::vector<std::vector<typename kdtree_type::neighbour_type>> approximate(num_targets);
+    for (std::size_t i = 0u; i < num_targets; ++i)
+        kdtree.nearest_neighbours(
+            default_coordinate_map(points[i]),
+            k,
+            scratch,
+            std::back_inserter(exact[i]));
+
+    for (auto _ : state)
+    {
+        for (std::size_t i = 0u; i < num_targets; ++i)
+        {
+            approximate[i].clear();
+            kdtree.approximate_nearest_neighbours(
+                default_coordinate_map(points[i]),
+                k,
+                approximation,
+                scratch,
+                std::back_inserter(approximate[i]));
+        }
+        benchmark::DoNotOptimize(approximate.data());
+    }
+    state.counters["recall"] = get_recall(exact, approximate);
+}
+
+template <class Neighbours>
+static void truncate_to_nearest(Neighbours& neighbours, std::size_t const k)
+{
+    // emulates a "k within radius" query with a range search followed by a sort
+    auto const middle =
+        neighbours.begin() + static_cast<std::ptrdiff_t>(std::min(k, neighbours.size()));
+    std::partial_sort(neighbours.begin(), middle, neighbours.end());
+    neighbours.erase(middle, neighbours.end());
+}
+template <class Neighbours>
+static void erase_outside_radius(Neighbours& neighbours, float const radius)
+{
+    // emulates a "k within radius" query with a knn search followed by a filter
+    neighbours.erase(
+        std::find_if(
+            neighbours.begin(),
+            neighbours.end(),
+            [=](auto const& neighbour) { return neighbour.squared_distance > radius * radius; }),
+        neighbours.end());
+}
+static void bm_linked_octree_radius_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    std::size_t const k = static_cast<std::size_t>(state.range(3));
+    auto const radius   = static_cast<float>(state.range(4));
+    // 0: hybrid search, 1: knn search then filter, 2: range search then sort and truncate
+    auto const mode = state.range(5);
+
+    std::size_t const num_targets = std::min<std::size_t>(points.size(), 1u << 10);
+    pcp::linked_octree_t::knn_scratch_type scratch;
+    std::vector<pcp::linked_octree_t::neighbour_type> neighbours;
+    std::size_t num_neighbours = 0u;
+    for (auto _ : state)
+    {
+        num_neighbours = 0u;
+        for (std::size_t i = 0u; i < num_targets; ++i)
+        {
+            auto const& target = points[i];
+            pcp::sphere_t<pcp::point_t> sphere;
+            sphere.position = target;
+            sphere.radius   = radius;
+            neighbours.clear();
+            if (mode == 0)
+            {
+                octree.radius_nearest_neighbours(
+                    target,
+                    k,
+                    radius,
+                    default_point_map,
+                    scratch,
+                    std::back_inserter(neighbours));
+            }
+            else if (mode == 1)
+            {
+                octree.nearest_neighbours(
+                    target,
+                    k,
+                    default_point_map,
+                    scratch,
+                    std::back_inserter(neighbours));
+                erase_outside_radius(neighbours, radius);
+            }
+            else
+            {
+                octree.visit_range(sphere, default_point_map, [&](pcp::point_t const& p) {
+                    if (!pcp::common::are_vectors_equal(p, target))
+                        neighbours.push_back({&p, pcp::common::squared_distance(target, p)});
+                });
+                truncate_to_nearest(neighbours, k);
+            }
+            num_neighbours += neighbours.size();
+        }
+        benchmark::DoNotOptimize(neighbours.data());
+    }
+    state.counters["neighbours"] =
+        static_cast<double>(num_neighbours) / static_cast<double>(num_targets);
+}
+static void bm_linked_kdtree_radius_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    using kdtree_type =
+        pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)>;
+    kdtree_type kdtree{points.begin(), points.end(), default_coordinate_map, params};
+
+    std::size_t const k = static_cast<std::size_t>(state.range(2));
+    auto const radius   = static_cast<float>(state.range(3));
+    // 0: hybrid search, 1: knn search then filter, 2: range search then sort and truncate
+    auto const mode = state.range(4);
+
+    std::size_t const num_targets = std::min<std::size_t>(points.size(), 1u << 10);
+    typename kdtree_type::knn_scratch_type scratch;
+    std::vector<typename kdtree_type::neighbour_type> neighbours;
+    std::size_t num_neighbours = 0u;
+    for (auto _ : state)
+    {
+        num_neighbours = 0u;
+        for (std::size_t i = 0u; i < num_targets; ++i)
+        {
+            auto const& target = points[i];
+            pcp::sphere_a<float> sphere;
+            sphere.position = default_coordinate_map(target);
+            sphere.radius   = radius;
+            neighbours.clear();
+            if (mode == 0)
+            {
+                kdtree.radius_nearest_neighbours(
+                    default_coordinate_map(target),
+                    k,
+                    radius,
+                    scratch,
+                    std::back_inserter(neighbours));
+            }
+            else if (mode == 1)
+            {
+                kdtree.nearest_neighbours(
+                    default_coordinate_map(target),
+                    k,
+                    scratch,
+                    std::back_inserter(neighbours));
+                erase_outside_radius(neighbours, radius);
+            }
+            else
+            {
+                kdtree.visit_range(sphere, [&](pcp::point_t const& p) {
+                    if (!pcp::common::are_vectors_equal(p, target))
+                        neighbours.push_back({&p, pcp::common::squared_distance(target, p)});
+                });
+                truncate_to_nearest(neighbours, k);
+            }
+            num_neighbours += neighbours.size();
+        }
+        benchmark::DoNotOptimize(neighbours.data());
+    }
+    state.counters["neighbours"] =
+        static_cast<double>(num_neighbours) / static_cast<double>(num_targets);
+}
+static void bm_frozen_octree_index_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    std::vector<std::uint32_t> indices(points.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    auto const index_map = [&points](std::uint32_t i) {
+        return points[i];
+    };
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    using params_type = pcp::octree_parameters_t<pcp::point_t>;
+    pcp::basic_linked_octree_t<std::uint32_t, params_type> const linked_octree(
+        indices.cbegin(),
+        indices.cend(),
+        index_map,
+        params);
+    bool const cache_coordinates = state.range(4) != 0;
+    auto const octree =
+        cache_coordinates ? linked_octree.freeze(index_map) : linked_octree.freeze();
+
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(3));
+    for (auto _ : state)
+    {
+        auto const reference           = get_reference_point(min, max);
+        std::vector<std::uint32_t> knn = octree.nearest_neighbours(reference, k, index_map);
+        benchmark::DoNotOptimize(knn.data());
+    }
+
+    auto const bytes = octree.nodes().size() * sizeof(pcp::frozen_octree_node_t) +
+                       octree.size() * sizeof(std::uint32_t) +
+                       (cache_coordinates ? octree.size() * 3u * sizeof(float) : 0u);
+    state.counters["bytes_per_point"] =
+        static_cast<double>(bytes) / static_cast<double>(octree.size());
+}
+static void bm_linked_kdtree_index_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+    std::vector<std::uint32_t> indices(points.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    auto const index_map = [&points](std::uint32_t i) {
+        return std::array<float, 3u>{points[i].x(), points[i].y(), points[i].z()};
+    };
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth         = static_cast<std::size_t>(state.range(1));
+    params.construction      = pcp::kdtree::construction_t::nth_element;
+    params.cache_coordinates = state.range(3) != 0;
+
+    using kdtree_type = pcp::basic_linked_kdtree_t<std::uint32_t, 3u, decltype(index_map)>;
+    kdtree_type kdtree{indices.begin(), indices.end(), index_map, params};
+
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(2));
+    for (auto _ : state)
+    {
+        auto const reference = get_reference_point(min, max);
+        std::array<float, 3u> const target{reference.x(), reference.y(), reference.z()};
+        std::vector<std::uint32_t> knn = kdtree.nearest_neighbours(target, k);
+        benchmark::DoNotOptimize(knn.data());
+    }
+
+    std::size_t nodes      = 0u;
+    auto const count_nodes = [&nodes](auto const& self, auto const* node) -> void {
+        if (node == nullptr)
+            return;
+        ++nodes;
+        self(self, node->left().get());
+        self(self, node->right().get());
+    };
+    count_nodes(count_nodes, kdtree.root().get());
+    auto const bytes = nodes * sizeof(typename kdtree_type::node_type) +
+                       kdtree.size() * sizeof(std::uint32_t) +
+                       (params.cache_coordinates ? kdtree.size() * 3u * sizeof(float) : 0u);
+    state.counters["bytes_per_point"] =
+        static_cast<double>(bytes) / static_cast<double>(kdtree.size());
+}
+
+static void bm_linked_kdtree_growing_k_knn_search(benchmark::State& state)
+{
+    auto constexpr min    = get_bm_min();
+    auto constexpr max    = get_bm_max();
+    auto const num_points = static_cast<std::uint64_t>(state.range(0));
+    std::vector<pcp::point_t> points = get_vector_of_points(num_points, min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+    auto const squared_radius =
+        get_squared_radius_holding(num_points, static_cast<std::uint64_t>(state.range(2)));
+    for (auto _ : state)
+    {
+        auto const reference = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn;
+        for (std::size_t k = 8u;; k *= 2u)
+        {
+            knn = kdtree.nearest_neighbours(reference, k);
+            if (knn.size() < k ||
+                pcp::common::squared_distance(reference, knn.back()) > squared_radius)
+                break;
+        }
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linked_kdtree_incremental_knn_search(benchmark::State& state)
+{
+    auto constexpr min    = get_bm_min();
+    auto constexpr max    = get_bm_max();
+    auto const num_points = static_cast<std::uint64_t>(state.range(0));
+    std::vector<pcp::point_t> points = get_vector_of_points(num_points, min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+    auto const squared_radius =
+        get_squared_radius_holding(num_points, static_cast<std::uint64_t>(state.range(2)));
+    for (auto _ : state)
+    {
+        auto const reference = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn;
+        for (auto const& neighbour : kdtree.incremental_nearest_neighbours(reference))
+        {
+            if (neighbour.squared_distance > squared_radius)
+                break;
+
+            knn.push_back(*neighbour.element);
+        }
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_linked_kdtree_clustered_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_clustered_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(2));
+    for (auto _ : state)
+    {
+        auto const reference          = get_clustered_reference_point(points, min, max);
+        std::vector<pcp::point_t> knn = kdtree.nearest_neighbours(reference, k);
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+static void bm_linked_kdtree_adaptive_depth_knn_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.construction          = pcp::kdtree::construction_t::nth_element;
+    params.compute_max_depth     = true;
+    params.max_elements_per_leaf = 64u;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+    std::uint64_t const k = static_cast<std::uint64_t>(state.range(1));
+    for (auto _ : state)
+    {
+        auto const reference          = get_reference_point(min, max);
+        std::vector<pcp::point_t> knn = kdtree.nearest_neighbours(reference, k);
+        benchmark::DoNotOptimize(knn.data());
+    }
+}
+
+static void bm_vector_iterator_traversal(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    for (auto _ : state)
+    {
+        bool const all = std::all_of(std::cbegin(points), std::cend(points), [](auto const& p) {
+            return pcp::common::are_vectors_equal(p, p);
+        });
+        benchmark::DoNotOptimize(all);
+    }
+}
+
+static void bm_linked_octree_iterator_traversal(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    for (auto _ : state)
+    {
+        bool const all = std::all_of(octree.cbegin(), octree.cend(), [](auto const& p) {
+            return pcp::common::are_vectors_equal(p, p);
+        });
+        benchmark::DoNotOptimize(all);
+    }
+}
+
+static void bm_linked_octree_bucket_traversal(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    for (auto _ : state)
+    {
+        bool const all =
+            std::all_of(octree.bucket_begin(), octree.bucket_end(), [](auto const& bucket) {
+                return std::all_of(bucket.cbegin(), bucket.cend(), [](auto const& p) {
+                    return pcp::common::are_vectors_equal(p, p);
+                });
+            });
+        benchmark::DoNotOptimize(all);
+    }
+}
+
+static void bm_linear_octree_iterator_traversal(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+
+    pcp::linear_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    for (auto _ : state)
+    {
+        bool const all = std::all_of(octree.cbegin(), octree.cend(), [](auto const& p) {
+            return pcp::common::are_vectors_equal(p, p);
+        });
+        benchmark::DoNotOptimize(all);
+    }
+}
+
+static void bm_linked_kdtree_iterator_traversal(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree(
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params);
+    for (auto _ : state)
+    {
+        bool const all = std::all_of(kdtree.cbegin(), kdtree.cend(), [](auto const& p) {
+            return pcp::common::are_vectors_equal(p, p);
+        });
+        benchmark::DoNotOptimize(all);
+    }
+}
+
+BENCHMARK(bm_vector_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12})
+    ->Args({1 << 16})
+    ->Args({1 << 20})
+    ->Args({1 << 24});
+BENCHMARK(bm_linked_octree_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 4u, 21u})
+    ->Args({1 << 20, 4u, 21u})
+    ->Args({1 << 12, 32u, 11u})
+    ->Args({1 << 16, 32u, 11u})
+    ->Args({1 << 20, 32u, 11u})
+    ->Args({1 << 24, 32u, 11u})
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 24, 512u, 21u});
+BENCHMARK(bm_linked_octree_parallel_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 24, 512u, 21u});
+BENCHMARK(bm_linked_octree_concurrent_insertion)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->Args({1 << 20, 32u, 21u, 1u})
+    ->Args({1 << 20, 32u, 21u, 2u})
+    ->Args({1 << 20, 32u, 21u, 4u})
+    ->Args({1 << 20, 32u, 21u, 8u})
+    ->Args({1 << 20, 32u, 21u, 16u})
+    ->Args({1 << 20, 32u, 21u, 32u})
+    ->Args({1 << 20, 32u, 21u, 64u});
+BENCHMARK(bm_linked_octree_crop)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 22, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 22, 512u, 21u});
+BENCHMARK(bm_linked_octree_lazy_crop)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 22, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 22, 512u, 21u});
+BENCHMARK(bm_linked_octree_erase)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_octree_erase_if)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_octree_moved_points_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_octree_update)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_octree_refit)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_octree_pool_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 4u, 21u})
+    ->Args({1 << 20, 4u, 21u})
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 24, 512u, 21u});
+BENCHMARK(bm_linear_octree_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 24, 512u, 21u});
+BENCHMARK(bm_frozen_octree_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 24, 512u, 21u});
+BENCHMARK(bm_linked_kdtree_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 11u})
+    ->Args({1 << 16, 11u})
+    ->Args({1 << 20, 11u})
+    ->Args({1 << 24, 11u})
+    ->Args({1 << 12, 21u})
+    ->Args({1 << 16, 21u})
+    ->Args({1 << 20, 21u})
+    ->Args({1 << 24, 21u});
+BENCHMARK(bm_linked_kdtree_pool_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 11u})
+    ->Args({1 << 16, 11u})
+    ->Args({1 << 20, 11u})
+    ->Args({1 << 24, 11u})
+    ->Args({1 << 12, 21u})
+    ->Args({1 << 16, 21u})
+    ->Args({1 << 20, 21u})
+    ->Args({1 << 24, 21u});
+BENCHMARK(bm_linked_octree_teardown)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 4u, 21u})
+    ->Args({1 << 20, 32u, 21u});
+BENCHMARK(bm_linked_octree_pool_teardown)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 4u, 21u})
+    ->Args({1 << 20, 32u, 21u});
+BENCHMARK(bm_linked_kdtree_teardown)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 21u});
+BENCHMARK(bm_linked_kdtree_pool_teardown)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 21u});
+static void bm_linked_octree_sphere_range_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    for (auto _ : state)
+    {
+        auto const range = get_sphere_range(min, max);
+        std::vector<pcp::point_t> found_points = octree.range_search(range, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+static void bm_linked_octree_sphere_range_count(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    for (auto _ : state)
+    {
+        auto const range = get_sphere_range(min, max);
+        auto const count = octree.range_count(range, default_point_map);
+        benchmark::DoNotOptimize(count);
+    }
+}
+static void bm_linked_octree_sphere_range_aggregate(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::aggregate_octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::basic_linked_octree_t<pcp::point_t, decltype(params)>
+        octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    for (auto _ : state)
+    {
+        auto const range     = get_sphere_range(min, max);
+        auto const aggregate = octree.range_aggregate(range, default_point_map);
+        benchmark::DoNotOptimize(aggregate);
+    }
+}
+static void bm_linked_kdtree_sphere_range_search(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+
+    for (auto _ : state)
+    {
+        auto const range                       = get_sphere_range_kdtree(min, max);
+        std::vector<pcp::point_t> found_points = kdtree.range_search(range);
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+static void bm_linked_octree_sphere_any_in_range(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    for (auto _ : state)
+    {
+        auto const range          = get_sphere_range(min, max);
+        bool const is_range_empty = !octree.any_in_range(range, default_point_map);
+        benchmark::DoNotOptimize(is_range_empty);
+    }
+}
+static void bm_linked_octree_sphere_range_search_first(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+
+    auto const n = static_cast<std::size_t>(state.range(3));
+    for (auto _ : state)
+    {
+        auto const range = get_sphere_range(min, max);
+        std::vector<pcp::point_t> found_points =
+            octree.range_search_first(range, n, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
+    }
+}
+static void bm_linked_kdtree_sphere_any_in_range(benchmark::State& state)
+{
+    auto constexpr min = get_bm_min();
+    auto constexpr max = get_bm_max();
+    std::vector<pcp::point_t> points =
+        get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
+
+    pcp::kdtree::construction_params_t params;
+    params.max_depth    = static_cast<std::size_t>(state.range(1));
+    params.construction = pcp::kdtree::construction_t::nth_element;
+
+    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
+        points.begin(),
+        points.end(),
+        default_coordinate_map,
+        params};
+
+    for (auto _ : state)
+    {
+        auto const range          = get_sphere_range_kdtree(min, max);
+        bool const is_range_empty = !kdtree.any_in_range(range);
+        benchmark::DoNotOptimize(is_range_empty);
     }
 }
-static void bm_linked_kdtree_range_search(benchmark::State& state)
+static void bm_linked_kdtree_sphere_range_search_first(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
@@ -204,43 +2471,45 @@ static void bm_linked_kdtree_range_search(benchmark::State& state)
         default_coordinate_map,
         params};
 
+    auto const n = static_cast<std::size_t>(state.range(2));
     for (auto _ : state)
     {
-        pcp::kd_axis_aligned_bounding_box_t range = get_range_kdtree(min, max);
-        std::vector<pcp::point_t> found_points    = kdtree.range_search(range);
+        auto const range                       = get_sphere_range_kdtree(min, max);
+        std::vector<pcp::point_t> found_points = kdtree.range_search_first(range, n);
         benchmark::DoNotOptimize(found_points.data());
     }
 }
-
-static void bm_vector_knn_search(benchmark::State& state)
+static void bm_vector_ray_cast(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
     std::vector<pcp::point_t> points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
-    std::int64_t const k = state.range(1);
+
+    float const radius = .5f;
     for (auto _ : state)
     {
-        pcp::point_t const reference = get_reference_point(min, max);
+        auto const origin    = get_reference_point(min, max);
+        auto const direction = get_ray_direction();
+        pcp::common::basic_vector3d_t<float> const unit_direction =
+            direction / pcp::common::norm(direction);
 
-        auto const distance = [](pcp::point_t const& p1, pcp::point_t const& p2) -> float {
-            auto const dx = p2.x() - p1.x();
-            auto const dy = p2.y() - p1.y();
-            auto const dz = p2.z() - p1.z();
-            return dx * dx + dy * dy + dz * dz;
-        };
-        auto const less_than = [reference,
-                                distance](pcp::point_t const& p1, pcp::point_t const& p2) -> bool {
-            return distance(p1, reference) < distance(p2, reference);
-        };
+        pcp::point_t const* hit = nullptr;
+        float hit_t             = std::numeric_limits<float>::max();
+        for (auto const& p : points)
+        {
+            pcp::common::basic_vector3d_t<float> const v = p - origin;
+            float const t = pcp::common::inner_product(v, unit_direction);
+            if (t < 0.f || t >= hit_t || pcp::common::inner_product(v, v) - t * t > radius * radius)
+                continue;
 
-        std::sort(points.begin(), points.end(), less_than);
-        std::vector<pcp::point_t> knn(points.cbegin(), points.cbegin() + k);
-        benchmark::DoNotOptimize(knn.data());
+            hit   = &p;
+            hit_t = t;
+        }
+        benchmark::DoNotOptimize(hit);
     }
 }
-
-static void bm_linked_octree_knn_search(benchmark::State& state)
+static void bm_linked_octree_ray_cast(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
@@ -252,144 +2521,138 @@ static void bm_linked_octree_knn_search(benchmark::State& state)
         pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
     params.node_capacity = static_cast<std::uint32_t>(state.range(1));
     params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
-
     pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
-    std::uint64_t const k = static_cast<std::uint64_t>(state.range(3));
+
     for (auto _ : state)
     {
-        auto const reference          = get_reference_point(min, max);
-        std::vector<pcp::point_t> knn = octree.nearest_neighbours(reference, k, default_point_map);
-        benchmark::DoNotOptimize(knn.data());
+        auto const origin    = get_reference_point(min, max);
+        auto const direction = get_ray_direction();
+        auto const hit       = octree.ray_cast(origin, direction, .5f, default_point_map);
+        benchmark::DoNotOptimize(hit);
     }
 }
-
-static void bm_linked_kdtree_knn_search(benchmark::State& state)
+static void bm_vector_frustum_search(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
     std::vector<pcp::point_t> points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
 
-    pcp::kdtree::construction_params_t params;
-    params.max_depth    = static_cast<std::size_t>(state.range(1));
-    params.construction = pcp::kdtree::construction_t::nth_element;
-
-    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
-        points.begin(),
-        points.end(),
-        default_coordinate_map,
-        params};
-    std::uint64_t const k = static_cast<std::uint64_t>(state.range(2));
     for (auto _ : state)
     {
-        auto const reference          = get_reference_point(min, max);
-        std::vector<pcp::point_t> knn = kdtree.nearest_neighbours(reference, k);
-        benchmark::DoNotOptimize(knn.data());
+        auto const frustum = get_frustum(min, max);
+        std::vector<pcp::point_t> found_points;
+        for (auto const& p : points)
+        {
+            bool const is_in_frustum =
+                std::all_of(frustum.cbegin(), frustum.cend(), [&p](auto const& plane) {
+                    return plane.signed_distance_to(p) >= 0.f;
+                });
+            if (is_in_frustum)
+                found_points.push_back(p);
+        }
+        benchmark::DoNotOptimize(found_points.data());
     }
 }
-
-static void bm_linked_kdtree_adaptive_depth_knn_search(benchmark::State& state)
+static void bm_linked_octree_frustum_search(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
     std::vector<pcp::point_t> points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
 
-    pcp::kdtree::construction_params_t params;
-    params.construction          = pcp::kdtree::construction_t::nth_element;
-    params.compute_max_depth     = true;
-    params.max_elements_per_leaf = 64u;
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
 
-    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree{
-        points.begin(),
-        points.end(),
-        default_coordinate_map,
-        params};
-    std::uint64_t const k = static_cast<std::uint64_t>(state.range(1));
     for (auto _ : state)
     {
-        auto const reference          = get_reference_point(min, max);
-        std::vector<pcp::point_t> knn = kdtree.nearest_neighbours(reference, k);
-        benchmark::DoNotOptimize(knn.data());
+        auto const frustum = get_frustum(min, max);
+        std::vector<pcp::point_t> found_points =
+            octree.frustum_search(frustum, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
     }
 }
 
-static void bm_vector_iterator_traversal(benchmark::State& state)
+static void bm_lod_octree_build_representatives(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
     std::vector<pcp::point_t> points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
 
+    pcp::lod_octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::basic_linked_octree_t<pcp::point_t, pcp::lod_octree_parameters_t<pcp::point_t>>
+        octree(points.cbegin(), points.cend(), default_point_map, params);
+
     for (auto _ : state)
     {
-        bool const all = std::all_of(std::cbegin(points), std::cend(points), [](auto const& p) {
-            return pcp::common::are_vectors_equal(p, p);
-        });
-        benchmark::DoNotOptimize(all);
+        octree.build_representatives(default_point_map);
+        benchmark::ClobberMemory();
     }
 }
-
-static void bm_linked_octree_iterator_traversal(benchmark::State& state)
+static void bm_lod_octree_lod_query(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
     std::vector<pcp::point_t> points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
 
-    pcp::octree_parameters_t<pcp::point_t> params;
+    pcp::lod_octree_parameters_t<pcp::point_t> params;
     params.voxel_grid =
         pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
     params.node_capacity = static_cast<std::uint32_t>(state.range(1));
     params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::basic_linked_octree_t<pcp::point_t, pcp::lod_octree_parameters_t<pcp::point_t>>
+        octree(points.cbegin(), points.cend(), default_point_map, params);
+    octree.build_representatives(default_point_map);
 
-    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
+    auto const range      = get_large_range(min, max);
+    auto const max_points = static_cast<std::size_t>(state.range(3));
     for (auto _ : state)
     {
-        bool const all = std::all_of(octree.cbegin(), octree.cend(), [](auto const& p) {
-            return pcp::common::are_vectors_equal(p, p);
-        });
-        benchmark::DoNotOptimize(all);
+        std::vector<pcp::point_t> found_points =
+            octree.lod_query(range, max_points, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
     }
 }
-
-static void bm_linked_kdtree_iterator_traversal(benchmark::State& state)
+static void bm_linked_octree_large_range_search(benchmark::State& state)
 {
     auto constexpr min = get_bm_min();
     auto constexpr max = get_bm_max();
     std::vector<pcp::point_t> points =
         get_vector_of_points(static_cast<std::uint64_t>(state.range(0)), min, max);
 
-    pcp::kdtree::construction_params_t params;
-    params.max_depth    = static_cast<std::size_t>(state.range(1));
-    params.construction = pcp::kdtree::construction_t::nth_element;
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{min, min, min}, {max, max, max}};
+    params.node_capacity = static_cast<std::uint32_t>(state.range(1));
+    params.max_depth     = static_cast<decltype(params.max_depth)>(state.range(2));
+    pcp::linked_octree_t octree(points.cbegin(), points.cend(), default_point_map, params);
 
-    pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(default_coordinate_map)> kdtree(
-        points.begin(),
-        points.end(),
-        default_coordinate_map,
-        params);
+    auto const range = get_large_range(min, max);
     for (auto _ : state)
     {
-        bool const all = std::all_of(kdtree.cbegin(), kdtree.cend(), [](auto const& p) {
-            return pcp::common::are_vectors_equal(p, p);
-        });
-        benchmark::DoNotOptimize(all);
+        std::vector<pcp::point_t> found_points = octree.range_search(range, default_point_map);
+        benchmark::DoNotOptimize(found_points.data());
     }
 }
 
-BENCHMARK(bm_vector_construction)
+BENCHMARK(bm_vector_range_search)
     ->Unit(benchmark::kMillisecond)
     ->Args({1 << 12})
     ->Args({1 << 16})
     ->Args({1 << 20})
     ->Args({1 << 24});
-BENCHMARK(bm_linked_octree_construction)
+BENCHMARK(bm_linked_octree_range_search)
     ->Unit(benchmark::kMillisecond)
-    ->Args({1 << 12, 32u, 11u})
-    ->Args({1 << 16, 32u, 11u})
-    ->Args({1 << 20, 32u, 11u})
-    ->Args({1 << 24, 32u, 11u})
     ->Args({1 << 12, 32u, 21u})
     ->Args({1 << 16, 32u, 21u})
     ->Args({1 << 20, 32u, 21u})
@@ -398,23 +2661,17 @@ BENCHMARK(bm_linked_octree_construction)
     ->Args({1 << 16, 512u, 21u})
     ->Args({1 << 20, 512u, 21u})
     ->Args({1 << 24, 512u, 21u});
-BENCHMARK(bm_linked_kdtree_construction)
-    ->Unit(benchmark::kMillisecond)
-    ->Args({1 << 12, 11u})
-    ->Args({1 << 16, 11u})
-    ->Args({1 << 20, 11u})
-    ->Args({1 << 24, 11u})
-    ->Args({1 << 12, 21u})
-    ->Args({1 << 16, 21u})
-    ->Args({1 << 20, 21u})
-    ->Args({1 << 24, 21u});
-BENCHMARK(bm_vector_range_search)
+BENCHMARK(bm_linear_octree_range_search)
     ->Unit(benchmark::kMillisecond)
-    ->Args({1 << 12})
-    ->Args({1 << 16})
-    ->Args({1 << 20})
-    ->Args({1 << 24});
-BENCHMARK(bm_linked_octree_range_search)
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 24, 512u, 21u});
+BENCHMARK(bm_frozen_octree_range_search)
     ->Unit(benchmark::kMillisecond)
     ->Args({1 << 12, 32u, 21u})
     ->Args({1 << 16, 32u, 21u})
@@ -434,6 +2691,89 @@ BENCHMARK(bm_linked_kdtree_range_search)
     ->Args({1 << 16, 21u})
     ->Args({1 << 20, 21u})
     ->Args({1 << 24, 21u});
+BENCHMARK(bm_linked_octree_sphere_range_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_octree_sphere_range_count)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_octree_sphere_range_aggregate)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_kdtree_sphere_range_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 11u})
+    ->Args({1 << 20, 11u})
+    ->Args({1 << 16, 21u})
+    ->Args({1 << 20, 21u});
+BENCHMARK(bm_linked_octree_sphere_any_in_range)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_linked_octree_sphere_range_search_first)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 32u, 21u, 10u})
+    ->Args({1 << 20, 32u, 21u, 10u})
+    ->Args({1 << 16, 512u, 21u, 10u})
+    ->Args({1 << 20, 512u, 21u, 10u});
+BENCHMARK(bm_linked_kdtree_sphere_any_in_range)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 11u})
+    ->Args({1 << 20, 11u})
+    ->Args({1 << 16, 21u})
+    ->Args({1 << 20, 21u});
+BENCHMARK(bm_linked_kdtree_sphere_range_search_first)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 11u, 10u})
+    ->Args({1 << 20, 11u, 10u})
+    ->Args({1 << 16, 21u, 10u})
+    ->Args({1 << 20, 21u, 10u});
+BENCHMARK(bm_vector_ray_cast)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16})
+    ->Args({1 << 20});
+BENCHMARK(bm_linked_octree_ray_cast)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_vector_frustum_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16})
+    ->Args({1 << 20});
+BENCHMARK(bm_linked_octree_frustum_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u});
+BENCHMARK(bm_lod_octree_build_representatives)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u});
+BENCHMARK(bm_lod_octree_lod_query)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u, 1 << 8})
+    ->Args({1 << 20, 32u, 21u, 1 << 8})
+    ->Args({1 << 20, 32u, 21u, 1 << 12})
+    ->Args({1 << 24, 32u, 21u, 1 << 12});
+BENCHMARK(bm_linked_octree_large_range_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u});
 BENCHMARK(bm_vector_knn_search)
     ->Unit(benchmark::kMillisecond)
     ->Args({1 << 12, 10u})
@@ -450,6 +2790,138 @@ BENCHMARK(bm_linked_octree_knn_search)
     ->Args({1 << 16, 512u, 21u, 10u})
     ->Args({1 << 20, 512u, 21u, 10u})
     ->Args({1 << 24, 512u, 21u, 10u});
+BENCHMARK(bm_linked_octree_clustered_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u, 15u})
+    ->Args({1 << 16, 32u, 21u, 15u})
+    ->Args({1 << 20, 32u, 21u, 15u})
+    ->Args({1 << 24, 32u, 21u, 15u});
+BENCHMARK(bm_linear_octree_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u, 10u})
+    ->Args({1 << 16, 32u, 21u, 10u})
+    ->Args({1 << 20, 32u, 21u, 10u})
+    ->Args({1 << 24, 32u, 21u, 10u})
+    ->Args({1 << 12, 512u, 21u, 10u})
+    ->Args({1 << 16, 512u, 21u, 10u})
+    ->Args({1 << 20, 512u, 21u, 10u})
+    ->Args({1 << 24, 512u, 21u, 10u});
+BENCHMARK(bm_frozen_octree_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u, 10u})
+    ->Args({1 << 16, 32u, 21u, 10u})
+    ->Args({1 << 20, 32u, 21u, 10u})
+    ->Args({1 << 24, 32u, 21u, 10u})
+    ->Args({1 << 12, 512u, 21u, 10u})
+    ->Args({1 << 16, 512u, 21u, 10u})
+    ->Args({1 << 20, 512u, 21u, 10u})
+    ->Args({1 << 24, 512u, 21u, 10u});
+BENCHMARK(bm_locked_linked_octree_knn_search_during_ingest)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 32u, 21u, 0u})
+    ->Args({1 << 16, 32u, 21u, 1u})
+    ->Args({1 << 20, 32u, 21u, 0u})
+    ->Args({1 << 20, 32u, 21u, 1u})
+    ->UseRealTime();
+BENCHMARK(bm_persistent_octree_knn_search_during_ingest)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 16, 32u, 21u, 0u})
+    ->Args({1 << 16, 32u, 21u, 1u})
+    ->Args({1 << 20, 32u, 21u, 0u})
+    ->Args({1 << 20, 32u, 21u, 1u})
+    ->UseRealTime();
+BENCHMARK(bm_linked_octree_sliding_window_stream)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u});
+BENCHMARK(bm_sliding_window_octree_stream)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u});
+BENCHMARK(bm_out_of_core_octree_construction)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 512u, 21u, 16u})
+    ->Args({1 << 20, 512u, 21u, 16u})
+    ->Args({1 << 20, 512u, 21u, 1024u});
+BENCHMARK(bm_out_of_core_octree_knn_search)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 20, 512u, 21u, 16u})
+    ->Args({1 << 20, 512u, 21u, 256u})
+    ->Args({1 << 20, 512u, 21u, 4096u})
+    ->Args({1 << 20, 4096u, 21u, 16u})
+    ->Args({1 << 20, 4096u, 21u, 512u});
+BENCHMARK(bm_linked_octree_growing_k_knn_search)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 20, 32u, 21u, 10u})
+    ->Args({1 << 20, 32u, 21u, 50u})
+    ->Args({1 << 20, 32u, 21u, 200u});
+BENCHMARK(bm_linked_octree_incremental_knn_search)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 20, 32u, 21u, 10u})
+    ->Args({1 << 20, 32u, 21u, 50u})
+    ->Args({1 << 20, 32u, 21u, 200u});
+BENCHMARK(bm_linked_kdtree_growing_k_knn_search)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 20, 15u, 10u})
+    ->Args({1 << 20, 15u, 50u})
+    ->Args({1 << 20, 15u, 200u});
+BENCHMARK(bm_linked_kdtree_incremental_knn_search)
+    ->Unit(benchmark::kMicrosecond)
+    ->Args({1 << 20, 15u, 10u})
+    ->Args({1 << 20, 15u, 50u})
+    ->Args({1 << 20, 15u, 200u});
+BENCHMARK(bm_linked_octree_approximate_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 32u, 21u, 10u, 0u, 0u})
+    ->Args({1 << 20, 32u, 21u, 10u, 10u, 0u})
+    ->Args({1 << 20, 32u, 21u, 10u, 50u, 0u})
+    ->Args({1 << 20, 32u, 21u, 10u, 100u, 0u})
+    ->Args({1 << 20, 32u, 21u, 10u, 0u, 8u})
+    ->Args({1 << 20, 32u, 21u, 10u, 0u, 4u})
+    ->Args({1 << 20, 32u, 21u, 10u, 0u, 2u})
+    ->Args({1 << 20, 32u, 21u, 10u, 0u, 1u});
+BENCHMARK(bm_linked_kdtree_approximate_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 15u, 10u, 0u, 0u})
+    ->Args({1 << 20, 15u, 10u, 10u, 0u})
+    ->Args({1 << 20, 15u, 10u, 50u, 0u})
+    ->Args({1 << 20, 15u, 10u, 100u, 0u})
+    ->Args({1 << 20, 15u, 10u, 0u, 8u})
+    ->Args({1 << 20, 15u, 10u, 0u, 4u})
+    ->Args({1 << 20, 15u, 10u, 0u, 2u})
+    ->Args({1 << 20, 15u, 10u, 0u, 1u});
+BENCHMARK(bm_linked_octree_radius_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 32u, 21u, 10u, 2u, 0u})
+    ->Args({1 << 20, 32u, 21u, 10u, 2u, 1u})
+    ->Args({1 << 20, 32u, 21u, 10u, 2u, 2u})
+    ->Args({1 << 20, 32u, 21u, 10u, 5u, 0u})
+    ->Args({1 << 20, 32u, 21u, 10u, 5u, 1u})
+    ->Args({1 << 20, 32u, 21u, 10u, 5u, 2u});
+BENCHMARK(bm_linked_kdtree_radius_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 15u, 10u, 2u, 0u})
+    ->Args({1 << 20, 15u, 10u, 2u, 1u})
+    ->Args({1 << 20, 15u, 10u, 2u, 2u})
+    ->Args({1 << 20, 15u, 10u, 5u, 0u})
+    ->Args({1 << 20, 15u, 10u, 5u, 1u})
+    ->Args({1 << 20, 15u, 10u, 5u, 2u});
+BENCHMARK(bm_frozen_octree_index_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 32u, 21u, 10u, 0u})
+    ->Args({1 << 20, 32u, 21u, 10u, 1u})
+    ->Args({1 << 24, 32u, 21u, 10u, 0u})
+    ->Args({1 << 24, 32u, 21u, 10u, 1u});
+BENCHMARK(bm_linked_kdtree_index_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 20, 15u, 10u, 0u})
+    ->Args({1 << 20, 15u, 10u, 1u})
+    ->Args({1 << 24, 19u, 10u, 0u})
+    ->Args({1 << 24, 19u, 10u, 1u});
 BENCHMARK(bm_linked_kdtree_knn_search)
     ->Unit(benchmark::kMillisecond)
     ->Args({1 << 12, 12u, 10u})
@@ -464,6 +2936,28 @@ BENCHMARK(bm_linked_kdtree_knn_search)
     ->Args({1 << 16, 18u, 10u})
     ->Args({1 << 20, 18u, 10u})
     ->Args({1 << 24, 18u, 10u});
+BENCHMARK(bm_linked_octree_all_points_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u, 10u})
+    ->Args({1 << 18, 32u, 21u, 10u});
+BENCHMARK(bm_linked_octree_batch_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 32u, 21u, 10u})
+    ->Args({1 << 18, 32u, 21u, 10u});
+BENCHMARK(bm_linked_kdtree_all_points_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 12u, 10u})
+    ->Args({1 << 18, 15u, 10u});
+BENCHMARK(bm_linked_kdtree_batch_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 16, 12u, 10u})
+    ->Args({1 << 18, 15u, 10u});
+BENCHMARK(bm_linked_kdtree_clustered_knn_search)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 12u, 15u})
+    ->Args({1 << 16, 12u, 15u})
+    ->Args({1 << 20, 12u, 15u})
+    ->Args({1 << 24, 12u, 15u});
 BENCHMARK(bm_linked_kdtree_adaptive_depth_knn_search)
     ->Unit(benchmark::kMillisecond)
     ->Args({1 << 12, 10u})
@@ -486,6 +2980,26 @@ BENCHMARK(bm_linked_octree_iterator_traversal)
     ->Args({1 << 16, 512u, 21u})
     ->Args({1 << 20, 512u, 21u})
     ->Args({1 << 24, 512u, 21u});
+BENCHMARK(bm_linked_octree_bucket_traversal)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 24, 512u, 21u});
+BENCHMARK(bm_linear_octree_iterator_traversal)
+    ->Unit(benchmark::kMillisecond)
+    ->Args({1 << 12, 32u, 21u})
+    ->Args({1 << 16, 32u, 21u})
+    ->Args({1 << 20, 32u, 21u})
+    ->Args({1 << 24, 32u, 21u})
+    ->Args({1 << 12, 512u, 21u})
+    ->Args({1 << 16, 512u, 21u})
+    ->Args({1 << 20, 512u, 21u})
+    ->Args({1 << 24, 512u, 21u});
 BENCHMARK(bm_linked_kdtree_iterator_traversal)
     ->Unit(benchmark::kMillisecond)
     ->Args({1 << 12, 21u})
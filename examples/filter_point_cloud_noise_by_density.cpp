@@ -84,8 +84,7 @@ int main(int argc, char** argv)
         points.end(),
         [&](pcp::point_t const& p) {
             pcp::sphere_t<pcp::point_t> ball{p, radius * radius_multiplier};
-            auto const& points_in_ball = octree.range_search(ball, point_view_map);
-            auto const density         = points_in_ball.size();
+            auto const density = octree.range_count(ball, point_view_map);
             return density < density_threshold;
         });
     points.erase(it, points.end());
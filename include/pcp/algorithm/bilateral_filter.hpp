@@ -70,14 +70,11 @@ std::invoke_result_t<PointMap, std::size_t> compute_pi(
     support_region.position = ci;
     support_region.radius   = two * sigmaf;
 
-    auto const neighbors = kdtree.range_search(support_region);
-
     scalar_type k = zero;
     point_type sprime{zero, zero, zero};
-    for (auto it = neighbors.begin(); it != neighbors.end(); ++it)
-    {
-        point_type const p           = point_map(*it);
-        normal_type const np         = normal_map(*it);
+    kdtree.visit_range(support_region, [&](auto const& neighbor) {
+        point_type const p           = point_map(neighbor);
+        normal_type const np         = normal_map(neighbor);
         point_type const s_projected = projection(p, np, s);
 
         scalar_type const rf = common::norm(s - p);
@@ -93,7 +90,7 @@ std::invoke_result_t<PointMap, std::size_t> compute_pi(
             w * s_projected.y(),
             w * s_projected.z()};
         sprime = sprime + translation;
-    }
+    });
     sprime = sprime / k;
 
     return sprime;
@@ -142,8 +139,6 @@ std::invoke_result_t<NormalMap, std::size_t> compute_ni(
     support_region.position = ci;
     support_region.radius   = two * sigmaf;
 
-    auto const neighbors = kdtree.range_search(support_region);
-
     /**
      * Jacobian of sum of:
      *
@@ -168,10 +163,9 @@ std::invoke_result_t<NormalMap, std::size_t> compute_ni(
      */
     scalar_type k = zero;
 
-    for (auto it = neighbors.begin(); it != neighbors.end(); ++it)
-    {
-        point_type const pcp_p           = point_map(*it);
-        normal_type const pcp_np         = normal_map(*it);
+    kdtree.visit_range(support_region, [&](auto const& neighbor) {
+        point_type const pcp_p           = point_map(neighbor);
+        normal_type const pcp_np         = normal_map(neighbor);
         point_type const pcp_s_projected = projection(pcp_p, pcp_np, pcp_s);
 
         column_vector_3d_type const p{pcp_p.x(), pcp_p.y(), pcp_p.z()};
@@ -241,7 +235,7 @@ std::invoke_result_t<NormalMap, std::size_t> compute_ni(
          * Product rule grad(projection(s) * f(||s - p||) * g(||projection(s) - s||))
          */
         J_pi_f_g += (Jpi * wf * wg) + (sps * grad_f * wg) + (sps * wf * grad_g);
-    }
+    });
 
     /**
      * Quotient rule grad(u/v) = (1/v^2) * (grad(u)*v - u*grad(v))
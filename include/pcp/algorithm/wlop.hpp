@@ -42,24 +42,19 @@ ScalarType compute_vj(
     radial_support_region.radius   = h;
     radial_support_region.position = c1;
 
-    auto const neighbors = kdtree.range_search(radial_support_region);
-
     scalar_type vj{1.0};
     scalar_type constexpr eps = static_cast<scalar_type>(1e-9);
 
-    auto begin = neighbors.begin();
-    auto end   = neighbors.end();
-    for (auto it = begin; it != end; ++it)
-    {
-        auto const& c2 = p_cmap(*it);
+    kdtree.visit_range(radial_support_region, [&](auto const& neighbor) {
+        auto const& c2 = p_cmap(neighbor);
         pcp::basic_point_t<scalar_type> pjp{c2[0], c2[1], c2[2]};
 
         if (common::are_vectors_equal(pj, pjp, eps))
-            continue;
+            return;
 
         auto const r2 = common::squared_distance(pj, pjp);
         vj += theta(r2);
-    }
+    });
 
     return vj;
 }
@@ -81,24 +76,19 @@ ScalarType compute_wi(
     radial_support_region.radius   = h;
     radial_support_region.position = c1;
 
-    auto const neighbors = kdtree.range_search(radial_support_region);
-
     scalar_type wi{1.0};
     scalar_type constexpr eps = static_cast<scalar_type>(1e-9);
 
-    auto begin = neighbors.begin();
-    auto end   = neighbors.end();
-    for (auto it = begin; it != end; ++it)
-    {
-        auto const& c2 = q_cmap(*it);
+    kdtree.visit_range(radial_support_region, [&](auto const& neighbor) {
+        auto const& c2 = q_cmap(neighbor);
         pcp::basic_point_t<scalar_type> qip{c2[0], c2[1], c2[2]};
 
         if (common::are_vectors_equal(qi, qip, eps))
-            continue;
+            return;
 
         auto const r2 = common::squared_distance(qi, qip);
         wi += theta(r2);
-    }
+    });
 
     return wi;
 }
@@ -128,28 +118,23 @@ basic_point_t<ScalarType> solve_first_energy_median(
     radial_support_region.radius   = h;
     radial_support_region.position = c1;
 
-    auto const neighbors = kdtree.range_search(radial_support_region);
-
     // loop over j in support region
     scalar_type sum{0.0};
     basic_point_t<scalar_type> median;
     scalar_type constexpr zero = static_cast<scalar_type>(0.);
     scalar_type constexpr eps  = static_cast<scalar_type>(1e-9);
 
-    auto begin = neighbors.begin();
-    auto end   = neighbors.end();
-    for (auto it = begin; it != end; ++it)
-    {
-        auto const& c2 = p_cmap(*it);
+    kdtree.visit_range(radial_support_region, [&](auto const& neighbor) {
+        auto const& c2 = p_cmap(neighbor);
 
         basic_point_t<scalar_type> const p{c2[0], c2[1], c2[2]};
 
         if (common::are_vectors_equal(q, p, eps))
-            continue;
+            return;
 
         scalar_type const r2 = common::squared_distance(q, p);
         scalar_type const r  = std::sqrt(r2);
-        scalar_type const vj = vj_map(*it);
+        scalar_type const vj = vj_map(neighbor);
 
         bool const alpha_zero_division = common::floating_point_equals(r, zero, eps);
         bool const vj_zero_division    = common::floating_point_equals(vj, zero, eps);
@@ -160,7 +145,7 @@ basic_point_t<ScalarType> solve_first_energy_median(
         t      = coeff * t;
         median = median + t;
         sum += coeff;
-    }
+    });
     bool const median_zero_division = common::floating_point_equals(sum, zero, eps);
     median                          = median_zero_division ? q : median / sum;
 
@@ -186,28 +171,23 @@ common::basic_vector3d_t<ScalarType> solve_second_energy_repulsion_force(
     radial_support_region.radius   = h;
     radial_support_region.position = c1;
 
-    auto const neighbors = kdtree.range_search(radial_support_region);
-
     // loop over all i in support region
     common::basic_vector3d_t<scalar_type> repulsion{0., 0., 0.};
     scalar_type sum{0.};
     scalar_type const zero = static_cast<scalar_type>(0.);
     scalar_type const eps  = static_cast<scalar_type>(1e-9);
 
-    auto begin = neighbors.begin();
-    auto end   = neighbors.end();
-    for (auto it = begin; it != end; ++it)
-    {
-        auto const& c2 = q_cmap(*it);
+    kdtree.visit_range(radial_support_region, [&](auto const& neighbor) {
+        auto const& c2 = q_cmap(neighbor);
         basic_point_t<scalar_type> const qi{c2[0], c2[1], c2[2]};
 
         if (common::are_vectors_equal(qi, qip, eps))
-            continue;
+            return;
 
         common::basic_vector3d_t<scalar_type> const d = qip - qi;
         scalar_type const r2                          = common::squared_distance(qip, qi);
         scalar_type const r                           = std::sqrt(r2);
-        scalar_type const wi                          = wi_map(*it);
+        scalar_type const wi                          = wi_map(neighbor);
 
         bool const beta_zero_division = common::floating_point_equals(r, zero, eps);
 
@@ -216,7 +196,7 @@ common::basic_vector3d_t<ScalarType> solve_second_energy_repulsion_force(
         scalar_type const coeff = wi * beta_ii;
         repulsion               = repulsion + coeff * d;
         sum += coeff;
-    }
+    });
     bool const repulsion_zero_division = common::floating_point_equals(sum, zero, eps);
     repulsion = repulsion_zero_division ? zero * repulsion : (mu / sum) * repulsion;
 
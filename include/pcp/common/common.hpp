@@ -19,6 +19,36 @@
  * @ingroup common
  */
 
+/**
+ * @defgroup nearest-neighbours "Nearest Neighbours"
+ * Common types for nearest neighbours searches.
+ * @ingroup common
+ */
+
+/**
+ * @defgroup range-search "Range Search"
+ * Common types for range searches.
+ * @ingroup common
+ */
+
+/**
+ * @defgroup node-allocation "Node Allocation"
+ * Allocators for the nodes of the spatial data structures.
+ * @ingroup common
+ */
+
+/**
+ * @defgroup concurrency "Concurrency"
+ * Synchronization primitives for concurrent access to the spatial data structures.
+ * @ingroup common
+ */
+
+/**
+ * @defgroup space-filling-curves "Space Filling Curves"
+ * Morton codes for spatially coherent orderings.
+ * @ingroup common
+ */
+
 /**
  * @defgroup common-vector3 "3D Vectors"
  * Common 3D Vector Operations and Types
@@ -27,7 +57,11 @@
 
 #include "axis_aligned_bounding_box.hpp"
 #include "intersections.hpp"
+#include "lock_table.hpp"
 #include "mesh_triangle.hpp"
+#include "morton.hpp"
+#include "nearest_neighbours.hpp"
+#include "node_allocator.hpp"
 #include "norm.hpp"
 #include "normals/normal.hpp"
 #include "normals/normal_estimation.hpp"
@@ -35,6 +69,7 @@
 #include "points/point.hpp"
 #include "points/point_view.hpp"
 #include "points/vertex.hpp"
+#include "range_search.hpp"
 #include "regular_grid3d.hpp"
 #include "sphere.hpp"
 #include "timer.hpp"
@@ -10,6 +10,12 @@
 #include "norm.hpp"
 #include "sphere.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 namespace pcp {
 namespace intersections {
 
@@ -98,7 +104,8 @@ inline bool intersects(axis_aligned_bounding_box_t<Point> const& b, sphere_t<Poi
         return true;
 
     Point const nearest_point_on_box_from_sphere = b.nearest_point_from(center);
-    return common::squared_distance(nearest_point_on_box_from_sphere, center) <= s.radius;
+    return common::squared_distance(nearest_point_on_box_from_sphere, center) <=
+           s.radius * s.radius;
 }
 
 /**
@@ -126,7 +133,8 @@ inline bool intersects(
         return true;
 
     auto const nearest_point_on_box_from_sphere = b.nearest_point_from(center);
-    return common::squared_distance(nearest_point_on_box_from_sphere, center) <= s.radius;
+    return common::squared_distance(nearest_point_on_box_from_sphere, center) <=
+           s.radius * s.radius;
 }
 
 /**
@@ -161,6 +169,264 @@ inline bool intersects(sphere_t<Point> const& s, axis_aligned_bounding_box_t<Poi
     return intersects(b, s);
 }
 
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * Containment test of an AABB inside another AABB
+ * @tparam Point
+ * @param outer
+ * @param inner
+ * @return true if inner lies entirely inside outer
+ */
+template <class Point>
+inline bool contains(
+    axis_aligned_bounding_box_t<Point> const& outer,
+    axis_aligned_bounding_box_t<Point> const& inner)
+{
+    return outer.contains(inner.min) && outer.contains(inner.max);
+}
+
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * Containment test of a kd-AABB inside another kd-AABB
+ * @tparam CoordinateType
+ * @param outer
+ * @param inner
+ * @return true if inner lies entirely inside outer
+ */
+template <class CoordinateType, std::size_t K>
+inline bool contains(
+    kd_axis_aligned_bounding_box_t<CoordinateType, K> const& outer,
+    kd_axis_aligned_bounding_box_t<CoordinateType, K> const& inner)
+{
+    for (std::size_t i = 0; i < K; ++i)
+    {
+        if (!(inner.min[i] >= outer.min[i] && inner.max[i] <= outer.max[i]))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * Containment test of an AABB inside a sphere. The AABB is contained
+ * if its corner furthest from the sphere's center is in the sphere.
+ * @tparam Point
+ * @param s
+ * @param b
+ * @return true if b lies entirely inside s
+ */
+template <class Point>
+inline bool contains(sphere_t<Point> const& s, axis_aligned_bounding_box_t<Point> const& b)
+{
+    Point const center = s.center();
+
+    auto const dx = std::max(center.x() - b.min.x(), b.max.x() - center.x());
+    auto const dy = std::max(center.y() - b.min.y(), b.max.y() - center.y());
+    auto const dz = std::max(center.z() - b.min.z(), b.max.z() - center.z());
+
+    return dx * dx + dy * dy + dz * dz <= s.radius * s.radius;
+}
+
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * Containment test of a kd-AABB inside a sphere. The kd-AABB is contained
+ * if its corner furthest from the sphere's center is in the sphere.
+ * @tparam CoordinateType
+ * @param s
+ * @param b
+ * @return true if b lies entirely inside s
+ */
+template <class CoordinateType>
+inline bool contains(
+    sphere_a<CoordinateType> const& s,
+    kd_axis_aligned_bounding_box_t<CoordinateType, 3> const& b)
+{
+    auto const center = s.center();
+
+    CoordinateType squared_distance_to_furthest_corner{0};
+    for (std::size_t i = 0; i < 3u; ++i)
+    {
+        auto const d = std::max(center[i] - b.min[i], b.max[i] - center[i]);
+        squared_distance_to_furthest_corner += d * d;
+    }
+
+    return squared_distance_to_furthest_corner <= s.radius * s.radius;
+}
+
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * Compile-time check for the existence of a containment test
+ * contains(range, box) of a box inside a range
+ * @tparam Range
+ * @tparam Box
+ */
+template <class Range, class Box, class = void>
+struct has_containment_test : std::false_type
+{
+};
+
+template <class Range, class Box>
+struct has_containment_test<
+    Range,
+    Box,
+    std::void_t<decltype(contains(std::declval<Range const&>(), std::declval<Box const&>()))>>
+    : std::true_type
+{
+};
+
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * How a bounding volume overlaps a queried range
+ */
+enum class overlap_t
+{
+    disjoint, ///< The volume and the range do not intersect
+    partial,  ///< The volume intersects the range, but is not contained in it
+    contained ///< The volume lies entirely inside the range
+};
+
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * Classifies a box against a range. Ranges without a containment test
+ * contains(range, box) are never reported as containing the box.
+ * @tparam Box
+ * @tparam Range
+ * @param b
+ * @param r
+ * @return Whether b is disjoint from r, partially overlaps r or is contained in r
+ */
+template <class Box, class Range>
+inline overlap_t classify(Box const& b, Range const& r)
+{
+    if (!intersects(b, r))
+        return overlap_t::disjoint;
+
+    if constexpr (has_containment_test<Range, Box>::value)
+    {
+        if (contains(r, b))
+            return overlap_t::contained;
+    }
+
+    return overlap_t::partial;
+}
+
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * Slab test between a ray and an AABB. The ray's points are origin + t * direction
+ * for the parameters t in [t_min, t_max], which are clipped to the parameters of
+ * the ray's points inside the box when they intersect.
+ * @tparam Point
+ * @tparam TPointView Type satisfying PointView concept
+ * @tparam Vector3d Type satisfying Vector3d concept
+ * @param b
+ * @param origin The ray's origin
+ * @param direction The ray's direction
+ * @param t_min Smallest parameter of the ray, replaced by the parameter where it enters b
+ * @param t_max Largest parameter of the ray, replaced by the parameter where it exits b
+ * @return True if the ray intersects b
+ */
+template <class Point, class TPointView, class Vector3d>
+inline bool intersects_ray(
+    axis_aligned_bounding_box_t<Point> const& b,
+    TPointView const& origin,
+    Vector3d const& direction,
+    typename Point::coordinate_type& t_min,
+    typename Point::coordinate_type& t_max)
+{
+    using coordinate_type = typename Point::coordinate_type;
+    using coordinates_t   = std::array<coordinate_type, 3>;
+
+    coordinates_t const o{
+        static_cast<coordinate_type>(origin.x()),
+        static_cast<coordinate_type>(origin.y()),
+        static_cast<coordinate_type>(origin.z())};
+    coordinates_t const d{
+        static_cast<coordinate_type>(direction.x()),
+        static_cast<coordinate_type>(direction.y()),
+        static_cast<coordinate_type>(direction.z())};
+    coordinates_t const lo{b.min.x(), b.min.y(), b.min.z()};
+    coordinates_t const hi{b.max.x(), b.max.y(), b.max.z()};
+
+    for (std::size_t i = 0u; i < 3u; ++i)
+    {
+        /*
+         * A ray parallel to a slab either lies between
+         * its planes everywhere or nowhere.
+         */
+        if (!(d[i] < static_cast<coordinate_type>(0)) && !(d[i] > static_cast<coordinate_type>(0)))
+        {
+            if (o[i] < lo[i] || o[i] > hi[i])
+                return false;
+
+            continue;
+        }
+
+        auto const inverse = static_cast<coordinate_type>(1) / d[i];
+        auto t1            = (lo[i] - o[i]) * inverse;
+        auto t2            = (hi[i] - o[i]) * inverse;
+        if (t1 > t2)
+            std::swap(t1, t2);
+
+        t_min = std::max(t_min, t1);
+        t_max = std::min(t_max, t2);
+        if (t_min > t_max)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @ingroup intersection-tests
+ * @brief
+ * Classifies an AABB against a convex volume bounded by planes, such as a view
+ * frustum, whose normals point inside the volume. Each plane is tested against
+ * the box corner furthest along its normal and the corner furthest against it.
+ * The test is conservative: a box near the volume's edges may be reported as
+ * partially overlapping a volume it does not intersect.
+ * @tparam Point
+ * @tparam Planes Range of planes with normal() and signed_distance_to(point)
+ * @param b
+ * @param planes
+ * @return Whether b is disjoint from the volume, partially overlaps it or is contained in it
+ */
+template <class Point, class Planes>
+inline overlap_t classify_against_planes(
+    axis_aligned_bounding_box_t<Point> const& b,
+    Planes const& planes)
+{
+    bool is_contained = true;
+    for (auto const& plane : planes)
+    {
+        auto const& n = plane.normal();
+        Point const furthest_corner{
+            n.x() >= 0 ? b.max.x() : b.min.x(),
+            n.y() >= 0 ? b.max.y() : b.min.y(),
+            n.z() >= 0 ? b.max.z() : b.min.z()};
+
+        if (plane.signed_distance_to(furthest_corner) < 0)
+            return overlap_t::disjoint;
+
+        Point const nearest_corner{
+            n.x() >= 0 ? b.min.x() : b.max.x(),
+            n.y() >= 0 ? b.min.y() : b.max.y(),
+            n.z() >= 0 ? b.min.z() : b.max.z()};
+
+        if (plane.signed_distance_to(nearest_corner) < 0)
+            is_contained = false;
+    }
+
+    return is_contained ? overlap_t::contained : overlap_t::partial;
+}
+
 } // namespace intersections
 } // namespace pcp
 
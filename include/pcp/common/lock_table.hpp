@@ -0,0 +1,63 @@
+#ifndef PCP_COMMON_LOCK_TABLE_HPP
+#define PCP_COMMON_LOCK_TABLE_HPP
+
+/**
+ * @file
+ * @ingroup common
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+
+namespace pcp {
+
+/**
+ * @ingroup concurrency
+ * @brief
+ * Fixed-size table of reader-writer locks shared by all the nodes of a tree.
+ * Each node is mapped to one of the table's locks by hashing its address,
+ * so the memory used for locking does not grow with the size of the tree,
+ * and nodes do not have to be locked in any particular order as long as a
+ * thread holds at most one of the table's locks at a time. Each lock is
+ * on its own cache line to prevent false sharing between threads locking
+ * different nodes.
+ */
+class shared_lock_table_t
+{
+  public:
+    static constexpr std::size_t num_stripes = 256u; ///< Number of locks in the table
+
+    shared_lock_table_t() = default;
+    shared_lock_table_t(shared_lock_table_t const&) = delete;
+    shared_lock_table_t& operator=(shared_lock_table_t const&) = delete;
+
+    /**
+     * @brief Lock guarding the object at the given address
+     * @param key Address of the guarded object
+     * @return The object's lock
+     */
+    std::shared_mutex& mutex_of(void const* key) const
+    {
+        /*
+         * Fibonacci hashing of the address, so that nodes allocated
+         * contiguously are spread over the whole table.
+         */
+        auto h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(key));
+        h *= 0x9e3779b97f4a7c15u;
+        return stripes_[static_cast<std::size_t>(h >> 56u) % num_stripes].mutex;
+    }
+
+  private:
+    struct alignas(64) stripe_t
+    {
+        std::shared_mutex mutex;
+    };
+
+    mutable std::array<stripe_t, num_stripes> stripes_;
+};
+
+} // namespace pcp
+
+#endif // PCP_COMMON_LOCK_TABLE_HPP
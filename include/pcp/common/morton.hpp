@@ -0,0 +1,142 @@
+#ifndef PCP_COMMON_MORTON_HPP
+#define PCP_COMMON_MORTON_HPP
+
+/**
+ * @file
+ * @ingroup common
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace pcp {
+namespace morton {
+
+/**
+ * @ingroup space-filling-curves
+ * @brief
+ * Number of bits per dimension of a K-dimensional 64-bit Morton code
+ * @tparam K Number of dimensions
+ */
+template <std::size_t K>
+static constexpr std::uint32_t bits_per_dimension_v = static_cast<std::uint32_t>(64u / K);
+
+/**
+ * @ingroup space-filling-curves
+ * @brief
+ * Inserts two zero bits between each of the 21 low bits of v
+ * @param v The value to spread
+ * @return The spread bits
+ */
+inline std::uint64_t spread_bits_3d(std::uint32_t v)
+{
+    std::uint64_t x = v & 0x1fffffu;
+    x               = (x | x << 32u) & 0x1f00000000ffffu;
+    x               = (x | x << 16u) & 0x1f0000ff0000ffu;
+    x               = (x | x << 8u) & 0x100f00f00f00f00fu;
+    x               = (x | x << 4u) & 0x10c30c30c30c30c3u;
+    x               = (x | x << 2u) & 0x1249249249249249u;
+    return x;
+}
+
+/**
+ * @ingroup space-filling-curves
+ * @brief
+ * Morton code of a 3-dimensional grid cell. The x coordinate has the most
+ * significant bit of each triplet, which matches the octant numbering of
+ * the octrees (x -> 0b100, y -> 0b010, z -> 0b001).
+ * @param x Cell coordinate along x, of at most 21 bits
+ * @param y Cell coordinate along y, of at most 21 bits
+ * @param z Cell coordinate along z, of at most 21 bits
+ * @return The cell's Morton code
+ */
+inline std::uint64_t encode(std::uint32_t x, std::uint32_t y, std::uint32_t z)
+{
+    return (spread_bits_3d(x) << 2u) | (spread_bits_3d(y) << 1u) | spread_bits_3d(z);
+}
+
+/**
+ * @ingroup space-filling-curves
+ * @brief
+ * Morton code of a K-dimensional grid cell, interleaving the bits of its
+ * coordinates from the first dimension to the last
+ * @tparam K Number of dimensions
+ * @param cell Cell coordinates, of at most bits_per_dimension_v<K> bits each
+ * @return The cell's Morton code
+ */
+template <std::size_t K>
+std::uint64_t encode(std::array<std::uint32_t, K> const& cell)
+{
+    if constexpr (K == 3u)
+    {
+        return encode(cell[0], cell[1], cell[2]);
+    }
+    else
+    {
+        std::uint64_t code = 0u;
+        for (std::uint32_t b = bits_per_dimension_v<K>; b-- > 0u;)
+            for (std::size_t d = 0u; d < K; ++d)
+                code = (code << 1u) | ((cell[d] >> b) & 1u);
+        return code;
+    }
+}
+
+/**
+ * @ingroup space-filling-curves
+ * @brief
+ * Grid cell coordinate of a value along one dimension of a bounding box
+ * split into 2^bits cells. Values outside of the box are clamped.
+ * @tparam Scalar Type of the coordinates
+ * @param value The coordinate to quantize
+ * @param min Minimum of the bounding box along the dimension
+ * @param max Maximum of the bounding box along the dimension
+ * @param bits Number of bits of the cell coordinate
+ * @return The cell coordinate
+ */
+template <class Scalar>
+std::uint32_t quantize(Scalar value, Scalar min, Scalar max, std::uint32_t bits)
+{
+    auto const num_cells = static_cast<double>(std::uint64_t{1u} << bits);
+    auto const extent    = static_cast<double>(max) - static_cast<double>(min);
+    if (!(extent > 0.))
+        return 0u;
+
+    auto const t    = (static_cast<double>(value) - static_cast<double>(min)) / extent;
+    auto const cell = std::clamp(t * num_cells, 0., num_cells - 1.);
+    return static_cast<std::uint32_t>(cell);
+}
+
+/**
+ * @ingroup space-filling-curves
+ * @brief
+ * Permutation sorting a range of Morton codes. Elements with equal codes
+ * keep their relative order.
+ * @tparam ExecutionPolicy Type of STL execution policy
+ * @param policy The execution policy
+ * @param codes The Morton codes
+ * @return Indices of the codes in increasing Morton order
+ */
+template <class ExecutionPolicy>
+std::vector<std::size_t>
+sorted_order(ExecutionPolicy&& policy, std::vector<std::uint64_t> const& codes)
+{
+    std::vector<std::size_t> order(codes.size());
+    std::iota(order.begin(), order.end(), std::size_t{0u});
+    std::stable_sort(
+        std::forward<ExecutionPolicy>(policy),
+        order.begin(),
+        order.end(),
+        [&codes](std::size_t i, std::size_t j) { return codes[i] < codes[j]; });
+    return order;
+}
+
+} // namespace morton
+} // namespace pcp
+
+#endif // PCP_COMMON_MORTON_HPP
@@ -0,0 +1,371 @@
+#ifndef PCP_COMMON_NEAREST_NEIGHBOURS_HPP
+#define PCP_COMMON_NEAREST_NEIGHBOURS_HPP
+
+/**
+ * @file
+ * @ingroup common
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace pcp {
+
+/**
+ * @ingroup nearest-neighbours
+ * @brief
+ * A neighbour found by a nearest neighbours search along with its
+ * squared distance to the search's target.
+ * @tparam T Type referring to the neighbour (element, pointer or index)
+ * @tparam Scalar Type of the squared distance
+ */
+template <class T, class Scalar>
+struct neighbour_t
+{
+    using value_type  = T;
+    using scalar_type = Scalar;
+
+    T element;               ///< The neighbour
+    Scalar squared_distance; ///< The neighbour's squared distance to the target
+
+    bool operator<(neighbour_t const& other) const
+    {
+        return squared_distance < other.squared_distance;
+    }
+};
+
+/**
+ * @ingroup nearest-neighbours
+ * @brief
+ * Fixed-size max-heap of the k best neighbours found so far during a
+ * nearest neighbours search. The top of the heap is the current k-th
+ * nearest neighbour, whose squared distance is the pruning bound of
+ * the search once the heap is full.
+ * @tparam T Type referring to the neighbours (element, pointer or index)
+ * @tparam Scalar Type of the squared distances
+ */
+template <class T, class Scalar>
+class k_best_heap_t
+{
+  public:
+    using neighbour_type  = neighbour_t<T, Scalar>;
+    using neighbours_type = std::vector<neighbour_type>;
+
+    /**
+     * @brief Constructs an empty heap holding at most k neighbours
+     * @param k Maximum number of neighbours
+     */
+    explicit k_best_heap_t(std::size_t k = 0u)
+        : k_(k), max_squared_distance_(std::numeric_limits<Scalar>::max()), heap_()
+    {
+        heap_.reserve(k);
+    }
+
+    /**
+     * @brief
+     * Empties the heap and sets its maximum number of neighbours,
+     * reusing the heap's storage. Candidates further than
+     * max_squared_distance are rejected, so a known upper bound on
+     * the k-th nearest neighbour's squared distance prunes the search
+     * from the start.
+     * @param k Maximum number of neighbours
+     * @param max_squared_distance Maximum squared distance of the neighbours
+     */
+    void reset(std::size_t k, Scalar max_squared_distance = std::numeric_limits<Scalar>::max())
+    {
+        k_                    = k;
+        max_squared_distance_ = max_squared_distance;
+        heap_.clear();
+        heap_.reserve(k);
+    }
+
+    std::size_t k() const { return k_; }
+    std::size_t size() const { return heap_.size(); }
+    bool empty() const { return heap_.empty(); }
+    bool full() const { return heap_.size() >= k_; }
+
+    /**
+     * @brief
+     * Squared distance beyond which no candidate can enter the heap
+     * @return The k-th best squared distance, or the maximum squared distance if the heap
+     * is not full
+     */
+    Scalar bound() const { return full() ? heap_.front().squared_distance : max_squared_distance_; }
+
+    /**
+     * @brief
+     * Offers a candidate to the heap. The candidate is kept only if the heap
+     * is not full or if it is nearer than the current k-th best neighbour.
+     * @param element The candidate
+     * @param squared_distance The candidate's squared distance to the target
+     * @return True if the candidate was kept
+     */
+    bool push(T const& element, Scalar squared_distance)
+    {
+        if (k_ == 0u)
+            return false;
+
+        if (!full())
+        {
+            if (max_squared_distance_ < squared_distance)
+                return false;
+
+            heap_.push_back(neighbour_type{element, squared_distance});
+            std::push_heap(heap_.begin(), heap_.end());
+            return true;
+        }
+
+        if (!(squared_distance < heap_.front().squared_distance))
+            return false;
+
+        /*
+         * The candidate replaces the top of the heap and is sifted down to
+         * its place, in one pass instead of the two passes of pop_heap and
+         * push_heap. Children greater than the candidate move up into the
+         * hole left by the candidate, which ends up where neither child is
+         * greater than it.
+         */
+        std::size_t const size = heap_.size();
+        std::size_t hole       = 0u;
+        for (std::size_t child = 1u; child < size; child = 2u * hole + 1u)
+        {
+            if (child + 1u < size && heap_[child] < heap_[child + 1u])
+                ++child;
+            if (!(squared_distance < heap_[child].squared_distance))
+                break;
+
+            heap_[hole] = heap_[child];
+            hole        = child;
+        }
+        heap_[hole] = neighbour_type{element, squared_distance};
+        return true;
+    }
+
+    /**
+     * @brief
+     * Sorts the neighbours from nearest to furthest. The heap
+     * property is lost, so the heap must be cleared before reuse.
+     * @return The sorted neighbours
+     */
+    neighbours_type& sort()
+    {
+        std::sort_heap(heap_.begin(), heap_.end());
+        return heap_;
+    }
+
+    void clear() { heap_.clear(); }
+
+  private:
+    std::size_t k_;
+    Scalar max_squared_distance_;
+    neighbours_type heap_;
+};
+
+/**
+ * @ingroup nearest-neighbours
+ * @brief
+ * Approximation settings of a nearest neighbours search. With an error
+ * bound epsilon > 0, nodes are pruned as soon as they are further than the
+ * current k-th best distance divided by (1 + epsilon), so that each returned
+ * neighbour is at most (1 + epsilon) times further than the exact neighbour
+ * of the same rank. With a leaf budget, the search stops after visiting
+ * max_visited_leaves leaves, nearest leaves first, trading the guarantee
+ * for a bounded cost. The default settings give an exact search.
+ */
+struct approximate_knn_parameters_t
+{
+    double epsilon = 0.; ///< Relative error bound on the neighbours' distances
+    std::size_t max_visited_leaves =
+        std::numeric_limits<std::size_t>::max(); ///< Maximum number of visited leaves
+
+    /**
+     * @brief
+     * Factor by which squared distances to nodes are scaled before being
+     * compared to the k-th best squared distance
+     * @tparam Scalar Type of the squared distances
+     * @return (1 + epsilon)^2
+     */
+    template <class Scalar>
+    Scalar squared_distance_factor() const
+    {
+        return static_cast<Scalar>((1. + epsilon) * (1. + epsilon));
+    }
+};
+
+/**
+ * @ingroup nearest-neighbours
+ * @brief
+ * Lazy range of the neighbours of a target, from nearest to furthest
+ * (distance browsing). Nodes of a spatial data structure and elements
+ * share one min-heap keyed on their squared distance to the target, and
+ * a node is only expanded when it reaches the top of the heap, so that
+ * the search stops as soon as the caller stops iterating. The next
+ * neighbour is the nearest element once no node is nearer.
+ *
+ * Iterators are input iterators referring to the range, which must
+ * outlive them. Advancing any iterator advances the range.
+ *
+ * @tparam T Type referring to the neighbours (element, pointer or index)
+ * @tparam Node Type referring to a node and the data needed to expand it
+ * @tparam Scalar Type of the squared distances
+ * @tparam Expand
+ * Callable type taking a Node const& and this range, which pushes the
+ * node's elements and children with push_element and push_node
+ */
+template <class T, class Node, class Scalar, class Expand>
+class incremental_nearest_neighbours_t
+{
+  public:
+    using self_type      = incremental_nearest_neighbours_t<T, Node, Scalar, Expand>;
+    using neighbour_type = neighbour_t<T, Scalar>;
+
+    /**
+     * @brief Input iterator to the neighbours of an incremental_nearest_neighbours_t
+     */
+    class iterator
+    {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = neighbour_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = neighbour_type const*;
+        using reference         = neighbour_type const&;
+
+        iterator() = default;
+        explicit iterator(self_type* range) : range_(range) {}
+
+        reference operator*() const { return range_->front(); }
+        pointer operator->() const { return &range_->front(); }
+
+        iterator& operator++()
+        {
+            range_->pop();
+            if (range_->empty())
+                range_ = nullptr;
+            return *this;
+        }
+
+        void operator++(int) { ++(*this); }
+
+        bool operator==(iterator const& other) const { return range_ == other.range_; }
+        bool operator!=(iterator const& other) const { return !(*this == other); }
+
+      private:
+        self_type* range_ = nullptr;
+    };
+
+    /**
+     * @brief Constructs the range of neighbours found in a root node
+     * @param root The root node
+     * @param root_squared_distance Squared distance from the target to the root node
+     * @param expand The node expansion callable
+     */
+    incremental_nearest_neighbours_t(Node root, Scalar root_squared_distance, Expand expand)
+        : heap_(), current_(), has_current_(false), expand_(std::move(expand))
+    {
+        push_node(std::move(root), root_squared_distance);
+        advance();
+    }
+
+    incremental_nearest_neighbours_t(self_type const&) = delete;
+    self_type& operator=(self_type const&) = delete;
+
+    iterator begin() { return iterator(empty() ? nullptr : this); }
+    iterator end() { return iterator(); }
+
+    /**
+     * @brief Checks if all neighbours have been visited
+     * @return True if there is no next neighbour
+     */
+    bool empty() const { return !has_current_; }
+
+    /**
+     * @brief The next neighbour, the range must not be empty
+     * @return The nearest neighbour not visited yet
+     */
+    neighbour_type const& front() const { return current_; }
+
+    /**
+     * @brief Moves to the next neighbour, the range must not be empty
+     */
+    void pop() { advance(); }
+
+    /**
+     * @brief Adds a node to visit, called by the expansion callable
+     * @param node The node
+     * @param squared_distance Lower bound on the squared distance of the node's elements
+     */
+    void push_node(Node node, Scalar squared_distance)
+    {
+        heap_.push_back(entry_t{squared_distance, std::move(node), T{}, false});
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    }
+
+    /**
+     * @brief Adds a neighbour candidate, called by the expansion callable
+     * @param element The candidate
+     * @param squared_distance The candidate's squared distance to the target
+     */
+    void push_element(T element, Scalar squared_distance)
+    {
+        heap_.push_back(entry_t{squared_distance, Node{}, std::move(element), true});
+        std::push_heap(heap_.begin(), heap_.end(), greater);
+    }
+
+  private:
+    struct entry_t
+    {
+        Scalar squared_distance;
+        Node node;
+        T element;
+        bool is_element;
+    };
+
+    /*
+     * Greater comparison makes the heap a min-heap. Among entries at the
+     * same distance, elements come first, so that they are reported
+     * without expanding the nodes tied with them.
+     */
+    static bool greater(entry_t const& e1, entry_t const& e2)
+    {
+        if (e2.squared_distance < e1.squared_distance)
+            return true;
+        if (e1.squared_distance < e2.squared_distance)
+            return false;
+
+        return !e1.is_element && e2.is_element;
+    }
+
+    void advance()
+    {
+        while (!heap_.empty())
+        {
+            std::pop_heap(heap_.begin(), heap_.end(), greater);
+            entry_t entry = std::move(heap_.back());
+            heap_.pop_back();
+
+            if (entry.is_element)
+            {
+                current_     = neighbour_type{std::move(entry.element), entry.squared_distance};
+                has_current_ = true;
+                return;
+            }
+
+            expand_(static_cast<Node const&>(entry.node), *this);
+        }
+        has_current_ = false;
+    }
+
+    std::vector<entry_t> heap_;
+    neighbour_type current_;
+    bool has_current_;
+    Expand expand_;
+};
+
+} // namespace pcp
+
+#endif // PCP_COMMON_NEAREST_NEIGHBOURS_HPP
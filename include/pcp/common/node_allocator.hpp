@@ -0,0 +1,627 @@
+#ifndef PCP_COMMON_NODE_ALLOCATOR_HPP
+#define PCP_COMMON_NODE_ALLOCATOR_HPP
+
+/**
+ * @file
+ * @ingroup common
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pcp {
+
+/**
+ * @ingroup node-allocation
+ * @brief
+ * Deleter for tree nodes created by allocate_node. The node's memory is
+ * returned to the allocator obtained from the node's get_allocator(), so
+ * the deleter is stateless and node pointers stay pointer-sized.
+ * @tparam Node Type of node, exposing allocator_type and get_allocator()
+ */
+template <class Node>
+struct node_deleter_t
+{
+    void operator()(Node* node) const
+    {
+        using allocator_type = typename std::allocator_traits<
+            typename Node::allocator_type>::template rebind_alloc<Node>;
+        using traits_type = std::allocator_traits<allocator_type>;
+
+        allocator_type allocator(node->get_allocator());
+        traits_type::destroy(allocator, node);
+        traits_type::deallocate(allocator, node, 1u);
+    }
+};
+
+/**
+ * @ingroup node-allocation
+ * @brief
+ * Base class giving a node access to the allocator it was created with.
+ * Stateful allocators are stored in the node, while stateless allocators,
+ * whose instances all compare equal, are default constructed on demand, so
+ * that nodes using std::allocator do not pay for an empty member.
+ * @tparam Allocator Type of allocator
+ */
+template <
+    class Allocator,
+    bool IsStateless = std::is_default_constructible_v<Allocator> &&
+                       std::allocator_traits<Allocator>::is_always_equal::value>
+class node_allocator_holder_t
+{
+  public:
+    node_allocator_holder_t() = default;
+    explicit node_allocator_holder_t(Allocator const& allocator) : allocator_(allocator) {}
+
+    Allocator get_allocator() const { return allocator_; }
+
+  private:
+    Allocator allocator_;
+};
+
+template <class Allocator>
+class node_allocator_holder_t<Allocator, true>
+{
+  public:
+    node_allocator_holder_t() = default;
+    explicit node_allocator_holder_t(Allocator const&) {}
+
+    Allocator get_allocator() const { return Allocator{}; }
+};
+
+/**
+ * @ingroup node-allocation
+ * @brief Owning pointer to a tree node created by allocate_node
+ */
+template <class Node>
+using node_pointer_t = std::unique_ptr<Node, node_deleter_t<Node>>;
+
+/**
+ * @ingroup node-allocation
+ * @brief
+ * Equivalent of std::make_unique for tree nodes, allocating the node with
+ * the given allocator. The node must be constructed with an equal allocator,
+ * which it later returns from get_allocator() for its deallocation.
+ * @tparam Node Type of the node to create
+ * @tparam Args Types of the node's constructor arguments
+ * @param allocator The allocator
+ * @param args The node's constructor arguments
+ * @return The created node
+ */
+template <class Node, class... Args>
+node_pointer_t<Node> allocate_node(typename Node::allocator_type const& allocator, Args&&... args)
+{
+    using allocator_type = typename std::allocator_traits<
+        typename Node::allocator_type>::template rebind_alloc<Node>;
+    using traits_type = std::allocator_traits<allocator_type>;
+
+    allocator_type a(allocator);
+    Node* node = traits_type::allocate(a, 1u);
+    try
+    {
+        traits_type::construct(a, node, std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+        traits_type::deallocate(a, node, 1u);
+        throw;
+    }
+    return node_pointer_t<Node>(node);
+}
+
+/**
+ * @ingroup node-allocation
+ * @brief
+ * Thread-safe memory pool for tree nodes and their element buffers.
+ * Small requests are rounded up to a size class, in steps of 16 bytes up to
+ * 256 bytes and in powers of two above, and carved out of large chunks.
+ * Each thread using the pool gets its own cache of free blocks and its own
+ * current chunk, so that allocations from concurrent tree builds do not
+ * contend on a lock. Freed blocks go to the freeing thread's cache and are
+ * reused by its subsequent allocations. A cache holding too many free blocks
+ * of a size class hands all of them to a shared free list, from which
+ * caches running out of blocks refill in batches, so that blocks allocated
+ * by one thread and freed by another are not stranded. Building and
+ * destroying trees repeatedly thus does not go through the global heap.
+ *
+ * Free lists handed out in the reverse order of the last teardown scatter
+ * the next tree's nodes over the chunks. Once every tree using the pool is
+ * cleared or destroyed, reset() discards the free lists and carves the
+ * chunks again from their start, so that the next tree is laid out in
+ * allocation order like a monotonic arena. All chunks are released at once
+ * by release() or when the pool is destroyed.
+ */
+class node_pool_t
+{
+  public:
+    static constexpr std::size_t min_block_size     = 16u;       ///< Smallest size class
+    static constexpr std::size_t max_block_size     = 1u << 16u; ///< Largest size class
+    static constexpr std::size_t default_chunk_size = 1u << 20u; ///< Default chunk size
+
+    /**
+     * @brief Constructs an empty pool
+     * @param chunk_size Number of bytes requested from the global heap at a time
+     */
+    explicit node_pool_t(std::size_t chunk_size = default_chunk_size)
+        : id_(next_pool_id()),
+          chunk_size_(chunk_size < max_block_size ? max_block_size : chunk_size),
+          chunks_(),
+          num_used_chunks_(0u),
+          caches_(),
+          shared_free_lists_(),
+          num_shared_blocks_(),
+          mutex_()
+    {
+    }
+
+    node_pool_t(node_pool_t const&) = delete;
+    node_pool_t& operator=(node_pool_t const&) = delete;
+
+    ~node_pool_t() { release(); }
+
+    /**
+     * @brief Allocates a block of memory of at least the given size
+     * @param bytes Size of the block
+     * @param alignment Alignment of the block
+     * @return The block
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        if (bytes > max_block_size || alignment > alignof(std::max_align_t))
+            return ::operator new(bytes, std::align_val_t{alignment});
+
+        auto const size_class = size_class_of(bytes);
+        thread_cache_t& cache = local_cache();
+        ++cache.live_blocks;
+
+        auto& free_list = cache.free_lists[size_class];
+        if (free_list.head == nullptr && !refill(free_list, size_class))
+            return carve(cache, size_class);
+
+        return pop_free_block(free_list);
+    }
+
+    /**
+     * @brief Returns a block of memory to the pool
+     * @param p The block, obtained from allocate with the same size and alignment
+     * @param bytes Size of the block
+     * @param alignment Alignment of the block
+     */
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t))
+    {
+        if (p == nullptr)
+            return;
+
+        if (bytes > max_block_size || alignment > alignof(std::max_align_t))
+        {
+            ::operator delete(p, std::align_val_t{alignment});
+            return;
+        }
+
+        auto const size_class = size_class_of(bytes);
+        thread_cache_t& cache = local_cache();
+        --cache.live_blocks;
+
+        auto& free_list = cache.free_lists[size_class];
+        push_free_block(free_list, p);
+        if (free_list.size > max_cached_blocks(size_class))
+            flush(free_list, size_class);
+    }
+
+    /**
+     * @brief
+     * Makes all of the pool's memory available again at once, keeping its
+     * chunks. Subsequent allocations are carved from the start of the chunks.
+     * No block allocated from the pool may be in use, and no other thread
+     * may use the pool during the call.
+     */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::ptrdiff_t live_blocks = 0;
+        for (auto const& cache : caches_)
+        {
+            live_blocks += cache.second->live_blocks;
+            *cache.second = thread_cache_t{};
+        }
+        assert(live_blocks == 0);
+        (void)live_blocks;
+
+        shared_free_lists_.fill(free_list_t{});
+        for (auto& num_shared_blocks : num_shared_blocks_)
+            num_shared_blocks.store(0u, std::memory_order_relaxed);
+        num_used_chunks_ = 0u;
+    }
+
+    /**
+     * @brief
+     * Releases all of the pool's memory at once. No block allocated
+     * from the pool may be in use, and no other thread may use the pool
+     * during the call.
+     */
+    void release()
+    {
+        reset();
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunks_.clear();
+    }
+
+    /**
+     * @brief Number of bytes held by the pool
+     * @return Number of bytes held by the pool
+     */
+    std::size_t capacity() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return chunks_.size() * chunk_size_;
+    }
+
+  private:
+    struct free_block_t
+    {
+        free_block_t* next;
+    };
+
+    struct free_list_t
+    {
+        free_block_t* head = nullptr;
+        free_block_t* tail = nullptr; ///< Last block, valid while head is not null
+        std::size_t size   = 0u;
+    };
+
+    static constexpr std::size_t num_small_size_classes = 16u; ///< 16 to 256 bytes
+    static constexpr std::size_t num_size_classes =
+        num_small_size_classes + 8u; ///< 16 bytes to 64 KiB
+    static constexpr std::size_t max_cached_bytes =
+        1u << 18u; ///< Bytes of free blocks of one size class kept by a thread
+
+    /**
+     * @brief Blocks owned by one thread, aligned to avoid false sharing between threads
+     */
+    struct alignas(64) thread_cache_t
+    {
+        std::array<free_list_t, num_size_classes> free_lists{};
+        std::byte* current         = nullptr;
+        std::size_t remaining      = 0u;
+        std::ptrdiff_t live_blocks = 0; ///< Allocations minus deallocations by this thread
+    };
+
+    /**
+     * @brief Cache of a thread, remembered by the thread for the pool of the given id
+     */
+    struct thread_cache_entry_t
+    {
+        std::uint64_t pool_id = 0u;
+        thread_cache_t* cache = nullptr;
+    };
+
+    /**
+     * @brief
+     * The caches of the pools last used by the calling thread, most recently
+     * used first. Pools are identified by a unique id rather than their
+     * address, so that an entry left by a destroyed pool is never mistaken
+     * for another pool's.
+     */
+    using thread_cache_entries_t = std::array<thread_cache_entry_t, 4u>;
+
+    static std::uint64_t next_pool_id()
+    {
+        static std::atomic<std::uint64_t> id{1u};
+        return id.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    static thread_cache_entries_t& thread_cache_entries()
+    {
+        thread_local thread_cache_entries_t entries{};
+        return entries;
+    }
+
+    static std::size_t size_class_of(std::size_t bytes)
+    {
+        if (bytes <= num_small_size_classes * min_block_size)
+            return bytes == 0u ? 0u : (bytes - 1u) / min_block_size;
+
+        std::size_t size_class = num_small_size_classes;
+        while (block_size_of(size_class) < bytes)
+            ++size_class;
+        return size_class;
+    }
+
+    static std::size_t block_size_of(std::size_t size_class)
+    {
+        if (size_class < num_small_size_classes)
+            return (size_class + 1u) * min_block_size;
+
+        auto const largest_small_block_size = num_small_size_classes * min_block_size;
+        return largest_small_block_size << (size_class - num_small_size_classes + 1u);
+    }
+
+    static std::size_t max_cached_blocks(std::size_t size_class)
+    {
+        auto const blocks = max_cached_bytes / block_size_of(size_class);
+        return blocks < 2u ? 2u : blocks;
+    }
+
+    static void push_free_block(free_list_t& free_list, void* p)
+    {
+        auto* block = static_cast<free_block_t*>(p);
+        block->next = free_list.head;
+        if (free_list.head == nullptr)
+            free_list.tail = block;
+        free_list.head = block;
+        ++free_list.size;
+    }
+
+    static void* pop_free_block(free_list_t& free_list)
+    {
+        free_block_t* block = free_list.head;
+        free_list.head      = block->next;
+        --free_list.size;
+        return block;
+    }
+
+    /**
+     * @brief
+     * Moves the first n blocks of a free list to the front of another
+     * @param from The free list to take the blocks from
+     * @param to The free list receiving the blocks
+     * @param n Number of blocks to move, at most the size of from
+     */
+    static void splice(free_list_t& from, free_list_t& to, std::size_t n)
+    {
+        if (n == 0u)
+            return;
+
+        free_block_t* last = from.head;
+        for (std::size_t i = 1u; i < n; ++i)
+            last = last->next;
+
+        free_block_t* first = from.head;
+        from.head           = last->next;
+        from.size -= n;
+        if (to.head == nullptr)
+            to.tail = last;
+        last->next = to.head;
+        to.head    = first;
+        to.size += n;
+    }
+
+    /**
+     * @brief Moves all blocks of a free list to the front of another in constant time
+     * @param from The free list to empty
+     * @param to The free list receiving the blocks
+     */
+    static void splice_all(free_list_t& from, free_list_t& to)
+    {
+        if (from.head == nullptr)
+            return;
+
+        if (to.head == nullptr)
+            to.tail = from.tail;
+        from.tail->next = to.head;
+        to.head         = from.head;
+        to.size += from.size;
+        from = free_list_t{};
+    }
+
+    /**
+     * @brief
+     * Cache of the calling thread. The check for the most recently used pool
+     * is kept small enough to be inlined into allocate and deallocate.
+     */
+    thread_cache_t& local_cache()
+    {
+        auto& entries = thread_cache_entries();
+        if (entries.front().pool_id == id_)
+            return *entries.front().cache;
+
+        return find_local_cache(entries);
+    }
+
+    thread_cache_t& find_local_cache(thread_cache_entries_t& entries)
+    {
+        auto it = std::find_if(entries.begin(), entries.end(), [this](auto const& entry) {
+            return entry.pool_id == id_;
+        });
+        if (it == entries.end())
+        {
+            it  = std::prev(entries.end());
+            *it = thread_cache_entry_t{id_, create_local_cache()};
+        }
+
+        std::rotate(entries.begin(), it, std::next(it));
+        return *entries.front().cache;
+    }
+
+    /**
+     * @brief Finds the cache of the calling thread, creating it on its first use of the pool
+     */
+    thread_cache_t* create_local_cache()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto const thread_id = std::this_thread::get_id();
+        auto const it =
+            std::find_if(caches_.begin(), caches_.end(), [&](auto const& thread_cache) {
+                return thread_cache.first == thread_id;
+            });
+        if (it != caches_.end())
+            return it->second.get();
+
+        caches_.emplace_back(thread_id, std::make_unique<thread_cache_t>());
+        return caches_.back().second.get();
+    }
+
+    /**
+     * @brief Refills an empty free list of a thread cache from the shared free list
+     * @return True if blocks were taken from the shared free list
+     */
+    bool refill(free_list_t& free_list, std::size_t size_class)
+    {
+        /*
+         * Threads carving new blocks out of their chunks find the shared
+         * free list empty on every allocation, so they do not take the lock.
+         */
+        if (num_shared_blocks_[size_class].load(std::memory_order_relaxed) == 0u)
+            return false;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& shared_free_list = shared_free_lists_[size_class];
+        auto const batch       = max_cached_blocks(size_class) / 2u;
+        splice(
+            shared_free_list,
+            free_list,
+            shared_free_list.size < batch ? shared_free_list.size : batch);
+        num_shared_blocks_[size_class].store(shared_free_list.size, std::memory_order_relaxed);
+        return free_list.head != nullptr;
+    }
+
+    /**
+     * @brief
+     * Hands all blocks of a thread cache's free list to the shared free list,
+     * without walking the blocks just freed by a teardown
+     */
+    void flush(free_list_t& free_list, std::size_t size_class)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& shared_free_list = shared_free_lists_[size_class];
+        splice_all(free_list, shared_free_list);
+        num_shared_blocks_[size_class].store(shared_free_list.size, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Carves a new block out of a thread cache's current chunk
+     */
+    void* carve(thread_cache_t& cache, std::size_t size_class)
+    {
+        auto const block_size = block_size_of(size_class);
+        if (cache.remaining < block_size)
+        {
+            /*
+             * The tail of the current chunk is handed out to the
+             * free lists so that no memory is wasted.
+             */
+            recycle_tail(cache);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (num_used_chunks_ == chunks_.size())
+                chunks_.push_back(std::make_unique<std::byte[]>(chunk_size_));
+
+            cache.current   = chunks_[num_used_chunks_++].get();
+            cache.remaining = chunk_size_;
+        }
+
+        void* block = cache.current;
+        cache.current += block_size;
+        cache.remaining -= block_size;
+        return block;
+    }
+
+    static void recycle_tail(thread_cache_t& cache)
+    {
+        for (std::size_t size_class = num_size_classes; size_class-- > 0u;)
+        {
+            auto const block_size = block_size_of(size_class);
+            while (cache.remaining >= block_size)
+            {
+                push_free_block(cache.free_lists[size_class], cache.current);
+                cache.current += block_size;
+                cache.remaining -= block_size;
+            }
+        }
+    }
+
+    std::uint64_t id_;
+    std::size_t chunk_size_;
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    std::size_t num_used_chunks_; ///< Number of chunks handed to thread caches since the last reset
+    std::vector<std::pair<std::thread::id, std::unique_ptr<thread_cache_t>>> caches_;
+    std::array<free_list_t, num_size_classes> shared_free_lists_;
+    std::array<std::atomic<std::size_t>, num_size_classes>
+        num_shared_blocks_; ///< Sizes of the shared free lists, readable without the lock
+    mutable std::mutex mutex_;
+};
+
+/**
+ * @ingroup node-allocation
+ * @brief
+ * Allocator handle to a node_pool_t, to be used as the Allocator template
+ * parameter of the linked octree and the linked kdtree. A default constructed
+ * allocator has no pool and falls back to the global heap. The pool must
+ * outlive every container using it.
+ * @tparam T Type of the allocated objects
+ */
+template <class T>
+class node_pool_allocator_t
+{
+  public:
+    using value_type = T;
+
+    template <class U>
+    friend class node_pool_allocator_t;
+
+    node_pool_allocator_t() noexcept : pool_(nullptr) {}
+    explicit node_pool_allocator_t(node_pool_t& pool) noexcept : pool_(std::addressof(pool)) {}
+
+    template <class U>
+    node_pool_allocator_t(node_pool_allocator_t<U> const& other) noexcept : pool_(other.pool_)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        auto const bytes = n * sizeof(T);
+        if (pool_ == nullptr)
+            return static_cast<T*>(::operator new(bytes, std::align_val_t{alignof(T)}));
+
+        return static_cast<T*>(pool_->allocate(bytes, alignof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        auto const bytes = n * sizeof(T);
+        if (pool_ == nullptr)
+        {
+            ::operator delete(p, std::align_val_t{alignof(T)});
+            return;
+        }
+
+        pool_->deallocate(p, bytes, alignof(T));
+    }
+
+    node_pool_t* pool() const { return pool_; }
+
+    template <class U>
+    bool operator==(node_pool_allocator_t<U> const& other) const
+    {
+        return pool_ == other.pool_;
+    }
+
+    template <class U>
+    bool operator!=(node_pool_allocator_t<U> const& other) const
+    {
+        return !(*this == other);
+    }
+
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+  private:
+    node_pool_t* pool_;
+};
+
+} // namespace pcp
+
+#endif // PCP_COMMON_NODE_ALLOCATOR_HPP
@@ -0,0 +1,161 @@
+#ifndef PCP_COMMON_RANGE_SEARCH_HPP
+#define PCP_COMMON_RANGE_SEARCH_HPP
+
+/**
+ * @file
+ * @ingroup common
+ */
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace pcp {
+
+/**
+ * @ingroup range-search
+ * @brief
+ * Lazy range of the elements of a spatial data structure found in a queried
+ * range. The data structure is searched depth-first as the range is iterated,
+ * using an explicit stack of nodes still to search and of elements found in
+ * the range, so that a search stops as soon as the caller stops iterating,
+ * which makes existence tests and capped searches cheap. Elements are
+ * visited in no particular order.
+ *
+ * Iterators are input iterators referring to the range, which must
+ * outlive them. Advancing any iterator advances the range.
+ *
+ * @tparam Element Type of the data structure's elements
+ * @tparam Node Type referring to a node and the data needed to search it
+ * @tparam Expand
+ * Callable type taking a Node const& and this range, which pushes the node's
+ * elements found in the queried range and its children which may hold
+ * elements in the queried range with push_element and push_node
+ */
+template <class Element, class Node, class Expand>
+class lazy_range_search_t
+{
+  public:
+    using self_type    = lazy_range_search_t<Element, Node, Expand>;
+    using element_type = Element;
+
+    /**
+     * @brief Input iterator to the elements of a lazy_range_search_t
+     */
+    class iterator
+    {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = element_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = element_type const*;
+        using reference         = element_type const&;
+
+        iterator() = default;
+        explicit iterator(self_type* range) : range_(range) {}
+
+        reference operator*() const { return range_->front(); }
+        pointer operator->() const { return &range_->front(); }
+
+        iterator& operator++()
+        {
+            range_->pop();
+            if (range_->empty())
+                range_ = nullptr;
+            return *this;
+        }
+
+        void operator++(int) { ++(*this); }
+
+        bool operator==(iterator const& other) const { return range_ == other.range_; }
+        bool operator!=(iterator const& other) const { return !(*this == other); }
+
+      private:
+        self_type* range_ = nullptr;
+    };
+
+    /**
+     * @brief Constructs the range of elements found in the subtree of a root node
+     * @param root The root node
+     * @param expand The node expansion callable
+     */
+    lazy_range_search_t(Node root, Expand expand)
+        : stack_(), current_(nullptr), expand_(std::move(expand))
+    {
+        push_node(std::move(root));
+        advance();
+    }
+
+    lazy_range_search_t(self_type const&) = delete;
+    self_type& operator=(self_type const&) = delete;
+
+    iterator begin() { return iterator(empty() ? nullptr : this); }
+    iterator end() { return iterator(); }
+
+    /**
+     * @brief Checks if all elements in the range have been visited
+     * @return True if there is no next element
+     */
+    bool empty() const { return current_ == nullptr; }
+
+    /**
+     * @brief The next element, the range must not be empty
+     * @return The next element found in the range
+     */
+    element_type const& front() const { return *current_; }
+
+    /**
+     * @brief Moves to the next element, the range must not be empty
+     */
+    void pop() { advance(); }
+
+    /**
+     * @brief Adds a node to search, called by the expansion callable
+     * @param node The node
+     */
+    void push_node(Node node) { stack_.push_back(entry_t{std::move(node), nullptr}); }
+
+    /**
+     * @brief Adds an element found in the range, called by the expansion callable
+     * @param element The element, which must outlive the range
+     */
+    void push_element(element_type const& element)
+    {
+        stack_.push_back(entry_t{Node{}, std::addressof(element)});
+    }
+
+  private:
+    struct entry_t
+    {
+        Node node;
+        element_type const* element;
+    };
+
+    void advance()
+    {
+        while (!stack_.empty())
+        {
+            entry_t entry = std::move(stack_.back());
+            stack_.pop_back();
+
+            if (entry.element != nullptr)
+            {
+                current_ = entry.element;
+                return;
+            }
+
+            expand_(static_cast<Node const&>(entry.node), *this);
+        }
+        current_ = nullptr;
+    }
+
+    std::vector<entry_t> stack_;
+    element_type const* current_;
+    Expand expand_;
+};
+
+} // namespace pcp
+
+#endif // PCP_COMMON_RANGE_SEARCH_HPP
@@ -8,14 +8,21 @@
 
 #include "pcp/common/axis_aligned_bounding_box.hpp"
 #include "pcp/common/intersections.hpp"
+#include "pcp/common/morton.hpp"
+#include "pcp/common/nearest_neighbours.hpp"
 #include "pcp/common/points/point.hpp"
+#include "pcp/common/range_search.hpp"
 #include "pcp/common/vector3d_queries.hpp"
 #include "pcp/kdtree/linked_kdtree_node.hpp"
 #include "pcp/traits/coordinate_map.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <queue>
+#include <cstdint>
+#include <execution>
+#include <limits>
+#include <numeric>
 #include <stack>
 
 namespace pcp {
@@ -30,6 +37,7 @@ struct construction_params_t
     std::size_t min_element_count_for_parallel_exec = 32'768;
     bool compute_max_depth                          = false;
     std::size_t max_elements_per_leaf               = 64u;
+    bool cache_coordinates                          = false;
 };
 
 } // namespace kdtree
@@ -53,40 +61,82 @@ struct construction_params_t
  * depth 2 => compare on the 1st dimension again
  *
  * Our Kdtree implementation uses a flat storage of the elements
- * and the nodes contain pointers to the storage. The depth of the tree
+ * and the nodes refer to contiguous ranges of the storage. The depth of the tree
  * is adjustable only on construction and in our implementation,
  * the leaf nodes contain one or more than elements.
  *
+ * Elements can be 32-bit indices into an external point cloud, with a
+ * coordinate map reading the indexed coordinates. The coordinates of the
+ * elements can also be cached in structure of arrays form, in the order
+ * of the storage, so that KNN and range searches read the coordinates of
+ * a node's elements as contiguous arrays rather than through the
+ * coordinate map.
+ *
  * @tparam Element Type of the kdtree's elements
  * @tparam K Dimensionality of the stored elements
  * @tparam CoordinateMap The mapping between the index of an element and its coordinates
+ * @tparam Allocator Type of allocator used for the kdtree's nodes and storage
  */
-template <class Element, std::size_t K, class CoordinateMap>
+template <
+    class Element,
+    std::size_t K,
+    class CoordinateMap,
+    class Allocator = std::allocator<Element>>
 class basic_linked_kdtree_t
 {
   public:
     using self_type        = basic_linked_kdtree_t;
     using element_type     = Element;
-    using node_type        = basic_linked_kdtree_node_t<element_type>;
+    using node_type        = basic_linked_kdtree_node_t<element_type, Allocator>;
     using node_type_ptr    = typename node_type::self_type_ptr;
     using coordinates_type = std::invoke_result_t<CoordinateMap, Element>;
     using coordinate_type  = traits::coordinate_type<CoordinateMap, Element>;
     using aabb_type        = kd_axis_aligned_bounding_box_t<coordinate_type, K>;
 
     // container aliases
-    using iterator        = typename std::vector<element_type>::iterator;
-    using const_iterator  = typename std::vector<element_type>::const_iterator;
+    using storage_type    = std::vector<element_type, Allocator>;
+    using iterator        = typename storage_type::iterator;
+    using const_iterator  = typename storage_type::const_iterator;
     using value_type      = element_type;
     using reference       = value_type&;
     using const_reference = value_type const&;
-    using difference_type = typename std::vector<element_type>::difference_type;
-    using size_type       = typename std::vector<element_type>::size_type;
-    using allocator_type  = typename std::vector<element_type>::allocator_type;
+    using difference_type = typename storage_type::difference_type;
+    using size_type       = typename storage_type::size_type;
+    using allocator_type  = typename storage_type::allocator_type;
+
+    using coordinate_cache_type = std::array<
+        std::vector<
+            coordinate_type,
+            typename std::allocator_traits<Allocator>::template rebind_alloc<coordinate_type>>,
+        K>; ///< Coordinates of the elements in structure of arrays form
 
     static_assert(
         traits::is_coordinate_map_v<CoordinateMap, Element, coordinate_type, K>,
         "CoordinateMap must satisfy CoordinateMap concept");
 
+    /**
+     * @brief
+     * Reusable storage for KNN searches. Keeping one scratch object per thread
+     * lets repeated searches run without allocating.
+     */
+    struct knn_scratch_t
+    {
+        using neighbour_type  = neighbour_t<element_type const*, coordinate_type>;
+        using neighbours_type = std::vector<neighbour_type>;
+
+        k_best_heap_t<element_type const*, coordinate_type> k_best; ///< The k best elements
+    };
+
+    using knn_scratch_type = knn_scratch_t;
+    using neighbour_type   = typename knn_scratch_t::neighbour_type;
+
+    /**
+     * @brief
+     * Number of consecutive targets, in Morton order, searched by the
+     * same thread during batched KNN searches
+     */
+    static constexpr std::size_t knn_batch_chunk_size = 256u;
+
     /**
      * @brief
      * Constructs this kdtree from a range of elements and a coordinate map
@@ -96,18 +146,21 @@ class basic_linked_kdtree_t
      * @param coordinate_map The coordinate map for the mapping between the element and its
      * coordinates
      * @param params The configuration for this kdtree
+     * @param allocator The allocator for the kdtree's nodes and storage
      */
     template <class ForwardIter>
     basic_linked_kdtree_t(
         ForwardIter begin,
         ForwardIter end,
         CoordinateMap coordinate_map         = CoordinateMap{},
-        kdtree::construction_params_t params = kdtree::construction_params_t{})
+        kdtree::construction_params_t params = kdtree::construction_params_t{},
+        allocator_type const& allocator      = allocator_type{})
         : max_depth_{params.max_depth},
-          storage_(begin, end),
+          storage_(begin, end, allocator),
           root_{},
           coordinate_map_{coordinate_map},
-          aabb_{}
+          aabb_{},
+          coordinate_cache_{}
     {
         aabb_ = kd_bounding_box<coordinate_type, K, CoordinateMap, ForwardIter>(
             begin,
@@ -132,6 +185,9 @@ class basic_linked_kdtree_t
             // TODO: Perform correct presorting in exact median construction method
             // construct_presort();
         }
+
+        if (params.cache_coordinates)
+            cache_coordinates();
     }
 
     /**
@@ -154,8 +210,48 @@ class basic_linked_kdtree_t
     {
         root_.reset();
         storage_.clear();
+        for (auto& coordinates : coordinate_cache_)
+            coordinates.clear();
+    }
+
+    /**
+     * @brief
+     * Caches the coordinates of the elements in structure of arrays form,
+     * in the order of the storage. Searches then read the cached coordinates
+     * instead of calling the coordinate map.
+     */
+    void cache_coordinates()
+    {
+        auto const allocator = storage_.get_allocator();
+        for (std::size_t d = 0u; d < K; ++d)
+        {
+            coordinate_cache_[d] = typename coordinate_cache_type::value_type(allocator);
+            coordinate_cache_[d].reserve(storage_.size());
+        }
+
+        for (auto const& element : storage_)
+        {
+            coordinates_type const& coordinates = coordinate_map_(element);
+            for (std::size_t d = 0u; d < K; ++d)
+                coordinate_cache_[d].push_back(coordinates[d]);
+        }
+    }
+
+    /**
+     * @brief Checks if the coordinates of the elements are cached
+     * @return True if the coordinates of the elements are cached
+     */
+    bool has_coordinate_cache() const
+    {
+        return !storage_.empty() && coordinate_cache_.front().size() == storage_.size();
     }
 
+    /**
+     * @brief The cached coordinates of the elements, in the order of the storage
+     * @return The cached coordinates, one array per dimension
+     */
+    coordinate_cache_type const& coordinate_cache() const { return coordinate_cache_; }
+
     /**
      * @brief Iterator to the first element of this kdtree
      * @return Iterator to the first element of this kdtree
@@ -175,6 +271,12 @@ class basic_linked_kdtree_t
     const_iterator cbegin() const { return storage_.cbegin(); }
     const_iterator cend() const { return storage_.cend(); }
 
+    /**
+     * @brief The allocator used for the kdtree's nodes and storage
+     * @return The allocator used for the kdtree's nodes and storage
+     */
+    allocator_type get_allocator() const { return storage_.get_allocator(); }
+
     /**
      * @brief Root of the kdtree
      * @return Root of the kdtree
@@ -202,47 +304,261 @@ class basic_linked_kdtree_t
         std::size_t k,
         coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
     {
-        auto const less_than_coordinates =
-            [target](coordinates_type const& c1, coordinates_type const& c2) {
-                auto const distance1 = common::squared_distance(target, c1);
-                auto const distance2 = common::squared_distance(target, c2);
-                return distance1 < distance2;
-            };
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, scratch, eps);
 
-        auto const less_than_elements = [less_than_coordinates,
-                                         this](element_type const* e1, element_type const* e2) {
-            auto const& coordinates1 = coordinate_map_(*e1);
-            auto const& coordinates2 = coordinate_map_(*e2);
+        std::vector<element_type> knearest_neighbours{};
+        knearest_neighbours.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_neighbours.push_back(*neighbour.element);
 
-            return less_than_coordinates(coordinates1, coordinates2);
-        };
+        return knearest_neighbours;
+    }
 
-        node_type const* current_node = root_.get();
-        std::priority_queue<element_type*, std::vector<element_type*>, decltype(less_than_elements)>
-            max_heap(less_than_elements);
-
-        recurse_knn<decltype(less_than_coordinates), decltype(less_than_elements)>(
-            target,
-            k,
-            current_node,
-            aabb_,
-            0u,
-            less_than_coordinates,
-            less_than_elements,
-            max_heap,
-            eps);
+    /**
+     * @brief
+     * Writes the k-nearest-neighbours in K dimensions Euclidean space to out as
+     * (element, squared distance) pairs, ordered from nearest to furthest.
+     * This algorithm will not return a point that is the same as the target point.
+     * Storage for the search is taken from scratch, which should be reused
+     * across queries (one per thread) to avoid allocating.
+     * @tparam OutputIter Output iterator accepting neighbour_type values
+     * @param target the coordinates to the reference point for which we want the k nearest
+     * neighbors
+     * @param k The number of neighbors to return that are nearest to the specified point
+     * @param scratch The reusable search storage
+     * @param out Output iterator to the neighbours
+     * @param eps eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class OutputIter>
+    OutputIter nearest_neighbours(
+        coordinates_type const& target,
+        std::size_t k,
+        knn_scratch_t& scratch,
+        OutputIter out,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        auto const& neighbours = knn_search(target, k, scratch, eps);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /**
+     * @brief
+     * Returns approximate k-nearest-neighbours in K dimensions Euclidean space.
+     * Subtrees further than the k-th nearest neighbour divided by
+     * (1 + approximation.epsilon) are pruned, and the search stops after
+     * visiting approximation.max_visited_leaves leaves.
+     * This algorithm will not return a point that is the same as the target point.
+     * @param target the coordinates to the reference point for which we want the k nearest
+     * neighbors
+     * @param k The number of neighbors to return that are nearest to the specified point
+     * @param approximation The approximation settings
+     * @param eps eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    std::vector<element_type> approximate_nearest_neighbours(
+        coordinates_type const& target,
+        std::size_t k,
+        approximate_knn_parameters_t const& approximation,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, scratch, eps, approximation);
 
         std::vector<element_type> knearest_neighbours{};
-        knearest_neighbours.reserve(k);
-        while (!max_heap.empty())
-        {
-            knearest_neighbours.push_back(*max_heap.top());
-            max_heap.pop();
-        }
-        std::reverse(knearest_neighbours.begin(), knearest_neighbours.end());
+        knearest_neighbours.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_neighbours.push_back(*neighbour.element);
+
+        return knearest_neighbours;
+    }
+
+    /**
+     * @brief
+     * Writes approximate k-nearest-neighbours in K dimensions Euclidean space to
+     * out as (element, squared distance) pairs, ordered from nearest to furthest.
+     * @tparam OutputIter Output iterator accepting neighbour_type values
+     * @param target the coordinates to the reference point for which we want the k nearest
+     * neighbors
+     * @param k The number of neighbors to return that are nearest to the specified point
+     * @param approximation The approximation settings
+     * @param scratch The reusable search storage
+     * @param out Output iterator to the neighbours
+     * @param eps eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class OutputIter>
+    OutputIter approximate_nearest_neighbours(
+        coordinates_type const& target,
+        std::size_t k,
+        approximate_knn_parameters_t const& approximation,
+        knn_scratch_t& scratch,
+        OutputIter out,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        auto const& neighbours = knn_search(target, k, scratch, eps, approximation);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /**
+     * @brief
+     * Returns at most k nearest neighbours in K dimensions Euclidean space within
+     * a radius of the target. The search starts with the squared radius as its
+     * pruning bound, so subtrees are pruned against the nearer of the radius and
+     * the k-th nearest neighbour.
+     * This algorithm will not return a point that is the same as the target point.
+     * @param target the coordinates to the reference point for which we want the k nearest
+     * neighbors
+     * @param k The maximum number of neighbors to return
+     * @param radius The maximum distance of the neighbours to the target
+     * @param eps eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    std::vector<element_type> radius_nearest_neighbours(
+        coordinates_type const& target,
+        std::size_t k,
+        coordinate_type radius,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, scratch, eps, {}, radius * radius);
+
+        std::vector<element_type> knearest_neighbours{};
+        knearest_neighbours.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_neighbours.push_back(*neighbour.element);
+
         return knearest_neighbours;
     }
 
+    /**
+     * @brief
+     * Writes at most k nearest neighbours in K dimensions Euclidean space within a
+     * radius of the target to out as (element, squared distance) pairs, ordered
+     * from nearest to furthest.
+     * @tparam OutputIter Output iterator accepting neighbour_type values
+     * @param target the coordinates to the reference point for which we want the k nearest
+     * neighbors
+     * @param k The maximum number of neighbors to return
+     * @param radius The maximum distance of the neighbours to the target
+     * @param scratch The reusable search storage
+     * @param out Output iterator to the neighbours
+     * @param eps eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class OutputIter>
+    OutputIter radius_nearest_neighbours(
+        coordinates_type const& target,
+        std::size_t k,
+        coordinate_type radius,
+        knn_scratch_t& scratch,
+        OutputIter out,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        auto const& neighbours = knn_search(target, k, scratch, eps, {}, radius * radius);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /**
+     * @brief
+     * Computes the k-nearest-neighbours of a batch of targets. The targets are
+     * sorted in Morton order and split into chunks of consecutive targets, which
+     * are searched concurrently. Within a chunk, the previous target's neighbours
+     * bound the distance to the next target's k-th nearest neighbour, so that each
+     * search starts with most of the kdtree already pruned when consecutive
+     * targets are close.
+     * @tparam ExecutionPolicy Type of STL execution policy
+     * @tparam RandomAccessIter Type of iterator to the targets' coordinates
+     * @tparam OutputIter Random access iterator to sequence containers of element_type
+     * @param policy The execution policy
+     * @param first Begin iterator to the targets
+     * @param last End iterator to the targets
+     * @param k The number of neighbors to return for each target
+     * @param out Iterator to the containers receiving each target's k nearest
+     * neighbours, from nearest to furthest, in the order of the targets
+     * @param eps eps The error tolerance for floating point equality
+     */
+    template <class ExecutionPolicy, class RandomAccessIter, class OutputIter>
+    void batch_nearest_neighbours(
+        ExecutionPolicy&& policy,
+        RandomAccessIter first,
+        RandomAccessIter last,
+        std::size_t k,
+        OutputIter out,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        auto const num_targets = static_cast<std::size_t>(std::distance(first, last));
+
+        /*
+         * Targets outside of the kdtree's bounding box are clamped to
+         * its boundary, which only affects their scheduling.
+         */
+        std::vector<std::uint64_t> codes(num_targets);
+        std::transform(policy, first, last, codes.begin(), [this](coordinates_type const& target) {
+            std::array<std::uint32_t, K> cell{};
+            for (std::size_t d = 0u; d < K; ++d)
+                cell[d] = morton::quantize(
+                    target[d],
+                    aabb_.min[d],
+                    aabb_.max[d],
+                    morton::bits_per_dimension_v<K>);
+            return morton::encode(cell);
+        });
+        auto const order = morton::sorted_order(policy, codes);
+
+        std::vector<std::size_t> chunks(
+            (num_targets + knn_batch_chunk_size - 1u) / knn_batch_chunk_size);
+        std::iota(chunks.begin(), chunks.end(), std::size_t{0u});
+        std::for_each(policy, chunks.begin(), chunks.end(), [&](std::size_t chunk) {
+            auto const chunk_begin = chunk * knn_batch_chunk_size;
+            auto const chunk_end   = std::min(chunk_begin + knn_batch_chunk_size, num_targets);
+
+            knn_scratch_t scratch;
+            typename knn_scratch_t::neighbours_type const* previous_neighbours = nullptr;
+            for (auto i = chunk_begin; i < chunk_end; ++i)
+            {
+                auto const target_index        = order[i];
+                coordinates_type const& target = first[static_cast<std::ptrdiff_t>(target_index)];
+                auto const max_squared_distance =
+                    previous_neighbours == nullptr ?
+                        std::numeric_limits<coordinate_type>::max() :
+                        knn_bound_from(*previous_neighbours, target, k, eps);
+
+                auto const& neighbours =
+                    knn_search(target, k, scratch, eps, {}, max_squared_distance);
+                previous_neighbours    = std::addressof(neighbours);
+
+                auto& knearest_neighbours = out[static_cast<std::ptrdiff_t>(target_index)];
+                knearest_neighbours.clear();
+                for (auto const& neighbour : neighbours)
+                    knearest_neighbours.push_back(*neighbour.element);
+            }
+        });
+    }
+
+    /**
+     * @brief
+     * Computes the k-nearest-neighbours of a batch of targets sequentially.
+     * @tparam RandomAccessIter Type of iterator to the targets' coordinates
+     * @tparam OutputIter Random access iterator to sequence containers of element_type
+     * @param first Begin iterator to the targets
+     * @param last End iterator to the targets
+     * @param k The number of neighbors to return for each target
+     * @param out Iterator to the containers receiving each target's k nearest neighbours
+     * @param eps eps The error tolerance for floating point equality
+     */
+    template <class RandomAccessIter, class OutputIter>
+    void batch_nearest_neighbours(
+        RandomAccessIter first,
+        RandomAccessIter last,
+        std::size_t k,
+        OutputIter out,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        batch_nearest_neighbours(std::execution::seq, first, last, k, out, eps);
+    }
+
     /**
      * @brief 
      * Returns the k-nearest-neighbours in K dimensions Euclidean space.
@@ -262,6 +578,100 @@ class basic_linked_kdtree_t
         return nearest_neighbours(target, k, eps);
     }
 
+    /**
+     * @brief
+     * Returns a lazy range of the neighbours in K dimensions Euclidean space, as
+     * (element pointer, squared distance) pairs ordered from nearest to furthest,
+     * for searches which do not know how many neighbours they need.
+     * This algorithm will not return a point that is the same as the target point.
+     * Subtrees are only visited when the next neighbour may lie in them, so stopping
+     * early does not pay for the neighbours that were not visited. The kdtree must
+     * outlive the range.
+     * @param target the coordinates to the reference point for which we want the nearest
+     * neighbors
+     * @param eps eps The error tolerance for floating point equality
+     * @return An input range of neighbour_type values
+     */
+    auto incremental_nearest_neighbours(
+        coordinates_type const& target,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        struct subtree_t
+        {
+            node_type const* node;
+            aabb_type aabb;
+            std::size_t depth;
+        };
+
+        auto expand = [this, target, eps](subtree_t const& subtree, auto& neighbours) {
+            node_type const* current_node = subtree.node;
+            if (current_node == nullptr)
+                return;
+
+            for (auto const& element : current_node->points())
+            {
+                coordinates_type const& element_coordinates = coordinate_map_(*element);
+
+                bool is_target = true;
+                for (std::size_t d = 0u; d < K; ++d)
+                    is_target = is_target && common::floating_point_equals(
+                                                 element_coordinates[d],
+                                                 target[d],
+                                                 eps);
+                if (is_target)
+                    continue;
+
+                neighbours.push_element(
+                    element,
+                    common::squared_distance(target, element_coordinates));
+            }
+
+            auto const dimension = subtree.depth % K;
+            auto const split     = split_coordinate(current_node, dimension);
+
+            aabb_type left_aabb       = subtree.aabb;
+            left_aabb.max[dimension]  = split;
+            aabb_type right_aabb      = subtree.aabb;
+            right_aabb.min[dimension] = split;
+
+            auto const push_child = [&](node_type const* child, aabb_type const& child_aabb) {
+                if (child == nullptr)
+                    return;
+
+                neighbours.push_node(
+                    subtree_t{child, child_aabb, subtree.depth + 1u},
+                    common::squared_distance(child_aabb.nearest_point_from(target), target));
+            };
+            push_child(current_node->left().get(), left_aabb);
+            push_child(current_node->right().get(), right_aabb);
+        };
+
+        using neighbours_type = incremental_nearest_neighbours_t<
+            element_type const*,
+            subtree_t,
+            coordinate_type,
+            decltype(expand)>;
+        return neighbours_type(
+            subtree_t{root_.get(), aabb_, 0u},
+            common::squared_distance(aabb_.nearest_point_from(target), target),
+            std::move(expand));
+    }
+
+    /**
+     * @brief
+     * Returns a lazy range of the neighbours in K dimensions Euclidean space, as
+     * (element pointer, squared distance) pairs ordered from nearest to furthest.
+     * @param element_target The reference point for which we want the nearest neighbors
+     * @param eps eps The error tolerance for floating point equality
+     * @return An input range of neighbour_type values
+     */
+    auto incremental_nearest_neighbours(
+        element_type const& element_target,
+        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+    {
+        return incremental_nearest_neighbours(coordinate_map_(element_target), eps);
+    }
+
     /**
      * @brief Range search
      * @param range The range in which we want to find points
@@ -271,48 +681,232 @@ class basic_linked_kdtree_t
     std::vector<element_type> range_search(Range const& range) const
     {
         std::vector<element_type> elements_in_range{};
+        visit_range(range, [&elements_in_range](element_type const& e) {
+            elements_in_range.push_back(e);
+        });
+        return elements_in_range;
+    }
+
+    /**
+     * @brief Range search writing the elements found to out
+     * @param range The range in which we want to find points
+     * @param out Output iterator to the elements in range
+     * @return Output iterator past the last written element
+     */
+    template <class Range, class OutputIter>
+    OutputIter range_search(Range const& range, OutputIter out) const
+    {
+        visit_range(range, [&out](element_type const& e) { *out++ = e; });
+        return out;
+    }
+
+    /**
+     * @brief Range search calling visitor on the elements found, without storing them
+     * @param range The range in which we want to find points
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Range, class Visitor>
+    void visit_range(Range const& range, Visitor&& visitor) const
+    {
         node_type const* current_node = root_.get();
-        range_search_recursive(range, aabb_, current_node, elements_in_range, 0);
+        if (current_node == nullptr)
+            return;
+
+        auto const overlap = intersections::classify(aabb_, range);
+        if (overlap == intersections::overlap_t::disjoint)
+            return;
+
+        if (overlap == intersections::overlap_t::contained)
+            visit_subtree(current_node, visitor);
+        else
+            visit_range_recursive(range, aabb_, current_node, visitor, 0);
+    }
+
+    /**
+     * @brief
+     * Lazy range search. The kdtree is searched depth-first as the returned range
+     * is iterated, so that the search stops as soon as the iteration stops.
+     * The kdtree must outlive the returned range.
+     * @param range The range in which we want to find points, copied into the returned range
+     * @return An input range of the points in the range
+     */
+    template <class Range>
+    auto lazy_range_search(Range const& range) const
+    {
+        struct subtree_t
+        {
+            node_type const* node;
+            aabb_type aabb;
+            std::size_t depth;
+            bool is_contained;
+        };
+
+        /*
+         * Cells are classified against the range when they are searched,
+         * and the elements of cells contained in the range are reported
+         * without testing them.
+         */
+        auto expand = [this, range](subtree_t const& subtree, auto& elements) {
+            node_type const* current_node = subtree.node;
+            if (current_node == nullptr)
+                return;
+
+            bool is_contained = subtree.is_contained;
+            if (!is_contained)
+            {
+                auto const overlap = intersections::classify(subtree.aabb, range);
+                if (overlap == intersections::overlap_t::disjoint)
+                    return;
+
+                is_contained = overlap == intersections::overlap_t::contained;
+            }
+
+            for (auto const& element : current_node->points())
+                if (is_contained || range.contains(coordinate_map_(*element)))
+                    elements.push_element(*element);
+
+            auto const dimension      = subtree.depth % K;
+            auto const split          = split_coordinate(current_node, dimension);
+            aabb_type left_aabb       = subtree.aabb;
+            left_aabb.max[dimension]  = split;
+            aabb_type right_aabb      = subtree.aabb;
+            right_aabb.min[dimension] = split;
+
+            if (node_type const* left_child = current_node->left().get())
+                elements.push_node(
+                    subtree_t{left_child, left_aabb, subtree.depth + 1u, is_contained});
+            if (node_type const* right_child = current_node->right().get())
+                elements.push_node(
+                    subtree_t{right_child, right_aabb, subtree.depth + 1u, is_contained});
+        };
+
+        using elements_type = lazy_range_search_t<element_type, subtree_t, decltype(expand)>;
+        return elements_type(subtree_t{root_.get(), aabb_, 0u, false}, std::move(expand));
+    }
+
+    /**
+     * @brief Checks if any point lies in a range, stopping at the first point found
+     * @param range The range in which we want to find points
+     * @return True if a point lies in the range
+     */
+    template <class Range>
+    bool any_in_range(Range const& range) const
+    {
+        return !lazy_range_search(range).empty();
+    }
+
+    /**
+     * @brief Range search stopping once n points are found
+     * @param range The range in which we want to find points
+     * @param n Maximum number of points to return
+     * @return At most n of the points in the range
+     */
+    template <class Range>
+    std::vector<element_type> range_search_first(Range const& range, std::size_t n) const
+    {
+        std::vector<element_type> elements_in_range{};
+        if (n == 0u)
+            return elements_in_range;
+
+        /*
+         * Stop as soon as the n-th element is found, since advancing
+         * the lazy search again may expand a whole subtree.
+         */
+        auto elements = lazy_range_search(range);
+        for (auto it = elements.begin(); it != elements.end(); ++it)
+        {
+            elements_in_range.push_back(*it);
+            if (elements_in_range.size() == n)
+                break;
+        }
         return elements_in_range;
     }
 
   private:
-    template <class Range>
-    void range_search_recursive(
+    template <class Range, class Visitor>
+    void visit_range_recursive(
         Range const& range,
         aabb_type const& current_aabb,
         node_type const* current_node,
-        std::vector<element_type>& elements_in_range,
+        Visitor& visitor,
         std::size_t current_depth) const
     {
         // verify if the point is in the range
-        auto const node_elements = current_node->points();
-        for (auto const& element : node_elements)
+        auto const& node_elements = current_node->points();
+        if (has_coordinate_cache())
         {
-            coordinates_type const& element_coordinates = coordinate_map_(*element);
-            if (range.contains(element_coordinates))
-                elements_in_range.push_back(*element);
+            auto const first = static_cast<std::size_t>(node_elements.data() - storage_.data());
+            for (std::size_t i = 0u; i < node_elements.size(); ++i)
+            {
+                typename aabb_type::point_type element_coordinates;
+                for (std::size_t d = 0u; d < K; ++d)
+                    element_coordinates[d] = coordinate_cache_[d][first + i];
+                if (range.contains(element_coordinates))
+                    visitor(node_elements.data()[i]);
+            }
+        }
+        else
+        {
+            for (auto const& element : node_elements)
+            {
+                coordinates_type const& element_coordinates = coordinate_map_(*element);
+                if (range.contains(element_coordinates))
+                    visitor(*element);
+            }
         }
         auto const dimension      = current_depth % K;
-        auto const& median        = current_node->points().front();
-        auto const& median_point  = coordinate_map_(*median);
+        auto const split          = split_coordinate(current_node, dimension);
         aabb_type left_aabb       = current_aabb;
-        left_aabb.max[dimension]  = median_point[dimension];
+        left_aabb.max[dimension]  = split;
         aabb_type right_aabb      = current_aabb;
-        right_aabb.min[dimension] = median_point[dimension];
+        right_aabb.min[dimension] = split;
         auto left_child           = current_node->left().get();
         auto right_child          = current_node->right().get();
 
         ++current_depth;
-        if (left_child != nullptr && intersections::intersects(left_aabb, range))
-            range_search_recursive(range, left_aabb, left_child, elements_in_range, current_depth);
-        if (right_child != nullptr && intersections::intersects(right_aabb, range))
-            range_search_recursive(
-                range,
-                right_aabb,
-                right_child,
-                elements_in_range,
-                current_depth);
+        if (left_child != nullptr)
+            visit_range_child(range, left_aabb, left_child, visitor, current_depth);
+        if (right_child != nullptr)
+            visit_range_child(range, right_aabb, right_child, visitor, current_depth);
+    }
+
+    /**
+     * @brief
+     * Discards, bulk-visits or searches the child's cell according
+     * to the cell's overlap with the range
+     */
+    template <class Range, class Visitor>
+    void visit_range_child(
+        Range const& range,
+        aabb_type const& child_aabb,
+        node_type const* child,
+        Visitor& visitor,
+        std::size_t child_depth) const
+    {
+        auto const overlap = intersections::classify(child_aabb, range);
+        if (overlap == intersections::overlap_t::disjoint)
+            return;
+
+        // every element of a cell contained in the range is in the range
+        if (overlap == intersections::overlap_t::contained)
+            visit_subtree(child, visitor);
+        else
+            visit_range_recursive(range, child_aabb, child, visitor, child_depth);
+    }
+
+    /**
+     * @brief Calls visitor on every element of the subtree rooted at node
+     */
+    template <class Visitor>
+    void visit_subtree(node_type const* node, Visitor& visitor) const
+    {
+        for (auto const& element : node->points())
+            visitor(*element);
+
+        if (node_type const* left_child = node->left().get())
+            visit_subtree(left_child, visitor);
+        if (node_type const* right_child = node->right().get())
+            visit_subtree(right_child, visitor);
     }
     /**
      * @brief comparator for elements on a certain dimension
@@ -347,7 +941,7 @@ class basic_linked_kdtree_t
             construct_nth_element_recursive(min_element_count_for_parallel_exec, 0u, size - 1u, 0u);
     }
 
-    std::unique_ptr<node_type> construct_nth_element_recursive(
+    node_type_ptr construct_nth_element_recursive(
         std::size_t min_element_count_for_parallel_exec,
         std::size_t first,
         std::size_t last,
@@ -361,23 +955,16 @@ class basic_linked_kdtree_t
             return nullptr;
         }
 
-        auto node    = std::make_unique<node_type>();
-        auto& points = node->points();
-        auto size    = std::size_t{(last + 1u) - first};
+        auto const allocator = storage_.get_allocator();
+        auto node            = allocate_node<node_type>(allocator, allocator);
+        auto size            = std::size_t{(last + 1u) - first};
 
         /**
          * Leaf node
          */
         if (current_depth == max_depth_ - 1u)
         {
-            points.resize(size);
-            auto begin     = storage_.begin() + static_cast<difference_type>(first);
-            auto end       = storage_.begin() + static_cast<difference_type>(last + 1u);
-            auto out_begin = points.begin();
-
-            std::transform(begin, end, out_begin, [](element_type& e) {
-                return std::addressof(e);
-            });
+            node->set_points(std::addressof(storage_[first]), static_cast<std::uint32_t>(size));
             return node;
         }
 
@@ -386,7 +973,7 @@ class basic_linked_kdtree_t
          */
         if (first == last)
         {
-            points.push_back(std::addressof(storage_[first]));
+            node->set_points(std::addressof(storage_[first]), 1u);
             return node;
         }
 
@@ -404,7 +991,7 @@ class basic_linked_kdtree_t
             std::nth_element(std::execution::seq, begin, mid, end, less_than);
 
         auto median = first + size / 2u;
-        points.push_back(std::addressof(storage_[median]));
+        node->set_points(std::addressof(storage_[median]), 1u);
 
         ++current_depth;
         auto left_child = construct_nth_element_recursive(
@@ -433,130 +1020,232 @@ class basic_linked_kdtree_t
     //{
     //}
 
-    template <class CoordinatesLessThanType, class ElementLessThanType>
-    void recurse_knn(
+    /**
+     * @brief
+     * KNN search implementation
+     * @param target The coordinates of the reference point
+     * @param k The number of neighbours to search for
+     * @param scratch Storage for the search's heap
+     * @param eps The error tolerance for floating point equality
+     * @param approximation The approximation settings, exact by default
+     * @param max_squared_distance Known upper bound on the k-th nearest neighbour's
+     * squared distance to the target
+     * @return The neighbours sorted from nearest to furthest, stored in scratch
+     */
+    typename knn_scratch_t::neighbours_type const& knn_search(
         coordinates_type const& target,
         std::size_t k,
+        knn_scratch_t& scratch,
+        coordinate_type eps,
+        approximate_knn_parameters_t const& approximation = {},
+        coordinate_type max_squared_distance = std::numeric_limits<coordinate_type>::max()) const
+    {
+        auto& k_best = scratch.k_best;
+        k_best.reset(k, max_squared_distance);
+
+        node_type const* current_node = root_.get();
+        std::size_t remaining_leaves  = approximation.max_visited_leaves;
+        if (k > 0u && current_node != nullptr && remaining_leaves > 0u)
+            recurse_knn(
+                target,
+                current_node,
+                aabb_,
+                0u,
+                k_best,
+                eps,
+                approximation.squared_distance_factor<coordinate_type>(),
+                remaining_leaves);
+
+        return k_best.sort();
+    }
+
+    /**
+     * @brief
+     * Upper bound on the squared distance from a target to its k-th nearest
+     * neighbour, given k candidate neighbours such as the neighbours of a
+     * nearby target
+     * @param candidates The candidate neighbours
+     * @param target The coordinates of the reference point
+     * @param k The number of neighbours to search for
+     * @param eps The error tolerance for floating point equality
+     * @return The bound, or the maximum coordinate value if the candidates do not bound the search
+     */
+    coordinate_type knn_bound_from(
+        typename knn_scratch_t::neighbours_type const& candidates,
+        coordinates_type const& target,
+        std::size_t k,
+        coordinate_type eps) const
+    {
+        auto constexpr no_bound = std::numeric_limits<coordinate_type>::max();
+        if (candidates.size() < k)
+            return no_bound;
+
+        /*
+         * Elements at the target's position are not neighbours
+         * of the target, so they cannot be counted in the bound.
+         */
+        coordinate_type bound{0};
+        for (auto const& candidate : candidates)
+        {
+            coordinates_type const& coordinates = coordinate_map_(*candidate.element);
+
+            bool is_target = true;
+            for (std::size_t d = 0u; d < K; ++d)
+                is_target =
+                    is_target && common::floating_point_equals(coordinates[d], target[d], eps);
+            if (is_target)
+                return no_bound;
+
+            bound = std::max(bound, common::squared_distance(target, coordinates));
+        }
+        return bound;
+    }
+
+    /**
+     * @brief
+     * Coordinate of a node's median element along the node's splitting
+     * dimension, read from the coordinate cache if there is one
+     * @param node The node
+     * @param dimension The node's splitting dimension
+     * @return The coordinate splitting the node's children's cells
+     */
+    coordinate_type split_coordinate(node_type const* node, std::size_t dimension) const
+    {
+        element_type const* median = node->points().front();
+        if (has_coordinate_cache())
+            return coordinate_cache_[dimension][static_cast<std::size_t>(median - storage_.data())];
+
+        coordinates_type const& median_point = coordinate_map_(*median);
+        return median_point[dimension];
+    }
+
+    void recurse_knn(
+        coordinates_type const& target,
         node_type const* current_node,
         aabb_type const& current_aabb,
         std::size_t current_depth,
-        CoordinatesLessThanType const& coordinates_less_than,
-        ElementLessThanType const& element_less_than,
-        std::priority_queue<element_type*, std::vector<element_type*>, ElementLessThanType>&
-            max_heap,
-        coordinate_type eps = static_cast<coordinate_type>(1e-5)) const
+        k_best_heap_t<element_type const*, coordinate_type>& k_best,
+        coordinate_type eps,
+        coordinate_type distance_factor,
+        std::size_t& remaining_leaves) const
     {
+        // TODO: Make array element checking code generated at compile time
+        //       using possibly integer sequence, or other TMP techniques
+        auto const are_kd_vectors_equal = [=](auto const& v1, auto const& v2) {
+            auto rng = ranges::views::zip(v1, v2);
+            return std::all_of(rng.begin(), rng.end(), [=](auto&& tup) {
+                auto const& c1 = std::get<0>(tup);
+                auto const& c2 = std::get<1>(tup);
+                return common::floating_point_equals(c1, c2, eps);
+            });
+        };
+
         /**
          * Add elements of the current node in our current
          * best k nearest neighbours if those elements are
          * better k nearest neighbours (close than the max
-         * heap's root)
+         * heap's root). Each element's distance to the target
+         * is computed once and kept in the heap.
          */
         auto const& elements = current_node->points();
-        for (auto const& element : elements)
+        if (has_coordinate_cache())
         {
-            bool const is_heap_full = max_heap.size() == k;
-            // TODO: Make array element checking code generated at compile time
-            //       using possibly integer sequence, or other TMP techniques
-            auto const are_kd_vectors_equal = [=](auto const& v1, auto const& v2) {
-                auto rng = ranges::views::zip(v1, v2);
-                return std::all_of(rng.begin(), rng.end(), [=](auto&& tup) {
-                    auto const& c1 = std::get<0>(tup);
-                    auto const& c2 = std::get<1>(tup);
-                    return common::floating_point_equals(c1, c2, eps);
-                });
-            };
-            auto const is_target = [&, this](element_type const& e) {
-                coordinates_type const& element_coordinates = coordinate_map_(e);
-                return are_kd_vectors_equal(target, element_coordinates);
-            };
-
-            if (is_target(*element))
-                continue;
-
-            if (!is_heap_full)
+            /**
+             * The node's cached coordinates are contiguous in each
+             * dimension's array.
+             */
+            auto const first = static_cast<std::size_t>(elements.data() - storage_.data());
+            for (std::size_t i = 0u; i < elements.size(); ++i)
             {
-                max_heap.push(element);
-                continue;
-            }
+                coordinate_type squared_distance{0};
+                bool is_target = true;
+                for (std::size_t d = 0u; d < K; ++d)
+                {
+                    auto const c     = coordinate_cache_[d][first + i];
+                    auto const delta = c - target[d];
+                    squared_distance += delta * delta;
+                    is_target = is_target && common::floating_point_equals(c, target[d], eps);
+                }
+                if (is_target)
+                    continue;
 
-            element_type const* heap_root = max_heap.top();
-            if (!element_less_than(element, heap_root))
-                continue;
+                k_best.push(elements.data() + i, squared_distance);
+            }
+        }
+        else
+        {
+            for (auto const& element : elements)
+            {
+                coordinates_type const& element_coordinates = coordinate_map_(*element);
+                if (are_kd_vectors_equal(target, element_coordinates))
+                    continue;
 
-            max_heap.pop();
-            max_heap.push(element);
+                k_best.push(element, common::squared_distance(target, element_coordinates));
+            }
         }
+        if (current_node->is_leaf())
+            --remaining_leaves;
 
         node_type const* left_child  = current_node->left().get();
         node_type const* right_child = current_node->right().get();
 
-        auto const dimension     = current_depth % K;
-        auto const& median       = current_node->points().front();
-        auto const& median_point = coordinate_map_(*median);
+        auto const dimension = current_depth % K;
+        auto const split     = split_coordinate(current_node, dimension);
 
         aabb_type left_aabb       = current_aabb;
-        left_aabb.max[dimension]  = median_point[dimension];
+        left_aabb.max[dimension]  = split;
         aabb_type right_aabb      = current_aabb;
-        right_aabb.min[dimension] = median_point[dimension];
+        right_aabb.min[dimension] = split;
 
-        auto left_nearest_aabb_point  = left_aabb.nearest_point_from(target);
-        auto right_nearest_aabb_point = right_aabb.nearest_point_from(target);
-
-        auto const is_heap_full = [&]() {
-            return max_heap.size() == k;
-        };
+        auto const left_distance =
+            common::squared_distance(left_aabb.nearest_point_from(target), target);
+        auto const right_distance =
+            common::squared_distance(right_aabb.nearest_point_from(target), target);
 
         auto const visit = [&](node_type const* child,
                                aabb_type const& child_aabb,
-                               coordinates_type nearest_aabb_point) {
-            bool const has_child = child != nullptr;
-            if (has_child)
-            {
-                element_type const* heap_root = max_heap.empty() ? nullptr : max_heap.top();
-                bool const should_recurse =
-                    !is_heap_full() ||
-                    coordinates_less_than(nearest_aabb_point, coordinate_map_(*heap_root));
-
-                if (should_recurse)
-                {
-                    recurse_knn<CoordinatesLessThanType, ElementLessThanType>(
-                        target,
-                        k,
-                        child,
-                        child_aabb,
-                        current_depth + 1u,
-                        coordinates_less_than,
-                        element_less_than,
-                        max_heap,
-                        eps);
-                }
-            }
+                               coordinate_type child_distance) {
+            /**
+             * Subtree distances are scaled by (1 + epsilon)^2 for approximate
+             * searches, and no subtree is visited once the leaf budget is spent.
+             */
+            bool const should_recurse = child != nullptr && remaining_leaves > 0u &&
+                                        child_distance * distance_factor <= k_best.bound();
+            if (should_recurse)
+                recurse_knn(
+                    target,
+                    child,
+                    child_aabb,
+                    current_depth + 1u,
+                    k_best,
+                    eps,
+                    distance_factor,
+                    remaining_leaves);
         };
 
         /**
          * Visit the child subtree closest to the target point first, and then
          * visit the other child.
          */
-        if (common::squared_distance(left_nearest_aabb_point, target) <
-            common::squared_distance(right_nearest_aabb_point, target))
+        if (left_distance < right_distance)
         {
-            visit(left_child, left_aabb, left_nearest_aabb_point);
-            visit(right_child, right_aabb, right_nearest_aabb_point);
+            visit(left_child, left_aabb, left_distance);
+            visit(right_child, right_aabb, right_distance);
         }
         else
         {
-            visit(right_child, right_aabb, right_nearest_aabb_point);
-            visit(left_child, left_aabb, left_nearest_aabb_point);
+            visit(right_child, right_aabb, right_distance);
+            visit(left_child, left_aabb, left_distance);
         }
     }
 
   private:
     std::size_t max_depth_;
-    std::vector<element_type> storage_;
+    storage_type storage_;
     node_type_ptr root_;
     CoordinateMap coordinate_map_;
     kd_axis_aligned_bounding_box_t<coordinate_type, K> aabb_;
+    coordinate_cache_type coordinate_cache_;
 };
 
 } // namespace pcp
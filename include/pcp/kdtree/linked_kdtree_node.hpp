@@ -6,26 +6,136 @@
  * @ingroup kd-tree
  */
 
+#include "pcp/common/node_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <memory>
-#include <vector>
 
 namespace pcp {
 
+/**
+ * @ingroup linked-kd-tree
+ * @brief
+ * View of the elements of a kdtree node, which are a contiguous range
+ * of the kdtree's storage. Iterating the view yields pointers to the
+ * elements.
+ * @tparam Element The element type
+ */
+template <class Element>
+class kdtree_node_points_t
+{
+  public:
+    using element_type = Element;
+
+    /**
+     * @brief Input iterator yielding pointers to the elements of the view
+     */
+    class iterator
+    {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = element_type*;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = value_type const*;
+        using reference         = value_type;
+
+        iterator() = default;
+        explicit iterator(element_type* element) : element_(element) {}
+
+        reference operator*() const { return element_; }
+        iterator& operator++()
+        {
+            ++element_;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            iterator it = *this;
+            ++element_;
+            return it;
+        }
+
+        bool operator==(iterator const& other) const { return element_ == other.element_; }
+        bool operator!=(iterator const& other) const { return !(*this == other); }
+
+      private:
+        element_type* element_ = nullptr;
+    };
+
+    kdtree_node_points_t() = default;
+    kdtree_node_points_t(element_type* first, std::uint32_t size) : first_(first), size_(size) {}
+
+    iterator begin() const { return iterator(first_); }
+    iterator end() const { return iterator(first_ + size_); }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0u; }
+
+    /**
+     * @brief Pointer to the first element, the view must not be empty
+     * @return Pointer to the first element
+     */
+    element_type* front() const { return first_; }
+
+    /**
+     * @brief Pointer to an element of the view
+     * @param i Position of the element in the view
+     * @return Pointer to the element
+     */
+    element_type* operator[](std::size_t i) const { return first_ + i; }
+
+    /**
+     * @brief Pointer to the first element of the view
+     * @return Pointer to the first element, or past the last element of an empty view
+     */
+    element_type* data() const { return first_; }
+
+  private:
+    element_type* first_ = nullptr;
+    std::uint32_t size_  = 0u;
+};
+
 /**
  *  @ingroup linked-kd-tree
  * @brief
  * A kdtree node at internal should only contain an element,
- * while a leaf node may contain more than one element
+ * while a leaf node may contain more than one element.
+ * The elements are a contiguous range of the kdtree's storage,
+ * referred to by a pointer and a 32-bit count. The node's allocator
+ * is only stored in the node if it is stateful.
  * @tparam Element The element type
+ * @tparam Allocator Type of allocator used for the nodes
  */
-template <class Element>
-class basic_linked_kdtree_node_t
+template <class Element, class Allocator = std::allocator<Element>>
+class basic_linked_kdtree_node_t : private node_allocator_holder_t<Allocator>
 {
+    using allocator_holder_type = node_allocator_holder_t<Allocator>;
+
   public:
-    using self_type     = basic_linked_kdtree_node_t;
-    using self_type_ptr = std::unique_ptr<self_type>;
-    using element_type  = Element;
-    using points_type   = std::vector<element_type*>;
+    using self_type      = basic_linked_kdtree_node_t;
+    using allocator_type = Allocator;
+    using self_type_ptr  = node_pointer_t<self_type>;
+    using element_type   = Element;
+    using points_type    = kdtree_node_points_t<element_type>;
+
+    basic_linked_kdtree_node_t() = default;
+
+    /**
+     * @brief Constructs an empty node
+     * @param allocator The allocator used for this node
+     */
+    explicit basic_linked_kdtree_node_t(allocator_type const& allocator)
+        : allocator_holder_type(allocator), right_(), left_(), points_()
+    {
+    }
+
+    /**
+     * @brief The allocator used by this node, only stored in the node if it is stateful
+     * @return The allocator used by this node
+     */
+    allocator_type get_allocator() const { return allocator_holder_type::get_allocator(); }
 
     /**
      * @brief Get the right child of the node
@@ -69,15 +179,14 @@ class basic_linked_kdtree_node_t
      * Leaf node may contain more than 1 element
      * @return List of elements in the node
      */
-    points_type& points() { return points_; }
+    points_type const& points() const { return points_; }
 
     /**
-     * @brief Get the list of elements in the node (readonly)
-     * internal node only contains 1 element
-     * Leaf node may contain more than 1 element
-     * @return List of elements in the node (readonly)
+     * @brief Set the list of elements in the node
+     * @param first Pointer to the first element in the kdtree's storage
+     * @param size Number of elements
      */
-    points_type const& points() const { return points_; }
+    void set_points(element_type* first, std::uint32_t size) { points_ = points_type(first, size); }
 
     /**
      * @brief Check if node is leaf
@@ -92,8 +201,13 @@ class basic_linked_kdtree_node_t
     bool is_internal() const { return !is_leaf(); }
 
   private:
-    std::unique_ptr<self_type> left_;
-    std::unique_ptr<self_type> right_;
+    /**
+     * Members are destroyed in reverse order of declaration, so the left
+     * subtree, allocated first by the tree's construction, is also freed
+     * first. Freeing nodes in allocation order is markedly faster.
+     */
+    self_type_ptr right_;
+    self_type_ptr left_;
     points_type points_;
 };
 
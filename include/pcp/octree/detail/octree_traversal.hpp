@@ -0,0 +1,342 @@
+#ifndef PCP_OCTREE_DETAIL_OCTREE_TRAVERSAL_HPP
+#define PCP_OCTREE_DETAIL_OCTREE_TRAVERSAL_HPP
+
+/**
+ * @file
+ * @ingroup octree
+ */
+
+#include "pcp/common/intersections.hpp"
+#include "pcp/common/norm.hpp"
+#include "pcp/common/vector3d_queries.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace pcp {
+namespace octree {
+namespace detail {
+
+/*
+ * Queries shared by the octrees whose nodes hold buckets of elements. The
+ * traversals only see the octree through a storage adapter, which is a
+ * type providing:
+ *
+ * - node_type, a cheap to copy handle to a node, like a pointer or an index
+ * - for_each_child(node, voxel, f), calling f(child, child_voxel) on the
+ *   children of a node of the given voxel, in octant order
+ * - for_each_element(node, f), calling f(e, p) on the elements held by the
+ *   node itself, where p is the point view of the element e
+ *
+ * Voxels are passed down the traversals, so nodes need not store them.
+ */
+
+/**
+ * @brief Voxel of a child of a voxel
+ * @tparam AABB Type of axis-aligned bounding box used for voxels
+ * @param voxel The parent voxel
+ * @param octant The child's octant in [0, 8) using the xyz bit order
+ * @return The child's voxel
+ */
+template <class AABB>
+AABB octant_voxel(AABB const& voxel, std::uint8_t octant)
+{
+    auto const center = voxel.center();
+    AABB child{};
+    child.min.x(octant & 0b100 ? center.x() : voxel.min.x());
+    child.max.x(octant & 0b100 ? voxel.max.x() : center.x());
+
+    child.min.y(octant & 0b010 ? center.y() : voxel.min.y());
+    child.max.y(octant & 0b010 ? voxel.max.y() : center.y());
+
+    child.min.z(octant & 0b001 ? center.z() : voxel.min.z());
+    child.max.z(octant & 0b001 ? voxel.max.z() : center.z());
+    return child;
+}
+
+/**
+ * @brief Octant of a voxel in which a point lies
+ * @tparam AABB Type of axis-aligned bounding box used for voxels
+ * @tparam TPointView Type satisfying PointView concept
+ * @param voxel The voxel
+ * @param p The point
+ * @return The octant in [0, 8) using the xyz bit order
+ */
+template <class AABB, class TPointView>
+std::uint8_t octant_of(AABB const& voxel, TPointView const& p)
+{
+    auto const center   = voxel.center();
+    std::uint8_t octant = 0b000;
+    if (p.x() > center.x())
+        octant |= 0b100;
+    if (p.y() > center.y())
+        octant |= 0b010;
+    if (p.z() > center.z())
+        octant |= 0b001;
+    return octant;
+}
+
+/**
+ * @brief
+ * Storage adapter of linked octrees, whose nodes hold their bucket in an
+ * elements member and own their children through the smart pointers of an
+ * octants member
+ * @tparam Node Type of the octree's nodes
+ * @tparam PointViewMap Type satisfying PointViewMap concept
+ */
+template <class Node, class PointViewMap>
+struct linked_storage_t
+{
+    using node_type = Node const*;
+
+    PointViewMap const& point_view; ///< The point view property map
+
+    template <class AABB, class Visitor>
+    void for_each_child(node_type node, AABB const& voxel, Visitor&& visitor) const
+    {
+        for (std::uint8_t o = 0u; o < 8u; ++o)
+            if (node->octants[o])
+                visitor(node->octants[o].get(), octant_voxel(voxel, o));
+    }
+
+    template <class Visitor>
+    void for_each_element(node_type node, Visitor&& visitor) const
+    {
+        for (auto const& e : node->elements)
+            visitor(e, point_view(e));
+    }
+};
+
+/**
+ * @brief
+ * Range query over the nodes of an octree. Elements of nodes overlapping
+ * the range are tested individually, while subtrees contained in the range
+ * are reported as a whole.
+ * @tparam Storage Type of the storage adapter
+ * @tparam AABB Type of axis-aligned bounding box used for voxels
+ * @tparam Range Type satisfying Range concept
+ * @tparam ElementVisitor Callable type taking an element
+ * @tparam SubtreeVisitor Callable type taking a Storage::node_type
+ * @param storage The octree's storage adapter
+ * @param root The root node
+ * @param root_voxel The root voxel
+ * @param range The queried range
+ * @param visit_element Callback on the elements found to be in the range
+ * @param visit_contained_subtree Callback on the subtrees contained in the range
+ */
+template <class Storage, class AABB, class Range, class ElementVisitor, class SubtreeVisitor>
+void query_range(
+    Storage const& storage,
+    typename Storage::node_type root,
+    AABB const& root_voxel,
+    Range const& range,
+    ElementVisitor& visit_element,
+    SubtreeVisitor const& visit_contained_subtree)
+{
+    using node_type = typename Storage::node_type;
+
+    auto const recurse = [&](auto const& self, node_type node, AABB const& voxel) -> void {
+        auto const overlap = intersections::classify(voxel, range);
+        if (overlap == intersections::overlap_t::disjoint)
+            return;
+
+        if (overlap == intersections::overlap_t::contained)
+        {
+            visit_contained_subtree(node);
+            return;
+        }
+
+        storage.for_each_element(node, [&](auto const& e, auto const& p) {
+            if (range.contains(p))
+                visit_element(e);
+        });
+        storage.for_each_child(node, voxel, [&](node_type child, AABB const& child_voxel) {
+            self(self, child, child_voxel);
+        });
+    };
+
+    recurse(recurse, root, root_voxel);
+}
+
+/**
+ * @brief
+ * Offers the elements of a node to the k best neighbours, skipping the
+ * elements at the target's position. The neighbours refer to the elements
+ * by address, unless the heap holds copies of the elements.
+ * @tparam Storage Type of the storage adapter
+ * @tparam TPointView Type satisfying PointView concept
+ * @tparam KBestHeap Type of k_best_heap_t
+ * @param storage The octree's storage adapter
+ * @param node The node
+ * @param target Position around which we want to find the k nearest neighbours
+ * @param k_best The k best neighbours found so far
+ * @param eps The error tolerance for floating point equality
+ */
+template <class Storage, class TPointView, class KBestHeap>
+void push_elements(
+    Storage const& storage,
+    typename Storage::node_type node,
+    TPointView const& target,
+    KBestHeap& k_best,
+    double const eps)
+{
+    using neighbour_value_type = typename KBestHeap::neighbour_type::value_type;
+
+    storage.for_each_element(node, [&](auto const& e, auto const& p) {
+        using coordinate_type = typename std::decay_t<decltype(p)>::coordinate_type;
+        if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+            return;
+
+        if constexpr (std::is_pointer_v<neighbour_value_type>)
+            k_best.push(std::addressof(e), common::squared_distance(target, p));
+        else
+            k_best.push(e, common::squared_distance(target, p));
+    });
+}
+
+/**
+ * @brief
+ * Depth-first KNN search. The children of a node are visited nearest
+ * first, so that the k-th nearest neighbour's distance shrinks as fast as
+ * possible and prunes the remaining children, without any heap of nodes.
+ * @tparam Storage Type of the storage adapter
+ * @tparam AABB Type of axis-aligned bounding box used for voxels
+ * @tparam TPointView Type satisfying PointView concept
+ * @tparam KBestHeap Type of k_best_heap_t
+ * @param storage The octree's storage adapter
+ * @param root The root node
+ * @param root_voxel The root voxel
+ * @param target Position around which we want to find the k nearest neighbours
+ * @param k_best The k best neighbours, which must be reset before the search
+ * @param eps The error tolerance for floating point equality
+ */
+template <class Storage, class AABB, class TPointView, class KBestHeap>
+void depth_first_knn_search(
+    Storage const& storage,
+    typename Storage::node_type root,
+    AABB const& root_voxel,
+    TPointView const& target,
+    KBestHeap& k_best,
+    double const eps)
+{
+    using node_type   = typename Storage::node_type;
+    using scalar_type = typename KBestHeap::neighbour_type::scalar_type;
+
+    struct child_t
+    {
+        scalar_type squared_distance;
+        node_type node;
+        AABB voxel;
+    };
+
+    auto const recurse = [&](auto const& self, node_type node, AABB const& voxel) -> void {
+        push_elements(storage, node, target, k_best, eps);
+
+        std::array<child_t, 8u> children{};
+        std::uint8_t n = 0u;
+        storage.for_each_child(node, voxel, [&](node_type child, AABB const& child_voxel) {
+            auto const d = common::squared_distance(target, child_voxel.nearest_point_from(target));
+            children[n]  = child_t{d, child, child_voxel};
+            ++n;
+        });
+        std::sort(children.begin(), children.begin() + n, [](child_t const& c1, child_t const& c2) {
+            return c1.squared_distance < c2.squared_distance;
+        });
+
+        for (std::uint8_t c = 0u; c < n; ++c)
+        {
+            if (children[c].squared_distance > k_best.bound())
+                break;
+
+            self(self, children[c].node, children[c].voxel);
+        }
+    };
+
+    recurse(recurse, root, root_voxel);
+}
+
+/**
+ * @brief Node waiting in the min-heap of a best-first KNN search
+ * @tparam Node Type of the storage adapter's node handles
+ * @tparam AABB Type of axis-aligned bounding box used for voxels
+ * @tparam Scalar Type of the squared distances
+ */
+template <class Node, class AABB, class Scalar>
+struct node_heap_node_t
+{
+    Node node;               ///< The node
+    AABB voxel;              ///< The node's voxel
+    Scalar squared_distance; ///< Squared distance from the target to the node's voxel
+};
+
+/**
+ * @brief
+ * Best-first KNN search. Nodes are visited in order of their distance to
+ * the target, so that only the nodes which may hold one of the k nearest
+ * neighbours are visited, at the cost of a heap of nodes.
+ * @tparam Storage Type of the storage adapter
+ * @tparam AABB Type of axis-aligned bounding box used for voxels
+ * @tparam TPointView Type satisfying PointView concept
+ * @tparam KBestHeap Type of k_best_heap_t
+ * @tparam Scalar Type of the squared distances
+ * @param storage The octree's storage adapter
+ * @param root The root node
+ * @param root_voxel The root voxel
+ * @param target Position around which we want to find the k nearest neighbours
+ * @param k_best The k best neighbours, which must be reset before the search
+ * @param heap Storage for the min-heap of nodes
+ * @param eps The error tolerance for floating point equality
+ */
+template <class Storage, class AABB, class TPointView, class KBestHeap, class Scalar>
+void best_first_knn_search(
+    Storage const& storage,
+    typename Storage::node_type root,
+    AABB const& root_voxel,
+    TPointView const& target,
+    KBestHeap& k_best,
+    std::vector<node_heap_node_t<typename Storage::node_type, AABB, Scalar>>& heap,
+    double const eps)
+{
+    using node_type      = typename Storage::node_type;
+    using heap_node_type = node_heap_node_t<node_type, AABB, Scalar>;
+
+    auto const greater = [](heap_node_type const& h1, heap_node_type const& h2) {
+        return h2.squared_distance < h1.squared_distance;
+    };
+
+    auto const distance_to = [&target](AABB const& voxel) {
+        return common::squared_distance(target, voxel.nearest_point_from(target));
+    };
+
+    heap.clear();
+    heap.push_back(heap_node_type{root, root_voxel, distance_to(root_voxel)});
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        auto const top = heap.back();
+        heap.pop_back();
+
+        if (top.squared_distance > k_best.bound())
+            break;
+
+        push_elements(storage, top.node, target, k_best, eps);
+        storage.for_each_child(top.node, top.voxel, [&](node_type child, AABB const& child_voxel) {
+            auto const d = distance_to(child_voxel);
+            if (d > k_best.bound())
+                return;
+
+            heap.push_back(heap_node_type{child, child_voxel, d});
+            std::push_heap(heap.begin(), heap.end(), greater);
+        });
+    }
+}
+
+} // namespace detail
+} // namespace octree
+} // namespace pcp
+
+#endif // PCP_OCTREE_DETAIL_OCTREE_TRAVERSAL_HPP
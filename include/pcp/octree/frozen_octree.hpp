@@ -0,0 +1,670 @@
+#ifndef PCP_OCTREE_FROZEN_OCTREE_HPP
+#define PCP_OCTREE_FROZEN_OCTREE_HPP
+
+/**
+ * @file
+ * @ingroup octree
+ */
+
+#include "linear_octree.hpp"
+#include "linked_octree_node.hpp"
+#include "pcp/common/intersections.hpp"
+#include "pcp/common/nearest_neighbours.hpp"
+#include "pcp/common/norm.hpp"
+#include "pcp/common/points/point.hpp"
+#include "pcp/common/vector3d_queries.hpp"
+#include "pcp/traits/property_map_traits.hpp"
+#include "pcp/traits/range_traits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace pcp {
+
+/**
+ * @ingroup frozen-octree
+ * @brief
+ * Node record of a frozen octree. Like in the linear octree, a node's
+ * subtree is the contiguous range of elements [first, first + count).
+ * Contrary to the linear octree, internal nodes also hold elements,
+ * which are the first bucket_size elements of their subtree's range.
+ */
+struct frozen_octree_node_t : linear_octree_node_t
+{
+    std::uint32_t bucket_size = 0u; ///< Number of elements held by this node itself
+};
+
+/**
+ * @ingroup frozen-octree
+ * @brief
+ * Immutable copy of a linked octree relaid out for read-only workloads.
+ * The linked octree's nodes are stored in one array in breadth-first
+ * order, so that the children of a node are contiguous, and its element
+ * buckets are stored in one array in depth-first order, so that every
+ * subtree is a contiguous range of elements. Voxels are not stored, they
+ * are recomputed from the root voxel during traversal.
+ *
+ * Frozen octrees are created by basic_linked_octree_t::freeze and keep the
+ * linked octree's structure, so they answer the same queries by visiting
+ * the same nodes, without chasing pointers to nodes scattered in memory.
+ *
+ * The coordinates of the elements can be cached in structure of arrays
+ * form, in the order of the elements, so that the buckets scanned by
+ * queries are read as contiguous arrays of coordinates. Elements can then
+ * be small handles, such as 32-bit indices into an external point cloud,
+ * without paying for the point view map's indirection on every test.
+ *
+ * @tparam Element Type of the octree's elements
+ * @tparam ParamsType Type containing the parameters of the frozen octree
+ */
+template <class Element, class ParamsType = octree_parameters_t<pcp::point_t>>
+class basic_frozen_octree_t
+{
+  public:
+    using element_type    = Element;              ///< Type of the elements stored by this octree
+    using elements_type   = std::vector<Element>; ///< Type of container storing the elements
+    using node_type       = frozen_octree_node_t; ///< Type of node record
+    using nodes_type      = std::vector<node_type>;         ///< Type of container of nodes
+    using params_type     = ParamsType;                     ///< Type of the octree's parameters
+    using aabb_type       = typename ParamsType::aabb_type; ///< Type of AABB used for voxels
+    using aabb_point_type = typename aabb_type::point_type; ///< Type of point used by the AABB
+    using const_iterator  = typename elements_type::const_iterator;
+    using iterator        = const_iterator; ///< Elements cannot be modified in place
+    using value_type      = element_type;
+    using reference       = value_type&;
+    using const_reference = value_type const&;
+    using pointer         = value_type*;
+    using const_pointer   = value_type const*;
+    using self_type       = basic_frozen_octree_t<element_type, params_type>;
+
+    /**
+     * @brief
+     * Reusable storage for KNN searches. Keeping one scratch object per thread
+     * lets repeated searches run without allocating.
+     */
+    struct knn_scratch_t
+    {
+        using scalar_type     = typename aabb_point_type::coordinate_type;
+        using neighbour_type  = neighbour_t<element_type const*, scalar_type>;
+        using neighbours_type = std::vector<neighbour_type>;
+
+        k_best_heap_t<element_type const*, scalar_type> k_best; ///< The k best elements
+    };
+
+    using knn_scratch_type = knn_scratch_t; ///< Reusable storage for KNN searches
+    using neighbour_type =
+        typename knn_scratch_type::neighbour_type; ///< (element, squared distance) pair
+    using coordinate_cache_type = std::array<
+        std::vector<typename knn_scratch_t::scalar_type>,
+        3u>; ///< Coordinates of the elements in structure of arrays form
+
+    /**
+     * @brief
+     * Copies the subtree rooted at a linked octree node. Nodes are numbered
+     * in breadth-first order, and each node's bucket is placed right before
+     * its children's subtrees.
+     * @tparam Allocator Type of allocator of the linked octree
+     * @param root The root of the copied subtree
+     */
+    template <class Allocator>
+    explicit basic_frozen_octree_t(
+        basic_linked_octree_node_t<Element, ParamsType, Allocator> const& root)
+        : voxel_grid_(root.voxel_grid()), elements_(), nodes_(), coordinate_cache_()
+    {
+        using linked_node_type = basic_linked_octree_node_t<Element, ParamsType, Allocator>;
+
+        std::vector<linked_node_type const*> sources{std::addressof(root)};
+        nodes_.push_back(node_type{});
+        for (std::size_t n = 0u; n < sources.size(); ++n)
+        {
+            auto const* source      = sources[n];
+            auto const first_child  = static_cast<std::uint32_t>(nodes_.size());
+            std::uint8_t child_mask = 0u;
+            nodes_[n].bucket_size   = static_cast<std::uint32_t>(source->elements_.size());
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+            {
+                auto const& octant = source->octants_[o];
+                if (!octant)
+                    continue;
+
+                node_type child{};
+                child.level = static_cast<std::uint8_t>(nodes_[n].level + 1u);
+                nodes_.push_back(child);
+                sources.push_back(octant.get());
+                child_mask |= static_cast<std::uint8_t>(1u << o);
+            }
+            nodes_[n].first_child = first_child;
+            nodes_[n].child_mask  = child_mask;
+        }
+
+        /*
+         * Children are numbered after their parent, so subtree sizes
+         * are accumulated by visiting the nodes in reverse order, and
+         * subtree ranges are then assigned from the root down.
+         */
+        for (std::size_t n = nodes_.size(); n-- > 0u;)
+        {
+            auto& node = nodes_[n];
+            node.count = node.bucket_size;
+            for (std::uint8_t c = 0u; c < node.num_children(); ++c)
+                node.count += nodes_[node.first_child + c].count;
+        }
+
+        elements_.resize(nodes_.front().count);
+        for (std::size_t n = 0u; n < nodes_.size(); ++n)
+        {
+            auto const& node   = nodes_[n];
+            auto const& bucket = sources[n]->elements_;
+            std::copy(
+                bucket.cbegin(),
+                bucket.cend(),
+                elements_.begin() + static_cast<std::ptrdiff_t>(node.first));
+
+            auto offset = node.first + node.bucket_size;
+            for (std::uint8_t c = 0u; c < node.num_children(); ++c)
+            {
+                auto& child = nodes_[node.first_child + c];
+                child.first = offset;
+                offset += child.count;
+            }
+        }
+    }
+
+    /**
+     * @brief
+     * Copies the subtree rooted at a linked octree node, and caches the
+     * coordinates of its elements
+     * @tparam Allocator Type of allocator of the linked octree
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param root The root of the copied subtree
+     * @param point_view The point view property map
+     */
+    template <class Allocator, class PointViewMap>
+    basic_frozen_octree_t(
+        basic_linked_octree_node_t<Element, ParamsType, Allocator> const& root,
+        PointViewMap const& point_view)
+        : basic_frozen_octree_t(root)
+    {
+        cache_coordinates(point_view);
+    }
+
+    /**
+     * @brief
+     * Caches the coordinates of the elements in structure of arrays form.
+     * Queries then read the cached coordinates instead of calling their
+     * point view map, which must agree with the one given here.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void cache_coordinates(PointViewMap const& point_view)
+    {
+        for (auto& coordinates : coordinate_cache_)
+        {
+            coordinates.clear();
+            coordinates.reserve(elements_.size());
+        }
+
+        for (auto const& e : elements_)
+        {
+            auto const p = point_view(e);
+            coordinate_cache_[0].push_back(p.x());
+            coordinate_cache_[1].push_back(p.y());
+            coordinate_cache_[2].push_back(p.z());
+        }
+    }
+
+    /**
+     * @brief Checks if the coordinates of the elements are cached
+     * @return True if the coordinates of the elements are cached
+     */
+    bool has_coordinate_cache() const
+    {
+        return !elements_.empty() && coordinate_cache_[0].size() == elements_.size();
+    }
+
+    /**
+     * @brief The cached x, y and z coordinates of the elements in depth-first order
+     * @return The cached coordinates
+     */
+    coordinate_cache_type const& coordinate_cache() const { return coordinate_cache_; }
+
+    /**
+     * @brief Number of elements in the octree
+     * @return Number of elements in the octree
+     */
+    std::size_t size() const { return elements_.size(); }
+
+    /**
+     * @brief Checks if octree is empty
+     * @return True if octree is empty
+     */
+    bool empty() const { return size() == 0u; }
+
+    /**
+     * @brief Gets the top-level voxel from this octree (the bounding box)
+     * @return This octree's root voxel
+     */
+    aabb_type const& voxel_grid() const { return voxel_grid_; }
+
+    /**
+     * @brief The octree's node records in breadth-first order, the root being the first node
+     * @return The octree's nodes
+     */
+    nodes_type const& nodes() const { return nodes_; }
+
+    /**
+     * @brief Iterator to the first element of this octree in depth-first order
+     * @return Iterator to the first element of this octree
+     */
+    iterator begin() const { return elements_.cbegin(); }
+
+    /**
+     * @brief End iterator to this octree's elements
+     * @return End iterator to this octree's elements
+     */
+    iterator end() const { return elements_.cend(); }
+
+    /**
+     * @brief Const iterator to the first element of this octree in depth-first order
+     * @return Const iterator to the first element of this octree
+     */
+    const_iterator cbegin() const { return elements_.cbegin(); }
+
+    /**
+     * @brief End const iterator to this octree's elements
+     * @return End const iterator to this octree's elements
+     */
+    const_iterator cend() const { return elements_.cend(); }
+
+    /*
+     * Returns an iterator to the point p in the octree if it exists.
+     *
+     * @param e Element to search for in the octree
+     * @param point_view The PointViewMap property map
+     * @return iterator to the found element in the octree, or end iterator if it was not found
+     */
+    template <class PointViewMap>
+    const_iterator find(element_type const& e, PointViewMap const& point_view) const
+    {
+        auto const p = point_view(e);
+        if (!voxel_grid_.contains(p))
+            return cend();
+
+        auto const is_equal = [&](element_type const& other) {
+            return common::are_vectors_equal(p, point_view(other));
+        };
+
+        /*
+         * Same descent as the linked octree's find, where
+         * the element can be held by any node along the path.
+         */
+        node_type const* node = std::addressof(nodes_.front());
+        aabb_type voxel       = voxel_grid_;
+        while (true)
+        {
+            auto const bucket_begin = cbegin() + node->first;
+            auto const bucket_end   = bucket_begin + node->bucket_size;
+            auto const it           = std::find_if(bucket_begin, bucket_end, is_equal);
+            if (it != bucket_end)
+                return it;
+
+            auto const center   = voxel.center();
+            std::uint8_t octant = 0b000;
+            if (p.x() > center.x())
+                octant |= 0b100;
+            if (p.y() > center.y())
+                octant |= 0b010;
+            if (p.z() > center.z())
+                octant |= 0b001;
+
+            if (!node->has_child(octant))
+                return cend();
+
+            voxel = octant_voxel(voxel, octant);
+            node  = std::addressof(nodes_[node->child(octant)]);
+        }
+    }
+
+    /*
+     * Returns the k-nearest-neighbours in 3d Euclidean space
+     * using the l2-norm as the notion of distance.
+     * The implementation is a best-first search over the octants.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * for all points of the octree
+     * @param point_view The PointViewMap property map
+     * @param eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        double eps = 1e-5) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+
+        std::vector<element_type> knearest_points{};
+        knearest_points.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_points.push_back(*neighbour.element);
+
+        return knearest_points;
+    }
+
+    /*
+     * Writes the k-nearest-neighbours in 3d Euclidean space to out as
+     * (element, squared distance) pairs, ordered from nearest to furthest.
+     * Storage for the search is taken from scratch, which should be reused
+     * across queries (one per thread) to avoid allocating.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * @param point_view The PointViewMap property map
+     * @param scratch The reusable search storage
+     * @param out Output iterator to neighbour_type values
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_type& scratch,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /*
+     * Returns all points that reside in the given range.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return A list of all points that reside in the given range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type> range_search(Range const& range, PointViewMap const& point_view) const
+    {
+        std::vector<element_type> elements_in_range;
+        range_search(range, point_view, std::back_inserter(elements_in_range));
+        return elements_in_range;
+    }
+
+    /*
+     * Writes all points that reside in the given range to out.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param out Output iterator to the elements in range
+     * @return Output iterator past the last written element
+     */
+    template <class Range, class PointViewMap, class OutputIter>
+    OutputIter
+    range_search(Range const& range, PointViewMap const& point_view, OutputIter out) const
+    {
+        auto const visit_element = [&out](element_type const& e) {
+            *out++ = e;
+        };
+        auto const visit_contained_subtree = [&](node_type const& node) {
+            out = std::copy(cbegin() + node.first, cbegin() + node.first + node.count, out);
+        };
+        query_range(range, point_view, visit_element, visit_contained_subtree);
+        return out;
+    }
+
+    /*
+     * Calls visitor on all points that reside in the given range,
+     * without storing them.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void visit_range(Range const& range, PointViewMap const& point_view, Visitor&& visitor) const
+    {
+        auto const visit_contained_subtree = [&](node_type const& node) {
+            std::for_each(cbegin() + node.first, cbegin() + node.first + node.count, visitor);
+        };
+        query_range(range, point_view, visitor, visit_contained_subtree);
+    }
+
+    /*
+     * Counts the points that reside in the given range. Subtrees
+     * lying entirely inside the range are counted without visiting
+     * their points.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return Number of points in the range
+     */
+    template <class Range, class PointViewMap>
+    std::size_t range_count(Range const& range, PointViewMap const& point_view) const
+    {
+        std::size_t count        = 0u;
+        auto const count_element = [&count](element_type const&) {
+            ++count;
+        };
+        auto const count_contained_subtree = [&count](node_type const& node) {
+            count += node.count;
+        };
+        query_range(range, point_view, count_element, count_contained_subtree);
+        return count;
+    }
+
+  private:
+    static aabb_type octant_voxel(aabb_type const& voxel, std::uint8_t octant)
+    {
+        return basic_linear_octree_t<Element, ParamsType>::octant_voxel(voxel, octant);
+    }
+
+    /**
+     * @brief
+     * Range query implementation shared by the range searches and range counts.
+     * Elements of nodes overlapping the range are tested individually, while
+     * subtrees contained in the range are reported as a whole.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam ElementVisitor Callable type taking an element_type const&
+     * @tparam SubtreeVisitor Callable type taking a node_type const&
+     * @param range The queried range
+     * @param point_view The point view property map
+     * @param visit_element Callback on the elements found to be in the range
+     * @param visit_contained_subtree Callback on the subtrees contained in the range
+     */
+    template <class Range, class PointViewMap, class ElementVisitor, class SubtreeVisitor>
+    void query_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        ElementVisitor& visit_element,
+        SubtreeVisitor const& visit_contained_subtree) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+
+        auto const recurse = [&](auto const& self, node_type const& node, aabb_type const& voxel) {
+            auto const overlap = intersections::classify(voxel, range);
+            if (overlap == intersections::overlap_t::disjoint)
+                return;
+
+            if (overlap == intersections::overlap_t::contained)
+            {
+                visit_contained_subtree(node);
+                return;
+            }
+
+            auto const bucket_end = node.first + node.bucket_size;
+            if (has_coordinate_cache())
+            {
+                for (auto i = node.first; i < bucket_end; ++i)
+                {
+                    aabb_point_type const p{
+                        coordinate_cache_[0][i],
+                        coordinate_cache_[1][i],
+                        coordinate_cache_[2][i]};
+                    if (range.contains(p))
+                        visit_element(elements_[i]);
+                }
+            }
+            else
+            {
+                for (auto i = node.first; i < bucket_end; ++i)
+                    if (range.contains(point_view(elements_[i])))
+                        visit_element(elements_[i]);
+            }
+
+            auto c = node.first_child;
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+                if (node.has_child(o))
+                    self(self, nodes_[c++], octant_voxel(voxel, o));
+        };
+
+        recurse(recurse, nodes_.front(), voxel_grid_);
+    }
+
+    /**
+     * @brief
+     * Depth-first KNN search implementation. The children of a node are
+     * visited nearest first, so that the k-th nearest neighbour's distance
+     * shrinks as fast as possible and prunes the remaining children. Since
+     * the children of a node are contiguous, this needs no heap of octants.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param scratch Storage for the search's heap
+     * @param eps The error tolerance for floating point equality
+     * @return The neighbours sorted from nearest to furthest, stored in scratch
+     */
+    template <class TPointView, class PointViewMap>
+    typename knn_scratch_t::neighbours_type const& knn_search(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_t& scratch,
+        double const eps) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+        using coordinate_type = typename point_view_type::coordinate_type;
+        using scalar_type     = typename knn_scratch_t::scalar_type;
+
+        auto& k_best = scratch.k_best;
+        k_best.reset(k);
+
+        if (k <= 0u || empty())
+            return k_best.sort();
+
+        bool const is_cached = has_coordinate_cache();
+        auto const& xs       = coordinate_cache_[0];
+        auto const& ys       = coordinate_cache_[1];
+        auto const& zs       = coordinate_cache_[2];
+        auto const tx        = static_cast<scalar_type>(target.x());
+        auto const ty        = static_cast<scalar_type>(target.y());
+        auto const tz        = static_cast<scalar_type>(target.z());
+        auto const seps      = static_cast<scalar_type>(eps);
+
+        auto const recurse = [&](auto const& self,
+                                 node_type const& node,
+                                 aabb_type const& voxel) -> void {
+            auto const bucket_end = node.first + node.bucket_size;
+            if (is_cached)
+            {
+                /*
+                 * The bucket's cached coordinates are contiguous
+                 * in each of the x, y and z arrays.
+                 */
+                for (auto i = node.first; i < bucket_end; ++i)
+                {
+                    auto const dx = xs[i] - tx;
+                    auto const dy = ys[i] - ty;
+                    auto const dz = zs[i] - tz;
+                    if (common::floating_point_equals(xs[i], tx, seps) &&
+                        common::floating_point_equals(ys[i], ty, seps) &&
+                        common::floating_point_equals(zs[i], tz, seps))
+                        continue;
+
+                    k_best.push(std::addressof(elements_[i]), dx * dx + dy * dy + dz * dz);
+                }
+            }
+            else
+            {
+                for (auto i = node.first; i < bucket_end; ++i)
+                {
+                    auto const& e = elements_[i];
+                    auto const p  = point_view(e);
+                    if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+                        continue;
+
+                    k_best.push(std::addressof(e), common::squared_distance(target, p));
+                }
+            }
+
+            struct child_t
+            {
+                scalar_type squared_distance;
+                std::uint32_t index;
+                aabb_type voxel;
+            };
+            std::array<child_t, 8u> children{};
+            std::uint8_t n = 0u;
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+            {
+                if (!node.has_child(o))
+                    continue;
+
+                auto const child_voxel = octant_voxel(voxel, o);
+                auto const d =
+                    common::squared_distance(target, child_voxel.nearest_point_from(target));
+                children[n] = child_t{d, node.first_child + n, child_voxel};
+                ++n;
+            }
+            std::sort(
+                children.begin(),
+                children.begin() + n,
+                [](child_t const& c1, child_t const& c2) {
+                    return c1.squared_distance < c2.squared_distance;
+                });
+
+            for (std::uint8_t c = 0u; c < n; ++c)
+            {
+                if (children[c].squared_distance > k_best.bound())
+                    break;
+
+                self(self, nodes_[children[c].index], children[c].voxel);
+            }
+        };
+
+        recurse(recurse, nodes_.front(), voxel_grid_);
+        return k_best.sort();
+    }
+
+    aabb_type voxel_grid_;                   ///< The root voxel
+    elements_type elements_;                 ///< The nodes' buckets in depth-first order
+    nodes_type nodes_;                       ///< The node records in breadth-first order
+    coordinate_cache_type coordinate_cache_; ///< Coordinates of the elements, if cached
+};
+
+using frozen_octree_t = pcp::basic_frozen_octree_t<pcp::point_t>;
+
+} // namespace pcp
+
+#endif // PCP_OCTREE_FROZEN_OCTREE_HPP
@@ -0,0 +1,578 @@
+#ifndef PCP_OCTREE_LINEAR_OCTREE_HPP
+#define PCP_OCTREE_LINEAR_OCTREE_HPP
+
+/**
+ * @file
+ * @ingroup octree
+ */
+
+#include "linked_octree_node.hpp"
+#include "pcp/common/intersections.hpp"
+#include "pcp/common/norm.hpp"
+#include "pcp/common/points/point.hpp"
+#include "pcp/common/vector3d_queries.hpp"
+#include "pcp/traits/property_map_traits.hpp"
+#include "pcp/traits/range_traits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <range/v3/view/subrange.hpp>
+#include <range/v3/view/transform.hpp>
+#include <utility>
+#include <vector>
+
+namespace pcp {
+
+/**
+ * @ingroup linear-octree
+ * @brief
+ * Compact node record of a linear octree. Nodes do not own any
+ * memory, they only refer to a contiguous range of the octree's
+ * Morton-sorted elements and to a contiguous range of the octree's
+ * nodes for their children. Nodes store neither their voxel nor their
+ * Morton code, the voxel of a child is derived during traversal from
+ * its parent's voxel and the child's octant, and the non-empty octants
+ * of a node are given by its 8-bit child mask, so that a node record
+ * fits in 16 bytes.
+ */
+struct linear_octree_node_t
+{
+    std::uint32_t first       = 0u; ///< Index of the first element of this node's subtree
+    std::uint32_t count       = 0u; ///< Number of elements in this node's subtree
+    std::uint32_t first_child = 0u; ///< Index of this node's first child in the node array
+    std::uint8_t child_mask   = 0u; ///< Bit o is set if octant o of this node is non-empty
+    std::uint8_t level        = 0u; ///< Depth of the node in the octree (root is 0)
+
+    /**
+     * @brief Checks if this node has no children
+     * @return True if this node is a leaf
+     */
+    bool is_leaf() const { return child_mask == 0u; }
+
+    /**
+     * @brief Checks if the given octant of this node is non-empty
+     * @param octant The octant index in [0, 8) using the xyz bit order
+     * @return True if this node has a child in the given octant
+     */
+    bool has_child(std::uint8_t octant) const { return (child_mask >> octant) & 1u; }
+
+    /**
+     * @brief Number of non-empty children of this node
+     * @return Number of children of this node
+     */
+    std::uint8_t num_children() const { return popcount(child_mask); }
+
+    /**
+     * @brief
+     * Index of the child in the given octant in the node array. Children
+     * are stored contiguously in octant order, so the child's offset from
+     * the first child is the number of non-empty octants preceding it.
+     * @param octant The octant index in [0, 8), must satisfy has_child(octant)
+     * @return The child's index in the node array
+     */
+    std::uint32_t child(std::uint8_t octant) const
+    {
+        assert(has_child(octant));
+        auto const preceding = static_cast<std::uint8_t>(child_mask & ((1u << octant) - 1u));
+        return first_child + popcount(preceding);
+    }
+
+  private:
+    static std::uint8_t popcount(std::uint8_t mask)
+    {
+        mask = static_cast<std::uint8_t>(mask - ((mask >> 1u) & 0x55u));
+        mask = static_cast<std::uint8_t>((mask & 0x33u) + ((mask >> 2u) & 0x33u));
+        return static_cast<std::uint8_t>((mask + (mask >> 4u)) & 0x0fu);
+    }
+};
+
+static_assert(sizeof(linear_octree_node_t) == 16u, "Linear octree nodes should be 16 bytes");
+
+/**
+ * @ingroup linear-octree
+ * @brief
+ * A pointerless octree which stores its elements sorted by Morton code
+ * (Z-order) in one contiguous array, and its nodes as compact records
+ * in another contiguous array. Children of a node are stored contiguously
+ * in breadth-first order, and a node's subtree corresponds to a contiguous
+ * range of elements. Voxels are not stored, they are recomputed from the
+ * root voxel during traversal.
+ *
+ * Contrary to the linked octree, elements are only stored in leaf nodes,
+ * and the octree is static. It is built once from a range of elements and
+ * offers the same query and iteration interface as basic_linked_octree_t,
+ * so that it can be swapped in for read-only workloads.
+ *
+ * Octants are labeled with the same xyz bit order as in the linked octree,
+ * so that the octant path of a node is its Morton code.
+ *
+ * @tparam Element Type of the octree's elements
+ * @tparam ParamsType Type containing the parameters for this octree
+ */
+template <class Element, class ParamsType = octree_parameters_t<pcp::point_t>>
+class basic_linear_octree_t
+{
+  public:
+    using element_type    = Element;              ///< Type of the elements stored by this octree
+    using elements_type   = std::vector<Element>; ///< Type of container storing the elements
+    using node_type       = linear_octree_node_t; ///< Type of node record
+    using nodes_type      = std::vector<node_type>;           ///< Type of container of nodes
+    using params_type     = ParamsType;                       ///< Type of the octree's parameters
+    using aabb_type       = typename ParamsType::aabb_type;   ///< Type of AABB used for voxels
+    using aabb_point_type = typename aabb_type::point_type;   ///< Type of point used by the AABB
+    using const_iterator  = typename elements_type::const_iterator;
+    using iterator        = const_iterator; ///< Elements cannot be modified in place
+    using value_type      = element_type;
+    using reference       = value_type&;
+    using const_reference = value_type const&;
+    using pointer         = value_type*;
+    using const_pointer   = value_type const*;
+    using self_type       = basic_linear_octree_t<element_type, params_type>;
+
+    /**
+     * @brief Maximum depth supported by 64-bit Morton codes
+     */
+    static constexpr std::uint8_t max_supported_depth = 21u;
+
+    /**
+     * @brief
+     * Constructs this octree from a range of elements
+     * @tparam ForwardIter Type of iterator to the elements
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param begin Begin iterator to the elements
+     * @param end End iterator to the elements
+     * @param point_view The point view property map
+     * @param params The configuration for this octree
+     */
+    template <class ForwardIter, class PointViewMap>
+    explicit basic_linear_octree_t(
+        ForwardIter begin,
+        ForwardIter end,
+        PointViewMap const& point_view,
+        params_type const& params)
+        : capacity_(params.node_capacity),
+          max_depth_(std::min(params.max_depth, max_supported_depth)),
+          voxel_grid_(params.voxel_grid),
+          elements_(),
+          nodes_()
+    {
+        build(begin, end, point_view);
+    }
+
+    /**
+     * @brief
+     * Constructs this octree from a range of elements.
+     * Computes the octree's configuration automatically.
+     * @tparam ForwardIter Type of iterator to the elements
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param begin Begin iterator to the elements
+     * @param end End iterator to the elements
+     * @param point_view The point view property map
+     */
+    template <class ForwardIter, class PointViewMap>
+    explicit basic_linear_octree_t(
+        ForwardIter begin,
+        ForwardIter end,
+        PointViewMap const& point_view)
+        : capacity_{}, max_depth_{}, voxel_grid_{}, elements_(), nodes_()
+    {
+        params_type params;
+        auto const projection = [&](element_type const& e) {
+            return point_view(e);
+        };
+        auto rng = ranges::make_subrange(begin, end) | ranges::views::transform(projection);
+        using rng_iter_type = decltype(rng.begin());
+        voxel_grid_ =
+            pcp::bounding_box<rng_iter_type, aabb_point_type, aabb_type>(rng.begin(), rng.end());
+        capacity_  = params.node_capacity;
+        max_depth_ = std::min(params.max_depth, max_supported_depth);
+        build(begin, end, point_view);
+    }
+
+    /**
+     * @brief Number of elements in the octree
+     * @return Number of elements in the octree
+     */
+    std::size_t size() const { return elements_.size(); }
+
+    /**
+     * @brief Checks if octree is empty
+     * @return True if octree is empty
+     */
+    bool empty() const { return size() == 0u; }
+
+    /**
+     * @brief Remove all elements from this octree
+     */
+    void clear()
+    {
+        elements_.clear();
+        nodes_.clear();
+        nodes_.push_back(node_type{});
+    }
+
+    /**
+     * @brief Gets the top-level voxel from this octree (the bounding box)
+     * @return This octree's root voxel
+     */
+    aabb_type const& voxel_grid() const { return voxel_grid_; }
+
+    /**
+     * @brief The octree's node records in breadth-first order, the root being the first node
+     * @return The octree's nodes
+     */
+    nodes_type const& nodes() const { return nodes_; }
+
+    /**
+     * @brief Iterator to the first element of this octree in Morton order
+     * @return Iterator to the first element of this octree
+     */
+    iterator begin() const { return elements_.cbegin(); }
+
+    /**
+     * @brief End iterator to this octree's elements
+     * @return End iterator to this octree's elements
+     */
+    iterator end() const { return elements_.cend(); }
+
+    /**
+     * @brief Const iterator to the first element of this octree in Morton order
+     * @return Const iterator to the first element of this octree
+     */
+    const_iterator cbegin() const { return elements_.cbegin(); }
+
+    /**
+     * @brief End const iterator to this octree's elements
+     * @return End const iterator to this octree's elements
+     */
+    const_iterator cend() const { return elements_.cend(); }
+
+    /**
+     * @brief Computes the voxel of a child octant of a voxel
+     * @param voxel The parent voxel
+     * @param octant The octant index in [0, 8) using the xyz bit order
+     * @return The child's voxel
+     */
+    static aabb_type octant_voxel(aabb_type const& voxel, std::uint8_t octant)
+    {
+        auto const center = voxel.center();
+        aabb_type child{};
+        child.min.x(octant & 0b100 ? center.x() : voxel.min.x());
+        child.max.x(octant & 0b100 ? voxel.max.x() : center.x());
+
+        child.min.y(octant & 0b010 ? center.y() : voxel.min.y());
+        child.max.y(octant & 0b010 ? voxel.max.y() : center.y());
+
+        child.min.z(octant & 0b001 ? center.z() : voxel.min.z());
+        child.max.z(octant & 0b001 ? voxel.max.z() : center.z());
+        return child;
+    }
+
+    /*
+     * Returns the k-nearest-neighbours in 3d Euclidean space
+     * using the l2-norm as the notion of distance.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * for all points of the octree
+     * @param point_view The PointViewMap property map
+     * @param eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        double eps = 1e-5) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+        using coordinate_type = typename point_view_type::coordinate_type;
+        using candidate_type  = std::pair<coordinate_type, std::uint32_t>;
+
+        if (k == 0u || empty())
+            return {};
+
+        /*
+         * Max heap of the current best candidates, the top being the
+         * furthest candidate. We store element indices so that the
+         * distances are computed only once per element.
+         */
+        std::priority_queue<candidate_type> max_heap;
+
+        auto const visit_leaf = [&](node_type const& node) {
+            auto const last = node.first + node.count;
+            for (auto i = node.first; i < last; ++i)
+            {
+                auto const p = point_view(elements_[i]);
+                if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+                    continue;
+
+                auto const d = common::squared_distance(p, target);
+                if (max_heap.size() < k)
+                {
+                    max_heap.push(candidate_type{d, i});
+                    continue;
+                }
+                if (d < max_heap.top().first)
+                {
+                    max_heap.pop();
+                    max_heap.push(candidate_type{d, i});
+                }
+            }
+        };
+
+        auto const recurse = [&](auto const& self, node_type const& node, aabb_type const& voxel) {
+            if (node.is_leaf())
+            {
+                visit_leaf(node);
+                return;
+            }
+
+            /*
+             * Visit children nearest first, so that the current k-th
+             * distance shrinks as fast as possible and prunes the
+             * remaining children.
+             */
+            struct child_t
+            {
+                coordinate_type squared_distance;
+                std::uint32_t index;
+                aabb_type voxel;
+            };
+            std::array<child_t, 8u> children{};
+            std::uint8_t n = 0u;
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+            {
+                if (!node.has_child(o))
+                    continue;
+
+                auto const child_voxel   = octant_voxel(voxel, o);
+                auto const nearest_point = child_voxel.nearest_point_from(target);
+                children[n]              = child_t{
+                    common::squared_distance(nearest_point, target),
+                    node.first_child + n,
+                    child_voxel};
+                ++n;
+            }
+            std::sort(
+                children.begin(),
+                children.begin() + n,
+                [](child_t const& c1, child_t const& c2) {
+                    return c1.squared_distance < c2.squared_distance;
+                });
+
+            for (std::uint8_t c = 0u; c < n; ++c)
+            {
+                bool const should_visit =
+                    max_heap.size() < k || children[c].squared_distance < max_heap.top().first;
+                if (!should_visit)
+                    break;
+
+                self(self, nodes_[children[c].index], children[c].voxel);
+            }
+        };
+
+        recurse(recurse, nodes_.front(), voxel_grid_);
+
+        std::vector<element_type> knearest_points(max_heap.size());
+        for (auto it = knearest_points.rbegin(); it != knearest_points.rend(); ++it)
+        {
+            *it = elements_[max_heap.top().second];
+            max_heap.pop();
+        }
+        return knearest_points;
+    }
+
+    /*
+     * Returns all points that reside in the given range.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return A list of all points that reside in the given range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type> range_search(Range const& range, PointViewMap const& point_view) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+
+        std::vector<element_type> elements_in_range;
+        if (empty())
+            return elements_in_range;
+
+        auto const recurse = [&](auto const& self, node_type const& node, aabb_type const& voxel) {
+            auto const overlap = intersections::classify(voxel, range);
+
+            /*
+             * If the queried range does not even intersect this
+             * octant, then no element of this octant's contiguous
+             * range of elements can be in the queried range.
+             */
+            if (overlap == intersections::overlap_t::disjoint)
+                return;
+
+            auto const last = node.first + node.count;
+
+            /*
+             * If this octant lies entirely inside the queried range,
+             * its whole contiguous range of elements is in the range.
+             */
+            if (overlap == intersections::overlap_t::contained)
+            {
+                elements_in_range.insert(
+                    elements_in_range.end(),
+                    elements_.begin() + node.first,
+                    elements_.begin() + last);
+                return;
+            }
+
+            if (node.is_leaf())
+            {
+                for (auto i = node.first; i < last; ++i)
+                    if (range.contains(point_view(elements_[i])))
+                        elements_in_range.push_back(elements_[i]);
+                return;
+            }
+
+            auto c = node.first_child;
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+                if (node.has_child(o))
+                    self(self, nodes_[c++], octant_voxel(voxel, o));
+        };
+
+        recurse(recurse, nodes_.front(), voxel_grid_);
+        return elements_in_range;
+    }
+
+  private:
+    /**
+     * @brief
+     * Sorts the elements in Morton order by recursively partitioning them
+     * into octants, and creates the node records in breadth-first order.
+     * @tparam ForwardIter Type of iterator to the elements
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param begin Begin iterator to the elements
+     * @param end End iterator to the elements
+     * @param point_view The point view property map
+     */
+    template <class ForwardIter, class PointViewMap>
+    void build(ForwardIter begin, ForwardIter end, PointViewMap const& point_view)
+    {
+        assert(capacity_ > 0u);
+        assert(max_depth_ > 0u);
+
+        /*
+         * Elements outside of the root voxel are not inserted,
+         * just like in the linked octree.
+         */
+        std::copy_if(begin, end, std::back_inserter(elements_), [&](element_type const& e) {
+            return voxel_grid_.contains(point_view(e));
+        });
+        assert(elements_.size() <= std::numeric_limits<std::uint32_t>::max());
+
+        node_type root{};
+        root.count = static_cast<std::uint32_t>(elements_.size());
+        nodes_.push_back(root);
+
+        /*
+         * Voxels are only needed during construction, they are
+         * recomputed from the root voxel during queries.
+         */
+        std::vector<aabb_type> voxels{voxel_grid_};
+        elements_type buffer(elements_.size());
+        std::vector<std::uint8_t> octants(elements_.size());
+
+        /*
+         * Nodes are processed in breadth-first order, and the children
+         * of a node are appended to the node array contiguously. Each
+         * node's range of elements is stably partitioned into its 8
+         * octants, which is exactly one step of a most significant
+         * digit radix sort on Morton codes.
+         */
+        for (std::size_t n = 0u; n < nodes_.size(); ++n)
+        {
+            node_type const node = nodes_[n];
+            bool const can_subdivide =
+                node.count > capacity_ && static_cast<std::uint8_t>(node.level + 1u) < max_depth_;
+            if (!can_subdivide)
+                continue;
+
+            aabb_type const voxel = voxels[n];
+            auto const center     = voxel.center();
+            auto const first      = node.first;
+            auto const last       = node.first + node.count;
+
+            std::array<std::uint32_t, 8u> counts{};
+            for (auto i = first; i < last; ++i)
+            {
+                auto const p        = point_view(elements_[i]);
+                std::uint8_t octant = 0b000;
+                if (p.x() > center.x())
+                    octant |= 0b100;
+                if (p.y() > center.y())
+                    octant |= 0b010;
+                if (p.z() > center.z())
+                    octant |= 0b001;
+                octants[i] = octant;
+                ++counts[octant];
+            }
+
+            std::array<std::uint32_t, 8u> offsets{};
+            std::uint32_t offset = first;
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+            {
+                offsets[o] = offset;
+                offset += counts[o];
+            }
+
+            auto cursor = offsets;
+            for (auto i = first; i < last; ++i)
+                buffer[cursor[octants[i]]++] = elements_[i];
+            std::copy(
+                buffer.begin() + static_cast<std::ptrdiff_t>(first),
+                buffer.begin() + static_cast<std::ptrdiff_t>(last),
+                elements_.begin() + static_cast<std::ptrdiff_t>(first));
+
+            auto const first_child  = static_cast<std::uint32_t>(nodes_.size());
+            std::uint8_t child_mask = 0u;
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+            {
+                if (counts[o] == 0u)
+                    continue;
+
+                node_type child{};
+                child.first = offsets[o];
+                child.count = counts[o];
+                child.level = static_cast<std::uint8_t>(node.level + 1u);
+                nodes_.push_back(child);
+                voxels.push_back(octant_voxel(voxel, o));
+                child_mask |= static_cast<std::uint8_t>(1u << o);
+            }
+
+            nodes_[n].first_child = first_child;
+            nodes_[n].child_mask  = child_mask;
+        }
+    }
+
+    std::uint32_t capacity_; ///< Maximum number of elements in a leaf (unless at max depth)
+    std::uint8_t max_depth_; ///< Maximum depth of the octree
+    aabb_type voxel_grid_;   ///< The root voxel
+    elements_type elements_; ///< The elements sorted in Morton order
+    nodes_type nodes_;       ///< The node records in breadth-first order
+};
+
+using linear_octree_t = pcp::basic_linear_octree_t<pcp::point_t>;
+
+} // namespace pcp
+
+#endif // PCP_OCTREE_LINEAR_OCTREE_HPP
@@ -6,12 +6,16 @@
  * @ingroup octree
  */
 
+#include "frozen_octree.hpp"
 #include "linked_octree_node.hpp"
 #include "pcp/algorithm/common.hpp"
 #include "pcp/common/points/point.hpp"
 #include "pcp/traits/property_map_traits.hpp"
 #include "pcp/traits/range_traits.hpp"
 
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <range/v3/view/subrange.hpp>
 #include <range/v3/view/transform.hpp>
 
@@ -34,41 +38,89 @@ namespace pcp {
  * a linked tree structure. The octree is also dynamic, so erasing
  * points from the octree is possible.
  *
+ * Nodes and their elements are allocated with Allocator, so a
+ * node_pool_allocator_t can be used to take the construction and
+ * destruction of large octrees off the global heap.
+ *
+ * Concurrent ingestion is supported by concurrent_insert, which
+ * locks nodes individually through a fixed-size table of locks,
+ * while concurrent_visit_range and concurrent_range_search read
+ * the octree. The lock table is allocated by the first of these
+ * calls, so octrees which are never used concurrently do not pay
+ * for it. Other operations are not thread-safe.
+ *
+ * With lazy_octree_parameters_t, insertion appends elements to the root
+ * without subdividing it, and nodes are subdivided by the first query
+ * visiting them, so that only the queried regions pay for subdivision.
+ * Queries may then move elements from a node to its children, which
+ * invalidates iterators, but they can still run concurrently.
+ *
  * @tparam Element Type of the octree's elements
  * @tparam ParamsType Type containing the parameters for this octree
+ * @tparam Allocator Type of allocator used for the octree's nodes and elements
  */
-template <class Element, class ParamsType = octree_parameters_t<pcp::point_t>>
+template <
+    class Element,
+    class ParamsType = octree_parameters_t<pcp::point_t>,
+    class Allocator  = std::allocator<Element>>
 class basic_linked_octree_t
 {
   public:
     using element_type = Element; ///< Type of the elements stored by this octree
     using octree_node_type =
-        basic_linked_octree_node_t<Element, ParamsType>; ///< Type of node stored
-    using params_type = ParamsType;                      ///< Type of the octree's parameters
-    using aabb_type   = typename ParamsType::aabb_type;  ///< Type of AABB used to represent voxels
+        basic_linked_octree_node_t<Element, ParamsType, Allocator>; ///< Type of node stored
+    using params_type    = ParamsType; ///< Type of the octree's parameters
+    using allocator_type = Allocator;  ///< Type of allocator used by the octree
+    using aabb_type = typename ParamsType::aabb_type; ///< Type of AABB used to represent voxels
     using aabb_point_type = typename aabb_type::point_type; ///< Type of point used by the AABB
     using iterator =
-        linked_octree_iterator_t<Element, ParamsType>; ///< iterator type of this octree
+        linked_octree_iterator_t<Element, ParamsType, Allocator>; ///< iterator type of this octree
     using const_iterator  = iterator const;
+    using bucket_iterator = linked_octree_bucket_iterator_t<
+        Element,
+        ParamsType,
+        Allocator>; ///< Iterator over the octree's nodes' contiguous elements
     using value_type      = element_type;
     using reference       = value_type&;
     using const_reference = value_type const&;
     using pointer         = value_type*;
     using const_pointer   = value_type const*;
-    using self_type = basic_linked_octree_t<element_type, params_type>; ///< Type of this octree
+    using self_type =
+        basic_linked_octree_t<element_type, params_type, allocator_type>; ///< Type of this octree
+    using knn_scratch_type =
+        typename octree_node_type::knn_scratch_t; ///< Reusable storage for KNN searches
+    using neighbour_type =
+        typename knn_scratch_type::neighbour_type; ///< (element, squared distance) pair
+    using range_aggregate_type =
+        typename octree_node_type::range_aggregate_type; ///< Count and coordinate sum in a range
+    using frozen_type =
+        basic_frozen_octree_t<Element, ParamsType>; ///< Type of read-only copy of this octree
 
     /**
-     * @brief Default move constructor
-     * @param other Copied-from octree
+     * @brief Move constructor
+     * @param other Moved-from octree
      */
-    basic_linked_octree_t(self_type&& other) = default;
+    basic_linked_octree_t(self_type&& other) noexcept
+        : root_(std::move(other.root_)),
+          size_(other.size_.load(std::memory_order_relaxed)),
+          locks_(other.locks_.exchange(nullptr, std::memory_order_relaxed))
+    {
+    }
+
+    ~basic_linked_octree_t() { delete locks_.load(std::memory_order_relaxed); }
 
     /**
      * @brief
      * Constructs this octree with configuration specified by params
      * @param params The configuration for this octree
+     * @param allocator The allocator for the octree's nodes and elements
      */
-    explicit basic_linked_octree_t(params_type const& params) : root_(params), size_(0u) {}
+    explicit basic_linked_octree_t(
+        params_type const& params,
+        allocator_type const& allocator = allocator_type{})
+        : root_(params, allocator), size_(0u)
+    {
+    }
 
     /**
      * @brief
@@ -79,14 +131,43 @@ class basic_linked_octree_t
      * @param end End iterator to the elements
      * @param point_view The point view property map
      * @param params The configuration for this octree
+     * @param allocator The allocator for the octree's nodes and elements
      */
     template <class ForwardIter, class PointViewMap>
     explicit basic_linked_octree_t(
         ForwardIter begin,
         ForwardIter end,
         PointViewMap const& point_view,
-        params_type const& params)
-        : root_(params), size_(root_.insert(begin, end, point_view))
+        params_type const& params,
+        allocator_type const& allocator = allocator_type{})
+        : root_(params, allocator), size_(root_.insert(begin, end, point_view))
+    {
+    }
+
+    /**
+     * @brief
+     * Constructs this octree from a range of elements in bulk,
+     * building sibling subtrees concurrently
+     * @tparam ExecutionPolicy Type of STL execution policy
+     * @tparam ForwardIter Type of iterator to the elements
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param policy The execution policy
+     * @param begin Begin iterator to the elements
+     * @param end End iterator to the elements
+     * @param point_view The point view property map
+     * @param params The configuration for this octree
+     * @param allocator The allocator for the octree's nodes and elements
+     */
+    template <class ExecutionPolicy, class ForwardIter, class PointViewMap>
+    explicit basic_linked_octree_t(
+        ExecutionPolicy&& policy,
+        ForwardIter begin,
+        ForwardIter end,
+        PointViewMap const& point_view,
+        params_type const& params,
+        allocator_type const& allocator = allocator_type{})
+        : root_(params, allocator),
+          size_(root_.insert(std::forward<ExecutionPolicy>(policy), begin, end, point_view))
     {
     }
 
@@ -99,12 +180,14 @@ class basic_linked_octree_t
      * @param begin Begin iterator to the elements
      * @param end The point view property map
      * @param point_view The point view property map
+     * @param allocator The allocator for the octree's nodes and elements
      */
     template <class ForwardIter, class PointViewMap>
     explicit basic_linked_octree_t(
         ForwardIter begin,
         ForwardIter end,
-        PointViewMap const& point_view)
+        PointViewMap const& point_view,
+        allocator_type const& allocator = allocator_type{})
         : root_{}, size_{}
     {
         params_type params;
@@ -116,7 +199,7 @@ class basic_linked_octree_t
         auto const bbox =
             pcp::bounding_box<rng_iter_type, aabb_point_type, aabb_type>(rng.begin(), rng.end());
         params.voxel_grid = bbox;
-        root_             = octree_node_type{params};
+        root_             = octree_node_type{params, allocator};
         size_             = root_.insert(begin, end, point_view);
     }
 
@@ -133,9 +216,21 @@ class basic_linked_octree_t
     bool empty() const { return size() == 0u; }
 
     /**
-     * @brief Remove all elements from this octree
+     * @brief
+     * Remove all elements from this octree. With a node_pool_allocator_t,
+     * the nodes' memory goes back to the pool for reuse by later insertions.
+     */
+    void clear()
+    {
+        root_.clear();
+        size_ = 0u;
+    }
+
+    /**
+     * @brief The allocator used for the octree's nodes and elements
+     * @return The allocator used for the octree's nodes and elements
      */
-    void clear() { root_.clear(); }
+    allocator_type get_allocator() const { return root_.get_allocator(); }
 
     /**
      * @brief Gets the top-level voxel from this octree (the bounding box)
@@ -167,6 +262,24 @@ class basic_linked_octree_t
      */
     const_iterator cend() const { return const_iterator{}; }
 
+    /**
+     * @brief
+     * Iterator to the first bucket of this octree. A bucket is the contiguous
+     * storage of a node's elements. Buckets are visited in the same order as
+     * the elements are by the element iterators.
+     * @return Iterator to the first bucket of this octree
+     */
+    bucket_iterator bucket_begin() const
+    {
+        return bucket_iterator(const_cast<octree_node_type*>(&root_));
+    }
+
+    /**
+     * @brief End iterator to this octree's buckets
+     * @return End iterator to this octree's buckets
+     */
+    bucket_iterator bucket_end() const { return bucket_iterator{}; }
+
     /**
      * @brief Insert range of elements in the octree
      * @tparam ForwardIter Type of the range's iterators
@@ -188,6 +301,34 @@ class basic_linked_octree_t
         return inserted;
     }
 
+    /**
+     * @brief
+     * Insert range of elements in the octree in bulk. The elements are
+     * partitioned top-down by octant and sibling subtrees are built
+     * concurrently. The resulting octree is identical to the one obtained
+     * by inserting the elements one at a time.
+     * @tparam ExecutionPolicy Type of STL execution policy
+     * @tparam ForwardIter Type of the range's iterators
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param policy The execution policy
+     * @param begin Iterator to the first element of the range
+     * @param end End iterator of the range
+     * @param point_view The point view property map
+     * @return The number of inserted elements
+     */
+    template <class ExecutionPolicy, class ForwardIter, class PointViewMap>
+    std::size_t insert(
+        ExecutionPolicy&& policy,
+        ForwardIter begin,
+        ForwardIter end,
+        PointViewMap const& point_view)
+    {
+        auto const inserted =
+            root_.insert(std::forward<ExecutionPolicy>(policy), begin, end, point_view);
+        size_ += inserted;
+        return inserted;
+    }
+
     /**
      * @brief Insert one element in the octree
      * @tparam PointViewMap Type satisfying PointViewMap concept
@@ -205,6 +346,41 @@ class basic_linked_octree_t
         return inserted;
     }
 
+    /**
+     * @brief
+     * Insert one element in the octree. Many threads may call concurrent_insert
+     * at once, while other threads run concurrent_visit_range or
+     * concurrent_range_search. No other operation may run concurrently with
+     * them. Count and aggregate range queries remain correct after concurrent
+     * insertions, but are slower until refresh_statistics is called.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param e The element to insert
+     * @param point_view The point view property map
+     * @return true if insert was successful
+     */
+    template <class PointViewMap>
+    bool concurrent_insert(element_type const& e, PointViewMap const& point_view)
+    {
+        bool const inserted = root_.concurrent_insert(e, point_view, lock_table());
+        if (inserted)
+            size_.fetch_add(1u, std::memory_order_relaxed);
+
+        return inserted;
+    }
+
+    /**
+     * @brief
+     * Recomputes the per-node subtree statistics left stale by concurrent
+     * insertions and erasures
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void refresh_statistics(PointViewMap const& point_view)
+    {
+        root_.refresh_statistics(point_view);
+    }
+
     /*
      * Returns an iterator to the point p in the octree if it exists.
      *
@@ -230,10 +406,92 @@ class basic_linked_octree_t
         return root_.erase(pos);
     }
 
+    /*
+     * Removes all elements satisfying a predicate in one traversal of
+     * the octree. Subtrees left with no more elements than the node
+     * capacity are collapsed and mostly empty node buffers are shrunk,
+     * so that memory is released after large deletions. Invalidates
+     * all iterators.
+     *
+     * @param pred Callable taking an element_type const& and returning true
+     * for the elements to remove
+     * @param point_view The PointViewMap property map
+     * @return Number of elements removed
+     */
+    template <class Predicate, class PointViewMap>
+    std::size_t erase_if(Predicate pred, PointViewMap const& point_view)
+    {
+        auto const num_erased = root_.erase_if(pred, point_view);
+        size_ -= num_erased;
+        return num_erased;
+    }
+
+    /*
+     * Moves one element to a new position. The element is searched for
+     * along the path of its old position. Point views are identified by
+     * the address of the point they view, so that elements at coinciding
+     * positions are told apart. Otherwise, elements are identified by
+     * position, like find does, by their old position if they are stored
+     * by value, or else by their new position if they refer to points that
+     * have already moved. An element staying in the voxel
+     * of its node is overwritten in place, without restructuring the
+     * octree. Otherwise, it is relocated through the nearest ancestor of
+     * its node containing its new position, instead of the root. An element
+     * leaving the voxel grid is removed. Invalidates iterators to the
+     * updated element.
+     *
+     * Elements have no handle to their node, so finding the element scans
+     * the buckets along its path from the root. An update is therefore not
+     * a constant time operation, even when the element stays in its node.
+     *
+     * @param element The element at its new position
+     * @param old_position Position of the element when it was last inserted or updated
+     * @param point_view The PointViewMap property map
+     * @return true if the element was found
+     */
+    template <class TPointView, class PointViewMap>
+    bool update(
+        element_type const& element,
+        TPointView const& old_position,
+        PointViewMap const& point_view)
+    {
+        static_assert(
+            traits::is_point_view_v<TPointView>,
+            "TPointView must satisfy PointView concept");
+
+        bool const is_found = root_.update(element, old_position, point_view);
+        if (is_found && !root_.voxel_grid().contains(point_view(element)))
+            --size_;
+
+        return is_found;
+    }
+
+    /*
+     * Relocates all elements whose position changed since they were
+     * inserted, for elements referring to points that are moved outside
+     * of the octree (by index, pointer or view). Each node checks that
+     * its elements are still in its voxel, so elements that did not leave
+     * their node cost one containment test, and moved elements are handed
+     * up to their nearest ancestor containing their new position, and
+     * inserted again from there. Elements leaving the voxel grid are
+     * removed. Invalidates all iterators.
+     *
+     * @param point_view The PointViewMap property map
+     * @return Number of elements that changed node, including the removed ones
+     */
+    template <class PointViewMap>
+    std::size_t refit(PointViewMap const& point_view)
+    {
+        typename octree_node_type::elements_type escaped(root_.get_allocator());
+        auto const num_moved = root_.refit(point_view, escaped);
+        size_ -= escaped.size();
+        return num_moved;
+    }
+
     /*
      * Returns the k-nearest-neighbours in 3d Euclidean space
      * using the l2-norm as the notion of distance.
-     * The implementation is recursive.
+     * The implementation is a best-first search over the octants.
      *
      * @param target    The reference point for which we want the k nearest neighbors
      * @param k         The number of neighbors to return that are nearest to the specified point
@@ -253,6 +511,219 @@ class basic_linked_octree_t
             .template nearest_neighbours<TPointView, PointViewMap>(target, k, point_view, eps);
     }
 
+    /*
+     * Writes the k-nearest-neighbours in 3d Euclidean space to out as
+     * (element, squared distance) pairs, ordered from nearest to furthest.
+     * Storage for the search is taken from scratch, which should be reused
+     * across queries (one per thread) to avoid allocating.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * @param point_view The PointViewMap property map
+     * @param scratch The reusable search storage
+     * @param out Output iterator to neighbour_type values
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_type& scratch,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        return root_.nearest_neighbours(target, k, point_view, scratch, out, eps);
+    }
+
+    /*
+     * Returns approximate k-nearest-neighbours in 3d Euclidean space. Octants
+     * further than the k-th nearest neighbour divided by (1 + epsilon) are
+     * pruned, and the search stops after visiting a budget of leaves.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * @param point_view The PointViewMap property map
+     * @param approximation The approximation settings
+     * @param eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> approximate_nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        approximate_knn_parameters_t const& approximation,
+        double eps = 1e-5) const
+    {
+        return root_.approximate_nearest_neighbours(target, k, point_view, approximation, eps);
+    }
+
+    /*
+     * Writes approximate k-nearest-neighbours in 3d Euclidean space to out as
+     * (element, squared distance) pairs, ordered from nearest to furthest.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * @param point_view The PointViewMap property map
+     * @param approximation The approximation settings
+     * @param scratch The reusable search storage
+     * @param out Output iterator to neighbour_type values
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter approximate_nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        approximate_knn_parameters_t const& approximation,
+        knn_scratch_type& scratch,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        return root_.approximate_nearest_neighbours(
+            target,
+            k,
+            point_view,
+            approximation,
+            scratch,
+            out,
+            eps);
+    }
+
+    /*
+     * Returns at most k nearest neighbours in 3d Euclidean space within a radius
+     * of the target. Octants are pruned against the nearer of the radius and the
+     * k-th nearest neighbour, so the search does the work of neither a full KNN
+     * search nor a full range search.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The maximum number of neighbors to return
+     * @param radius    The maximum distance of the neighbours to the reference point
+     * @param point_view The PointViewMap property map
+     * @param eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> radius_nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        typename knn_scratch_type::scalar_type radius,
+        PointViewMap const& point_view,
+        double eps = 1e-5) const
+    {
+        return root_.radius_nearest_neighbours(target, k, radius, point_view, eps);
+    }
+
+    /*
+     * Writes at most k nearest neighbours in 3d Euclidean space within a radius
+     * of the target to out as (element, squared distance) pairs, ordered from
+     * nearest to furthest.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The maximum number of neighbors to return
+     * @param radius    The maximum distance of the neighbours to the reference point
+     * @param point_view The PointViewMap property map
+     * @param scratch The reusable search storage
+     * @param out Output iterator to neighbour_type values
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter radius_nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        typename knn_scratch_type::scalar_type radius,
+        PointViewMap const& point_view,
+        knn_scratch_type& scratch,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        return root_.radius_nearest_neighbours(target, k, radius, point_view, scratch, out, eps);
+    }
+
+    /*
+     * Returns a lazy range of (element pointer, squared distance) pairs in
+     * 3d Euclidean space, ordered from nearest to furthest, for searches
+     * which do not know how many neighbours they need. Octants are only
+     * visited when the next neighbour may lie in them, so stopping early
+     * does not pay for the neighbours that were not visited. The octree
+     * must not be modified while the range is in use.
+     *
+     * @param target    The reference point for which we want the nearest neighbors
+     * @param point_view The PointViewMap property map
+     * @param eps The error tolerance for floating point equality
+     * @return An input range of neighbour_type values
+     */
+    template <class TPointView, class PointViewMap>
+    auto incremental_nearest_neighbours(
+        TPointView const& target,
+        PointViewMap const& point_view,
+        double eps = 1e-5) const
+    {
+        return root_.incremental_nearest_neighbours(target, point_view, eps);
+    }
+
+    /*
+     * Computes the k-nearest-neighbours of a batch of targets. The targets
+     * are scheduled in Morton order so that consecutive searches on a thread
+     * are spatially coherent, and each search is bounded from the start by
+     * the neighbours of the previous target.
+     *
+     * @param policy The execution policy
+     * @param first Begin iterator to the targets
+     * @param last End iterator to the targets
+     * @param k The number of neighbors to return for each target
+     * @param point_view The PointViewMap property map
+     * @param out Random access iterator to one sequence container per target
+     * (e.g. std::vector<element_type>), receiving the target's neighbours
+     * ordered from nearest to furthest
+     * @param eps The error tolerance for floating point equality
+     */
+    template <class ExecutionPolicy, class RandomAccessIter, class PointViewMap, class OutputIter>
+    void batch_nearest_neighbours(
+        ExecutionPolicy&& policy,
+        RandomAccessIter first,
+        RandomAccessIter last,
+        std::size_t k,
+        PointViewMap const& point_view,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        root_.batch_nearest_neighbours(
+            std::forward<ExecutionPolicy>(policy),
+            first,
+            last,
+            k,
+            point_view,
+            out,
+            eps);
+    }
+
+    /*
+     * Computes the k-nearest-neighbours of a batch of targets sequentially.
+     *
+     * @param first Begin iterator to the targets
+     * @param last End iterator to the targets
+     * @param k The number of neighbors to return for each target
+     * @param point_view The PointViewMap property map
+     * @param out Random access iterator to one sequence container per target
+     * @param eps The error tolerance for floating point equality
+     */
+    template <class RandomAccessIter, class PointViewMap, class OutputIter>
+    void batch_nearest_neighbours(
+        RandomAccessIter first,
+        RandomAccessIter last,
+        std::size_t k,
+        PointViewMap const& point_view,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        batch_nearest_neighbours(std::execution::seq, first, last, k, point_view, out, eps);
+    }
+
     /*
      * Returns all points that reside in the given range.
      * The implementation is recursive.
@@ -275,9 +746,373 @@ class basic_linked_octree_t
         return elements_in_range;
     }
 
+    /*
+     * Writes all points that reside in the given range to out.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param out Output iterator to the elements in range
+     * @return Output iterator past the last written element
+     */
+    template <class Range, class PointViewMap, class OutputIter>
+    OutputIter
+    range_search(Range const& range, PointViewMap const& point_view, OutputIter out) const
+    {
+        visit_range(range, point_view, [&out](element_type const& e) { *out++ = e; });
+        return out;
+    }
+
+    /*
+     * Calls visitor on all points that reside in the given range,
+     * without storing them.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void visit_range(Range const& range, PointViewMap const& point_view, Visitor&& visitor) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+        root_.visit_range(range, point_view, std::forward<Visitor>(visitor));
+    }
+
+    /*
+     * Returns a lazy range of the points that reside in the given range.
+     * The octree is searched as the returned range is iterated, so that
+     * the search stops as soon as the iteration stops. The octree must
+     * not be modified while the returned range is in use.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return An input range of the points that reside in the given range
+     */
+    template <class Range, class PointViewMap>
+    auto lazy_range_search(Range const& range, PointViewMap const& point_view) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+        return root_.lazy_range_search(range, point_view);
+    }
+
+    /*
+     * Checks if any point resides in the given range. The search
+     * stops at the first point found.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return True if a point resides in the given range
+     */
+    template <class Range, class PointViewMap>
+    bool any_in_range(Range const& range, PointViewMap const& point_view) const
+    {
+        return !lazy_range_search(range, point_view).empty();
+    }
+
+    /*
+     * Returns at most n of the points that reside in the given range.
+     * The search stops once n points are found.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param n Maximum number of points to return
+     * @param point_view The PointViewMap property map
+     * @return A list of at most n points that reside in the given range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type>
+    range_search_first(Range const& range, std::size_t n, PointViewMap const& point_view) const
+    {
+        std::vector<element_type> elements_in_range;
+        if (n == 0u)
+            return elements_in_range;
+
+        /*
+         * Stop as soon as the n-th element is found, since advancing
+         * the lazy search again may expand a whole subtree.
+         */
+        auto elements = lazy_range_search(range, point_view);
+        for (auto it = elements.begin(); it != elements.end(); ++it)
+        {
+            elements_in_range.push_back(*it);
+            if (elements_in_range.size() == n)
+                break;
+        }
+        return elements_in_range;
+    }
+
+    /*
+     * Calls visitor on all points that reside in the given range.
+     * Can run concurrently with concurrent_insert. The points of a
+     * node are copied while the node is locked, and the visitor is
+     * called on the copies after it is unlocked, so the visitor may
+     * insert points in this octree with concurrent_insert.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void concurrent_visit_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        Visitor&& visitor) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+        root_.concurrent_visit_range(
+            range,
+            point_view,
+            std::forward<Visitor>(visitor),
+            lock_table());
+    }
+
+    /*
+     * Returns all points that reside in the given range.
+     * Can run concurrently with concurrent_insert.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return A list of all points that reside in the given range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type>
+    concurrent_range_search(Range const& range, PointViewMap const& point_view) const
+    {
+        std::vector<element_type> elements_in_range;
+        concurrent_visit_range(range, point_view, [&elements_in_range](element_type const& e) {
+            elements_in_range.push_back(e);
+        });
+        return elements_in_range;
+    }
+
+    /*
+     * Counts the points that reside in the given range. Subtrees
+     * lying entirely inside the range are counted without visiting
+     * their points.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return Number of points in the range
+     */
+    template <class Range, class PointViewMap>
+    std::size_t range_count(Range const& range, PointViewMap const& point_view) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+        return root_.range_count(range, point_view);
+    }
+
+    /*
+     * Computes the number and the coordinate sum of the points that
+     * reside in the given range. With parameters storing coordinate
+     * sums (see aggregate_octree_parameters_t), subtrees lying entirely
+     * inside the range are aggregated without visiting their points.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return Aggregate of the points in the range
+     */
+    template <class Range, class PointViewMap>
+    range_aggregate_type range_aggregate(Range const& range, PointViewMap const& point_view) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+        return root_.range_aggregate(range, point_view);
+    }
+
+    /*
+     * Casts a ray through the octree for picking. Returns the point nearest
+     * to the ray's origin along the ray among the points within a distance
+     * radius of the ray. Octants are visited front to back along the ray,
+     * so the search stops soon after the first hit.
+     *
+     * @param origin The ray's origin
+     * @param direction The ray's direction, which need not be normalized
+     * @param radius Maximum distance from the ray to a picked point
+     * @param point_view The PointViewMap property map
+     * @return The picked point, or no point if the ray misses every point
+     */
+    template <class TPointView, class Vector3d, class PointViewMap>
+    std::optional<element_type> ray_cast(
+        TPointView const& origin,
+        Vector3d const& direction,
+        typename aabb_point_type::coordinate_type radius,
+        PointViewMap const& point_view) const
+    {
+        return root_.ray_cast(origin, direction, radius, point_view);
+    }
+
+    /*
+     * Returns the points inside a convex volume bounded by planes, such as
+     * a view frustum, for culling. The planes' normals point inside the
+     * volume. Points are returned front to back by octant, in order of
+     * their octants' distance to the first plane, which should be the
+     * frustum's near plane.
+     *
+     * @param planes Range of planes bounding the volume
+     * @param point_view The PointViewMap property map
+     * @return A list of the points inside the volume
+     */
+    template <class Planes, class PointViewMap>
+    std::vector<element_type>
+    frustum_search(Planes const& planes, PointViewMap const& point_view) const
+    {
+        std::vector<element_type> elements_in_frustum;
+        visit_frustum(planes, point_view, [&elements_in_frustum](element_type const& e) {
+            elements_in_frustum.push_back(e);
+        });
+        return elements_in_frustum;
+    }
+
+    /*
+     * Calls visitor on the points inside a convex volume bounded by planes,
+     * front to back by octant as in frustum_search.
+     *
+     * @param planes Range of planes bounding the volume
+     * @param point_view The PointViewMap property map
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Planes, class PointViewMap, class Visitor>
+    void visit_frustum(
+        Planes const& planes,
+        PointViewMap const& point_view,
+        Visitor&& visitor) const
+    {
+        root_.visit_frustum(planes, point_view, std::forward<Visitor>(visitor));
+    }
+
+    /*
+     * Selects the level-of-detail representatives of every node in one
+     * bottom-up pass. Requires octree parameters storing representatives
+     * (see lod_octree_parameters_t). Representatives are copies of the
+     * points, so they must be rebuilt after the octree is modified.
+     *
+     * @param point_view The PointViewMap property map
+     */
+    template <class PointViewMap>
+    void build_representatives(PointViewMap const& point_view)
+    {
+        root_.build_representatives(point_view);
+    }
+
+    /*
+     * Returns the representatives of the nodes at a depth of the octree,
+     * the root being at depth 0, and of the leaves above that depth. The
+     * points are spread over the whole octree, and there are at most
+     * representatives_per_node * 8^depth of them.
+     *
+     * @param depth The level of detail
+     * @return A list of representative points
+     */
+    std::vector<element_type> points_at_depth(std::size_t depth) const
+    {
+        std::vector<element_type> representatives;
+        root_.visit_points_at_depth(depth, [&representatives](element_type const& e) {
+            representatives.push_back(e);
+        });
+        return representatives;
+    }
+
+    /*
+     * Returns at most max_points representatives of the points that reside
+     * in the given range, spread over the range, for progressive queries and
+     * rendering. The cost depends on max_points rather than on the number
+     * of points in the range.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param max_points Maximum number of points to return
+     * @param point_view The PointViewMap property map
+     * @return A list of at most max_points representative points in the range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type>
+    lod_query(Range const& range, std::size_t max_points, PointViewMap const& point_view) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+        return root_.lod_query(range, max_points, point_view);
+    }
+
+    /*
+     * Returns a read-only copy of this octree whose nodes and elements
+     * are each stored contiguously, in breadth-first and depth-first
+     * order respectively. The copy has the same structure as this octree
+     * and answers the same queries with fewer cache misses, so it should
+     * be used once an octree is no longer modified.
+     *
+     * @return The frozen copy of this octree
+     */
+    frozen_type freeze() const { return frozen_type(root_); }
+
+    /*
+     * Returns a read-only copy of this octree, as freeze does, which also
+     * caches the coordinates of its elements in structure of arrays form
+     * so that its queries read contiguous coordinates.
+     *
+     * @param point_view The PointViewMap property map
+     * @return The frozen copy of this octree
+     */
+    template <class PointViewMap>
+    frozen_type freeze(PointViewMap const& point_view) const
+    {
+        return frozen_type(root_, point_view);
+    }
+
   private:
-    octree_node_type root_;
-    std::size_t size_;
+    /*
+     * Returns the table of locks used by concurrent operations, allocating
+     * it on first use. Threads racing to allocate the table publish their
+     * table with a compare-exchange, and the losers free theirs.
+     */
+    shared_lock_table_t const& lock_table() const
+    {
+        shared_lock_table_t* locks = locks_.load(std::memory_order_acquire);
+        if (locks != nullptr)
+            return *locks;
+
+        auto table = std::make_unique<shared_lock_table_t>();
+        if (locks_.compare_exchange_strong(
+                locks,
+                table.get(),
+                std::memory_order_acq_rel,
+                std::memory_order_acquire))
+            return *table.release();
+
+        return *locks;
+    }
+
+    /*
+     * Lazily subdivided octrees subdivide their nodes during
+     * queries, which only have const access to the octree.
+     */
+    mutable octree_node_type root_;
+    std::atomic<std::size_t> size_;
+    mutable std::atomic<shared_lock_table_t*> locks_{nullptr}; ///< Allocated on first use
 };
 
 using linked_octree_t = pcp::basic_linked_octree_t<pcp::point_t>;
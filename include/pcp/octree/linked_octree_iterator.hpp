@@ -6,26 +6,162 @@
  * @ingroup octree
  */
 
-#include <stack>
+#include <cstddef>
+#include <iterator>
 
 namespace pcp {
 
-template <class Element, class ParamsType>
+template <class Element, class ParamsType, class Allocator>
 class basic_linked_octree_node_t;
 
+template <class Element, class ParamsType, class Allocator>
+class linked_octree_iterator_t;
+
+/**
+ * @ingroup linked-octree
+ * @brief
+ * Read-only forward iterator over the non-empty nodes of the octree,
+ * in postorder. Dereferencing yields the node's elements, which are
+ * stored contiguously. Nodes store links to their parent, so the
+ * iterator only holds the root and the current node and is cheap to copy.
+ * @tparam Element The element type
+ * @tparam ParamsType Type containg the octree parameters
+ * @tparam Allocator Type of allocator used by the octree
+ */
+template <class Element, class ParamsType, class Allocator>
+class linked_octree_bucket_iterator_t
+{
+    using octree_node_type = basic_linked_octree_node_t<Element, ParamsType, Allocator>;
+
+  public:
+    using element_type      = Element; ///< Type of element stored in the buckets
+    using value_type        = typename octree_node_type::elements_type; ///< Type of bucket
+    using difference_type   = std::size_t;
+    using reference         = value_type const&;
+    using const_reference   = value_type const&;
+    using pointer           = value_type const*;
+    using const_pointer     = value_type const*;
+    using iterator_category = std::forward_iterator_tag; ///< Iterator category
+
+  private:
+    using self_type =
+        linked_octree_bucket_iterator_t<Element, ParamsType, Allocator>; ///< Type of this iterator
+
+  public:
+    friend class basic_linked_octree_node_t<Element, ParamsType, Allocator>;
+    friend class linked_octree_iterator_t<Element, ParamsType, Allocator>;
+
+    /**
+     * @brief Constructs an end iterator
+     */
+    linked_octree_bucket_iterator_t() : root_(nullptr), octree_node_(nullptr) {}
+
+    /**
+     * @brief
+     * Constructs an iterator to the first non-empty node of the subtree rooted at root
+     * @param root Root of the subtree to iterate over
+     */
+    explicit linked_octree_bucket_iterator_t(octree_node_type* root)
+        : root_(root), octree_node_(get_next_node(root, 0u))
+    {
+        if (octree_node_->elements_.empty())
+            ++(*this);
+    }
+
+    /**
+     * @brief Get the root of the octree
+     * @return Root of the octree
+     */
+    octree_node_type const* root() const { return root_; }
+
+    const_reference operator*() const { return octree_node_->elements_; }
+    const_pointer operator->() const { return &(octree_node_->elements_); }
+
+    self_type& operator++()
+    {
+        do
+        {
+            /*
+             * The root is the last node in postorder, so once we have
+             * visited it, we have reached the end iterator.
+             */
+            if (octree_node_ == root_)
+            {
+                root_        = nullptr;
+                octree_node_ = nullptr;
+                return *this;
+            }
+
+            /*
+             * The next node is the first node in postorder of our next
+             * non-null sibling's subtree, or our parent if there is none.
+             */
+            auto const next_octant = static_cast<std::size_t>(octree_node_->octant_index_) + 1u;
+            octree_node_           = get_next_node(octree_node_->parent_, next_octant);
+        } while (octree_node_->elements_.empty());
+
+        return *this;
+    }
+
+    self_type operator++(int)
+    {
+        self_type previous{*this};
+        ++(*this);
+        return previous;
+    }
+
+    bool operator==(self_type const& other) const { return octree_node_ == other.octree_node_; }
+    bool operator!=(self_type const& other) const { return !(*this == other); }
+
+  private:
+    /**
+     * @brief
+     * Returns the next node in post-order sequence.
+     * @param octree Node to start looking from.
+     * @param octant Index of the current node's child to start looking from.
+     * @return The next node to move to.
+     */
+    static octree_node_type* get_next_node(octree_node_type* octree, std::size_t octant)
+    {
+        /*
+         * Descend into the first non-null child until we find a node
+         * with no more children to visit, which is the next node to
+         * visit in post-order sequence.
+         */
+        while (octant < octree->octants_.size())
+        {
+            auto const& octree_child_node = octree->octants_[octant];
+            if (!octree_child_node)
+            {
+                ++octant;
+                continue;
+            }
+
+            octree = octree_child_node.get();
+            octant = 0u;
+        }
+
+        return octree;
+    }
+
+    octree_node_type* root_;        ///< Root of the iterated subtree
+    octree_node_type* octree_node_; ///< Current node in which this iterator is
+};
+
 /**
  * @ingroup linked-octree
  * @brief
  * Read-only forward iterator for points in the octree.
- * Uses a stack of ancestor nodes under the hood to
- * traverse the octree in postorder.
+ * Traverses the octree's nodes in postorder using a bucket
+ * iterator, and each node's elements in order.
  * @tparam Element The element type
  * @tparam ParamsType Type containg the octree parameters
+ * @tparam Allocator Type of allocator used by the octree
  */
-template <class Element, class ParamsType>
+template <class Element, class ParamsType, class Allocator>
 class linked_octree_iterator_t
 {
-    using octree_node_type = basic_linked_octree_node_t<Element, ParamsType>;
+    using octree_node_type = basic_linked_octree_node_t<Element, ParamsType, Allocator>;
 
   public:
     using element_type      = Element; ///< Type of element iterated over
@@ -38,33 +174,32 @@ class linked_octree_iterator_t
     using iterator_category = std::forward_iterator_tag; ///< Iterator category
 
   private:
-    using self_type = linked_octree_iterator_t<Element, ParamsType>; ///< Type of this iterator
+    using self_type =
+        linked_octree_iterator_t<Element, ParamsType, Allocator>; ///< Type of this iterator
+    using bucket_iterator =
+        linked_octree_bucket_iterator_t<Element, ParamsType, Allocator>; ///< Type of iterator to
+                                                                          ///< the octree's nodes
     using element_iterator =
         typename octree_node_type::elements_type::iterator; ///< Type of iterator to an octree
                                                             ///< node's elements
-    using const_element_iterator = typename octree_node_type::elements_type::const_iterator;
-    using octant_iterator =
-        typename octree_node_type::octants_type::iterator; ///< Type of iterator to an octree node's
-                                                           ///< children
-    using const_octant_iterator = typename octree_node_type::octants_type::const_iterator;
 
   public:
-    friend class basic_linked_octree_node_t<Element, ParamsType>;
+    friend class basic_linked_octree_node_t<Element, ParamsType, Allocator>;
 
     /**
      * @brief Constructs an end iterator
      */
-    linked_octree_iterator_t() : octree_node_(nullptr), it_() {}
+    linked_octree_iterator_t() : bucket_(), it_() {}
 
     /**
      * @brief
      * Constructs an iterator starting from octree_node
      * @param octree_node The node in which we initialize the iterator
      */
-    explicit linked_octree_iterator_t(octree_node_type* octree_node) : octree_node_(nullptr), it_()
+    explicit linked_octree_iterator_t(octree_node_type* octree_node) : bucket_(octree_node), it_()
     {
-        octree_node_ = get_next_node(octree_node, octree_node->octants_.cbegin());
-        it_          = octree_node_->elements_.begin();
+        if (bucket_.octree_node_ != nullptr)
+            it_ = bucket_.octree_node_->elements_.begin();
     }
 
     linked_octree_iterator_t(self_type const& other)     = default;
@@ -76,30 +211,7 @@ class linked_octree_iterator_t
      * @brief Get the root of the octree
      * @return Root of the octree
      */
-    octree_node_type const* root() const
-    {
-        using stack_type = decltype(ancestor_octree_nodes_);
-
-        if (ancestor_octree_nodes_.empty())
-            return octree_node_;
-
-        decltype(ancestor_octree_nodes_) copy;
-        while (!ancestor_octree_nodes_.empty())
-        {
-            copy.push(ancestor_octree_nodes_.top());
-            const_cast<stack_type&>(ancestor_octree_nodes_).pop();
-        }
-
-        auto const* root = copy.top();
-
-        while (!copy.empty())
-        {
-            const_cast<stack_type&>(ancestor_octree_nodes_).push(copy.top());
-            copy.pop();
-        }
-
-        return root;
-    }
+    octree_node_type const* root() const { return bucket_.root(); }
 
     const_reference operator*() const { return *it_; }
     reference operator*() { return *it_; }
@@ -110,26 +222,13 @@ class linked_octree_iterator_t
          * There are still points in this octree node, just
          * return the next point in line.
          */
-        if (++it_ != octree_node_->elements_.cend())
+        if (++it_ != bucket_.octree_node_->elements_.end())
             return *this;
 
-        /*
-         * If there are no ancestors, the current octree node
-         * is the root node. If we have exhausted all points
-         * of the root node, then we have reached the end
-         * iterator.
-         */
-        if (ancestor_octree_nodes_.empty())
-        {
-            octree_node_ = nullptr;
-            it_          = decltype(it_){};
-            return *this;
-        }
-
         /*
          * If there are no more points in this octree node,
-         * but there are still points remaining in the tree,
-         * we move to the next node in the sequence.
+         * we move to the next node in the sequence, or to the
+         * end iterator if this node was the last one.
          */
         move_to_next_node();
         return *this;
@@ -148,7 +247,7 @@ class linked_octree_iterator_t
 
     bool operator==(self_type const& other) const
     {
-        return (octree_node_ == other.octree_node_) && (it_ == other.it_);
+        return (bucket_ == other.bucket_) && (it_ == other.it_);
     }
 
     bool operator!=(self_type const& other) const { return !(*this == other); }
@@ -158,74 +257,19 @@ class linked_octree_iterator_t
 
   private:
     /**
-     * @brief
-     * Returns the next node in post-order sequence.
-     * @param octree Node to start looking from.
-     * @param begin Iterator to the current node's child to start looking from.
-     * @return The next node to move to.
-     */
-    octree_node_type* get_next_node(octree_node_type* octree, const_octant_iterator begin)
-    {
-        auto const end = octree->octants_.cend();
-
-        for (auto octree_child_node_it = begin; octree_child_node_it != end; ++octree_child_node_it)
-        {
-            auto const& octree_child_node = *octree_child_node_it;
-            if (!octree_child_node)
-                continue;
-
-            ancestor_octree_nodes_.push(octree);
-            return get_next_node(octree_child_node.get(), octree_child_node->octants_.begin());
-        }
-
-        /*
-         * If there were no more children to visit from this octree,
-         * it means this octree node is the next node to visit in
-         * post-order sequence.
-         */
-        return octree;
-    }
-
-    /**
-     * @brief Move iterator to the next node in post-order
+     * @brief Move iterator to the first point of the next node in post-order
      */
     void move_to_next_node()
     {
-        /*
-         * If we've exhausted all points of this octree node,
-         * then it's time to go back to our parent and look
-         * for the next point from there.
-         */
-        auto* parent = ancestor_octree_nodes_.top();
-        ancestor_octree_nodes_.pop();
-
-        auto const is_same_octant =
-            [target = octree_node_](
-                typename std::iterator_traits<const_octant_iterator>::reference octant) -> bool {
-            return octant.get() == target;
-        };
-
-        /*
-         * Find our next non-null sibling
-         */
-        const_octant_iterator next_octant =
-            std::find_if(parent->octants_.cbegin(), parent->octants_.cend(), is_same_octant);
-
-        octree_node_ = get_next_node(parent, ++next_octant);
-
-        /*
-         * Once we've found the next octree node in the
-         * sequence, we initialize our internal iterator
-         * to the first point of that octree node.
-         */
-        it_ = octree_node_->elements_.begin();
+        ++bucket_;
+        it_ = bucket_.octree_node_ != nullptr ? bucket_.octree_node_->elements_.begin() :
+                                                element_iterator{};
     }
 
-    octree_node_type* octree_node_; ///< Current node in which this iterator is
-    std::stack<octree_node_type*> ancestor_octree_nodes_; ///< Stack of nodes higher up in the tree
-    element_iterator it_; ///< Iterator to the current element of the current node
+    bucket_iterator bucket_; ///< Iterator to the current node in which this iterator is
+    element_iterator it_;    ///< Iterator to the current element of the current node
 };
 
 } // namespace pcp
 
-#endif // PCP_OCTREE_LINKED_OCTREE_ITERATOR_HPP
\ No newline at end of file
+#endif // PCP_OCTREE_LINKED_OCTREE_ITERATOR_HPP
@@ -8,21 +8,40 @@
 
 #include "linked_octree_iterator.hpp"
 #include "pcp/common/intersections.hpp"
+#include "pcp/common/lock_table.hpp"
+#include "pcp/common/morton.hpp"
+#include "pcp/common/nearest_neighbours.hpp"
+#include "pcp/common/node_allocator.hpp"
 #include "pcp/common/norm.hpp"
+#include "pcp/common/points/point.hpp"
+#include "pcp/common/range_search.hpp"
 #include "pcp/common/vector3d_queries.hpp"
 #include "pcp/traits/point_map.hpp"
 #include "pcp/traits/point_traits.hpp"
 #include "pcp/traits/property_map_traits.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <execution>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <numeric>
-#include <queue>
+#include <optional>
+#include <shared_mutex>
+#include <type_traits>
 #include <vector>
 
 namespace pcp {
 
+template <class Element, class ParamsType>
+class basic_frozen_octree_t;
+
 /**
  * @ingroup linked-octree
  * @brief Default type used to parameterize octrees.
@@ -39,6 +58,134 @@ struct octree_parameters_t
     aabb_type voxel_grid{};            ///< The octree's bounding box
 };
 
+/**
+ * @ingroup linked-octree
+ * @brief
+ * Octree parameters for octrees whose nodes also keep the sum of the coordinates
+ * of their subtree's elements. range_aggregate then does not visit the elements
+ * of subtrees that are contained in the queried range.
+ * @tparam Point Type of point used by the voxel grid to define its AABB.
+ */
+template <class Point>
+struct aggregate_octree_parameters_t : octree_parameters_t<Point>
+{
+    static constexpr bool store_coordinate_sums = true; ///< Nodes keep their coordinate sums
+};
+
+/**
+ * @ingroup linked-octree
+ * @brief
+ * Compile-time check for octree parameters requesting per-node coordinate sums
+ * @tparam ParamsType Type containing the octree parameters
+ */
+template <class ParamsType, class = void>
+struct stores_coordinate_sums : std::false_type
+{
+};
+
+template <class ParamsType>
+struct stores_coordinate_sums<ParamsType, std::enable_if_t<ParamsType::store_coordinate_sums>>
+    : std::true_type
+{
+};
+
+template <class ParamsType>
+static constexpr bool stores_coordinate_sums_v = stores_coordinate_sums<ParamsType>::value;
+
+/**
+ * @ingroup linked-octree
+ * @brief
+ * Octree parameters for lazily subdivided octrees. Inserted elements are appended
+ * to the node they are inserted in regardless of its capacity, and the elements
+ * past a node's capacity are only moved to its children when a query first visits
+ * the node, so that insertion takes constant time and subdivision only happens in
+ * the queried regions.
+ * @tparam Point Type of point used by the voxel grid to define its AABB.
+ */
+template <class Point>
+struct lazy_octree_parameters_t : octree_parameters_t<Point>
+{
+    static constexpr bool subdivide_lazily = true; ///< Nodes are subdivided by queries
+};
+
+/**
+ * @ingroup linked-octree
+ * @brief
+ * Compile-time check for octree parameters requesting lazy subdivision
+ * @tparam ParamsType Type containing the octree parameters
+ */
+template <class ParamsType, class = void>
+struct subdivides_lazily : std::false_type
+{
+};
+
+template <class ParamsType>
+struct subdivides_lazily<ParamsType, std::enable_if_t<ParamsType::subdivide_lazily>>
+    : std::true_type
+{
+};
+
+template <class ParamsType>
+static constexpr bool subdivides_lazily_v = subdivides_lazily<ParamsType>::value;
+
+/**
+ * @ingroup linked-octree
+ * @brief
+ * Octree parameters for octrees whose nodes keep level-of-detail representatives,
+ * a few elements of their subtree spread over their octants. Level-of-detail
+ * queries then return bounded numbers of elements spread over a region without
+ * visiting the region's elements.
+ * @tparam Point Type of point used by the voxel grid to define its AABB.
+ */
+template <class Point>
+struct lod_octree_parameters_t : octree_parameters_t<Point>
+{
+    static constexpr std::uint32_t representatives_per_node = 8u; ///< Representatives of a node
+};
+
+/**
+ * @ingroup linked-octree
+ * @brief
+ * Compile-time check for octree parameters requesting level-of-detail representatives
+ * @tparam ParamsType Type containing the octree parameters
+ */
+template <class ParamsType, class = void>
+struct stores_representatives : std::false_type
+{
+};
+
+template <class ParamsType>
+struct stores_representatives<
+    ParamsType,
+    std::enable_if_t<(ParamsType::representatives_per_node > 0u)>> : std::true_type
+{
+};
+
+template <class ParamsType>
+static constexpr bool stores_representatives_v = stores_representatives<ParamsType>::value;
+
+/**
+ * @ingroup linked-octree
+ * @brief
+ * Aggregate of the elements found in a range
+ * @tparam Point Type of point used to accumulate the coordinates
+ */
+template <class Point>
+struct range_aggregate_t
+{
+    using point_type      = Point;
+    using coordinate_type = typename Point::coordinate_type;
+
+    std::size_t count = 0u;              ///< Number of elements in the range
+    Point coordinate_sum{0.f, 0.f, 0.f}; ///< Sum of the coordinates of the elements in the range
+
+    /**
+     * @brief Mean position of the elements in the range. The range must not be empty.
+     * @return Mean position of the elements in the range
+     */
+    Point centroid() const { return coordinate_sum / static_cast<coordinate_type>(count); }
+};
+
 /**
  * @ingroup linked-octree
  * @brief
@@ -47,42 +194,96 @@ struct octree_parameters_t
  * child octree nodes (octants).
  * @tparam Element The element type
  * @tparam ParamsType Type containing the octree node's parameters
+ * @tparam Allocator Type of allocator used for the nodes and their elements
  */
-template <class Element, class ParamsType>
+template <class Element, class ParamsType, class Allocator>
 class basic_linked_octree_node_t
 {
   public:
-    friend class linked_octree_iterator_t<Element, ParamsType>;
-
-    using self_type    = basic_linked_octree_node_t<Element, ParamsType>; ///< Type of this octree
-    using element_type = Element; ///< Type of element stored by this octree
+    friend class linked_octree_iterator_t<Element, ParamsType, Allocator>;
+    friend class linked_octree_bucket_iterator_t<Element, ParamsType, Allocator>;
+    friend class basic_frozen_octree_t<Element, ParamsType>;
+
+    using self_type =
+        basic_linked_octree_node_t<Element, ParamsType, Allocator>; ///< Type of this octree
+    using element_type   = Element;   ///< Type of element stored by this octree
+    using allocator_type = Allocator; ///< Type of allocator used by this node
     using elements_type =
-        std::vector<element_type>; ///< Type of container used to store the elements in this node
-    using octants_type = std::array<std::unique_ptr<self_type>, 8>; ///< Type of container used to
-                                                                    ///< store this node's children
+        std::vector<element_type, allocator_type>; ///< Type of container used to store the
+                                                   ///< elements in this node
+    using octant_pointer_type = node_pointer_t<self_type>; ///< Type of pointer to a child node
+    using octants_type = std::array<octant_pointer_type, 8>; ///< Type of container used to
+                                                             ///< store this node's children
     using params_type = ParamsType; ///< Type of configuration object used by this node
     using aabb_type   = typename params_type::aabb_type; ///< Type of aabb used by this node
     using aabb_point_type =
         typename aabb_type::point_type; ///< Type of point used by this node's aabb
     using iterator =
-        linked_octree_iterator_t<element_type, params_type>; ///< Type of iterator to this node's
-                                                             ///< tree's elements
+        linked_octree_iterator_t<element_type, params_type, allocator_type>; ///< Type of iterator
+                                                                             ///< to this node's
+                                                                             ///< tree's elements
     using const_iterator = iterator const;
     using value_type     = typename std::iterator_traits<iterator>::value_type;
     using reference      = typename std::iterator_traits<iterator>::reference;
     using pointer        = typename std::iterator_traits<iterator>::pointer;
+    using range_aggregate_type =
+        range_aggregate_t<aabb_point_type>; ///< Type of aggregate returned by range_aggregate
+    using coordinate_sum_type =
+        basic_point_t<double>; ///< Type of point in which coordinates are accumulated
+
+    /**
+     * @brief
+     * Reusable storage for KNN searches. Keeping one scratch object per thread
+     * lets repeated searches run without allocating.
+     */
+    struct knn_scratch_t
+    {
+        using scalar_type           = typename aabb_point_type::coordinate_type;
+        using neighbour_type        = neighbour_t<element_type const*, scalar_type>;
+        using neighbours_type       = std::vector<neighbour_type>;
+        using octant_heap_node_type = neighbour_t<self_type const*, scalar_type>;
+
+        std::vector<octant_heap_node_type> octants; ///< Min-heap of octants to visit
+        k_best_heap_t<element_type const*, scalar_type> k_best; ///< The k best elements
+    };
+
+    /**
+     * @brief
+     * Minimum number of elements that a subtree must receive during bulk insertion
+     * for its child subtrees to be built concurrently
+     */
+    static constexpr std::size_t min_element_count_for_parallel_exec = 4'096u;
+
+    /**
+     * @brief
+     * Number of consecutive targets, in Morton order, searched by the
+     * same thread during batched KNN searches
+     */
+    static constexpr std::size_t knn_batch_chunk_size = 256u;
 
     /**
      * @brief
      * Constructs this node using configuration params
+     * @param params The node's configuration
+     * @param allocator The allocator used for this node's children and elements
      */
     basic_linked_octree_node_t() noexcept = default;
-    explicit basic_linked_octree_node_t(params_type const& params)
+    explicit basic_linked_octree_node_t(
+        params_type const& params,
+        allocator_type const& allocator = allocator_type{})
         : capacity_(params.node_capacity),
           max_depth_(params.max_depth),
           voxel_grid_(params.voxel_grid),
           octants_(),
-          elements_()
+          elements_(allocator),
+          parent_(nullptr),
+          octant_index_(0u),
+          has_stale_statistics_(false),
+          published_octants_(0u),
+          has_pending_elements_(false),
+          subtree_size_(0u),
+          coordinate_sums_(),
+          representatives_()
     {
         assert(capacity_ > 0u);
         assert(max_depth_ > 0u);
@@ -93,6 +294,55 @@ class basic_linked_octree_node_t
         elements_.reserve(params.node_capacity);
     }
 
+    /**
+     * @brief
+     * Moves other's elements and children into this node. The children's
+     * links to their parent are updated to refer to this node.
+     * @param other The node to move from
+     */
+    basic_linked_octree_node_t(self_type&& other) noexcept
+        : capacity_(other.capacity_),
+          max_depth_(other.max_depth_),
+          voxel_grid_(other.voxel_grid_),
+          octants_(std::move(other.octants_)),
+          elements_(std::move(other.elements_)),
+          parent_(other.parent_),
+          octant_index_(other.octant_index_),
+          has_stale_statistics_(other.has_stale_statistics_.load(std::memory_order_relaxed)),
+          published_octants_(other.published_octants_.load(std::memory_order_relaxed)),
+          has_pending_elements_(other.has_pending_elements_.load(std::memory_order_relaxed)),
+          subtree_size_(other.subtree_size_),
+          coordinate_sums_(other.coordinate_sums_),
+          representatives_(std::move(other.representatives_))
+    {
+        adopt_octants();
+    }
+
+    self_type& operator=(self_type&& other)
+    {
+        capacity_        = other.capacity_;
+        max_depth_       = other.max_depth_;
+        voxel_grid_      = other.voxel_grid_;
+        octants_         = std::move(other.octants_);
+        elements_        = std::move(other.elements_);
+        parent_          = other.parent_;
+        octant_index_    = other.octant_index_;
+        subtree_size_    = other.subtree_size_;
+        coordinate_sums_ = other.coordinate_sums_;
+        representatives_ = std::move(other.representatives_);
+        has_stale_statistics_.store(
+            other.has_stale_statistics_.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        published_octants_.store(
+            other.published_octants_.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        has_pending_elements_.store(
+            other.has_pending_elements_.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        adopt_octants();
+        return *this;
+    }
+
     /**
      * @brief
      * Constructs this node from a range of elements
@@ -120,6 +370,43 @@ class basic_linked_octree_node_t
      */
     aabb_type const& voxel_grid() const { return voxel_grid_; }
 
+    /**
+     * @brief The allocator used by this node
+     * @return The allocator used by this node
+     */
+    allocator_type get_allocator() const { return elements_.get_allocator(); }
+
+    /**
+     * @brief Number of elements in this node's subtree
+     * @return Number of elements in this node's subtree
+     */
+    std::size_t subtree_size() const { return count_subtree(); }
+
+    /**
+     * @brief
+     * Recomputes the subtree statistics left stale by concurrent insertions and
+     * by erasures, so that count and aggregate range queries can use them again.
+     * Nodes whose statistics are up to date are not visited.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void refresh_statistics(PointViewMap const& point_view)
+    {
+        bool is_up_to_date = !has_stale_statistics();
+        if constexpr (stores_coordinate_sums_v<params_type>)
+            is_up_to_date = is_up_to_date && coordinate_sums_.is_valid;
+
+        if (is_up_to_date)
+            return;
+
+        for (auto& octree_child_node : octants_)
+            if (octree_child_node)
+                octree_child_node->refresh_statistics(point_view);
+
+        update_statistics(point_view);
+    }
+
     /**
      * @brief Remove all elements from this node subtree
      */
@@ -128,6 +415,13 @@ class basic_linked_octree_node_t
         elements_.clear();
         for (auto& octant : octants_)
             octant.reset();
+
+        subtree_size_    = 0u;
+        coordinate_sums_ = coordinate_sums_type{};
+        representatives_ = representatives_type{};
+        has_stale_statistics_.store(false, std::memory_order_relaxed);
+        published_octants_.store(0u, std::memory_order_relaxed);
+        has_pending_elements_.store(false, std::memory_order_relaxed);
     }
 
     /**
@@ -152,6 +446,61 @@ class basic_linked_octree_node_t
             });
     }
 
+    /**
+     * @brief
+     * Inserts range of elements in this node subtree in bulk. Elements are partitioned
+     * top-down by octant, and sibling subtrees are built concurrently. The resulting
+     * subtree is identical to the one obtained by inserting the elements one at a time.
+     * @tparam ExecutionPolicy Type of STL execution policy
+     * @tparam ForwardIter Type of iterator to the elements
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param policy The execution policy
+     * @param begin Iterator to start of range of elements
+     * @param end End iterator to range of elements
+     * @param point_view The point view property map
+     * @return Number of elements inserted
+     */
+    template <class ExecutionPolicy, class ForwardIter, class PointViewMap>
+    std::size_t insert(
+        ExecutionPolicy&& policy,
+        ForwardIter begin,
+        ForwardIter end,
+        PointViewMap const& point_view)
+    {
+        /*
+         * Lazily subdivided nodes do not partition the elements,
+         * so there is no work to share between threads.
+         */
+        if constexpr (subdivides_lazily_v<params_type>)
+            return insert(begin, end, point_view);
+
+        std::vector<element_type const*> elements(
+            static_cast<std::size_t>(std::distance(begin, end)));
+        std::transform(policy, begin, end, elements.begin(), [](element_type const& e) {
+            return std::addressof(e);
+        });
+
+        /*
+         * Elements outside of this node's voxel are never inserted. std::remove_if
+         * is stable, so the insertion order of the remaining elements is preserved.
+         */
+        auto const last =
+            std::remove_if(policy, elements.begin(), elements.end(), [&](element_type const* e) {
+                return !voxel_grid_.contains(point_view(*e));
+            });
+        elements.erase(last, elements.end());
+
+        std::vector<element_type const*> scratch(elements.size());
+        bulk_insert(
+            policy,
+            elements.data(),
+            elements.data() + elements.size(),
+            scratch.data(),
+            point_view);
+
+        return elements.size();
+    }
+
     /**
      * @brief
      * Insert one element in this node subtree
@@ -174,6 +523,28 @@ class basic_linked_octree_node_t
         if (!voxel_grid_.contains(p))
             return false;
 
+        /*
+         * The point will be stored somewhere in this node's
+         * subtree, since the point is in the voxel of the
+         * child octant we would delegate it to.
+         */
+        ++subtree_size_;
+        if constexpr (stores_coordinate_sums_v<params_type>)
+            add_coordinates(coordinate_sums_.sum, p);
+
+        /*
+         * Lazily subdivided nodes keep the element, and the
+         * elements past their capacity are moved down to their
+         * children by the first query visiting this node.
+         */
+        if constexpr (subdivides_lazily_v<params_type>)
+        {
+            elements_.push_back(element);
+            if (max_depth_ > 1u && elements_.size() > capacity_)
+                has_pending_elements_.store(true, std::memory_order_relaxed);
+            return true;
+        }
+
         /*
          * If this octree node has reached the maximum depth
          * of the octree defined by the root node, we know
@@ -286,48 +657,96 @@ class basic_linked_octree_node_t
          * yet, we create it and delegate the work of inserting
          * point p to the newly created child octree.
          */
-        params_type params;
+        octant = make_octant(octants_bitmask);
+        return octant->insert(element, point_view);
+    }
 
-        /*
-         * This octree node must propagate the node capacity
-         * parameter to its children from top to bottom.
-         */
-        params.node_capacity = capacity_;
+    /**
+     * @brief
+     * Insert one element in this node subtree, concurrently with other calls to
+     * concurrent_insert and concurrent_visit_range using the same lock table.
+     * Full nodes are traversed without locking through their published children,
+     * and only the node receiving the element is locked, so insertions in
+     * different parts of the octree do not wait on each other. To keep writers
+     * from contending on the top nodes, the subtree statistics of the nodes above
+     * the inserted element are marked stale instead of being updated.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param element Element to insert
+     * @param point_view The point view property map
+     * @param locks The lock table guarding this node subtree
+     * @return True if element was inserted
+     */
+    template <class PointViewMap>
+    bool concurrent_insert(
+        element_type const& element,
+        PointViewMap const& point_view,
+        shared_lock_table_t const& locks)
+    {
+        static_assert(
+            !subdivides_lazily_v<params_type>,
+            "Lazily subdivided octrees do not support concurrent insertion");
 
-        /*
-         * Creating a child octree node implies having moved
-         * down a level in the tree. To propagate this information,
-         * we simply assign a value for the max depth of the
-         * created child to be 1 less than this octree node's
-         * max depth. By doing so, if we wanted a max depth of
-         * 2 for this octree node, for example, then the created
-         * child node will have a max depth of 1. Looking at the
-         * "if (max_depth_ == 1u)" check at the start of the insertion,
-         * we see that at that moment, we will not create any
-         * child octree nodes anymore, but instead append points to
-         * the octree's leaf nodes' list of points.
-         *
-         * If we wanted a max depth of 3, then the root octree node's
-         * children will have a max depth of 3 -1 = 2. Then, each
-         * child's children will have a max depth of 2 -1 = 1, at
-         * which point we will have reached the desired 3-level
-         * octree form that was initially specified.
-         *
-         * This works for any initial max depth > 0.
-         */
-        params.max_depth = max_depth_ - std::uint8_t{1u};
+        auto const p = point_view(element);
+        if (!voxel_grid_.contains(p))
+            return false;
 
-        params.voxel_grid.min.x(octants_bitmask & 0b100 ? center.x() : voxel_grid_.min.x());
-        params.voxel_grid.max.x(octants_bitmask & 0b100 ? voxel_grid_.max.x() : center.x());
+        self_type* node = this;
+        while (true)
+        {
+            auto const center         = node->voxel_grid_.center();
+            std::uint8_t octant_index = 0b000;
+            if (p.x() > center.x())
+                octant_index |= 0b100;
+            if (p.y() > center.y())
+                octant_index |= 0b010;
+            if (p.z() > center.z())
+                octant_index |= 0b001;
 
-        params.voxel_grid.min.y(octants_bitmask & 0b010 ? center.y() : voxel_grid_.min.y());
-        params.voxel_grid.max.y(octants_bitmask & 0b010 ? voxel_grid_.max.y() : center.y());
+            /*
+             * A published child is never modified nor released during
+             * concurrent insertions, and its parent stays full, so it
+             * can be reached without locking its parent. This is the
+             * common case once the top levels of the octree have
+             * filled up, and it keeps writers from contending on the
+             * locks of the top nodes.
+             */
+            std::uint8_t const octant_bit = static_cast<std::uint8_t>(1u << octant_index);
+            if (node->published_octants_.load(std::memory_order_acquire) & octant_bit)
+            {
+                if (self_type* const child = node->octants_[octant_index].get())
+                {
+                    node->mark_statistics_stale();
+                    node = child;
+                    continue;
+                }
+            }
 
-        params.voxel_grid.min.z(octants_bitmask & 0b001 ? center.z() : voxel_grid_.min.z());
-        params.voxel_grid.max.z(octants_bitmask & 0b001 ? voxel_grid_.max.z() : center.z());
+            /*
+             * Otherwise, the element is either stored in this node, or
+             * this node is full and the element goes to a child octant,
+             * which is created if needed and published for the next
+             * insertions.
+             */
+            std::unique_lock<std::shared_mutex> lock(locks.mutex_of(node));
+            bool const is_full =
+                node->max_depth_ > 1u && node->elements_.size() >= node->capacity_;
+            if (!is_full)
+            {
+                node->elements_.push_back(element);
+                ++node->subtree_size_;
+                if constexpr (stores_coordinate_sums_v<params_type>)
+                    add_coordinates(node->coordinate_sums_.sum, p);
+                return true;
+            }
 
-        octant = std::make_unique<self_type>(params);
-        return octant->insert(element, point_view);
+            auto& octant = node->octants_[octant_index];
+            if (!octant)
+                octant = node->make_octant(octant_index);
+
+            node->published_octants_.fetch_or(octant_bit, std::memory_order_release);
+            node->mark_statistics_stale();
+            node = octant.get();
+        }
     }
 
     /**
@@ -351,6 +770,7 @@ class basic_linked_octree_node_t
             return const_iterator{};
 
         iterator it{};
+        it.bucket_.root_ = const_cast<self_type*>(this);
         return this->do_find(element, it, point_view);
     }
 
@@ -369,7 +789,7 @@ class basic_linked_octree_node_t
          * Get the octree node that the iterator currently
          * resides in.
          */
-        self_type* octree_node = const_cast<self_type*>(next.octree_node_);
+        self_type* octree_node = next.bucket_.octree_node_;
 
         /*
          * If the point to erase actually exists, then
@@ -377,17 +797,26 @@ class basic_linked_octree_node_t
          * the next point in the sequence.
          */
         if (next.it_ != octree_node->elements_.cend())
-            const_cast<decltype(next.it_)&>(next.it_) = octree_node->elements_.erase(it.it_);
+        {
+            next.it_ = octree_node->elements_.erase(it.it_);
+            for (self_type* node = octree_node; node != nullptr; node = node->parent_)
+                node->uncount_element();
+        }
 
         /*
          * If after erasing the point, we still have other
          * points in this node, then simply return the next
          * iterator which already resides in the right octree
          * node and which already points to the next point in
-         * the sequence.
+         * the sequence, unless we erased the node's last point.
          */
         if (!octree_node->elements_.empty())
+        {
+            if (next.it_ == octree_node->elements_.end())
+                next.move_to_next_node();
+
             return next;
+        }
 
         /*
          * If this is an internal node, then it will succeed in
@@ -404,7 +833,7 @@ class basic_linked_octree_node_t
          * (which happens to be a leaf node) and there
          * are no points left.
          */
-        if (next.ancestor_octree_nodes_.empty())
+        if (octree_node == next.bucket_.root_)
         {
             return const_iterator{};
         }
@@ -414,7 +843,7 @@ class basic_linked_octree_node_t
          * to the next node, and we remove this leaf from its parent
          * since the leaf is empty.
          */
-        auto* parent = const_cast<self_type*>(next.ancestor_octree_nodes_.top());
+        auto* parent = octree_node->parent_;
 
         /*
          * Move the iterator to the next point before we change the structure
@@ -424,245 +853,2229 @@ class basic_linked_octree_node_t
          */
         next.move_to_next_node();
 
-        auto const is_same_octant =
-            [octree_node](std::unique_ptr<self_type> const& octant) -> bool {
-            return octant.get() == octree_node;
-        };
-
         /*
-         * Find the leaf and release/delete it.
+         * Release/delete the leaf.
          */
-        auto octant_it =
-            std::find_if(parent->octants_.begin(), parent->octants_.end(), is_same_octant);
-        octant_it->reset();
+        parent->release_octant(octree_node->octant_index_);
 
         return next;
     }
 
     /**
      * @brief
-     * KNN search
-     * @tparam TPointView Type satisfying PointView concept
+     * Removes all elements satisfying a predicate from this node subtree in one
+     * postorder traversal. Children left empty are destroyed, subtrees left with
+     * no more elements than the node capacity are collapsed into their root, and
+     * element buffers left mostly empty are shrunk. The subtree statistics are
+     * recomputed along the way, so they are up to date afterwards.
+     * @tparam Predicate Callable type taking an element_type const& and returning bool
      * @tparam PointViewMap Type satisfying PointViewMap concept
-     * @param target Position around which we want to find the k nearest neighbours
-     * @param k Number of nearest neighbours to query
+     * @param pred The predicate selecting the elements to remove
      * @param point_view The point view property map
-     * @param eps The error tolerance for floating point equality
-     * @return The k nearest neighbours
+     * @return Number of elements removed
      */
-    template <class TPointView, class PointViewMap>
-    std::vector<element_type> nearest_neighbours(
-        TPointView const& target,
-        std::size_t k,
-        PointViewMap const& point_view,
-        double const eps = 1e-5) const
+    template <class Predicate, class PointViewMap>
+    std::size_t erase_if(Predicate& pred, PointViewMap const& point_view)
     {
-        using point_view_type =
-            typename traits::property_map_traits<PointViewMap, Element>::value_type;
-        using coordinate_type = typename point_view_type::coordinate_type;
-
-        if (k <= 0u)
-            return {};
-
-        struct min_heap_node_t
+        std::size_t num_erased = 0u;
+        for (std::uint8_t i = 0u; i < octants_.size(); ++i)
         {
-            element_type const* e = nullptr;
-            self_type const* o    = nullptr;
-            bool is_point         = false;
-        };
-
-        /*
-         * This predicate defines our priority queue to be a min-heap, that
-         * is to say that the priority queue is a heap in which the top element
-         * is the point/octant of this octree nearest to the reference point p.
-         */
-        auto const greater = [&](min_heap_node_t const& h1, min_heap_node_t const& h2) -> bool {
-            aabb_point_type const p1 = h1.is_point ? aabb_point_type(point_view(*h1.e)) :
-                                                     h1.o->voxel_grid_.nearest_point_from(target);
-            aabb_point_type const p2 = h2.is_point ? aabb_point_type(point_view(*h2.e)) :
-                                                     h2.o->voxel_grid_.nearest_point_from(target);
+            auto& octree_child_node = octants_[i];
+            if (!octree_child_node)
+                continue;
 
-            auto const d1 = common::squared_distance(target, p1);
-            auto const d2 = common::squared_distance(target, p2);
+            num_erased += octree_child_node->erase_if(pred, point_view);
+            if (octree_child_node->subtree_size_ == 0u)
+                release_octant(i);
+        }
 
-            return d1 > d2;
-        };
+        auto const last =
+            std::remove_if(elements_.begin(), elements_.end(), [&pred](element_type const& e) {
+                return static_cast<bool>(pred(e));
+            });
+        num_erased += static_cast<std::size_t>(std::distance(last, elements_.end()));
+        elements_.erase(last, elements_.end());
 
-        /*
-         * This min heap holds points or octants. The trick is that when the
-         * top element of the min heap is a point, we know that this point
-         * is the closest one to the reference point, because no other point
-         * in all of the other octants could be closer. In other words, if
-         * there was a point in any of the octants in the min heap that was
-         * the closest to the reference point, the top element of the min
-         * heap would be an octant, not a point.
-         *
-         * Since we start adding elements to the min heap starting from the
-         * root of the octree, we know that the octants fill up all the
-         * space in the octree. Hence, there is no subset of the voxel grid
-         * that will not have been considered in this algorithm.
-         */
-        using min_heap_t =
-            std::priority_queue<min_heap_node_t, std::vector<min_heap_node_t>, decltype(greater)>;
-        min_heap_t min_heap(greater);
+        update_statistics(point_view);
 
         /*
-         * Add the root octree node to the heap
+         * A subtree whose elements fit in its root is collapsed,
+         * just like erase destroys a child once it is empty.
          */
-        min_heap.push(min_heap_node_t{nullptr, this, false});
+        if (subtree_size_ <= capacity_)
+            collapse_octants();
 
-        std::vector<element_type> knearest_points{};
-        // we only need up to k elements, so we can reserve the memory upfront
-        knearest_points.reserve(k);
+        shrink_elements();
+        if (elements_.size() <= capacity_)
+            has_pending_elements_.store(false, std::memory_order_relaxed);
 
-        /*
-         * We continue searching for nearest neighbours until we have
-         * k nearest neighbors, or until we have visited every single
-         * point contained in this octree. Basically, continue searching
-         * if we have less than k nearest neighbours and the min heap
-         * still hasn't been exhausted.
-         */
-        while (knearest_points.size() < k && !min_heap.empty())
-        {
-            min_heap_node_t heap_node = min_heap.top();
-            min_heap.pop();
+        return num_erased;
+    }
+
+    /**
+     * @brief
+     * Moves an element of this node subtree to a new position. The element is
+     * searched for along the path of its old position. Elements referring to
+     * a point, such as point views, are identified by the address of that
+     * point, so that elements at coinciding positions are told apart. Other
+     * elements, or referring elements which are not found, are identified by
+     * their old position, or by their new position if no element is at the
+     * old one, so that they may be stored by value or refer to a point that
+     * has already moved. An element staying in the voxel of its node is
+     * overwritten in place. Otherwise, it is removed from its node and inserted
+     * again from its nearest ancestor containing its new position, so that only
+     * the nodes between them are restructured. An element leaving this node's
+     * voxel grid is removed. Finding the element scans the buckets along its
+     * path, so an update costs a descent from this node, not constant time.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param element The element at its new position
+     * @param old_position Position of the element when it was last inserted or updated
+     * @param point_view The point view property map
+     * @return True if the element was found
+     */
+    template <class TPointView, class PointViewMap>
+    bool update(
+        element_type const& element,
+        TPointView const& old_position,
+        PointViewMap const& point_view)
+    {
+        if (!voxel_grid_.contains(old_position))
+            return false;
+
+        auto const new_position = point_view(element);
+
+        self_type* node = nullptr;
+        auto target     = elements_.end();
+        auto const find_along_path = [&](auto const& is_element) {
+            node   = this;
+            target = std::find_if(node->elements_.begin(), node->elements_.end(), is_element);
+            while (target == node->elements_.end())
+            {
+                auto const center             = node->voxel_grid_.center();
+                std::uint64_t octants_bitmask = 0b000;
+                if (old_position.x() > center.x())
+                    octants_bitmask |= 0b100;
+                if (old_position.y() > center.y())
+                    octants_bitmask |= 0b010;
+                if (old_position.z() > center.z())
+                    octants_bitmask |= 0b001;
+
+                auto const& octant = node->octants_[octants_bitmask];
+                if (!octant)
+                    return false;
+
+                node   = octant.get();
+                target = std::find_if(node->elements_.begin(), node->elements_.end(), is_element);
+            }
+            return true;
+        };
+
+        /*
+         * An element found at its new position may be another element
+         * already sitting there, so the new position is only tried once
+         * the whole path has been searched for the old one.
+         */
+        bool is_found = false;
+        if constexpr (traits::has_point_address_v<element_type>)
+            is_found = find_along_path(
+                [&](element_type const& e) { return e.point() == element.point(); });
+
+        if (!is_found)
+            is_found = find_along_path([&](element_type const& e) {
+                return common::are_vectors_equal(point_view(e), old_position);
+            });
+
+        if (!is_found)
+            is_found = find_along_path([&](element_type const& e) {
+                return common::are_vectors_equal(point_view(e), new_position);
+            });
+
+        if (!is_found)
+            return false;
+
+        /*
+         * The subtree sizes of the nodes containing both positions
+         * do not change, only their coordinate sums do.
+         */
+        self_type* ancestor = node;
+        while (ancestor != nullptr && !ancestor->voxel_grid_.contains(new_position))
+            ancestor = ancestor->parent_;
+
+        if (ancestor == node)
+        {
+            *target = element;
+            for (self_type* n = node; n != nullptr; n = n->parent_)
+                n->move_coordinates(old_position, new_position);
+            return true;
+        }
+
+        node->elements_.erase(target);
+        for (self_type* n = node; n != ancestor; n = n->parent_)
+            n->uncount_element(old_position);
+        for (self_type* n = ancestor; n != nullptr; n = n->parent_)
+            n->move_coordinates(old_position, new_position);
+
+        /*
+         * Leaves emptied by the removal are destroyed, up to the
+         * ancestor which receives the element.
+         */
+        auto const is_empty_leaf = [](self_type const* n) {
+            return n->elements_.empty() &&
+                   std::none_of(n->octants_.begin(), n->octants_.end(), [](auto const& o) {
+                       return static_cast<bool>(o);
+                   });
+        };
+        while (node != ancestor && node != this && is_empty_leaf(node))
+        {
+            auto* parent = node->parent_;
+            parent->release_octant(node->octant_index_);
+            node = parent;
+        }
+
+        if (ancestor == nullptr)
+            return true;
+
+        /*
+         * The ancestor's statistics already account for the element
+         * at its new position, which insert would count again.
+         */
+        --ancestor->subtree_size_;
+        if constexpr (stores_coordinate_sums_v<params_type>)
+            subtract_coordinates(ancestor->coordinate_sums_.sum, new_position);
+
+        ancestor->insert(element, point_view);
+        return true;
+    }
+
+    /**
+     * @brief
+     * Moves the elements of this node subtree whose position has changed to
+     * the nodes containing their new position, in one postorder traversal.
+     * Elements still in the voxel of their node stay where they are. Elements
+     * leaving the voxel of a node are handed to its parent, which inserts them
+     * again if its voxel contains them, or hands them to its own parent. The
+     * subtree statistics are recomputed along the way.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param point_view The point view property map
+     * @param escaped Receives the elements that left this node's voxel grid
+     * @return Number of elements that changed node, including the escaped ones
+     */
+    template <class PointViewMap>
+    std::size_t refit(PointViewMap const& point_view, elements_type& escaped)
+    {
+        std::size_t num_moved = 0u;
+        elements_type arrived(elements_.get_allocator());
+        for (auto const& octree_child_node : octants_)
+            if (octree_child_node)
+                num_moved += octree_child_node->refit(point_view, arrived);
+
+        auto const first_escaped =
+            std::partition(elements_.begin(), elements_.end(), [&](element_type const& e) {
+                return voxel_grid_.contains(point_view(e));
+            });
+        num_moved += static_cast<std::size_t>(std::distance(first_escaped, elements_.end()));
+        std::move(first_escaped, elements_.end(), std::back_inserter(escaped));
+        elements_.erase(first_escaped, elements_.end());
+
+        for (auto const& e : arrived)
+        {
+            if (voxel_grid_.contains(point_view(e)))
+                insert(e, point_view);
+            else
+                escaped.push_back(e);
+        }
+
+        for (std::uint8_t i = 0u; i < octants_.size(); ++i)
+            if (octants_[i] && octants_[i]->subtree_size_ == 0u)
+                release_octant(i);
+
+        update_statistics(point_view);
+        if constexpr (subdivides_lazily_v<params_type>)
+            has_pending_elements_.store(
+                max_depth_ > 1u && elements_.size() > capacity_,
+                std::memory_order_relaxed);
+
+        return num_moved;
+    }
+
+    /**
+     * @brief
+     * KNN search. Octants are visited best-first and pruned against
+     * the current k-th nearest neighbour.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param eps The error tolerance for floating point equality
+     * @return The k nearest neighbours
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        double const eps = 1e-5) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+
+        std::vector<element_type> knearest_points{};
+        knearest_points.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_points.push_back(*neighbour.element);
+
+        return knearest_points;
+    }
+
+    /**
+     * @brief
+     * KNN search writing (element, squared distance) pairs to out, from nearest
+     * to furthest. The search's heaps are stored in the caller-provided scratch
+     * object, so no allocation happens once the scratch has grown large enough.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam OutputIter Output iterator accepting neighbour_type values
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param scratch Reusable storage for the search, one per thread
+     * @param out Output iterator to the neighbours
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_t& scratch,
+        OutputIter out,
+        double const eps = 1e-5) const
+    {
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /**
+     * @brief
+     * Approximate KNN search. The best-first search of nearest_neighbours
+     * prunes octants further than the k-th nearest neighbour divided by
+     * (1 + approximation.epsilon), and stops after visiting
+     * approximation.max_visited_leaves leaves.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param approximation The approximation settings
+     * @param eps The error tolerance for floating point equality
+     * @return At most k approximate nearest neighbours, from nearest to furthest
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> approximate_nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        approximate_knn_parameters_t const& approximation,
+        double const eps = 1e-5) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps, approximation);
+
+        std::vector<element_type> knearest_points{};
+        knearest_points.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_points.push_back(*neighbour.element);
+
+        return knearest_points;
+    }
+
+    /**
+     * @brief
+     * Approximate KNN search writing (element, squared distance) pairs to out,
+     * from nearest to furthest, using the caller-provided scratch storage
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam OutputIter Output iterator accepting neighbour_type values
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param approximation The approximation settings
+     * @param scratch Reusable storage for the search, one per thread
+     * @param out Output iterator to the neighbours
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter approximate_nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        approximate_knn_parameters_t const& approximation,
+        knn_scratch_t& scratch,
+        OutputIter out,
+        double const eps = 1e-5) const
+    {
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps, approximation);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /**
+     * @brief
+     * Hybrid KNN and radius search, returning at most k neighbours within a
+     * radius of the target. The best-first search of nearest_neighbours
+     * starts with the squared radius as its pruning bound, so octants are
+     * pruned against the nearer of the radius and the k-th nearest neighbour.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Maximum number of nearest neighbours to query
+     * @param radius Maximum distance of the neighbours to the target
+     * @param point_view The point view property map
+     * @param eps The error tolerance for floating point equality
+     * @return At most k neighbours within the radius, from nearest to furthest
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> radius_nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        typename knn_scratch_t::scalar_type const radius,
+        PointViewMap const& point_view,
+        double const eps = 1e-5) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours =
+            knn_search(target, k, point_view, scratch, eps, {}, radius * radius);
+
+        std::vector<element_type> knearest_points{};
+        knearest_points.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_points.push_back(*neighbour.element);
+
+        return knearest_points;
+    }
+
+    /**
+     * @brief
+     * Hybrid KNN and radius search writing (element, squared distance) pairs
+     * to out, from nearest to furthest, using the caller-provided scratch storage
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam OutputIter Output iterator accepting neighbour_type values
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Maximum number of nearest neighbours to query
+     * @param radius Maximum distance of the neighbours to the target
+     * @param point_view The point view property map
+     * @param scratch Reusable storage for the search, one per thread
+     * @param out Output iterator to the neighbours
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter radius_nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        typename knn_scratch_t::scalar_type const radius,
+        PointViewMap const& point_view,
+        knn_scratch_t& scratch,
+        OutputIter out,
+        double const eps = 1e-5) const
+    {
+        auto const& neighbours =
+            knn_search(target, k, point_view, scratch, eps, {}, radius * radius);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /**
+     * @brief
+     * Lazy range of the elements from nearest to furthest from a target
+     * (distance browsing). Octants share the search's min-heap with the
+     * elements and are only expanded once no element is nearer, so that
+     * stopping the iteration early skips the rest of the search. The
+     * octree must not be modified while the range is in use.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the nearest neighbours
+     * @param point_view The point view property map, copied into the range
+     * @param eps The error tolerance for floating point equality
+     * @return Input range of (element pointer, squared distance) pairs
+     */
+    template <class TPointView, class PointViewMap>
+    auto incremental_nearest_neighbours(
+        TPointView const& target,
+        PointViewMap const& point_view,
+        double const eps = 1e-5) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+        using coordinate_type = typename point_view_type::coordinate_type;
+        using scalar_type     = typename knn_scratch_t::scalar_type;
+
+        auto expand = [target, point_view, eps](self_type const* const& octant, auto& neighbours) {
+            octant->subdivide_pending_elements(point_view);
+
+            for (auto const& e : octant->elements_)
+            {
+                auto const p = point_view(e);
+                if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+                    continue;
+
+                neighbours.push_element(std::addressof(e), common::squared_distance(target, p));
+            }
+
+            for (auto const& octree_child_node : octant->octants_)
+            {
+                if (!octree_child_node)
+                    continue;
+
+                auto const d = common::squared_distance(
+                    target,
+                    octree_child_node->voxel_grid_.nearest_point_from(target));
+                neighbours.push_node(octree_child_node.get(), d);
+            }
+        };
+
+        using neighbours_type = incremental_nearest_neighbours_t<
+            element_type const*,
+            self_type const*,
+            scalar_type,
+            decltype(expand)>;
+        return neighbours_type(
+            this,
+            common::squared_distance(target, voxel_grid_.nearest_point_from(target)),
+            std::move(expand));
+    }
+
+    /**
+     * @brief
+     * KNN search for a batch of targets. The targets are sorted in Morton order
+     * and split into chunks of consecutive targets, which are searched concurrently.
+     * Within a chunk, the previous target's neighbours bound the distance to the
+     * next target's k-th nearest neighbour, so that each search starts with most
+     * of the octree already pruned when consecutive targets are close.
+     * @tparam ExecutionPolicy Type of STL execution policy
+     * @tparam RandomAccessIter Type of iterator to the targets, satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam OutputIter Random access iterator to sequence containers of element_type
+     * @param policy The execution policy
+     * @param first Begin iterator to the targets
+     * @param last End iterator to the targets
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param out Iterator to the containers receiving each target's k nearest
+     * neighbours, from nearest to furthest, in the order of the targets
+     * @param eps The error tolerance for floating point equality
+     */
+    template <class ExecutionPolicy, class RandomAccessIter, class PointViewMap, class OutputIter>
+    void batch_nearest_neighbours(
+        ExecutionPolicy&& policy,
+        RandomAccessIter first,
+        RandomAccessIter last,
+        std::size_t k,
+        PointViewMap const& point_view,
+        OutputIter out,
+        double const eps = 1e-5) const
+    {
+        using scalar_type = typename knn_scratch_t::scalar_type;
+
+        auto const num_targets = static_cast<std::size_t>(std::distance(first, last));
+
+        /*
+         * Targets outside of the octree's voxel grid are clamped to
+         * its boundary, which only affects their scheduling.
+         */
+        std::vector<std::uint64_t> codes(num_targets);
+        std::transform(policy, first, last, codes.begin(), [this](auto const& target) {
+            auto constexpr bits = morton::bits_per_dimension_v<3u>;
+            auto const& min     = voxel_grid_.min;
+            auto const& max     = voxel_grid_.max;
+            return morton::encode(
+                morton::quantize<scalar_type>(target.x(), min.x(), max.x(), bits),
+                morton::quantize<scalar_type>(target.y(), min.y(), max.y(), bits),
+                morton::quantize<scalar_type>(target.z(), min.z(), max.z(), bits));
+        });
+        auto const order = morton::sorted_order(policy, codes);
+
+        std::vector<std::size_t> chunks(
+            (num_targets + knn_batch_chunk_size - 1u) / knn_batch_chunk_size);
+        std::iota(chunks.begin(), chunks.end(), std::size_t{0u});
+        std::for_each(policy, chunks.begin(), chunks.end(), [&](std::size_t chunk) {
+            auto const chunk_begin = chunk * knn_batch_chunk_size;
+            auto const chunk_end   = std::min(chunk_begin + knn_batch_chunk_size, num_targets);
+
+            knn_scratch_t scratch;
+            typename knn_scratch_t::neighbours_type const* previous_neighbours = nullptr;
+            for (auto i = chunk_begin; i < chunk_end; ++i)
+            {
+                auto const target_index = order[i];
+                auto const& target      = first[static_cast<std::ptrdiff_t>(target_index)];
+                auto const max_squared_distance =
+                    previous_neighbours == nullptr ?
+                        std::numeric_limits<scalar_type>::max() :
+                        knn_bound_from(*previous_neighbours, target, k, point_view, eps);
+
+                auto const& neighbours =
+                    knn_search(target, k, point_view, scratch, eps, {}, max_squared_distance);
+                previous_neighbours = std::addressof(neighbours);
+
+                auto& knearest_points = out[static_cast<std::ptrdiff_t>(target_index)];
+                knearest_points.clear();
+                for (auto const& neighbour : neighbours)
+                    knearest_points.push_back(*neighbour.element);
+            }
+        });
+    }
+
+    /**
+     * @brief
+     * Range search running concurrently with calls to concurrent_insert using
+     * the same lock table. Each node is locked in shared mode while its elements
+     * in the range are copied, and the visitor is called on the copies once the
+     * node is unlocked, so that the visitor may insert elements in this octree
+     * and does not hold off writers.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam Visitor Callable type taking an element_type const&
+     * @param range The range in which we want to find points
+     * @param point_view The point view property map
+     * @param visitor Callback on the elements found to be in the range
+     * @param locks The lock table guarding this node subtree
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void concurrent_visit_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        Visitor&& visitor,
+        shared_lock_table_t const& locks) const
+    {
+        auto const overlap = intersections::classify(voxel_grid_, range);
+        if (overlap == intersections::overlap_t::disjoint)
+            return;
+
+        bool const is_contained = overlap == intersections::overlap_t::contained;
+        std::vector<element_type> elements_in_range;
+        concurrent_visit_range(range, point_view, visitor, locks, elements_in_range, is_contained);
+    }
+
+    /**
+     * @brief
+     * Range search
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param range The range in which we want to find points
+     * @param elements_in_range The elements found to be in the range
+     * @param point_view The point view property map
+     */
+    template <class Range, class PointViewMap>
+    void range_search(
+        Range const& range,
+        std::vector<element_type>& elements_in_range,
+        PointViewMap const& point_view) const
+    {
+        visit_range(range, point_view, [&elements_in_range](element_type const& e) {
+            elements_in_range.push_back(e);
+        });
+    }
+
+    /**
+     * @brief
+     * Range search calling visitor on every element found in the range
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam Visitor Callable type taking an element_type const&
+     * @param range The range in which we want to find points
+     * @param point_view The point view property map
+     * @param visitor Callback on the elements found to be in the range
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void visit_range(Range const& range, PointViewMap const& point_view, Visitor&& visitor) const
+    {
+        auto const visit_contained_subtree = [&](self_type const& node) {
+            node.visit_subtree(visitor, point_view);
+        };
+        query_range(range, point_view, visitor, visit_contained_subtree);
+    }
+
+    /**
+     * @brief
+     * Lazy range search. The octree is searched depth-first as the returned
+     * range is iterated, so that the search stops when the iteration stops.
+     * The octree must not be modified while the range is in use.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param range The range in which we want to find points, copied into the returned range
+     * @param point_view The point view property map, copied into the returned range
+     * @return Input range of the elements found in the range
+     */
+    template <class Range, class PointViewMap>
+    auto lazy_range_search(Range const& range, PointViewMap const& point_view) const
+    {
+        struct subtree_t
+        {
+            self_type const* node;
+            bool is_contained;
+        };
+
+        /*
+         * Subtrees are classified against the range when they are searched,
+         * and the elements of subtrees contained in the range are reported
+         * without testing them.
+         */
+        auto expand = [range, point_view](subtree_t const& subtree, auto& elements) {
+            self_type const* node = subtree.node;
+            bool is_contained     = subtree.is_contained;
+            if (!is_contained)
+            {
+                auto const overlap = intersections::classify(node->voxel_grid_, range);
+                if (overlap == intersections::overlap_t::disjoint)
+                    return;
+
+                is_contained = overlap == intersections::overlap_t::contained;
+            }
+
+            node->subdivide_pending_elements(point_view);
+
+            for (auto const& e : node->elements_)
+                if (is_contained || range.contains(point_view(e)))
+                    elements.push_element(e);
+
+            for (auto const& octree_child_node : node->octants_)
+                if (octree_child_node)
+                    elements.push_node(subtree_t{octree_child_node.get(), is_contained});
+        };
+
+        using elements_type = lazy_range_search_t<element_type, subtree_t, decltype(expand)>;
+        return elements_type(subtree_t{this, false}, std::move(expand));
+    }
+
+    /**
+     * @brief
+     * Counts the elements in a range without visiting the elements of
+     * subtrees contained in the range
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param range The range in which we want to count points
+     * @param point_view The point view property map
+     * @return Number of elements in the range
+     */
+    template <class Range, class PointViewMap>
+    std::size_t range_count(Range const& range, PointViewMap const& point_view) const
+    {
+        std::size_t count = 0u;
+        auto const count_element = [&count](element_type const&) {
+            ++count;
+        };
+        auto const count_contained_subtree = [&count](self_type const& node) {
+            count += node.count_subtree();
+        };
+        query_range(range, point_view, count_element, count_contained_subtree);
+        return count;
+    }
+
+    /**
+     * @brief
+     * Number and coordinate sum of the elements in a range. With octree parameters
+     * storing coordinate sums, the elements of subtrees contained in the range are
+     * not visited.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param range The range in which we want to aggregate points
+     * @param point_view The point view property map
+     * @return Aggregate of the elements in the range
+     */
+    template <class Range, class PointViewMap>
+    range_aggregate_type range_aggregate(Range const& range, PointViewMap const& point_view) const
+    {
+        /*
+         * Coordinates are accumulated in double precision, since float sums
+         * over millions of elements lose several significant digits.
+         */
+        range_aggregate_type aggregate{};
+        coordinate_sum_type sum{0., 0., 0.};
+        auto const aggregate_element = [&](element_type const& e) {
+            ++aggregate.count;
+            add_coordinates(sum, point_view(e));
+        };
+        auto const aggregate_contained_subtree = [&](self_type const& node) {
+            node.aggregate_subtree(aggregate.count, sum, point_view);
+        };
+        query_range(range, point_view, aggregate_element, aggregate_contained_subtree);
+
+        using coordinate_type = typename range_aggregate_type::coordinate_type;
+        aggregate.coordinate_sum = aabb_point_type{
+            static_cast<coordinate_type>(sum.x()),
+            static_cast<coordinate_type>(sum.y()),
+            static_cast<coordinate_type>(sum.z())};
+        return aggregate;
+    }
+
+    /**
+     * @brief
+     * Ray casting. Finds the element nearest to the ray's origin along the ray,
+     * among the elements within a distance radius of the ray. Octants are
+     * visited front to back, in order of the parameter where the ray enters
+     * them once grown by the radius, so that the search stops at the first
+     * octant which the ray enters behind the nearest hit.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam Vector3d Type satisfying Vector3d concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param origin The ray's origin
+     * @param direction The ray's direction, which need not be normalized
+     * @param radius Maximum distance from the ray to a hit element
+     * @param point_view The point view property map
+     * @return The hit element, or no element if the ray misses every element
+     */
+    template <class TPointView, class Vector3d, class PointViewMap>
+    std::optional<element_type> ray_cast(
+        TPointView const& origin,
+        Vector3d const& direction,
+        typename knn_scratch_t::scalar_type radius,
+        PointViewMap const& point_view) const
+    {
+        using scalar_type        = typename knn_scratch_t::scalar_type;
+        using octant_heap_node_t = typename knn_scratch_t::octant_heap_node_type;
+
+        auto const dx     = static_cast<scalar_type>(direction.x());
+        auto const dy     = static_cast<scalar_type>(direction.y());
+        auto const dz     = static_cast<scalar_type>(direction.z());
+        auto const length = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (!(length > static_cast<scalar_type>(0)))
+            return {};
+
+        aabb_point_type const o{
+            static_cast<scalar_type>(origin.x()),
+            static_cast<scalar_type>(origin.y()),
+            static_cast<scalar_type>(origin.z())};
+        aabb_point_type const d{dx / length, dy / length, dz / length};
+
+        element_type const* hit = nullptr;
+        scalar_type hit_t       = std::numeric_limits<scalar_type>::max();
+
+        /*
+         * An element within the radius of the ray at parameter t lies in the
+         * cube of half side radius around the ray's point at t, so the ray
+         * enters the element's octant grown by the radius before t.
+         */
+        auto const entry_parameter = [&](aabb_type const& voxel, scalar_type& t_entry) {
+            aabb_type const grown_voxel{
+                aabb_point_type{
+                    voxel.min.x() - radius,
+                    voxel.min.y() - radius,
+                    voxel.min.z() - radius},
+                aabb_point_type{
+                    voxel.max.x() + radius,
+                    voxel.max.y() + radius,
+                    voxel.max.z() + radius}};
+
+            t_entry            = static_cast<scalar_type>(0);
+            scalar_type t_exit = hit_t;
+            return intersections::intersects_ray(grown_voxel, o, d, t_entry, t_exit);
+        };
+
+        auto const greater = [](octant_heap_node_t const& h1, octant_heap_node_t const& h2) {
+            return h2 < h1;
+        };
+
+        std::vector<octant_heap_node_t> octants;
+        scalar_type t_entry{};
+        if (entry_parameter(voxel_grid_, t_entry))
+            octants.push_back(octant_heap_node_t{this, t_entry});
+
+        while (!octants.empty())
+        {
+            std::pop_heap(octants.begin(), octants.end(), greater);
+            auto const [octant, octant_t_entry] = octants.back();
+            octants.pop_back();
+
+            if (octant_t_entry > hit_t)
+                break;
+
+            octant->subdivide_pending_elements(point_view);
+
+            for (auto const& e : octant->elements_)
+            {
+                auto const p  = point_view(e);
+                auto const vx = static_cast<scalar_type>(p.x()) - o.x();
+                auto const vy = static_cast<scalar_type>(p.y()) - o.y();
+                auto const vz = static_cast<scalar_type>(p.z()) - o.z();
+                auto const t  = vx * d.x() + vy * d.y() + vz * d.z();
+                if (t < static_cast<scalar_type>(0) || t >= hit_t)
+                    continue;
+
+                auto const squared_distance_to_ray = vx * vx + vy * vy + vz * vz - t * t;
+                if (squared_distance_to_ray > radius * radius)
+                    continue;
+
+                hit   = std::addressof(e);
+                hit_t = t;
+            }
+
+            for (auto const& octree_child_node : octant->octants_)
+            {
+                if (!octree_child_node)
+                    continue;
+
+                if (!entry_parameter(octree_child_node->voxel_grid_, t_entry))
+                    continue;
+
+                octants.push_back(octant_heap_node_t{octree_child_node.get(), t_entry});
+                std::push_heap(octants.begin(), octants.end(), greater);
+            }
+        }
+
+        if (hit == nullptr)
+            return {};
+
+        return *hit;
+    }
+
+    /**
+     * @brief
+     * Frustum culling. Calls visitor on the elements inside a convex volume
+     * bounded by planes, such as a view frustum. Octants contained in the volume
+     * are visited without testing their elements, and octants are visited front
+     * to back, in order of their distance to the first plane, which should be
+     * the near plane of a view frustum.
+     * @tparam Planes Range of planes whose normals point inside the volume
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam Visitor Callable type taking an element_type const&
+     * @param planes The planes bounding the volume
+     * @param point_view The point view property map
+     * @param visitor Callback on the elements found to be in the volume
+     */
+    template <class Planes, class PointViewMap, class Visitor>
+    void visit_frustum(
+        Planes const& planes,
+        PointViewMap const& point_view,
+        Visitor&& visitor) const
+    {
+        auto const overlap = intersections::classify_against_planes(voxel_grid_, planes);
+        if (overlap == intersections::overlap_t::disjoint)
+            return;
+
+        visit_frustum_subtree(
+            planes,
+            overlap == intersections::overlap_t::contained,
+            point_view,
+            visitor);
+    }
+
+    /**
+     * @brief
+     * Selects the level-of-detail representatives of this node's subtree in one
+     * bottom-up pass. A node's representatives are taken in turns from each of
+     * its children's representatives and from its own elements, so that they
+     * are spread over the node's octants. Representatives are copies of the
+     * elements, which are not updated by later modifications of the octree.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void build_representatives(PointViewMap const& point_view)
+    {
+        static_assert(
+            stores_representatives_v<params_type>,
+            "Octree parameters must request level-of-detail representatives");
+
+        subdivide_pending_elements(point_view);
+
+        std::array<std::vector<element_type> const*, 8u> sources{};
+        std::size_t sources_count = 0u;
+        for (auto const& octree_child_node : octants_)
+        {
+            if (!octree_child_node)
+                continue;
+
+            octree_child_node->build_representatives(point_view);
+            sources[sources_count++] = &octree_child_node->representatives_;
+        }
+
+        auto constexpr capacity = params_type::representatives_per_node;
+        representatives_.clear();
+        for (std::size_t turn = 0u; representatives_.size() < capacity; ++turn)
+        {
+            std::size_t const previous_size = representatives_.size();
+            for (std::size_t i = 0u; i < sources_count && representatives_.size() < capacity; ++i)
+                if (turn < sources[i]->size())
+                    representatives_.push_back((*sources[i])[turn]);
+
+            if (turn < elements_.size() && representatives_.size() < capacity)
+                representatives_.push_back(elements_[turn]);
+
+            if (representatives_.size() == previous_size)
+                break;
+        }
+    }
+
+    /**
+     * @brief
+     * Calls visitor on the level-of-detail representatives of the nodes at a
+     * depth of this node's subtree, and of the leaves above that depth.
+     * build_representatives must have been called beforehand.
+     * @tparam Visitor Callable type taking an element_type const&
+     * @param depth The depth, relative to this node
+     * @param visitor Callback on the representatives
+     */
+    template <class Visitor>
+    void visit_points_at_depth(std::size_t depth, Visitor&& visitor) const
+    {
+        static_assert(
+            stores_representatives_v<params_type>,
+            "Octree parameters must request level-of-detail representatives");
+
+        bool const is_leaf = std::none_of(
+            octants_.cbegin(),
+            octants_.cend(),
+            [](octant_pointer_type const& octant) { return static_cast<bool>(octant); });
+
+        if (depth == 0u || is_leaf)
+        {
+            for (auto const& e : representatives_)
+                visitor(e);
+            return;
+        }
+
+        for (auto const& octree_child_node : octants_)
+            if (octree_child_node)
+                octree_child_node->visit_points_at_depth(depth - 1u, visitor);
+    }
+
+    /**
+     * @brief
+     * Level-of-detail range query. Returns at most max_points representatives
+     * of the elements in a range, spread over the range. The nodes overlapping
+     * the range are refined level by level from this node, until the
+     * representatives of the next level in the range exceed max_points, which
+     * are then taken in turns from each node of that level, so that the cost
+     * depends on the size of the output rather than on the number of elements
+     * in the range. Nodes are finally refined to their own elements, such that
+     * all the elements in the range are returned when they fit in max_points.
+     * build_representatives must have been called beforehand.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param range The range in which we want to find points
+     * @param max_points Maximum number of points to return
+     * @param point_view The point view property map
+     * @return At most max_points representatives in the range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type>
+    lod_query(Range const& range, std::size_t max_points, PointViewMap const& point_view) const
+    {
+        static_assert(
+            stores_representatives_v<params_type>,
+            "Octree parameters must request level-of-detail representatives");
+
+        std::vector<element_type> representatives_in_range;
+        if (intersections::classify(voxel_grid_, range) == intersections::overlap_t::disjoint)
+            return representatives_in_range;
+
+        // a node is refined to its children and to its own elements, which are
+        // its finest level of detail
+        struct lod_node_t
+        {
+            self_type const* node;
+            bool is_refined;
+
+            std::vector<element_type> const& points() const
+            {
+                return is_refined ? node->elements_ : node->representatives_;
+            }
+        };
+
+        auto const count_in_range = [&](lod_node_t const& lod_node) {
+            auto const& points = lod_node.points();
+            return static_cast<std::size_t>(
+                std::count_if(points.cbegin(), points.cend(), [&](element_type const& e) {
+                    return range.contains(point_view(e));
+                }));
+        };
+
+        subdivide_pending_elements(point_view);
+
+        std::vector<lod_node_t> level{lod_node_t{this, false}};
+        std::vector<lod_node_t> next_level;
+        for (bool is_refined = true; is_refined;)
+        {
+            next_level.clear();
+            std::size_t next_level_size = 0u;
+            is_refined                  = false;
+            for (lod_node_t const& lod_node : level)
+            {
+                if (lod_node.is_refined)
+                {
+                    next_level.push_back(lod_node);
+                    next_level_size += count_in_range(lod_node);
+                    continue;
+                }
+
+                is_refined = true;
+                for (auto const& octree_child_node : lod_node.node->octants_)
+                {
+                    if (!octree_child_node ||
+                        intersections::classify(octree_child_node->voxel_grid_, range) ==
+                        intersections::overlap_t::disjoint)
+                        continue;
+
+                    octree_child_node->subdivide_pending_elements(point_view);
+                    next_level.push_back(lod_node_t{octree_child_node.get(), false});
+                    next_level_size += count_in_range(next_level.back());
+                }
+
+                if (!lod_node.node->elements_.empty())
+                {
+                    next_level.push_back(lod_node_t{lod_node.node, true});
+                    next_level_size += count_in_range(next_level.back());
+                }
+            }
+
+            if (is_refined)
+                std::swap(level, next_level);
+            if (next_level_size > max_points)
+                break;
+        }
+
+        // take the points in turns from each node, so that a capped output is
+        // still spread over the range
+        for (std::size_t i = 0u; representatives_in_range.size() < max_points; ++i)
+        {
+            bool has_points = false;
+            for (lod_node_t const& lod_node : level)
+            {
+                auto const& points = lod_node.points();
+                if (i >= points.size())
+                    continue;
+
+                has_points    = true;
+                auto const& e = points[i];
+                if (!range.contains(point_view(e)))
+                    continue;
+
+                if (representatives_in_range.size() >= max_points)
+                    return representatives_in_range;
+
+                representatives_in_range.push_back(e);
+            }
+
+            if (!has_points)
+                break;
+        }
+
+        return representatives_in_range;
+    }
+
+  protected:
+    /**
+     * @brief
+     * The element search implementation
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param element The element to search for
+     * @param it Current iterator before returning it
+     * @param point_view The point view property map
+     * @return Iterator to the found element or end iterator
+     */
+    template <class PointViewMap>
+    const_iterator
+    do_find(element_type const& element, iterator& it, PointViewMap const& point_view) const
+    {
+        subdivide_pending_elements(point_view);
+
+        auto p                   = point_view(element);
+        auto& non_const_elements = const_cast<decltype(elements_)&>(elements_);
+
+        auto target = std::find_if(
+            non_const_elements.begin(),
+            non_const_elements.end(),
+            [&p, &point_view](auto const& e) {
+                auto p2 = point_view(e);
+                return common::are_vectors_equal(p, p2);
+            });
+
+        it.bucket_.octree_node_ = const_cast<self_type*>(this);
+        it.it_                  = target;
+        if (it.it_ != non_const_elements.end())
+            return it;
+
+        auto const center             = voxel_grid_.center();
+        std::uint64_t octants_bitmask = 0b000;
+
+        if (p.x() > center.x())
+            octants_bitmask |= 0b100;
+        if (p.y() > center.y())
+            octants_bitmask |= 0b010;
+        if (p.z() > center.z())
+            octants_bitmask |= 0b001;
+
+        auto& octant = octants_[octants_bitmask];
+
+        if (!octant)
+            return const_iterator{};
+
+        return octant->do_find(p, it, point_view);
+    }
+
+  private:
+    /**
+     * @brief
+     * Concurrent range search implementation. The node's children are collected
+     * under its lock, and searched after the lock is released, so that a thread
+     * never holds more than one lock of the table.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam Visitor Callable type taking an element_type const&
+     * @param range The range in which we want to find points
+     * @param point_view The point view property map
+     * @param visitor Callback on the elements found to be in the range
+     * @param locks The lock table guarding this node subtree
+     * @param elements_in_range Buffer receiving the node's elements in the range
+     * @param is_contained True if this node's voxel is contained in the range
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void concurrent_visit_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        Visitor& visitor,
+        shared_lock_table_t const& locks,
+        std::vector<element_type>& elements_in_range,
+        bool const is_contained) const
+    {
+        subdivide_pending_elements(point_view);
+
+        std::array<self_type const*, 8u> children{};
+        elements_in_range.clear();
+        {
+            std::shared_lock<std::shared_mutex> lock(locks.mutex_of(this));
+            for (auto const& e : elements_)
+                if (is_contained || range.contains(point_view(e)))
+                    elements_in_range.push_back(e);
+
+            for (std::size_t i = 0u; i < octants_.size(); ++i)
+                children[i] = octants_[i].get();
+        }
+
+        for (auto const& e : elements_in_range)
+            visitor(e);
+
+        for (self_type const* octree_child_node : children)
+        {
+            if (octree_child_node == nullptr)
+                continue;
+
+            if (is_contained)
+            {
+                octree_child_node->concurrent_visit_range(
+                    range,
+                    point_view,
+                    visitor,
+                    locks,
+                    elements_in_range,
+                    true);
+                continue;
+            }
+
+            auto const overlap = intersections::classify(octree_child_node->voxel_grid_, range);
+            if (overlap == intersections::overlap_t::disjoint)
+                continue;
+
+            octree_child_node->concurrent_visit_range(
+                range,
+                point_view,
+                visitor,
+                locks,
+                elements_in_range,
+                overlap == intersections::overlap_t::contained);
+        }
+    }
+
+    /**
+     * @brief
+     * Range query implementation. Elements of this subtree found in the range are
+     * passed to visit_element, except for subtrees contained in the range, which
+     * are passed whole to visit_contained_subtree.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam ElementVisitor Callable type taking an element_type const&
+     * @tparam SubtreeVisitor Callable type taking a self_type const&
+     * @param range The queried range
+     * @param point_view The point view property map
+     * @param visit_element Callback on the elements found to be in the range
+     * @param visit_contained_subtree Callback on the subtrees contained in the range
+     */
+    template <class Range, class PointViewMap, class ElementVisitor, class SubtreeVisitor>
+    void query_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        ElementVisitor& visit_element,
+        SubtreeVisitor const& visit_contained_subtree) const
+    {
+        auto const overlap = intersections::classify(voxel_grid_, range);
+        if (overlap == intersections::overlap_t::disjoint)
+            return;
+
+        if (overlap == intersections::overlap_t::contained)
+            visit_contained_subtree(*this);
+        else
+            visit_overlapping_range(range, point_view, visit_element, visit_contained_subtree);
+    }
+
+    /**
+     * @brief
+     * Range query implementation for a range that partially overlaps this node's voxel.
+     * The elements of this node are tested individually, and the children are
+     * discarded, handed whole to visit_contained_subtree or searched recursively
+     * according to their overlap with the range.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam ElementVisitor Callable type taking an element_type const&
+     * @tparam SubtreeVisitor Callable type taking a self_type const&
+     * @param range The queried range
+     * @param point_view The point view property map
+     * @param visit_element Callback on the elements found to be in the range
+     * @param visit_contained_subtree Callback on the subtrees contained in the range
+     */
+    template <class Range, class PointViewMap, class ElementVisitor, class SubtreeVisitor>
+    void visit_overlapping_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        ElementVisitor& visit_element,
+        SubtreeVisitor const& visit_contained_subtree) const
+    {
+        subdivide_pending_elements(point_view);
+
+        for (auto const& e : elements_)
+            if (range.contains(point_view(e)))
+                visit_element(e);
+
+        for (auto const& octree_child_node : octants_)
+        {
+            if (!octree_child_node)
+                continue;
+
+            auto const overlap = intersections::classify(octree_child_node->voxel_grid_, range);
+
+            /*
+             * If the queried range does not even intersect this
+             * octant, then no point in that octant can be contained
+             * in the queried range. In that case, we can discard
+             * searching in this whole octant.
+             */
+            if (overlap == intersections::overlap_t::disjoint)
+                continue;
+
+            /*
+             * If this octant lies entirely inside the queried range,
+             * then every point of this octant is in the range, so we
+             * report them all without testing them.
+             */
+            if (overlap == intersections::overlap_t::contained)
+            {
+                visit_contained_subtree(*octree_child_node);
+                continue;
+            }
+
+            /*
+             * If the queried range does intersect this octant,
+             * then any point of this octant could be inside or
+             * outside of the queried range, but we don't know
+             * which. In this case, we simply delegate the job
+             * of searching to this octant's octree node.
+             */
+            octree_child_node->visit_overlapping_range(
+                range,
+                point_view,
+                visit_element,
+                visit_contained_subtree);
+        }
+    }
+
+    /**
+     * @brief
+     * Frustum culling implementation for a node overlapping the volume. The
+     * children overlapping the volume are searched in order of their distance
+     * to the first plane.
+     * @tparam Planes Range of planes whose normals point inside the volume
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam Visitor Callable type taking an element_type const&
+     * @param planes The planes bounding the volume
+     * @param is_contained True if this node's voxel lies inside the volume
+     * @param point_view The point view property map
+     * @param visitor Callback on the elements found to be in the volume
+     */
+    template <class Planes, class PointViewMap, class Visitor>
+    void visit_frustum_subtree(
+        Planes const& planes,
+        bool is_contained,
+        PointViewMap const& point_view,
+        Visitor& visitor) const
+    {
+        using scalar_type = typename knn_scratch_t::scalar_type;
+
+        subdivide_pending_elements(point_view);
+
+        for (auto const& e : elements_)
+        {
+            auto const p = point_view(e);
+            bool const is_in_volume =
+                is_contained ||
+                std::all_of(std::begin(planes), std::end(planes), [&p](auto const& plane) {
+                    return plane.signed_distance_to(p) >= 0;
+                });
+
+            if (is_in_volume)
+                visitor(e);
+        }
+
+        struct frustum_octant_t
+        {
+            scalar_type front_distance;
+            self_type const* octant;
+            bool is_contained;
+        };
+
+        std::array<frustum_octant_t, 8> children{};
+        std::size_t children_count = 0u;
+        for (auto const& octree_child_node : octants_)
+        {
+            if (!octree_child_node)
+                continue;
+
+            auto const overlap =
+                is_contained ?
+                    intersections::overlap_t::contained :
+                    intersections::classify_against_planes(octree_child_node->voxel_grid_, planes);
+
+            if (overlap == intersections::overlap_t::disjoint)
+                continue;
+
+            children[children_count++] = frustum_octant_t{
+                front_distance_to(octree_child_node->voxel_grid_, planes),
+                octree_child_node.get(),
+                overlap == intersections::overlap_t::contained};
+        }
+
+        auto const children_end = children.begin() + static_cast<std::ptrdiff_t>(children_count);
+        std::sort(
+            children.begin(),
+            children_end,
+            [](frustum_octant_t const& c1, frustum_octant_t const& c2) {
+                return c1.front_distance < c2.front_distance;
+            });
+
+        for (auto it = children.begin(); it != children_end; ++it)
+            it->octant->visit_frustum_subtree(planes, it->is_contained, point_view, visitor);
+    }
+
+    /**
+     * @brief
+     * Signed distance from the first of the planes to the nearest corner of a voxel
+     * @tparam Planes Range of planes
+     * @param voxel The voxel
+     * @param planes The planes
+     * @return The distance, or zero if there are no planes
+     */
+    template <class Planes>
+    static typename knn_scratch_t::scalar_type
+    front_distance_to(aabb_type const& voxel, Planes const& planes)
+    {
+        using scalar_type = typename knn_scratch_t::scalar_type;
+
+        auto const first = std::begin(planes);
+        if (first == std::end(planes))
+            return static_cast<scalar_type>(0);
+
+        auto const& n = first->normal();
+        aabb_point_type const nearest_corner{
+            n.x() >= 0 ? voxel.min.x() : voxel.max.x(),
+            n.y() >= 0 ? voxel.min.y() : voxel.max.y(),
+            n.z() >= 0 ? voxel.min.z() : voxel.max.z()};
+        return static_cast<scalar_type>(first->signed_distance_to(nearest_corner));
+    }
+
+    /**
+     * @brief
+     * Calls visitor on every element of this node's subtree
+     * @tparam Visitor Callable type taking an element_type const&
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param visitor Callback on the elements
+     * @param point_view The point view property map
+     */
+    template <class Visitor, class PointViewMap>
+    void visit_subtree(Visitor& visitor, PointViewMap const& point_view) const
+    {
+        subdivide_pending_elements(point_view);
+
+        for (auto const& e : elements_)
+            visitor(e);
+
+        for (auto const& octree_child_node : octants_)
+            if (octree_child_node)
+                octree_child_node->visit_subtree(visitor, point_view);
+    }
+
+    /**
+     * @brief
+     * Adds this node's subtree to an aggregate count and coordinate sum. Stored
+     * coordinate sums are used when they are up to date. Erasing elements leaves
+     * the sums of the erased elements' ancestors out of date, in which case they
+     * are recomputed from the node's elements and its children's sums.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param count The element count to add to
+     * @param sum The coordinate sum to add to
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void aggregate_subtree(
+        std::size_t& count,
+        coordinate_sum_type& sum,
+        PointViewMap const& point_view) const
+    {
+        if constexpr (stores_coordinate_sums_v<params_type>)
+        {
+            if (coordinate_sums_.is_valid && !has_stale_statistics())
+            {
+                count += subtree_size_;
+                add_coordinates(sum, coordinate_sums_.sum);
+                return;
+            }
+        }
+
+        subdivide_pending_elements(point_view);
+
+        count += elements_.size();
+        for (auto const& e : elements_)
+            add_coordinates(sum, point_view(e));
+
+        for (auto const& octree_child_node : octants_)
+            if (octree_child_node)
+                octree_child_node->aggregate_subtree(count, sum, point_view);
+    }
+
+    /**
+     * @brief
+     * Recomputes this node's subtree statistics from its elements and its
+     * children's statistics
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void update_statistics(PointViewMap const& point_view)
+    {
+        bool has_stale_child = false;
+        subtree_size_        = elements_.size();
+        for (auto const& octree_child_node : octants_)
+        {
+            if (!octree_child_node)
+                continue;
+
+            subtree_size_ += octree_child_node->subtree_size_;
+            has_stale_child = has_stale_child || octree_child_node->has_stale_statistics();
+        }
+        has_stale_statistics_.store(has_stale_child, std::memory_order_relaxed);
+
+        if constexpr (stores_coordinate_sums_v<params_type>)
+        {
+            coordinate_sums_type sums{};
+            for (auto const& e : elements_)
+                add_coordinates(sums.sum, point_view(e));
+
+            for (auto const& octree_child_node : octants_)
+            {
+                if (!octree_child_node)
+                    continue;
+
+                add_coordinates(sums.sum, octree_child_node->coordinate_sums_.sum);
+                sums.is_valid = sums.is_valid && octree_child_node->coordinate_sums_.is_valid;
+            }
+
+            coordinate_sums_ = sums;
+        }
+    }
+
+    /**
+     * @brief
+     * Number of elements in this node's subtree. Stale subtree sizes are
+     * recomputed from the node's elements and its children's subtree sizes.
+     * @return Number of elements in this node's subtree
+     */
+    std::size_t count_subtree() const
+    {
+        if (!has_stale_statistics())
+            return subtree_size_;
+
+        std::size_t count = elements_.size();
+        for (auto const& octree_child_node : octants_)
+            if (octree_child_node)
+                count += octree_child_node->count_subtree();
+        return count;
+    }
+
+    bool has_stale_statistics() const
+    {
+        return has_stale_statistics_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief
+     * Marks this node's subtree statistics as stale. The flag is only
+     * written once, so that concurrent writers going through this node
+     * keep sharing its cache line.
+     */
+    void mark_statistics_stale()
+    {
+        if (!has_stale_statistics())
+            has_stale_statistics_.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Removes one element from this node's subtree statistics
+     */
+    void uncount_element()
+    {
+        --subtree_size_;
+        if constexpr (stores_coordinate_sums_v<params_type>)
+            coordinate_sums_.is_valid = false;
+    }
+
+    /**
+     * @brief
+     * Removes one element whose position is known from this node's
+     * subtree statistics, keeping its coordinate sum exact
+     * @tparam TPointView Type satisfying PointView concept
+     * @param p Position of the removed element
+     */
+    template <class TPointView>
+    void uncount_element(TPointView const& p)
+    {
+        --subtree_size_;
+        if constexpr (stores_coordinate_sums_v<params_type>)
+            subtract_coordinates(coordinate_sums_.sum, p);
+    }
+
+    /**
+     * @brief
+     * Updates this node's coordinate sum for an element of its subtree
+     * moving from one position to another
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam TPointView2 Type satisfying PointView concept
+     * @param from Old position of the element
+     * @param to New position of the element
+     */
+    template <class TPointView, class TPointView2>
+    void move_coordinates(TPointView const& from, TPointView2 const& to)
+    {
+        if constexpr (stores_coordinate_sums_v<params_type>)
+        {
+            subtract_coordinates(coordinate_sums_.sum, from);
+            add_coordinates(coordinate_sums_.sum, to);
+        }
+    }
+
+    /**
+     * @brief
+     * Moves the elements past this node's capacity down to its children, as
+     * insert would have done, if this node belongs to a lazily subdivided octree.
+     * Queries call it before reading a node's elements or children. Concurrent
+     * queries subdivide a node once, the first of them holding the node's lock
+     * while the others wait for it.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void subdivide_pending_elements(PointViewMap const& point_view) const
+    {
+        if constexpr (subdivides_lazily_v<params_type>)
+        {
+            if (!has_pending_elements_.load(std::memory_order_acquire))
+                return;
+
+            std::lock_guard<std::shared_mutex> lock(lazy_subdivision_locks().mutex_of(this));
+            if (!has_pending_elements_.load(std::memory_order_relaxed))
+                return;
 
             /*
-             * If the heap node is a point, then we know for sure that
-             * this point is closer to the reference point than any other
-             * point contained in any octant of the octree. In this case,
-             * we have effectively found a new nearest neighbour.
+             * Queries only have const access to the nodes. Nodes are never
+             * const objects though, since the octree's root is a mutable
+             * member of the octree and the other nodes are allocated, so
+             * subdividing a node from a query is well-defined.
              */
-            if (heap_node.is_point)
+            auto& node = const_cast<self_type&>(*this);
+            node.distribute_pending_elements(point_view);
+            node.has_pending_elements_.store(false, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief
+     * Inserts the elements past this node's capacity in its children, in their
+     * insertion order. Children of lazily subdivided octrees keep these elements
+     * pending in turn until they are visited.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void distribute_pending_elements(PointViewMap const& point_view)
+    {
+        if (max_depth_ == 1u || elements_.size() <= capacity_)
+            return;
+
+        auto const center        = voxel_grid_.center();
+        auto const first_pending = elements_.begin() + static_cast<std::ptrdiff_t>(capacity_);
+        for (auto it = first_pending; it != elements_.end(); ++it)
+        {
+            auto const p                  = point_view(*it);
+            std::uint64_t octants_bitmask = 0b000;
+            if (p.x() > center.x())
+                octants_bitmask |= 0b100;
+            if (p.y() > center.y())
+                octants_bitmask |= 0b010;
+            if (p.z() > center.z())
+                octants_bitmask |= 0b001;
+
+            auto& octant = octants_[octants_bitmask];
+            if (!octant)
+                octant = make_octant(octants_bitmask);
+
+            octant->insert(*it, point_view);
+        }
+        elements_.erase(first_pending, elements_.end());
+    }
+
+    /**
+     * @brief
+     * Locks taken to subdivide the nodes of lazily subdivided octrees,
+     * shared by all octrees of this type
+     * @return The lock table
+     */
+    static shared_lock_table_t const& lazy_subdivision_locks()
+    {
+        static shared_lock_table_t const locks{};
+        return locks;
+    }
+
+    /**
+     * @brief Adds the coordinates of p to sum
+     * @tparam TPointView Type satisfying PointView concept
+     * @param sum The coordinate sum
+     * @param p The point to add
+     */
+    template <class TPointView>
+    static void add_coordinates(coordinate_sum_type& sum, TPointView const& p)
+    {
+        sum.x(sum.x() + static_cast<double>(p.x()));
+        sum.y(sum.y() + static_cast<double>(p.y()));
+        sum.z(sum.z() + static_cast<double>(p.z()));
+    }
+
+    /**
+     * @brief Subtracts the coordinates of p from sum
+     * @tparam TPointView Type satisfying PointView concept
+     * @param sum The coordinate sum
+     * @param p The point to subtract
+     */
+    template <class TPointView>
+    static void subtract_coordinates(coordinate_sum_type& sum, TPointView const& p)
+    {
+        sum.x(sum.x() - static_cast<double>(p.x()));
+        sum.y(sum.y() - static_cast<double>(p.y()));
+        sum.z(sum.z() - static_cast<double>(p.z()));
+    }
+
+    /**
+     * @brief
+     * Best-first KNN search implementation
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param scratch Storage for the search's heaps
+     * @param eps The error tolerance for floating point equality
+     * @param approximation The approximation settings, exact by default
+     * @param max_squared_distance Known upper bound on the k-th nearest neighbour's
+     * squared distance to the target
+     * @return The neighbours sorted from nearest to furthest, stored in scratch
+     */
+    template <class TPointView, class PointViewMap>
+    typename knn_scratch_t::neighbours_type const& knn_search(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_t& scratch,
+        double const eps,
+        approximate_knn_parameters_t const& approximation = {},
+        typename knn_scratch_t::scalar_type const max_squared_distance =
+            std::numeric_limits<typename knn_scratch_t::scalar_type>::max()) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+        using coordinate_type    = typename point_view_type::coordinate_type;
+        using octant_heap_node_t = typename knn_scratch_t::octant_heap_node_type;
+
+        auto& k_best  = scratch.k_best;
+        auto& octants = scratch.octants;
+        k_best.reset(k, max_squared_distance);
+        octants.clear();
+
+        if (k <= 0u)
+            return k_best.sort();
+
+        /*
+         * Octants are visited best-first, in order of their squared distance to
+         * the target, which is computed once when the octant is discovered.
+         * Greater comparison on the distance makes the octants heap a min-heap.
+         * The k best elements found so far are kept in a bounded max-heap, whose
+         * top element is the current k-th nearest neighbour.
+         */
+        auto const greater = [](octant_heap_node_t const& h1, octant_heap_node_t const& h2) {
+            return h2 < h1;
+        };
+
+        /*
+         * Octant distances are scaled by (1 + epsilon)^2 for approximate
+         * searches, which is 1 for exact searches.
+         */
+        using scalar_type            = typename knn_scratch_t::scalar_type;
+        auto const distance_factor   = approximation.squared_distance_factor<scalar_type>();
+        std::size_t remaining_leaves = approximation.max_visited_leaves;
+
+        std::array<scalar_type, 3u> const t{
+            static_cast<scalar_type>(target.x()),
+            static_cast<scalar_type>(target.y()),
+            static_cast<scalar_type>(target.z())};
+
+        auto const is_leaf = [](self_type const* octant) {
+            return std::none_of(
+                octant->octants_.cbegin(),
+                octant->octants_.cend(),
+                [](octant_pointer_type const& child) { return static_cast<bool>(child); });
+        };
+
+        /*
+         * Elements are compared to the target only if they
+         * are near enough to enter the k best elements.
+         */
+        auto const visit_elements = [&](self_type const* octant) {
+            for (auto const& e : octant->elements_)
             {
-                auto const& e = *heap_node.e;
-                auto p        = point_view(e);
-                if (!common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
-                    knearest_points.push_back(e);
-                continue;
+                auto const p = point_view(e);
+                auto const d = common::squared_distance(target, p);
+                if (d > k_best.bound())
+                    continue;
+
+                if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+                    continue;
+
+                k_best.push(std::addressof(e), d);
             }
+        };
 
-            /*
-             * If the heap node is an octant, then we know that there are
-             * points in this octant that are closer to the reference point
-             * than any other point in any other octant of this octree.
-             * We add points of this octree node to the priority queue.
-             */
-            for (auto const& e : heap_node.o->elements_)
+        /*
+         * Children split their parent's voxel at its center, so their
+         * squared distances to the target are sums of the squared
+         * distances to the lower or upper half of the voxel along
+         * each axis, computed once for all children without reading
+         * the children's voxels.
+         */
+        auto const push_children = [&](self_type const* octant, self_type const* visited_child) {
+            auto const& voxel = octant->voxel_grid_;
+            auto const center = voxel.center();
+            std::array<scalar_type, 3u> const lo{voxel.min.x(), voxel.min.y(), voxel.min.z()};
+            std::array<scalar_type, 3u> const mid{center.x(), center.y(), center.z()};
+            std::array<scalar_type, 3u> const hi{voxel.max.x(), voxel.max.y(), voxel.max.z()};
+            std::array<std::array<scalar_type, 2u>, 3u> half_distances{};
+            for (std::size_t a = 0u; a < 3u; ++a)
+            {
+                half_distances[a][0] = squared_distance_to_interval(t[a], lo[a], mid[a]);
+                half_distances[a][1] = squared_distance_to_interval(t[a], mid[a], hi[a]);
+            }
+
+            for (std::size_t i = 0u; i < octant->octants_.size(); ++i)
             {
-                min_heap.push(min_heap_node_t{&e, nullptr, true});
+                auto const& octree_child_node = octant->octants_[i];
+                if (!octree_child_node || octree_child_node.get() == visited_child)
+                    continue;
+
+                auto const d = half_distances[0][(i >> 2u) & 1u] +
+                               half_distances[1][(i >> 1u) & 1u] + half_distances[2][i & 1u];
+
+                /*
+                 * Octants further than the k-th nearest neighbour
+                 * are pruned without ever entering the heap.
+                 */
+                if (d * distance_factor > k_best.bound())
+                    continue;
+
+                octants.push_back(octant_heap_node_t{octree_child_node.get(), d});
+                std::push_heap(octants.begin(), octants.end(), greater);
             }
+        };
 
+        if (remaining_leaves == 0u)
+            return k_best.sort();
+
+        if (voxel_grid_.contains(target))
+        {
             /*
-             * We also add the child octree nodes of this octree
-             * node.
+             * The octant holding the target and all of its ancestors lie at
+             * distance 0 from the target, so the best-first search would
+             * visit all of them first, in no particular order. Descending to
+             * the deepest octant holding the target and visiting it before
+             * its ancestors tightens the k-th nearest neighbour's distance
+             * early, so that the ancestors' elements, which are spread over
+             * their whole voxels, rarely enter the k best elements and their
+             * children are pruned before entering the heap.
              */
-            for (auto const& octree_child_node : heap_node.o->octants_)
+            self_type const* deepest = this;
+            for (;;)
             {
-                if (!octree_child_node)
-                    continue;
+                deepest->subdivide_pending_elements(point_view);
+
+                auto const center             = deepest->voxel_grid_.center();
+                std::uint64_t octants_bitmask = 0b000;
+                if (target.x() > center.x())
+                    octants_bitmask |= 0b100;
+                if (target.y() > center.y())
+                    octants_bitmask |= 0b010;
+                if (target.z() > center.z())
+                    octants_bitmask |= 0b001;
+
+                auto const& octant = deepest->octants_[octants_bitmask];
+                if (!octant)
+                    break;
+
+                deepest = octant.get();
+            }
+
+            if (is_leaf(deepest))
+                --remaining_leaves;
 
-                min_heap.push(min_heap_node_t{nullptr, octree_child_node.get(), false});
+            visit_elements(deepest);
+            push_children(deepest, nullptr);
+            for (self_type const* octant = deepest; octant != this; octant = octant->parent_)
+            {
+                visit_elements(octant->parent_);
+                push_children(octant->parent_, octant);
             }
         }
+        else
+        {
+            octants.push_back(octant_heap_node_t{
+                this,
+                common::squared_distance(target, voxel_grid_.nearest_point_from(target))});
+        }
 
-        return knearest_points;
+        while (!octants.empty() && remaining_leaves > 0u)
+        {
+            std::pop_heap(octants.begin(), octants.end(), greater);
+            auto const [octant, octant_distance] = octants.back();
+            octants.pop_back();
+
+            /*
+             * Since octants are visited nearest-first, once the nearest
+             * remaining octant lies further than the k-th nearest
+             * neighbour, no remaining element can improve the result.
+             */
+            if (octant_distance * distance_factor > k_best.bound())
+                break;
+
+            octant->subdivide_pending_elements(point_view);
+
+            bool const is_leaf_octant = is_leaf(octant);
+            if (is_leaf_octant)
+                --remaining_leaves;
+
+            visit_elements(octant);
+            if (!is_leaf_octant)
+                push_children(octant, nullptr);
+        }
+
+        return k_best.sort();
+    }
+
+    /**
+     * @brief Squared distance from a coordinate to an interval along one axis
+     * @tparam Scalar Type of the coordinates
+     * @param c The coordinate
+     * @param lo Lower end of the interval
+     * @param hi Upper end of the interval
+     * @return 0 if c is in the interval, the squared distance to its nearest end otherwise
+     */
+    template <class Scalar>
+    static Scalar squared_distance_to_interval(Scalar c, Scalar lo, Scalar hi)
+    {
+        Scalar const delta = c < lo ? lo - c : (hi < c ? c - hi : Scalar{0});
+        return delta * delta;
     }
 
     /**
      * @brief
-     * Range search
-     * @tparam Range Type satisfying Range concept
+     * Upper bound on the squared distance from a target to its k-th nearest
+     * neighbour, given k candidate neighbours such as the neighbours of a
+     * nearby target
+     * @tparam TPointView Type satisfying PointView concept
      * @tparam PointViewMap Type satisfying PointViewMap concept
-     * @param range The range in which we want to find points
-     * @param elements_in_range The elements found to be in the range
+     * @param candidates The candidate neighbours
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
      * @param point_view The point view property map
+     * @param eps The error tolerance for floating point equality
+     * @return The bound, or the maximum scalar value if the candidates do not bound the search
      */
-    template <class Range, class PointViewMap>
-    void range_search(
-        Range const& range,
-        std::vector<element_type>& elements_in_range,
-        PointViewMap const& point_view) const
+    template <class TPointView, class PointViewMap>
+    typename knn_scratch_t::scalar_type knn_bound_from(
+        typename knn_scratch_t::neighbours_type const& candidates,
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        double const eps) const
     {
-        for (auto const& e : elements_)
-            if (range.contains(point_view(e)))
-                elements_in_range.push_back(e);
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+        using coordinate_type = typename point_view_type::coordinate_type;
+        using scalar_type     = typename knn_scratch_t::scalar_type;
 
-        for (auto const& octree_child_node : octants_)
+        auto constexpr no_bound = std::numeric_limits<scalar_type>::max();
+        if (candidates.size() < k)
+            return no_bound;
+
+        /*
+         * Elements at the target's position are not neighbours
+         * of the target, so they cannot be counted in the bound.
+         */
+        scalar_type bound{0};
+        for (auto const& candidate : candidates)
         {
-            if (!octree_child_node)
-                continue;
+            auto const p = point_view(*candidate.element);
+            if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+                return no_bound;
 
-            /*
-             * If the queried range does not even intersect this
-             * octant, then no point in that octant can be contained
-             * in the queried range. In that case, we can discard
-             * searching in this whole octant.
-             */
-            if (!intersections::intersects(octree_child_node->voxel_grid_, range))
+            bound = std::max(bound, common::squared_distance(target, p));
+        }
+        return bound;
+    }
+
+    /**
+     * @brief
+     * Destroys one of this node's children, and unpublishes it
+     * from concurrent insertions
+     * @param octant_index Index of the child
+     */
+    void release_octant(std::uint8_t const octant_index)
+    {
+        auto const octant_bit = static_cast<std::uint8_t>(1u << octant_index);
+        published_octants_.fetch_and(
+            static_cast<std::uint8_t>(~octant_bit),
+            std::memory_order_relaxed);
+        octants_[octant_index].reset();
+    }
+
+    /**
+     * @brief
+     * Moves the elements of this node's descendants into this node,
+     * and destroys its children
+     */
+    void collapse_octants()
+    {
+        for (std::uint8_t i = 0u; i < octants_.size(); ++i)
+        {
+            auto& octree_child_node = octants_[i];
+            if (!octree_child_node)
                 continue;
 
-            /*
-             * If the queried range does intersect this octant,
-             * then any point of this octant could be inside or
-             * outside of the queried range, but we don't know
-             * which. In this case, we simply delegate the job
-             * of searching to this octant's octree node.
-             */
-            octree_child_node->range_search(range, elements_in_range, point_view);
+            octree_child_node->collapse_octants();
+            std::move(
+                octree_child_node->elements_.begin(),
+                octree_child_node->elements_.end(),
+                std::back_inserter(elements_));
+            release_octant(i);
         }
     }
 
-  protected:
     /**
      * @brief
-     * The element search implementation
+     * Releases the memory of this node's element buffer if less than half
+     * of it is used, keeping room for the node capacity
+     */
+    void shrink_elements()
+    {
+        auto const size     = elements_.size();
+        auto const reserved = std::max<std::size_t>(capacity_, size);
+        if (elements_.capacity() <= std::max<std::size_t>(capacity_, 2u * size))
+            return;
+
+        elements_type shrunk(elements_.get_allocator());
+        shrunk.reserve(reserved);
+        std::move(elements_.begin(), elements_.end(), std::back_inserter(shrunk));
+        elements_.swap(shrunk);
+    }
+
+    /**
+     * @brief
+     * Creates this node's child node for the given octant
+     * @param octants_bitmask The child's octant index
+     * @return The child node, covering the given octant of this node's voxel
+     */
+    octant_pointer_type make_octant(std::uint64_t const octants_bitmask)
+    {
+        auto const center = voxel_grid_.center();
+        params_type params;
+
+        /*
+         * This octree node must propagate the node capacity
+         * parameter to its children from top to bottom.
+         */
+        params.node_capacity = capacity_;
+
+        /*
+         * Creating a child octree node implies having moved
+         * down a level in the tree. To propagate this information,
+         * we simply assign a value for the max depth of the
+         * created child to be 1 less than this octree node's
+         * max depth. By doing so, if we wanted a max depth of
+         * 2 for this octree node, for example, then the created
+         * child node will have a max depth of 1. Looking at the
+         * "if (max_depth_ == 1u)" check at the start of the insertion,
+         * we see that at that moment, we will not create any
+         * child octree nodes anymore, but instead append points to
+         * the octree's leaf nodes' list of points.
+         *
+         * If we wanted a max depth of 3, then the root octree node's
+         * children will have a max depth of 3 -1 = 2. Then, each
+         * child's children will have a max depth of 2 -1 = 1, at
+         * which point we will have reached the desired 3-level
+         * octree form that was initially specified.
+         *
+         * This works for any initial max depth > 0.
+         */
+        params.max_depth = max_depth_ - std::uint8_t{1u};
+
+        params.voxel_grid.min.x(octants_bitmask & 0b100 ? center.x() : voxel_grid_.min.x());
+        params.voxel_grid.max.x(octants_bitmask & 0b100 ? voxel_grid_.max.x() : center.x());
+
+        params.voxel_grid.min.y(octants_bitmask & 0b010 ? center.y() : voxel_grid_.min.y());
+        params.voxel_grid.max.y(octants_bitmask & 0b010 ? voxel_grid_.max.y() : center.y());
+
+        params.voxel_grid.min.z(octants_bitmask & 0b001 ? center.z() : voxel_grid_.min.z());
+        params.voxel_grid.max.z(octants_bitmask & 0b001 ? voxel_grid_.max.z() : center.z());
+
+        auto octant           = allocate_node<self_type>(get_allocator(), params, get_allocator());
+        octant->parent_       = this;
+        octant->octant_index_ = static_cast<std::uint8_t>(octants_bitmask);
+        return octant;
+    }
+
+    /**
+     * @brief Links this node's children back to this node
+     */
+    void adopt_octants()
+    {
+        for (auto& octant : octants_)
+            if (octant)
+                octant->parent_ = this;
+    }
+
+    /**
+     * @brief
+     * Bulk insertion implementation. The first elements of [first, last) fill this node up
+     * to its capacity, and the remaining ones are stably partitioned by octant into the
+     * scratch buffer and delegated to the child nodes. Each child then uses its own
+     * sub-range of [first, last) as its scratch buffer.
+     * @tparam ExecutionPolicy Type of STL execution policy
      * @tparam PointViewMap Type satisfying PointViewMap concept
-     * @param element The element to search for
-     * @param it Current iterator before returning it
+     * @param policy The execution policy
+     * @param first Pointer to the first element to insert
+     * @param last End pointer of the elements to insert
+     * @param scratch Buffer of at least last - first elements
      * @param point_view The point view property map
-     * @return Iterator to the found element or end iterator
      */
-    template <class PointViewMap>
-    const_iterator
-    do_find(element_type const& element, iterator& it, PointViewMap const& point_view) const
+    template <class ExecutionPolicy, class PointViewMap>
+    void bulk_insert(
+        ExecutionPolicy const& policy,
+        element_type const** first,
+        element_type const** last,
+        element_type const** scratch,
+        PointViewMap const& point_view)
     {
-        auto p                   = point_view(element);
-        auto& non_const_elements = const_cast<decltype(elements_)&>(elements_);
+        auto const count = static_cast<std::size_t>(last - first);
 
-        auto target = std::find_if(
-            non_const_elements.begin(),
-            non_const_elements.end(),
-            [&p, &point_view](auto const& e) {
-                auto p2 = point_view(e);
-                return common::are_vectors_equal(p, p2);
+        if (max_depth_ == 1u)
+        {
+            std::for_each(first, last, [this](element_type const* e) {
+                elements_.push_back(*e);
             });
+            update_statistics(point_view);
+            return;
+        }
 
-        it.octree_node_ = const_cast<self_type*>(this);
-        it.it_          = target;
-        if (it.it_ != non_const_elements.end())
-            return it;
+        auto const num_elements = elements_.size();
+        auto const num_free     = num_elements < capacity_ ? capacity_ - num_elements : 0u;
+        auto const num_kept     = std::min(count, static_cast<std::size_t>(num_free));
+        std::for_each(first, first + num_kept, [this](element_type const* e) {
+            elements_.push_back(*e);
+        });
 
-        auto const center             = voxel_grid_.center();
-        std::uint64_t octants_bitmask = 0b000;
+        if (num_kept == count)
+        {
+            update_statistics(point_view);
+            return;
+        }
 
-        if (p.x() > center.x())
-            octants_bitmask |= 0b100;
-        if (p.y() > center.y())
-            octants_bitmask |= 0b010;
-        if (p.z() > center.z())
-            octants_bitmask |= 0b001;
+        first += num_kept;
+
+        auto const center    = voxel_grid_.center();
+        auto const octant_of = [&](element_type const* e) -> std::uint64_t {
+            auto const p                  = point_view(*e);
+            std::uint64_t octants_bitmask = 0b000;
+            if (p.x() > center.x())
+                octants_bitmask |= 0b100;
+            if (p.y() > center.y())
+                octants_bitmask |= 0b010;
+            if (p.z() > center.z())
+                octants_bitmask |= 0b001;
+            return octants_bitmask;
+        };
 
-        auto& octant = octants_[octants_bitmask];
+        /*
+         * Counting sort of the remaining elements by octant. The partition is
+         * stable, so every child receives its elements in insertion order.
+         */
+        std::array<std::size_t, 9u> offsets{};
+        std::for_each(first, last, [&](element_type const* e) { ++offsets[octant_of(e) + 1u]; });
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        auto const bounds = offsets;
+        std::for_each(first, last, [&](element_type const* e) {
+            scratch[offsets[octant_of(e)]++] = e;
+        });
+
+        std::array<std::uint64_t, 8u> octants{};
+        std::iota(octants.begin(), octants.end(), std::uint64_t{0u});
+        auto const build_octant = [&](std::uint64_t const o) {
+            if (bounds[o] == bounds[o + 1u])
+                return;
+
+            auto& octant = octants_[o];
+            if (!octant)
+                octant = make_octant(o);
+
+            octant->bulk_insert(
+                policy,
+                scratch + bounds[o],
+                scratch + bounds[o + 1u],
+                first + bounds[o],
+                point_view);
+        };
 
-        if (!octant)
-            return const_iterator{};
+        if (count - num_kept >= min_element_count_for_parallel_exec)
+            std::for_each(policy, octants.begin(), octants.end(), build_octant);
+        else
+            std::for_each(octants.begin(), octants.end(), build_octant);
 
-        it.ancestor_octree_nodes_.push(const_cast<self_type*>(this));
-        return octant->do_find(p, it, point_view);
+        update_statistics(point_view);
     }
 
-  private:
     /**
      * @brief
      * Adjust tree structure after an element removal
@@ -670,7 +3083,7 @@ class basic_linked_octree_node_t
      */
     typename octants_type::const_iterator take_point_from_first_nonempty_octant()
     {
-        auto const exists = [](std::unique_ptr<self_type> const& o) {
+        auto const exists = [](octant_pointer_type const& o) {
             return static_cast<bool>(o);
         };
 
@@ -694,6 +3107,7 @@ class basic_linked_octree_node_t
          */
         elements_.push_back(octree_child_node->elements_.back());
         octree_child_node->elements_.pop_back();
+        octree_child_node->uncount_element();
 
         /*
          * If the octree's child octant still has points left,
@@ -714,7 +3128,7 @@ class basic_linked_octree_node_t
         if (octree_child_node->take_point_from_first_nonempty_octant() ==
             octree_child_node->octants_.cend())
         {
-            octree_child_node.reset();
+            release_octant(octree_child_node->octant_index_);
         }
 
         /*
@@ -724,11 +3138,52 @@ class basic_linked_octree_node_t
         return octree_child_node_it;
     }
 
-    std::uint32_t capacity_; ///< This node's maximum number of elements
-    std::uint8_t max_depth_; ///< Bookkeeping variable on this node's current depth
-    aabb_type voxel_grid_;   ///< This node's englobing voxel
-    octants_type octants_;   ///< This node's child voxels
-    elements_type elements_; ///< The elements stored in this node
+    /**
+     * @brief Sum of the coordinates of the elements of a node's subtree
+     */
+    struct coordinate_sums_t
+    {
+        coordinate_sum_type sum{0., 0., 0.}; ///< The coordinate sum
+        bool is_valid = true; ///< False if elements were erased since the sum was computed
+    };
+
+    /**
+     * @brief Placeholder for the coordinate sums of octrees that do not store them
+     */
+    struct no_coordinate_sums_t
+    {
+    };
+
+    using coordinate_sums_type = std::conditional_t<
+        stores_coordinate_sums_v<params_type>,
+        coordinate_sums_t,
+        no_coordinate_sums_t>;
+
+    /**
+     * @brief Placeholder for the representatives of octrees that do not store them
+     */
+    struct no_representatives_t
+    {
+    };
+
+    using representatives_type = std::conditional_t<
+        stores_representatives_v<params_type>,
+        std::vector<element_type>,
+        no_representatives_t>;
+
+    std::uint32_t capacity_;    ///< This node's maximum number of elements
+    std::uint8_t max_depth_;    ///< Bookkeeping variable on this node's current depth
+    aabb_type voxel_grid_;      ///< This node's englobing voxel
+    octants_type octants_;      ///< This node's child voxels
+    elements_type elements_;    ///< The elements stored in this node
+    self_type* parent_ = nullptr; ///< This node's parent, or nullptr if this node is the root
+    std::uint8_t octant_index_ = 0u; ///< Index of this node in its parent's children
+    std::atomic<bool> has_stale_statistics_{false}; ///< True if subtree_size_ is out of date
+    std::atomic<std::uint8_t> published_octants_{0u}; ///< Children reachable without locking
+    std::atomic<bool> has_pending_elements_{false}; ///< True if elements exceed capacity (lazy)
+    std::size_t subtree_size_ = 0u; ///< Number of elements in this node's subtree
+    coordinate_sums_type coordinate_sums_; ///< Coordinate sum of this node's subtree's elements
+    representatives_type representatives_; ///< Level-of-detail representatives of the subtree
 };
 
 } // namespace pcp
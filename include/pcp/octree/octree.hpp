@@ -13,8 +13,43 @@
  * @ingroup octree
  */
 
+/**
+ * @defgroup linear-octree "Linear Octree"
+ * Pointerless Morton-ordered Octree implementation.
+ * @ingroup octree
+ */
+
+/**
+ * @defgroup frozen-octree "Frozen Octree"
+ * Read-only contiguous copy of a Linked Octree.
+ * @ingroup octree
+ */
+
+/**
+ * @defgroup out-of-core-octree "Out-of-core Octree"
+ * Octree whose elements are stored in a page file and read through a bounded page cache.
+ * @ingroup octree
+ */
+
+/**
+ * @defgroup persistent-octree "Persistent Octree"
+ * Copy-on-write Octree whose published versions are queried concurrently with updates.
+ * @ingroup octree
+ */
+
+/**
+ * @defgroup sliding-window-octree "Sliding Window Octree"
+ * Octree holding the points of the last frames of a stream, evicted frame by frame.
+ * @ingroup octree
+ */
+
+#include "frozen_octree.hpp"
+#include "linear_octree.hpp"
 #include "linked_octree_iterator.hpp"
 #include "linked_octree.hpp"
 #include "linked_octree_node.hpp"
+#include "out_of_core_octree.hpp"
+#include "persistent_octree.hpp"
+#include "sliding_window_octree.hpp"
 
 #endif // PCP_OCTREE_HPP
\ No newline at end of file
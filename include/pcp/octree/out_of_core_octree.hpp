@@ -0,0 +1,965 @@
+#ifndef PCP_OCTREE_OUT_OF_CORE_OCTREE_HPP
+#define PCP_OCTREE_OUT_OF_CORE_OCTREE_HPP
+
+/**
+ * @file
+ * @ingroup octree
+ */
+
+#include "linear_octree.hpp"
+#include "linked_octree_node.hpp"
+#include "pcp/common/intersections.hpp"
+#include "pcp/common/morton.hpp"
+#include "pcp/common/nearest_neighbours.hpp"
+#include "pcp/common/norm.hpp"
+#include "pcp/common/points/point.hpp"
+#include "pcp/common/vector3d_queries.hpp"
+#include "pcp/traits/property_map_traits.hpp"
+#include "pcp/traits/range_traits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pcp {
+
+/**
+ * @ingroup out-of-core-octree
+ * @brief
+ * Parameters of an out-of-core octree. Leaf buckets are stored in pages of
+ * node_capacity elements, and at most max_cached_pages pages are kept in memory.
+ * @tparam Point Type of point used by the voxel grid to define its AABB.
+ */
+template <class Point>
+struct out_of_core_octree_parameters_t : octree_parameters_t<Point>
+{
+    std::filesystem::path page_file{};  ///< Path of the page file, a temporary file if empty
+    std::size_t max_cached_pages = 64u; ///< Maximum number of pages kept in memory
+};
+
+/**
+ * @ingroup out-of-core-octree
+ * @brief
+ * Octree whose elements are stored in a page file, for point clouds larger
+ * than the available memory. Only the octree's nodes are kept in memory, while
+ * the elements live in the buckets of the leaves, each stored in pages of
+ * node_capacity elements in the page file. Leaves are split when their bucket
+ * is full, like in the linked octree, except at the maximum depth where their
+ * buckets grow by chaining pages.
+ *
+ * Pages are read on demand by the queries and insertions through a least
+ * recently used cache holding at most max_cached_pages pages, so that the
+ * memory used by the elements is capped by the configuration. Modified pages
+ * are written back when they are evicted from the cache or when the octree
+ * is flushed. Range counts of subtrees contained in the queried range are
+ * answered from the nodes without reading any page.
+ *
+ * The page file is created when the octree is constructed and removed when
+ * it is destroyed. Failing to open the page file, or to read or write a page,
+ * throws std::ios_base::failure. Elements must be trivially copyable, since they are
+ * written to the page file as they are in memory. Queries update the page
+ * cache, so the octree must not be used by several threads at once.
+ *
+ * @tparam Element Type of the octree's elements
+ * @tparam ParamsType Type containing the parameters of the octree
+ */
+template <class Element, class ParamsType = out_of_core_octree_parameters_t<pcp::point_t>>
+class basic_out_of_core_octree_t
+{
+    static_assert(
+        std::is_trivially_copyable_v<Element>,
+        "Element must be trivially copyable to be stored in pages");
+
+  public:
+    using element_type    = Element;                        ///< Type of the elements
+    using params_type     = ParamsType;                     ///< Type of the octree's parameters
+    using aabb_type       = typename ParamsType::aabb_type; ///< Type of AABB used for voxels
+    using aabb_point_type = typename aabb_type::point_type; ///< Type of point used by the AABB
+    using page_id_type    = std::uint64_t;                  ///< Type of page identifiers
+    using self_type       = basic_out_of_core_octree_t<element_type, params_type>;
+
+    /**
+     * @brief
+     * Reusable storage for KNN searches. Neighbours are copies of the elements,
+     * since the pages holding the elements may be evicted during the search.
+     */
+    struct knn_scratch_t
+    {
+        using scalar_type         = typename aabb_point_type::coordinate_type;
+        using neighbour_type      = neighbour_t<element_type, scalar_type>;
+        using neighbours_type     = std::vector<neighbour_type>;
+        using node_heap_node_type = neighbour_t<std::size_t, scalar_type>;
+
+        std::vector<node_heap_node_type> nodes;          ///< Min-heap of nodes to visit
+        k_best_heap_t<element_type, scalar_type> k_best; ///< The k best elements
+    };
+
+    using knn_scratch_type = knn_scratch_t; ///< Reusable storage for KNN searches
+    using neighbour_type =
+        typename knn_scratch_type::neighbour_type; ///< (element, squared distance) pair
+
+    /**
+     * @brief Constructs an empty octree and creates its page file
+     * @param params The octree's parameters
+     * @throw std::ios_base::failure if the page file cannot be created
+     */
+    explicit basic_out_of_core_octree_t(params_type const& params)
+        : capacity_(std::max<std::uint32_t>(params.node_capacity, 1u)),
+          max_depth_(params.max_depth),
+          voxel_grid_(params.voxel_grid),
+          nodes_(),
+          pages_(
+              params.page_file.empty() ? temporary_page_file() : params.page_file,
+              capacity_,
+              std::max<std::size_t>(params.max_cached_pages, 1u)),
+          batch_size_(std::max<std::size_t>(params.max_cached_pages, 1u) * capacity_)
+    {
+        clear();
+    }
+
+    /**
+     * @brief Constructs an octree of a range of elements
+     * @tparam ForwardIter Type of the range's iterators
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param begin Iterator to the first element
+     * @param end End iterator of the range
+     * @param point_view The point view property map
+     * @param params The octree's parameters
+     */
+    template <class ForwardIter, class PointViewMap>
+    basic_out_of_core_octree_t(
+        ForwardIter begin,
+        ForwardIter end,
+        PointViewMap const& point_view,
+        params_type const& params)
+        : basic_out_of_core_octree_t(params)
+    {
+        insert(begin, end, point_view);
+    }
+
+    basic_out_of_core_octree_t(self_type const&) = delete;
+    self_type& operator=(self_type const&) = delete;
+
+    /**
+     * @brief Number of elements in the octree
+     * @return Number of elements
+     */
+    std::size_t size() const { return nodes_.front().subtree_size; }
+
+    /**
+     * @brief Checks if the octree is empty
+     * @return True if the octree is empty
+     */
+    bool empty() const { return size() == 0u; }
+
+    /**
+     * @brief Gets the top-level voxel from this octree (the bounding box)
+     * @return This octree's root voxel
+     */
+    aabb_type const& voxel_grid() const { return voxel_grid_; }
+
+    /**
+     * @brief Checks if the page file is open, which it is from construction to destruction
+     * @return True if the page file is open
+     */
+    bool is_open() const { return pages_.is_open(); }
+
+    /**
+     * @brief Number of pages in use in the page file
+     * @return Number of pages
+     */
+    std::size_t page_count() const { return pages_.page_count(); }
+
+    /**
+     * @brief Number of pages currently held in memory, at most max_cached_pages
+     * @return Number of cached pages
+     */
+    std::size_t cached_page_count() const { return pages_.cached_page_count(); }
+
+    /**
+     * @brief Number of pages read from the page file since the octree was constructed
+     * @return Number of page faults
+     */
+    std::size_t page_faults() const { return pages_.page_faults(); }
+
+    /**
+     * @brief Writes the modified pages held in memory to the page file
+     */
+    void flush() { pages_.flush(); }
+
+    /**
+     * @brief Removes all elements from the octree
+     */
+    void clear()
+    {
+        pages_.clear();
+        nodes_.clear();
+        nodes_.push_back(node_t{voxel_grid_});
+    }
+
+    /**
+     * @brief
+     * Inserts a range of elements. Elements outside of the voxel grid are not
+     * inserted. The elements are read in batches of as many elements as the
+     * page cache can hold, and each batch is inserted in Morton order, which
+     * is the depth-first order of the leaves, so that each leaf's pages are
+     * read and written about once per batch.
+     * @tparam ForwardIter Type of the range's iterators
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param begin Iterator to the first element
+     * @param end End iterator of the range
+     * @param point_view The point view property map
+     * @return The number of inserted elements
+     */
+    template <class ForwardIter, class PointViewMap>
+    std::size_t insert(ForwardIter begin, ForwardIter end, PointViewMap const& point_view)
+    {
+        using scalar_type   = typename aabb_point_type::coordinate_type;
+        auto constexpr bits = morton::bits_per_dimension_v<3u>;
+
+        auto const& min = voxel_grid_.min;
+        auto const& max = voxel_grid_.max;
+
+        std::size_t inserted = 0u;
+        std::vector<element_type> batch;
+        std::vector<std::uint64_t> codes;
+        batch.reserve(batch_size_);
+        codes.reserve(batch_size_);
+        for (auto it = begin; it != end;)
+        {
+            batch.clear();
+            codes.clear();
+            for (; it != end && batch.size() < batch_size_; ++it)
+            {
+                auto const p = point_view(*it);
+                if (!voxel_grid_.contains(p))
+                    continue;
+
+                batch.push_back(*it);
+                codes.push_back(morton::encode(
+                    morton::quantize<scalar_type>(p.x(), min.x(), max.x(), bits),
+                    morton::quantize<scalar_type>(p.y(), min.y(), max.y(), bits),
+                    morton::quantize<scalar_type>(p.z(), min.z(), max.z(), bits)));
+            }
+
+            for (auto const i : morton::sorted_order(std::execution::seq, codes))
+                insert_from(0u, 1u, batch[i], point_view);
+
+            inserted += batch.size();
+        }
+
+        return inserted;
+    }
+
+    /**
+     * @brief
+     * Inserts an element in the bucket of its leaf, reading the bucket's last
+     * page, and splits the leaf if its bucket is full
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param e The element to insert
+     * @param point_view The point view property map
+     * @return true if insert was successful
+     */
+    template <class PointViewMap>
+    bool insert(element_type const& e, PointViewMap const& point_view)
+    {
+        auto const p = point_view(e);
+        if (!voxel_grid_.contains(p))
+            return false;
+
+        insert_from(0u, 1u, e, point_view);
+        return true;
+    }
+
+    /*
+     * Returns the k-nearest-neighbours in 3d Euclidean space
+     * using the l2-norm as the notion of distance. The pages
+     * of the visited leaves are read on demand.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * for all points of the octree
+     * @param point_view The PointViewMap property map
+     * @param eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        double eps = 1e-5) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+
+        std::vector<element_type> knearest_points{};
+        knearest_points.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_points.push_back(neighbour.element);
+
+        return knearest_points;
+    }
+
+    /*
+     * Writes the k-nearest-neighbours in 3d Euclidean space to out as
+     * (element, squared distance) pairs, ordered from nearest to furthest.
+     * Storage for the search is taken from scratch, which should be reused
+     * across queries to avoid allocating.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * @param point_view The PointViewMap property map
+     * @param scratch The reusable search storage
+     * @param out Output iterator to neighbour_type values
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_type& scratch,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /*
+     * Returns all points that reside in the given range. The pages
+     * of the leaves overlapping the range are read on demand.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return A list of all points that reside in the given range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type> range_search(Range const& range, PointViewMap const& point_view) const
+    {
+        std::vector<element_type> elements_in_range;
+        range_search(range, point_view, std::back_inserter(elements_in_range));
+        return elements_in_range;
+    }
+
+    /*
+     * Writes all points that reside in the given range to out.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param out Output iterator to the elements in range
+     * @return Output iterator past the last written element
+     */
+    template <class Range, class PointViewMap, class OutputIter>
+    OutputIter
+    range_search(Range const& range, PointViewMap const& point_view, OutputIter out) const
+    {
+        visit_range(range, point_view, [&out](element_type const& e) { *out++ = e; });
+        return out;
+    }
+
+    /*
+     * Calls visitor on all points that reside in the given range,
+     * without storing them. The visitor must not use this octree.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void visit_range(Range const& range, PointViewMap const& point_view, Visitor&& visitor) const
+    {
+        auto const visit_contained_subtree = [&](std::size_t node) {
+            visit_subtree(node, visitor);
+        };
+        query_range(range, point_view, visitor, visit_contained_subtree);
+    }
+
+    /*
+     * Counts the points that reside in the given range. Subtrees
+     * lying entirely inside the range are counted without reading
+     * their pages.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return Number of points in the range
+     */
+    template <class Range, class PointViewMap>
+    std::size_t range_count(Range const& range, PointViewMap const& point_view) const
+    {
+        std::size_t count        = 0u;
+        auto const count_element = [&count](element_type const&) {
+            ++count;
+        };
+        auto const count_contained_subtree = [&](std::size_t node) {
+            count += nodes_[node].subtree_size;
+        };
+        query_range(range, point_view, count_element, count_contained_subtree);
+        return count;
+    }
+
+    /*
+     * Calls visitor on all points of the octree, in depth-first order.
+     * The visitor must not use this octree.
+     *
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Visitor>
+    void for_each(Visitor&& visitor) const
+    {
+        visit_subtree(0u, visitor);
+    }
+
+  private:
+    static constexpr std::size_t no_node = 0u; ///< The root is never a child
+
+    /**
+     * @brief A page of a leaf's bucket
+     */
+    struct page_ref_t
+    {
+        page_id_type id;  ///< Identifier of the page in the page file
+        std::size_t size; ///< Number of elements in the page
+    };
+
+    struct node_t
+    {
+        aabb_type voxel{};                     ///< The node's voxel
+        std::array<std::size_t, 8u> octants{}; ///< Children, no_node if absent
+        std::vector<page_ref_t> pages{};       ///< Pages of the bucket of a leaf
+        std::size_t subtree_size = 0u;         ///< Number of elements in the subtree
+        bool is_leaf             = true;       ///< True if the node has no children
+    };
+
+    /**
+     * @brief
+     * Least recently used cache of the pages of a page file. Pages hold up to
+     * page_capacity elements at offsets id * page_capacity * sizeof(element_type).
+     * Pages returned by fetch and allocate stay valid until the next call
+     * to fetch or allocate. I/O errors throw std::ios_base::failure, leaving
+     * the cache without the page which could not be read or with the page
+     * which could not be written still marked as modified.
+     */
+    class page_cache_t
+    {
+      public:
+        page_cache_t(
+            std::filesystem::path path,
+            std::size_t page_capacity,
+            std::size_t max_cached_pages)
+            : path_(std::move(path)),
+              file_(
+                  path_,
+                  std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc),
+              page_capacity_(page_capacity),
+              max_cached_pages_(max_cached_pages)
+        {
+            if (!file_.is_open())
+                throw std::ios_base::failure("could not create page file " + path_.string());
+        }
+
+        page_cache_t(page_cache_t const&) = delete;
+        page_cache_t& operator=(page_cache_t const&) = delete;
+
+        ~page_cache_t()
+        {
+            file_.close();
+            std::error_code ec;
+            std::filesystem::remove(path_, ec);
+        }
+
+        bool is_open() const { return file_.is_open(); }
+        std::size_t page_count() const { return next_page_ - free_pages_.size(); }
+        std::size_t cached_page_count() const { return lru_.size(); }
+        std::size_t page_faults() const { return page_faults_; }
+
+        /**
+         * @brief Reads a page, from the cache if it is cached
+         * @param page The page
+         * @return The page's elements
+         */
+        std::vector<element_type>& fetch(page_ref_t const& page)
+        {
+            auto const it = index_.find(page.id);
+            if (it != index_.end())
+            {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                return lru_.front().elements;
+            }
+
+            auto& cached = make_room_for(page.id);
+            cached.elements.resize(page.size);
+            if (page.size > 0u)
+            {
+                file_.seekg(offset_of(page.id));
+                file_.read(
+                    reinterpret_cast<char*>(cached.elements.data()),
+                    static_cast<std::streamsize>(page.size * sizeof(element_type)));
+                if (!file_)
+                {
+                    index_.erase(page.id);
+                    lru_.pop_front();
+                    file_.clear();
+                    throw std::ios_base::failure("could not read page from " + path_.string());
+                }
+            }
+            ++page_faults_;
+            return cached.elements;
+        }
+
+        /**
+         * @brief Marks a cached page as modified, to be written back on eviction
+         * @param id The page's identifier
+         */
+        void mark_dirty(page_id_type id) { index_.at(id)->is_dirty = true; }
+
+        /**
+         * @brief Creates an empty page, reusing the pages of the file released by release
+         * @return The new page's identifier
+         */
+        page_id_type allocate()
+        {
+            page_id_type id = next_page_;
+            if (free_pages_.empty())
+                ++next_page_;
+            else
+            {
+                id = free_pages_.back();
+                free_pages_.pop_back();
+            }
+
+            auto& cached    = make_room_for(id);
+            cached.is_dirty = true;
+            cached.elements.reserve(page_capacity_);
+            return id;
+        }
+
+        /**
+         * @brief Releases a page without writing it back
+         * @param id The page's identifier
+         */
+        void release(page_id_type id)
+        {
+            auto const it = index_.find(id);
+            if (it != index_.end())
+            {
+                lru_.erase(it->second);
+                index_.erase(it);
+            }
+            free_pages_.push_back(id);
+        }
+
+        void flush()
+        {
+            for (auto& cached : lru_)
+                write_back(cached);
+            if (!file_.flush())
+            {
+                file_.clear();
+                throw std::ios_base::failure("could not flush page file " + path_.string());
+            }
+        }
+
+        void clear()
+        {
+            lru_.clear();
+            index_.clear();
+            free_pages_.clear();
+            next_page_ = 0u;
+        }
+
+      private:
+        struct cached_page_t
+        {
+            page_id_type id;
+            std::vector<element_type> elements;
+            bool is_dirty;
+        };
+
+        using lru_type = std::list<cached_page_t>;
+
+        std::streamoff offset_of(page_id_type id) const
+        {
+            return static_cast<std::streamoff>(id * page_capacity_ * sizeof(element_type));
+        }
+
+        void write_back(cached_page_t& cached)
+        {
+            if (!cached.is_dirty)
+                return;
+
+            if (!cached.elements.empty())
+            {
+                file_.seekp(offset_of(cached.id));
+                file_.write(
+                    reinterpret_cast<char const*>(cached.elements.data()),
+                    static_cast<std::streamsize>(cached.elements.size() * sizeof(element_type)));
+                if (!file_)
+                {
+                    file_.clear();
+                    throw std::ios_base::failure("could not write page to " + path_.string());
+                }
+            }
+            cached.is_dirty = false;
+        }
+
+        /**
+         * @brief
+         * Evicts the least recently used page if the cache is full, and
+         * caches an empty page, reusing the evicted page's storage
+         * @param id Identifier of the cached page
+         * @return The cached page, the most recently used
+         */
+        cached_page_t& make_room_for(page_id_type id)
+        {
+            if (lru_.size() >= max_cached_pages_)
+            {
+                auto& evicted = lru_.back();
+                write_back(evicted);
+                index_.erase(evicted.id);
+                lru_.splice(lru_.begin(), lru_, std::prev(lru_.end()));
+            }
+            else
+            {
+                lru_.emplace_front(cached_page_t{id, {}, false});
+            }
+
+            auto& cached = lru_.front();
+            cached.id    = id;
+            cached.elements.clear();
+            cached.is_dirty = false;
+            index_[id]      = lru_.begin();
+            return cached;
+        }
+
+        std::filesystem::path path_;
+        std::fstream file_;
+        std::size_t page_capacity_;
+        std::size_t max_cached_pages_;
+        lru_type lru_{}; ///< Cached pages, from the most to the least recently used
+        std::unordered_map<page_id_type, typename lru_type::iterator> index_{};
+        std::vector<page_id_type> free_pages_{};
+        page_id_type next_page_  = 0u;
+        std::size_t page_faults_ = 0u;
+    };
+
+    static std::filesystem::path temporary_page_file()
+    {
+        std::random_device rd;
+        std::uniform_int_distribution<std::uint64_t> distribution{};
+        return std::filesystem::temp_directory_path() /
+               ("pcp-octree-" + std::to_string(distribution(rd)) + ".pages");
+    }
+
+    static aabb_type octant_voxel(aabb_type const& voxel, std::uint8_t octant)
+    {
+        return basic_linear_octree_t<Element, ParamsType>::octant_voxel(voxel, octant);
+    }
+
+    template <class TPointView>
+    static std::uint8_t octant_of(aabb_type const& voxel, TPointView const& p)
+    {
+        auto const center   = voxel.center();
+        std::uint8_t octant = 0b000;
+        if (p.x() > center.x())
+            octant |= 0b100;
+        if (p.y() > center.y())
+            octant |= 0b010;
+        if (p.z() > center.z())
+            octant |= 0b001;
+        return octant;
+    }
+
+    /**
+     * @brief
+     * Inserts an element in the subtree of a node. Full leaves above the
+     * maximum depth are split, while leaves at the maximum depth chain a
+     * new page to their bucket.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param node Index of the subtree's root
+     * @param depth Depth of the subtree's root, 1 for the root
+     * @param e The element to insert
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void insert_from(
+        std::size_t node,
+        std::uint8_t depth,
+        element_type const& e,
+        PointViewMap const& point_view)
+    {
+        auto const p = point_view(e);
+        for (;; ++depth)
+        {
+            ++nodes_[node].subtree_size;
+            if (nodes_[node].is_leaf)
+            {
+                auto const size = nodes_[node].subtree_size - 1u;
+                if (size < capacity_ || depth >= max_depth_)
+                {
+                    append(node, e);
+                    return;
+                }
+
+                split(node, depth, point_view);
+            }
+
+            node = child_of(node, octant_of(nodes_[node].voxel, p));
+        }
+    }
+
+    /**
+     * @brief Gets the child of a node in an octant, creating an empty leaf if it has none
+     * @param node Index of the node
+     * @param octant The octant
+     * @return Index of the child
+     */
+    std::size_t child_of(std::size_t node, std::uint8_t octant)
+    {
+        auto const child = nodes_[node].octants[octant];
+        if (child != no_node)
+            return child;
+
+        nodes_.push_back(node_t{octant_voxel(nodes_[node].voxel, octant)});
+        nodes_[node].octants[octant] = nodes_.size() - 1u;
+        return nodes_.size() - 1u;
+    }
+
+    /**
+     * @brief Appends an element to a leaf's bucket, chaining a new page if the last is full
+     * @param node Index of the leaf
+     * @param e The element
+     */
+    void append(std::size_t node, element_type const& e)
+    {
+        auto& pages = nodes_[node].pages;
+        if (pages.empty() || pages.back().size >= capacity_)
+            pages.push_back(page_ref_t{pages_.allocate(), 0u});
+
+        auto& page = pages.back();
+        pages_.fetch(page).push_back(e);
+        pages_.mark_dirty(page.id);
+        ++page.size;
+    }
+
+    /**
+     * @brief
+     * Turns a full leaf into an internal node, moving its bucket's elements
+     * down to its children, and releases the leaf's pages
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param node Index of the leaf
+     * @param depth Depth of the leaf
+     * @param point_view The point view property map
+     */
+    template <class PointViewMap>
+    void split(std::size_t node, std::uint8_t depth, PointViewMap const& point_view)
+    {
+        std::vector<element_type> elements;
+        elements.reserve(nodes_[node].subtree_size);
+        for (auto const& page : nodes_[node].pages)
+        {
+            auto const& page_elements = pages_.fetch(page);
+            elements.insert(elements.end(), page_elements.cbegin(), page_elements.cend());
+            pages_.release(page.id);
+        }
+
+        nodes_[node].pages.clear();
+        nodes_[node].is_leaf = false;
+        for (auto const& e : elements)
+        {
+            auto const child = child_of(node, octant_of(nodes_[node].voxel, point_view(e)));
+            insert_from(child, static_cast<std::uint8_t>(depth + 1u), e, point_view);
+        }
+    }
+
+    template <class Visitor>
+    void visit_leaf(node_t const& node, Visitor& visitor) const
+    {
+        for (auto const& page : node.pages)
+            for (auto const& e : pages_.fetch(page))
+                visitor(e);
+    }
+
+    template <class Visitor>
+    void visit_subtree(std::size_t node, Visitor& visitor) const
+    {
+        if (nodes_[node].is_leaf)
+        {
+            visit_leaf(nodes_[node], visitor);
+            return;
+        }
+
+        for (auto const octant : nodes_[node].octants)
+            if (octant != no_node)
+                visit_subtree(octant, visitor);
+    }
+
+    /**
+     * @brief
+     * Range query implementation shared by the range searches and range counts.
+     * Elements of leaves overlapping the range are tested individually, while
+     * subtrees contained in the range are reported as a whole.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam ElementVisitor Callable type taking an element_type const&
+     * @tparam SubtreeVisitor Callable type taking the index of a node
+     * @param range The queried range
+     * @param point_view The point view property map
+     * @param visit_element Callback on the elements found to be in the range
+     * @param visit_contained_subtree Callback on the subtrees contained in the range
+     */
+    template <class Range, class PointViewMap, class ElementVisitor, class SubtreeVisitor>
+    void query_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        ElementVisitor& visit_element,
+        SubtreeVisitor const& visit_contained_subtree) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+
+        auto const recurse = [&](auto const& self, std::size_t node) -> void {
+            auto const overlap = intersections::classify(nodes_[node].voxel, range);
+            if (overlap == intersections::overlap_t::disjoint)
+                return;
+
+            if (overlap == intersections::overlap_t::contained)
+            {
+                visit_contained_subtree(node);
+                return;
+            }
+
+            if (nodes_[node].is_leaf)
+            {
+                auto const visit_element_in_range = [&](element_type const& e) {
+                    if (range.contains(point_view(e)))
+                        visit_element(e);
+                };
+                visit_leaf(nodes_[node], visit_element_in_range);
+                return;
+            }
+
+            for (auto const octant : nodes_[node].octants)
+                if (octant != no_node)
+                    self(self, octant);
+        };
+
+        recurse(recurse, 0u);
+    }
+
+    /**
+     * @brief
+     * Best-first KNN search implementation. Nodes are visited in order of their
+     * distance to the target, so that only the pages of the leaves which may
+     * hold one of the k nearest neighbours are read.
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param scratch Storage for the search's heaps
+     * @param eps The error tolerance for floating point equality
+     * @return The neighbours sorted from nearest to furthest, stored in scratch
+     */
+    template <class TPointView, class PointViewMap>
+    typename knn_scratch_t::neighbours_type const& knn_search(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_t& scratch,
+        double const eps) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+        using coordinate_type  = typename point_view_type::coordinate_type;
+        using node_heap_node_t = typename knn_scratch_t::node_heap_node_type;
+
+        auto& k_best = scratch.k_best;
+        auto& heap   = scratch.nodes;
+        k_best.reset(k);
+        heap.clear();
+
+        if (k <= 0u || empty())
+            return k_best.sort();
+
+        auto const greater = [](node_heap_node_t const& h1, node_heap_node_t const& h2) {
+            return h2 < h1;
+        };
+
+        auto const distance_to = [&target](aabb_type const& voxel) {
+            return common::squared_distance(target, voxel.nearest_point_from(target));
+        };
+
+        heap.push_back(node_heap_node_t{0u, distance_to(nodes_.front().voxel)});
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            auto const [node, node_distance] = heap.back();
+            heap.pop_back();
+
+            if (node_distance > k_best.bound())
+                break;
+
+            if (nodes_[node].is_leaf)
+            {
+                auto const push_element = [&](element_type const& e) {
+                    auto const p = point_view(e);
+                    if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+                        return;
+
+                    k_best.push(e, common::squared_distance(target, p));
+                };
+                visit_leaf(nodes_[node], push_element);
+                continue;
+            }
+
+            for (auto const octant : nodes_[node].octants)
+            {
+                if (octant == no_node)
+                    continue;
+
+                auto const d = distance_to(nodes_[octant].voxel);
+                if (d > k_best.bound())
+                    continue;
+
+                heap.push_back(node_heap_node_t{octant, d});
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+
+        return k_best.sort();
+    }
+
+    std::uint32_t capacity_;     ///< Maximum number of elements of a page
+    std::uint8_t max_depth_;     ///< Maximum depth of the octree
+    aabb_type voxel_grid_;       ///< The root voxel
+    std::vector<node_t> nodes_;  ///< The nodes, the root first
+    mutable page_cache_t pages_; ///< Cache of the page file
+    std::size_t batch_size_;     ///< Number of elements sorted together by range insertions
+};
+
+using out_of_core_octree_t = pcp::basic_out_of_core_octree_t<pcp::point_t>;
+
+} // namespace pcp
+
+#endif // PCP_OCTREE_OUT_OF_CORE_OCTREE_HPP
@@ -0,0 +1,774 @@
+#ifndef PCP_OCTREE_PERSISTENT_OCTREE_HPP
+#define PCP_OCTREE_PERSISTENT_OCTREE_HPP
+
+/**
+ * @file
+ * @ingroup octree
+ */
+
+#include "linear_octree.hpp"
+#include "linked_octree_node.hpp"
+#include "pcp/common/intersections.hpp"
+#include "pcp/common/nearest_neighbours.hpp"
+#include "pcp/common/norm.hpp"
+#include "pcp/common/points/point.hpp"
+#include "pcp/common/vector3d_queries.hpp"
+#include "pcp/traits/property_map_traits.hpp"
+#include "pcp/traits/range_traits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace pcp {
+
+/**
+ * @ingroup persistent-octree
+ * @brief
+ * Node of a persistent octree. Nodes reachable from a published version
+ * are never modified, so they are shared between versions, and a node
+ * is destroyed when the last version referring to it is released.
+ * @tparam Element Type of the octree's elements
+ */
+template <class Element>
+struct persistent_octree_node_t
+{
+    using self_type    = persistent_octree_node_t<Element>;
+    using pointer_type = std::shared_ptr<self_type>;
+
+    std::vector<Element> elements{};        ///< Elements held by this node itself
+    std::array<pointer_type, 8u> octants{}; ///< Children of this node, indexed by octant
+    std::size_t subtree_size = 0u;          ///< Number of elements in this node's subtree
+    std::uint64_t version    = 0u;          ///< Version of the octree which created this node
+};
+
+/**
+ * @ingroup persistent-octree
+ * @brief
+ * Immutable version of a persistent octree. A snapshot keeps its version
+ * alive for as long as it exists, whatever the writer does to the octree
+ * afterwards, so any number of threads may query snapshots while the
+ * octree is being modified.
+ * @tparam Element Type of the octree's elements
+ * @tparam ParamsType Type containing the parameters of the octree
+ */
+template <class Element, class ParamsType = octree_parameters_t<pcp::point_t>>
+class basic_persistent_octree_snapshot_t
+{
+  public:
+    using element_type    = Element;                           ///< Type of the elements
+    using node_type       = persistent_octree_node_t<Element>; ///< Type of the octree's nodes
+    using params_type     = ParamsType;                        ///< Type of the octree's parameters
+    using aabb_type       = typename ParamsType::aabb_type;    ///< Type of AABB used for voxels
+    using aabb_point_type = typename aabb_type::point_type;    ///< Type of point used by the AABB
+    using self_type       = basic_persistent_octree_snapshot_t<element_type, params_type>;
+
+    /**
+     * @brief
+     * Reusable storage for KNN searches. Keeping one scratch object per thread
+     * lets repeated searches run without allocating.
+     */
+    struct knn_scratch_t
+    {
+        using scalar_type     = typename aabb_point_type::coordinate_type;
+        using neighbour_type  = neighbour_t<element_type const*, scalar_type>;
+        using neighbours_type = std::vector<neighbour_type>;
+
+        k_best_heap_t<element_type const*, scalar_type> k_best; ///< The k best elements
+    };
+
+    using knn_scratch_type = knn_scratch_t; ///< Reusable storage for KNN searches
+    using neighbour_type =
+        typename knn_scratch_type::neighbour_type; ///< (element, squared distance) pair
+
+    basic_persistent_octree_snapshot_t() = default;
+
+    /**
+     * @brief Snapshot of the octree version rooted at root
+     * @param root The version's root node
+     * @param voxel_grid The octree's bounding box
+     * @param version The version number
+     */
+    basic_persistent_octree_snapshot_t(
+        std::shared_ptr<node_type const> root,
+        aabb_type const& voxel_grid,
+        std::uint64_t version)
+        : root_(std::move(root)), voxel_grid_(voxel_grid), version_(version)
+    {
+    }
+
+    /**
+     * @brief Number of elements in this version of the octree
+     * @return Number of elements
+     */
+    std::size_t size() const { return root_ ? root_->subtree_size : 0u; }
+
+    /**
+     * @brief Checks if this version of the octree is empty
+     * @return True if this version of the octree is empty
+     */
+    bool empty() const { return size() == 0u; }
+
+    /**
+     * @brief Gets the top-level voxel from this octree (the bounding box)
+     * @return This octree's root voxel
+     */
+    aabb_type const& voxel_grid() const { return voxel_grid_; }
+
+    /**
+     * @brief Number of the octree version, incremented by each publication
+     * @return The version number
+     */
+    std::uint64_t version() const { return version_; }
+
+    /*
+     * Returns true if an element at the position of e is in this
+     * version of the octree.
+     *
+     * @param e Element to search for in the octree
+     * @param point_view The PointViewMap property map
+     * @return true if the element was found
+     */
+    template <class PointViewMap>
+    bool contains(element_type const& e, PointViewMap const& point_view) const
+    {
+        auto const p = point_view(e);
+        if (!root_ || !voxel_grid_.contains(p))
+            return false;
+
+        auto const is_equal = [&](element_type const& other) {
+            return common::are_vectors_equal(p, point_view(other));
+        };
+
+        node_type const* node = root_.get();
+        aabb_type voxel       = voxel_grid_;
+        while (node != nullptr)
+        {
+            if (std::any_of(node->elements.cbegin(), node->elements.cend(), is_equal))
+                return true;
+
+            auto const octant = octant_of(voxel, p);
+            voxel             = octant_voxel(voxel, octant);
+            node              = node->octants[octant].get();
+        }
+        return false;
+    }
+
+    /*
+     * Returns the k-nearest-neighbours in 3d Euclidean space
+     * using the l2-norm as the notion of distance.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * for all points of the octree
+     * @param point_view The PointViewMap property map
+     * @param eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        double eps = 1e-5) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+
+        std::vector<element_type> knearest_points{};
+        knearest_points.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_points.push_back(*neighbour.element);
+
+        return knearest_points;
+    }
+
+    /*
+     * Writes the k-nearest-neighbours in 3d Euclidean space to out as
+     * (element, squared distance) pairs, ordered from nearest to furthest.
+     * Storage for the search is taken from scratch, which should be reused
+     * across queries (one per thread) to avoid allocating. The elements
+     * pointed to remain valid for as long as this snapshot exists.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * @param point_view The PointViewMap property map
+     * @param scratch The reusable search storage
+     * @param out Output iterator to neighbour_type values
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_type& scratch,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /*
+     * Returns all points that reside in the given range.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return A list of all points that reside in the given range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type> range_search(Range const& range, PointViewMap const& point_view) const
+    {
+        std::vector<element_type> elements_in_range;
+        range_search(range, point_view, std::back_inserter(elements_in_range));
+        return elements_in_range;
+    }
+
+    /*
+     * Writes all points that reside in the given range to out.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param out Output iterator to the elements in range
+     * @return Output iterator past the last written element
+     */
+    template <class Range, class PointViewMap, class OutputIter>
+    OutputIter
+    range_search(Range const& range, PointViewMap const& point_view, OutputIter out) const
+    {
+        visit_range(range, point_view, [&out](element_type const& e) { *out++ = e; });
+        return out;
+    }
+
+    /*
+     * Calls visitor on all points that reside in the given range,
+     * without storing them.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void visit_range(Range const& range, PointViewMap const& point_view, Visitor&& visitor) const
+    {
+        auto const visit_contained_subtree = [&visitor](node_type const& node) {
+            visit_subtree(node, visitor);
+        };
+        query_range(range, point_view, visitor, visit_contained_subtree);
+    }
+
+    /*
+     * Counts the points that reside in the given range. Subtrees
+     * lying entirely inside the range are counted without visiting
+     * their points.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return Number of points in the range
+     */
+    template <class Range, class PointViewMap>
+    std::size_t range_count(Range const& range, PointViewMap const& point_view) const
+    {
+        std::size_t count        = 0u;
+        auto const count_element = [&count](element_type const&) {
+            ++count;
+        };
+        auto const count_contained_subtree = [&count](node_type const& node) {
+            count += node.subtree_size;
+        };
+        query_range(range, point_view, count_element, count_contained_subtree);
+        return count;
+    }
+
+    /*
+     * Calls visitor on all points of this version of the octree, in
+     * depth-first order.
+     *
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Visitor>
+    void for_each(Visitor&& visitor) const
+    {
+        if (root_)
+            visit_subtree(*root_, visitor);
+    }
+
+  private:
+    static aabb_type octant_voxel(aabb_type const& voxel, std::uint8_t octant)
+    {
+        return basic_linear_octree_t<Element, ParamsType>::octant_voxel(voxel, octant);
+    }
+
+    template <class TPointView>
+    static std::uint8_t octant_of(aabb_type const& voxel, TPointView const& p)
+    {
+        auto const center   = voxel.center();
+        std::uint8_t octant = 0b000;
+        if (p.x() > center.x())
+            octant |= 0b100;
+        if (p.y() > center.y())
+            octant |= 0b010;
+        if (p.z() > center.z())
+            octant |= 0b001;
+        return octant;
+    }
+
+    template <class Visitor>
+    static void visit_subtree(node_type const& node, Visitor& visitor)
+    {
+        for (auto const& e : node.elements)
+            visitor(e);
+
+        for (auto const& octant : node.octants)
+            if (octant)
+                visit_subtree(*octant, visitor);
+    }
+
+    /**
+     * @brief
+     * Range query implementation shared by the range searches and range counts.
+     * Elements of nodes overlapping the range are tested individually, while
+     * subtrees contained in the range are reported as a whole.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam ElementVisitor Callable type taking an element_type const&
+     * @tparam SubtreeVisitor Callable type taking a node_type const&
+     * @param range The queried range
+     * @param point_view The point view property map
+     * @param visit_element Callback on the elements found to be in the range
+     * @param visit_contained_subtree Callback on the subtrees contained in the range
+     */
+    template <class Range, class PointViewMap, class ElementVisitor, class SubtreeVisitor>
+    void query_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        ElementVisitor& visit_element,
+        SubtreeVisitor const& visit_contained_subtree) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+
+        if (!root_)
+            return;
+
+        auto const recurse = [&](auto const& self, node_type const& node, aabb_type const& voxel) {
+            auto const overlap = intersections::classify(voxel, range);
+            if (overlap == intersections::overlap_t::disjoint)
+                return;
+
+            if (overlap == intersections::overlap_t::contained)
+            {
+                visit_contained_subtree(node);
+                return;
+            }
+
+            for (auto const& e : node.elements)
+                if (range.contains(point_view(e)))
+                    visit_element(e);
+
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+                if (node.octants[o])
+                    self(self, *node.octants[o], octant_voxel(voxel, o));
+        };
+
+        recurse(recurse, *root_, voxel_grid_);
+    }
+
+    /**
+     * @brief
+     * Depth-first KNN search implementation, visiting the children of a node
+     * nearest first like the frozen octree does
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param scratch Storage for the search's heap
+     * @param eps The error tolerance for floating point equality
+     * @return The neighbours sorted from nearest to furthest, stored in scratch
+     */
+    template <class TPointView, class PointViewMap>
+    typename knn_scratch_t::neighbours_type const& knn_search(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_t& scratch,
+        double const eps) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+        using coordinate_type = typename point_view_type::coordinate_type;
+        using scalar_type     = typename knn_scratch_t::scalar_type;
+
+        auto& k_best = scratch.k_best;
+        k_best.reset(k);
+
+        if (k <= 0u || empty())
+            return k_best.sort();
+
+        auto const recurse = [&](auto const& self,
+                                 node_type const& node,
+                                 aabb_type const& voxel) -> void {
+            for (auto const& e : node.elements)
+            {
+                auto const p = point_view(e);
+                if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+                    continue;
+
+                k_best.push(std::addressof(e), common::squared_distance(target, p));
+            }
+
+            struct child_t
+            {
+                scalar_type squared_distance;
+                node_type const* node;
+                aabb_type voxel;
+            };
+            std::array<child_t, 8u> children{};
+            std::uint8_t n = 0u;
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+            {
+                if (!node.octants[o])
+                    continue;
+
+                auto const child_voxel = octant_voxel(voxel, o);
+                auto const d =
+                    common::squared_distance(target, child_voxel.nearest_point_from(target));
+                children[n] = child_t{d, node.octants[o].get(), child_voxel};
+                ++n;
+            }
+            std::sort(
+                children.begin(),
+                children.begin() + n,
+                [](child_t const& c1, child_t const& c2) {
+                    return c1.squared_distance < c2.squared_distance;
+                });
+
+            for (std::uint8_t c = 0u; c < n; ++c)
+            {
+                if (children[c].squared_distance > k_best.bound())
+                    break;
+
+                self(self, *children[c].node, children[c].voxel);
+            }
+        };
+
+        recurse(recurse, *root_, voxel_grid_);
+        return k_best.sort();
+    }
+
+    std::shared_ptr<node_type const> root_{}; ///< Root of this version
+    aabb_type voxel_grid_{};                  ///< The root voxel
+    std::uint64_t version_ = 0u;              ///< Number of this version
+};
+
+/**
+ * @ingroup persistent-octree
+ * @brief
+ * Octree with copy-on-write nodes, for indices that keep answering queries
+ * while they are being modified. A single writer modifies the octree's
+ * working version, and publishes it once a batch of modifications is done.
+ * Readers take snapshots of the last published version, concurrently with
+ * the writer and with each other, and query them without any locking.
+ *
+ * The working version shares all the nodes that it did not modify with the
+ * published versions. The first modification of a published node copies it,
+ * along with the path from the root to it, so a batch of modifications copies
+ * each node it touches at most once. Nodes created since the last publication
+ * are modified in place. Old versions are reclaimed by reference counting:
+ * the nodes that only belong to a version are destroyed when the last
+ * snapshot of the version is released, which may happen on a reader thread.
+ *
+ * Elements are placed in the nodes like in the eager linked octree, so
+ * the snapshots have the structure of a linked octree holding the same
+ * elements inserted in the same order.
+ *
+ * @tparam Element Type of the octree's elements
+ * @tparam ParamsType Type containing the parameters of the octree
+ */
+template <class Element, class ParamsType = octree_parameters_t<pcp::point_t>>
+class basic_persistent_octree_t
+{
+  public:
+    using element_type  = Element;                           ///< Type of the elements
+    using node_type     = persistent_octree_node_t<Element>; ///< Type of the octree's nodes
+    using params_type   = ParamsType;                        ///< Type of the octree's parameters
+    using aabb_type     = typename ParamsType::aabb_type;    ///< Type of AABB used for voxels
+    using snapshot_type = basic_persistent_octree_snapshot_t<Element, ParamsType>; ///< Version
+    using self_type     = basic_persistent_octree_t<element_type, params_type>;
+
+    /**
+     * @brief Constructs an empty octree, whose first published version is empty
+     * @param params The octree's parameters
+     */
+    explicit basic_persistent_octree_t(params_type const& params)
+        : capacity_(params.node_capacity),
+          max_depth_(params.max_depth),
+          voxel_grid_(params.voxel_grid),
+          root_(std::make_shared<node_type>())
+    {
+        publish();
+    }
+
+    /**
+     * @brief Constructs the octree with a range of elements, and publishes it
+     * @tparam ForwardIter Type of the range's iterators
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param begin Iterator to the first element of the range
+     * @param end End iterator of the range
+     * @param point_view The point view property map
+     * @param params The octree's parameters
+     */
+    template <class ForwardIter, class PointViewMap>
+    explicit basic_persistent_octree_t(
+        ForwardIter begin,
+        ForwardIter end,
+        PointViewMap const& point_view,
+        params_type const& params)
+        : capacity_(params.node_capacity),
+          max_depth_(params.max_depth),
+          voxel_grid_(params.voxel_grid),
+          root_(std::make_shared<node_type>())
+    {
+        insert(begin, end, point_view);
+        publish();
+    }
+
+    basic_persistent_octree_t(self_type const&) = delete;
+    self_type& operator=(self_type const&) = delete;
+
+    /**
+     * @brief Number of elements in the working version of the octree
+     * @return Number of elements
+     */
+    std::size_t size() const { return root_->subtree_size; }
+
+    /**
+     * @brief Checks if the working version of the octree is empty
+     * @return True if the working version is empty
+     */
+    bool empty() const { return size() == 0u; }
+
+    /**
+     * @brief Gets the top-level voxel from this octree (the bounding box)
+     * @return This octree's root voxel
+     */
+    aabb_type const& voxel_grid() const { return voxel_grid_; }
+
+    /**
+     * @brief Number of the working version, which is the last published version plus one
+     * @return The working version number
+     */
+    std::uint64_t version() const { return version_; }
+
+    /**
+     * @brief
+     * Insert one element in the working version of the octree
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param e The element to insert
+     * @param point_view The point view property map
+     * @return true if insert was successful
+     */
+    template <class PointViewMap>
+    bool insert(element_type const& e, PointViewMap const& point_view)
+    {
+        auto const p = point_view(e);
+        if (!voxel_grid_.contains(p))
+            return false;
+
+        node_type* node = root_.get();
+        aabb_type voxel = voxel_grid_;
+        for (std::uint8_t depth = 1u;; ++depth)
+        {
+            ++node->subtree_size;
+            if (depth >= max_depth_ || node->elements.size() < capacity_)
+            {
+                node->elements.push_back(e);
+                return true;
+            }
+
+            auto const octant = octant_of(voxel, p);
+            auto& child       = node->octants[octant];
+            if (!child)
+                child = make_node();
+
+            node  = writable(child);
+            voxel = octant_voxel(voxel, octant);
+        }
+    }
+
+    /**
+     * @brief
+     * Insert range of elements in the working version of the octree
+     * @tparam ForwardIter Type of the range's iterators
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param begin Iterator to the first element of the range
+     * @param end End iterator of the range
+     * @param point_view The point view property map
+     * @return The number of inserted elements
+     */
+    template <class ForwardIter, class PointViewMap>
+    std::size_t insert(ForwardIter begin, ForwardIter end, PointViewMap const& point_view)
+    {
+        std::size_t inserted = 0u;
+        for (auto it = begin; it != end; ++it)
+            if (insert(*it, point_view))
+                ++inserted;
+
+        return inserted;
+    }
+
+    /**
+     * @brief
+     * Removes the element at the position of e from the working version of
+     * the octree. Leaves left empty are removed.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param e The element to remove
+     * @param point_view The point view property map
+     * @return true if an element was removed
+     */
+    template <class PointViewMap>
+    bool erase(element_type const& e, PointViewMap const& point_view)
+    {
+        auto const p = point_view(e);
+        if (!voxel_grid_.contains(p))
+            return false;
+
+        auto const is_equal = [&](element_type const& other) {
+            return common::are_vectors_equal(p, point_view(other));
+        };
+
+        /*
+         * The element is searched for before copying any node,
+         * so that erasing a missing element leaves the shared
+         * nodes untouched.
+         */
+        std::vector<std::uint8_t> path;
+        node_type const* node = root_.get();
+        aabb_type voxel       = voxel_grid_;
+        while (std::none_of(node->elements.cbegin(), node->elements.cend(), is_equal))
+        {
+            auto const octant = octant_of(voxel, p);
+            if (!node->octants[octant])
+                return false;
+
+            path.push_back(octant);
+            node  = node->octants[octant].get();
+            voxel = octant_voxel(voxel, octant);
+        }
+
+        std::vector<node_type*> nodes{root_.get()};
+        for (auto const octant : path)
+            nodes.push_back(writable(nodes.back()->octants[octant]));
+
+        for (auto* n : nodes)
+            --n->subtree_size;
+
+        auto& elements = nodes.back()->elements;
+        elements.erase(std::find_if(elements.begin(), elements.end(), is_equal));
+
+        for (std::size_t i = path.size(); i-- > 0u;)
+            if (nodes[i + 1u]->subtree_size == 0u)
+                nodes[i]->octants[path[i]].reset();
+
+        return true;
+    }
+
+    /**
+     * @brief Removes all elements from the working version of the octree
+     */
+    void clear() { root_ = make_node(); }
+
+    /**
+     * @brief
+     * Makes the working version of the octree visible to the snapshots taken
+     * from now on. The nodes of the published version become immutable, and
+     * the next modifications copy them before changing them.
+     */
+    void publish()
+    {
+        auto const published = std::make_shared<snapshot_type const>(
+            std::shared_ptr<node_type const>(root_),
+            voxel_grid_,
+            version_);
+        std::atomic_store(&published_, published);
+
+        ++version_;
+        root_ = std::make_shared<node_type>(*root_);
+        root_->version = version_;
+    }
+
+    /**
+     * @brief
+     * Snapshot of the last published version of the octree. May be called
+     * by any number of threads, concurrently with the writer.
+     * @return The last published version
+     */
+    snapshot_type snapshot() const { return *std::atomic_load(&published_); }
+
+  private:
+    static aabb_type octant_voxel(aabb_type const& voxel, std::uint8_t octant)
+    {
+        return basic_linear_octree_t<Element, ParamsType>::octant_voxel(voxel, octant);
+    }
+
+    template <class TPointView>
+    static std::uint8_t octant_of(aabb_type const& voxel, TPointView const& p)
+    {
+        auto const center   = voxel.center();
+        std::uint8_t octant = 0b000;
+        if (p.x() > center.x())
+            octant |= 0b100;
+        if (p.y() > center.y())
+            octant |= 0b010;
+        if (p.z() > center.z())
+            octant |= 0b001;
+        return octant;
+    }
+
+    typename node_type::pointer_type make_node() const
+    {
+        auto node     = std::make_shared<node_type>();
+        node->version = version_;
+        return node;
+    }
+
+    /**
+     * @brief
+     * Gives write access to a node of the working version, copying it first if
+     * it belongs to a published version. The parent of the node must already
+     * belong to the working version.
+     * @param node The parent's pointer to the node, replaced by the copy
+     * @return The node of the working version
+     */
+    node_type* writable(typename node_type::pointer_type& node) const
+    {
+        if (node->version != version_)
+        {
+            node          = std::make_shared<node_type>(*node);
+            node->version = version_;
+        }
+        return node.get();
+    }
+
+    std::uint32_t capacity_;                         ///< Maximum number of elements of a node
+    std::uint8_t max_depth_;                         ///< Maximum depth of the octree
+    aabb_type voxel_grid_;                           ///< The root voxel
+    std::uint64_t version_ = 0u;                     ///< Number of the working version
+    typename node_type::pointer_type root_;          ///< Root of the working version
+    std::shared_ptr<snapshot_type const> published_; ///< Last published version
+};
+
+using persistent_octree_t = pcp::basic_persistent_octree_t<pcp::point_t>;
+
+} // namespace pcp
+
+#endif // PCP_OCTREE_PERSISTENT_OCTREE_HPP
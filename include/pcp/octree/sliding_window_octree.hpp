@@ -0,0 +1,698 @@
+#ifndef PCP_OCTREE_SLIDING_WINDOW_OCTREE_HPP
+#define PCP_OCTREE_SLIDING_WINDOW_OCTREE_HPP
+
+/**
+ * @file
+ * @ingroup octree
+ */
+
+#include "linear_octree.hpp"
+#include "linked_octree_node.hpp"
+#include "pcp/common/intersections.hpp"
+#include "pcp/common/nearest_neighbours.hpp"
+#include "pcp/common/norm.hpp"
+#include "pcp/common/points/point.hpp"
+#include "pcp/common/vector3d_queries.hpp"
+#include "pcp/traits/property_map_traits.hpp"
+#include "pcp/traits/range_traits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace pcp {
+
+/**
+ * @ingroup sliding-window-octree
+ * @brief
+ * Parameters of a sliding window octree. Frames are evicted when the window
+ * holds more than max_frames frames, or when they are older than max_age
+ * relative to the newest frame.
+ * @tparam Point Type of point used by the voxel grid to define its AABB.
+ */
+template <class Point>
+struct sliding_window_octree_parameters_t : octree_parameters_t<Point>
+{
+    std::size_t max_frames = 0u; ///< Maximum number of frames in the window, 0 for no limit
+    double max_age = std::numeric_limits<double>::infinity(); ///< Maximum age of a frame
+};
+
+/**
+ * @ingroup sliding-window-octree
+ * @brief
+ * Octree holding the points of the last frames of a stream. Points are inserted
+ * one frame at a time, and whole frames are evicted from the oldest to the newest.
+ *
+ * Elements are placed in the nodes like in the eager linked octree, and each
+ * node's bucket is kept sorted by frame as a sequence of runs of elements of
+ * the same frame. Since frames are evicted in insertion order, the evicted
+ * elements of a node are always a prefix of its bucket, and each node knows
+ * the oldest frame of its subtree, so an eviction only visits the nodes
+ * holding elements of the evicted frames, and costs O(bucket) per node.
+ *
+ * Evictions also compact the octree: subtrees left with no more elements than
+ * the node capacity are collapsed into their root as the eviction goes through
+ * them, so the octree does not accumulate sparse branches over long streams.
+ *
+ * @tparam Element Type of the octree's elements
+ * @tparam ParamsType Type containing the parameters of the octree
+ */
+template <class Element, class ParamsType = sliding_window_octree_parameters_t<pcp::point_t>>
+class basic_sliding_window_octree_t
+{
+  public:
+    using element_type    = Element;                        ///< Type of the elements
+    using params_type     = ParamsType;                     ///< Type of the octree's parameters
+    using aabb_type       = typename ParamsType::aabb_type; ///< Type of AABB used for voxels
+    using aabb_point_type = typename aabb_type::point_type; ///< Type of point used by the AABB
+    using frame_id_type   = std::uint64_t;                  ///< Type of frame identifiers
+    using self_type       = basic_sliding_window_octree_t<element_type, params_type>;
+
+    /**
+     * @brief Record of a frame in the window
+     */
+    struct frame_t
+    {
+        frame_id_type id;  ///< Identifier of the frame, incremented by each new frame
+        double timestamp;  ///< Timestamp of the frame
+        std::size_t size;  ///< Number of elements of the frame in the octree
+    };
+
+    using frames_type = std::deque<frame_t>; ///< Type of container of frame records
+
+    /**
+     * @brief
+     * Reusable storage for KNN searches. Keeping one scratch object per thread
+     * lets repeated searches run without allocating.
+     */
+    struct knn_scratch_t
+    {
+        using scalar_type     = typename aabb_point_type::coordinate_type;
+        using neighbour_type  = neighbour_t<element_type const*, scalar_type>;
+        using neighbours_type = std::vector<neighbour_type>;
+
+        k_best_heap_t<element_type const*, scalar_type> k_best; ///< The k best elements
+    };
+
+    using knn_scratch_type = knn_scratch_t; ///< Reusable storage for KNN searches
+    using neighbour_type =
+        typename knn_scratch_type::neighbour_type; ///< (element, squared distance) pair
+
+    /**
+     * @brief Constructs an empty window
+     * @param params The octree's parameters
+     */
+    explicit basic_sliding_window_octree_t(params_type const& params)
+        : capacity_(params.node_capacity),
+          max_depth_(params.max_depth),
+          max_frames_(params.max_frames),
+          max_age_(params.max_age),
+          voxel_grid_(params.voxel_grid),
+          root_()
+    {
+    }
+
+    /**
+     * @brief Number of elements in the window
+     * @return Number of elements
+     */
+    std::size_t size() const { return root_.subtree_size; }
+
+    /**
+     * @brief Checks if the window is empty
+     * @return True if the window is empty
+     */
+    bool empty() const { return size() == 0u; }
+
+    /**
+     * @brief Gets the top-level voxel from this octree (the bounding box)
+     * @return This octree's root voxel
+     */
+    aabb_type const& voxel_grid() const { return voxel_grid_; }
+
+    /**
+     * @brief The frames in the window, from the oldest to the newest
+     * @return The frame records
+     */
+    frames_type const& frames() const { return frames_; }
+
+    /**
+     * @brief Removes all frames from the window
+     */
+    void clear()
+    {
+        root_ = node_type{};
+        frames_.clear();
+    }
+
+    /**
+     * @brief
+     * Inserts a range of elements as the newest frame of the window, then
+     * evicts the frames that fall out of the window. Elements outside of
+     * the voxel grid are not inserted.
+     * @tparam ForwardIter Type of the range's iterators
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param begin Iterator to the first element of the frame
+     * @param end End iterator of the frame
+     * @param point_view The point view property map
+     * @param timestamp Timestamp of the frame, not older than the newest frame's
+     * @return The number of inserted elements
+     */
+    template <class ForwardIter, class PointViewMap>
+    std::size_t
+    push_frame(ForwardIter begin, ForwardIter end, PointViewMap const& point_view, double timestamp)
+    {
+        assert(frames_.empty() || frames_.back().timestamp <= timestamp);
+
+        frame_id_type const id = next_frame_id_++;
+        std::size_t inserted   = 0u;
+        for (auto it = begin; it != end; ++it)
+            if (insert(*it, id, point_view))
+                ++inserted;
+
+        frames_.push_back(frame_t{id, timestamp, inserted});
+
+        std::size_t num_expired = 0u;
+        while (num_expired < frames_.size() &&
+               ((max_frames_ > 0u && frames_.size() - num_expired > max_frames_) ||
+                timestamp - frames_[num_expired].timestamp > max_age_))
+        {
+            ++num_expired;
+        }
+        evict_oldest_frames(num_expired);
+
+        return inserted;
+    }
+
+    /**
+     * @brief Evicts the n oldest frames of the window in one traversal of the octree
+     * @param n Number of frames to evict
+     * @return Number of evicted elements
+     */
+    std::size_t evict_oldest_frames(std::size_t n)
+    {
+        n = std::min(n, frames_.size());
+        if (n == 0u)
+            return 0u;
+
+        auto const last_evicted = frames_[n - 1u].id;
+        auto const evicted      = evict(root_, last_evicted);
+        frames_.erase(frames_.begin(), frames_.begin() + static_cast<std::ptrdiff_t>(n));
+        return evicted;
+    }
+
+    /**
+     * @brief Evicts the frames older than a timestamp
+     * @param timestamp The oldest timestamp kept in the window
+     * @return Number of evicted elements
+     */
+    std::size_t evict_frames_before(double timestamp)
+    {
+        auto const first_kept = std::find_if(
+            frames_.cbegin(),
+            frames_.cend(),
+            [timestamp](frame_t const& frame) { return frame.timestamp >= timestamp; });
+        return evict_oldest_frames(
+            static_cast<std::size_t>(std::distance(frames_.cbegin(), first_kept)));
+    }
+
+    /*
+     * Returns the k-nearest-neighbours in 3d Euclidean space
+     * using the l2-norm as the notion of distance.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * for all points of the octree
+     * @param point_view The PointViewMap property map
+     * @param eps The error tolerance for floating point equality
+     * @return A list of nearest points ordered from nearest to furthest of size s where 0 <= s <= k
+     */
+    template <class TPointView, class PointViewMap>
+    std::vector<element_type> nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        double eps = 1e-5) const
+    {
+        knn_scratch_t scratch;
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+
+        std::vector<element_type> knearest_points{};
+        knearest_points.reserve(neighbours.size());
+        for (auto const& neighbour : neighbours)
+            knearest_points.push_back(*neighbour.element);
+
+        return knearest_points;
+    }
+
+    /*
+     * Writes the k-nearest-neighbours in 3d Euclidean space to out as
+     * (element, squared distance) pairs, ordered from nearest to furthest.
+     * Storage for the search is taken from scratch, which should be reused
+     * across queries (one per thread) to avoid allocating.
+     *
+     * @param target    The reference point for which we want the k nearest neighbors
+     * @param k         The number of neighbors to return that are nearest to the specified point
+     * @param point_view The PointViewMap property map
+     * @param scratch The reusable search storage
+     * @param out Output iterator to neighbour_type values
+     * @param eps The error tolerance for floating point equality
+     * @return Output iterator past the last written neighbour
+     */
+    template <class TPointView, class PointViewMap, class OutputIter>
+    OutputIter nearest_neighbours(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_type& scratch,
+        OutputIter out,
+        double eps = 1e-5) const
+    {
+        auto const& neighbours = knn_search(target, k, point_view, scratch, eps);
+        return std::copy(neighbours.cbegin(), neighbours.cend(), out);
+    }
+
+    /*
+     * Returns all points that reside in the given range.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return A list of all points that reside in the given range
+     */
+    template <class Range, class PointViewMap>
+    std::vector<element_type> range_search(Range const& range, PointViewMap const& point_view) const
+    {
+        std::vector<element_type> elements_in_range;
+        range_search(range, point_view, std::back_inserter(elements_in_range));
+        return elements_in_range;
+    }
+
+    /*
+     * Writes all points that reside in the given range to out.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param out Output iterator to the elements in range
+     * @return Output iterator past the last written element
+     */
+    template <class Range, class PointViewMap, class OutputIter>
+    OutputIter
+    range_search(Range const& range, PointViewMap const& point_view, OutputIter out) const
+    {
+        visit_range(range, point_view, [&out](element_type const& e) { *out++ = e; });
+        return out;
+    }
+
+    /*
+     * Calls visitor on all points that reside in the given range,
+     * without storing them.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Range, class PointViewMap, class Visitor>
+    void visit_range(Range const& range, PointViewMap const& point_view, Visitor&& visitor) const
+    {
+        auto const visit_contained_subtree = [&visitor](node_type const& node) {
+            visit_subtree(node, visitor);
+        };
+        query_range(range, point_view, visitor, visit_contained_subtree);
+    }
+
+    /*
+     * Counts the points that reside in the given range. Subtrees
+     * lying entirely inside the range are counted without visiting
+     * their points.
+     *
+     * @param range A range satisfying the Range type requirements
+     * @param point_view The PointViewMap property map
+     * @return Number of points in the range
+     */
+    template <class Range, class PointViewMap>
+    std::size_t range_count(Range const& range, PointViewMap const& point_view) const
+    {
+        std::size_t count        = 0u;
+        auto const count_element = [&count](element_type const&) {
+            ++count;
+        };
+        auto const count_contained_subtree = [&count](node_type const& node) {
+            count += node.subtree_size;
+        };
+        query_range(range, point_view, count_element, count_contained_subtree);
+        return count;
+    }
+
+    /*
+     * Calls visitor on all points of the window, in depth-first order.
+     *
+     * @param visitor Callable taking an element_type const&
+     */
+    template <class Visitor>
+    void for_each(Visitor&& visitor) const
+    {
+        visit_subtree(root_, visitor);
+    }
+
+  private:
+    static constexpr frame_id_type no_frame = std::numeric_limits<frame_id_type>::max();
+
+    /**
+     * @brief Consecutive elements of a node's bucket belonging to the same frame
+     */
+    struct run_t
+    {
+        frame_id_type frame; ///< The elements' frame
+        std::size_t size;    ///< Number of elements
+    };
+
+    struct node_t
+    {
+        std::vector<Element> elements{};                   ///< Elements sorted by frame
+        std::vector<run_t> runs{};                         ///< Frames of the elements
+        std::array<std::unique_ptr<node_t>, 8u> octants{}; ///< Children, indexed by octant
+        std::size_t subtree_size   = 0u;                   ///< Number of elements in the subtree
+        frame_id_type oldest_frame = no_frame;             ///< Oldest frame of the subtree
+    };
+
+    using node_type = node_t;
+
+    static aabb_type octant_voxel(aabb_type const& voxel, std::uint8_t octant)
+    {
+        return basic_linear_octree_t<Element, ParamsType>::octant_voxel(voxel, octant);
+    }
+
+    template <class TPointView>
+    static std::uint8_t octant_of(aabb_type const& voxel, TPointView const& p)
+    {
+        auto const center   = voxel.center();
+        std::uint8_t octant = 0b000;
+        if (p.x() > center.x())
+            octant |= 0b100;
+        if (p.y() > center.y())
+            octant |= 0b010;
+        if (p.z() > center.z())
+            octant |= 0b001;
+        return octant;
+    }
+
+    /**
+     * @brief
+     * Inserts one element of the newest frame. The element is placed like
+     * in the eager linked octree, at the end of its node's bucket, which
+     * keeps the bucket sorted by frame.
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param e The element to insert
+     * @param frame The newest frame
+     * @param point_view The point view property map
+     * @return true if insert was successful
+     */
+    template <class PointViewMap>
+    bool insert(element_type const& e, frame_id_type frame, PointViewMap const& point_view)
+    {
+        auto const p = point_view(e);
+        if (!voxel_grid_.contains(p))
+            return false;
+
+        node_type* node = &root_;
+        aabb_type voxel = voxel_grid_;
+        for (std::uint8_t depth = 1u;; ++depth)
+        {
+            if (node->subtree_size == 0u)
+                node->oldest_frame = frame;
+            ++node->subtree_size;
+
+            if (depth >= max_depth_ || node->elements.size() < capacity_)
+            {
+                node->elements.push_back(e);
+                if (node->runs.empty() || node->runs.back().frame != frame)
+                    node->runs.push_back(run_t{frame, 0u});
+                ++node->runs.back().size;
+                return true;
+            }
+
+            auto const octant = octant_of(voxel, p);
+            auto& child       = node->octants[octant];
+            if (!child)
+                child = std::make_unique<node_type>();
+
+            node  = child.get();
+            voxel = octant_voxel(voxel, octant);
+        }
+    }
+
+    /**
+     * @brief
+     * Removes the elements of the frames up to last_evicted from a node's
+     * subtree, skipping the subtrees which have no such elements, and
+     * collapses the subtree into the node if it fits in the node's bucket.
+     * @param node The subtree's root
+     * @param last_evicted The newest evicted frame
+     * @return Number of evicted elements
+     */
+    std::size_t evict(node_type& node, frame_id_type last_evicted)
+    {
+        if (node.oldest_frame > last_evicted)
+            return 0u;
+
+        std::size_t evicted = 0u;
+        auto first_kept     = node.runs.begin();
+        for (; first_kept != node.runs.end() && first_kept->frame <= last_evicted; ++first_kept)
+            evicted += first_kept->size;
+        node.runs.erase(node.runs.begin(), first_kept);
+        node.elements.erase(
+            node.elements.begin(),
+            node.elements.begin() + static_cast<std::ptrdiff_t>(evicted));
+
+        bool has_octants = false;
+        for (auto& octant : node.octants)
+        {
+            if (!octant)
+                continue;
+
+            evicted += evict(*octant, last_evicted);
+            if (octant->subtree_size == 0u)
+                octant.reset();
+            else
+                has_octants = true;
+        }
+        node.subtree_size -= evicted;
+
+        if (has_octants && node.subtree_size <= capacity_)
+            collapse(node);
+
+        node.oldest_frame = node.runs.empty() ? no_frame : node.runs.front().frame;
+        for (auto const& octant : node.octants)
+            if (octant)
+                node.oldest_frame = std::min(node.oldest_frame, octant->oldest_frame);
+
+        return evicted;
+    }
+
+    /**
+     * @brief
+     * Moves the elements of a node's descendants into its bucket, merging
+     * the runs by frame, and destroys its children
+     * @param node The node
+     */
+    void collapse(node_type& node)
+    {
+        std::vector<std::pair<frame_id_type, Element>> elements;
+        elements.reserve(node.subtree_size);
+        auto const gather = [&elements](auto const& self, node_type& n) -> void {
+            auto e = n.elements.begin();
+            for (auto const& run : n.runs)
+                for (std::size_t i = 0u; i < run.size; ++i)
+                    elements.emplace_back(run.frame, std::move(*e++));
+
+            for (auto& octant : n.octants)
+                if (octant)
+                    self(self, *octant);
+        };
+        gather(gather, node);
+
+        std::stable_sort(
+            elements.begin(),
+            elements.end(),
+            [](auto const& e1, auto const& e2) { return e1.first < e2.first; });
+
+        node.elements.clear();
+        node.runs.clear();
+        for (auto& [frame, e] : elements)
+        {
+            node.elements.push_back(std::move(e));
+            if (node.runs.empty() || node.runs.back().frame != frame)
+                node.runs.push_back(run_t{frame, 0u});
+            ++node.runs.back().size;
+        }
+
+        for (auto& octant : node.octants)
+            octant.reset();
+    }
+
+    template <class Visitor>
+    static void visit_subtree(node_type const& node, Visitor& visitor)
+    {
+        for (auto const& e : node.elements)
+            visitor(e);
+
+        for (auto const& octant : node.octants)
+            if (octant)
+                visit_subtree(*octant, visitor);
+    }
+
+    /**
+     * @brief
+     * Range query implementation shared by the range searches and range counts.
+     * Elements of nodes overlapping the range are tested individually, while
+     * subtrees contained in the range are reported as a whole.
+     * @tparam Range Type satisfying Range concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @tparam ElementVisitor Callable type taking an element_type const&
+     * @tparam SubtreeVisitor Callable type taking a node_type const&
+     * @param range The queried range
+     * @param point_view The point view property map
+     * @param visit_element Callback on the elements found to be in the range
+     * @param visit_contained_subtree Callback on the subtrees contained in the range
+     */
+    template <class Range, class PointViewMap, class ElementVisitor, class SubtreeVisitor>
+    void query_range(
+        Range const& range,
+        PointViewMap const& point_view,
+        ElementVisitor& visit_element,
+        SubtreeVisitor const& visit_contained_subtree) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+
+        static_assert(
+            traits::is_range_v<Range, point_view_type>,
+            "Range must satisfy Range concept");
+
+        auto const recurse = [&](auto const& self, node_type const& node, aabb_type const& voxel) {
+            auto const overlap = intersections::classify(voxel, range);
+            if (overlap == intersections::overlap_t::disjoint)
+                return;
+
+            if (overlap == intersections::overlap_t::contained)
+            {
+                visit_contained_subtree(node);
+                return;
+            }
+
+            for (auto const& e : node.elements)
+                if (range.contains(point_view(e)))
+                    visit_element(e);
+
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+                if (node.octants[o])
+                    self(self, *node.octants[o], octant_voxel(voxel, o));
+        };
+
+        recurse(recurse, root_, voxel_grid_);
+    }
+
+    /**
+     * @brief
+     * Depth-first KNN search implementation, visiting the children of a node
+     * nearest first like the frozen octree does
+     * @tparam TPointView Type satisfying PointView concept
+     * @tparam PointViewMap Type satisfying PointViewMap concept
+     * @param target Position around which we want to find the k nearest neighbours
+     * @param k Number of nearest neighbours to query
+     * @param point_view The point view property map
+     * @param scratch Storage for the search's heap
+     * @param eps The error tolerance for floating point equality
+     * @return The neighbours sorted from nearest to furthest, stored in scratch
+     */
+    template <class TPointView, class PointViewMap>
+    typename knn_scratch_t::neighbours_type const& knn_search(
+        TPointView const& target,
+        std::size_t k,
+        PointViewMap const& point_view,
+        knn_scratch_t& scratch,
+        double const eps) const
+    {
+        using point_view_type =
+            typename traits::property_map_traits<PointViewMap, Element>::value_type;
+        using coordinate_type = typename point_view_type::coordinate_type;
+        using scalar_type     = typename knn_scratch_t::scalar_type;
+
+        auto& k_best = scratch.k_best;
+        k_best.reset(k);
+
+        if (k <= 0u || empty())
+            return k_best.sort();
+
+        auto const recurse = [&](auto const& self,
+                                 node_type const& node,
+                                 aabb_type const& voxel) -> void {
+            for (auto const& e : node.elements)
+            {
+                auto const p = point_view(e);
+                if (common::are_vectors_equal(p, target, static_cast<coordinate_type>(eps)))
+                    continue;
+
+                k_best.push(std::addressof(e), common::squared_distance(target, p));
+            }
+
+            struct child_t
+            {
+                scalar_type squared_distance;
+                node_type const* node;
+                aabb_type voxel;
+            };
+            std::array<child_t, 8u> children{};
+            std::uint8_t n = 0u;
+            for (std::uint8_t o = 0u; o < 8u; ++o)
+            {
+                if (!node.octants[o])
+                    continue;
+
+                auto const child_voxel = octant_voxel(voxel, o);
+                auto const d =
+                    common::squared_distance(target, child_voxel.nearest_point_from(target));
+                children[n] = child_t{d, node.octants[o].get(), child_voxel};
+                ++n;
+            }
+            std::sort(
+                children.begin(),
+                children.begin() + n,
+                [](child_t const& c1, child_t const& c2) {
+                    return c1.squared_distance < c2.squared_distance;
+                });
+
+            for (std::uint8_t c = 0u; c < n; ++c)
+            {
+                if (children[c].squared_distance > k_best.bound())
+                    break;
+
+                self(self, *children[c].node, children[c].voxel);
+            }
+        };
+
+        recurse(recurse, root_, voxel_grid_);
+        return k_best.sort();
+    }
+
+    std::uint32_t capacity_;           ///< Maximum number of elements of a node
+    std::uint8_t max_depth_;           ///< Maximum depth of the octree
+    std::size_t max_frames_;           ///< Maximum number of frames in the window, 0 for no limit
+    double max_age_;                   ///< Maximum age of a frame in the window
+    aabb_type voxel_grid_;             ///< The root voxel
+    node_type root_;                   ///< The root node
+    frames_type frames_{};             ///< The frames in the window, from the oldest
+    frame_id_type next_frame_id_ = 0u; ///< Identifier of the next pushed frame
+};
+
+using sliding_window_octree_t = pcp::basic_sliding_window_octree_t<pcp::point_t>;
+
+} // namespace pcp
+
+#endif // PCP_OCTREE_SLIDING_WINDOW_OCTREE_HPP
@@ -124,6 +124,29 @@ template <class PointView1, class PointView2>
 static constexpr bool is_point_view_equality_comparable_to_v =
     is_point_view_equality_comparable_to<PointView1, PointView2>::value;
 
+template <class PointView, class = void>
+struct has_point_address : std::false_type
+{
+};
+
+template <class PointView>
+struct has_point_address<
+    PointView,
+    std::enable_if_t<std::is_pointer_v<decltype(std::declval<PointView const&>().point())>>>
+    : std::true_type
+{
+};
+
+/**
+ * @ingroup traits
+ * @brief
+ * Compile-time check to verify if PointView refers to a point that it does
+ * not own, and exposes the address of that point through point()
+ * @tparam PointView
+ */
+template <class PointView>
+static constexpr bool has_point_address_v = has_point_address<PointView>::value;
+
 template <class PointView1, class PointView2, class = void>
 struct is_point_view_assignable_from : std::false_type
 {
@@ -0,0 +1,68 @@
+#include <catch2/catch.hpp>
+#include <pcp/common/intersections.hpp>
+#include <pcp/common/points/point.hpp>
+
+SCENARIO("intersection tests between boxes and spheres", "[intersections]")
+{
+    GIVEN("a unit box")
+    {
+        pcp::axis_aligned_bounding_box_t<pcp::point_t> const box{
+            pcp::point_t{0.f, 0.f, 0.f},
+            pcp::point_t{1.f, 1.f, 1.f}};
+
+        pcp::kd_axis_aligned_bounding_box_t<float, 3u> kd_box;
+        kd_box.min = {0.f, 0.f, 0.f};
+        kd_box.max = {1.f, 1.f, 1.f};
+
+        WHEN("testing intersection with spheres near the box")
+        {
+            // the box is at a distance of .5 from the spheres' center
+            pcp::sphere_t<pcp::point_t> small_sphere{pcp::point_t{1.5f, .5f, .5f}, .3f};
+            pcp::sphere_t<pcp::point_t> large_sphere{pcp::point_t{2.2f, .5f, .5f}, 1.3f};
+            pcp::sphere_a<float> const small_sphere_a{{1.5f, .5f, .5f}, .3f};
+            pcp::sphere_a<float> const large_sphere_a{{2.2f, .5f, .5f}, 1.3f};
+
+            THEN("the squared distance to the box is compared against the squared radius")
+            {
+                REQUIRE_FALSE(pcp::intersections::intersects(box, small_sphere));
+                REQUIRE(pcp::intersections::intersects(box, large_sphere));
+                REQUIRE_FALSE(pcp::intersections::intersects(kd_box, small_sphere_a));
+                REQUIRE(pcp::intersections::intersects(kd_box, large_sphere_a));
+            }
+        }
+        WHEN("classifying the box against ranges")
+        {
+            using pcp::intersections::overlap_t;
+
+            // the box's corners are at a distance of sqrt(.75) from its center
+            pcp::sphere_t<pcp::point_t> const enclosing_sphere{pcp::point_t{.5f, .5f, .5f}, .9f};
+            pcp::sphere_t<pcp::point_t> const inner_sphere{pcp::point_t{.5f, .5f, .5f}, .8f};
+            pcp::sphere_t<pcp::point_t> const far_sphere{pcp::point_t{3.f, 3.f, 3.f}, 1.f};
+            pcp::sphere_a<float> const enclosing_sphere_a{{.5f, .5f, .5f}, .9f};
+            pcp::sphere_a<float> const inner_sphere_a{{.5f, .5f, .5f}, .8f};
+
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const enclosing_box{
+                pcp::point_t{-1.f, 0.f, -1.f},
+                pcp::point_t{1.f, 2.f, 1.f}};
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const overlapping_box{
+                pcp::point_t{.5f, .5f, .5f},
+                pcp::point_t{2.f, 2.f, 2.f}};
+
+            THEN("disjoint, partially overlapping and enclosing ranges are distinguished")
+            {
+                REQUIRE(
+                    pcp::intersections::classify(box, enclosing_sphere) == overlap_t::contained);
+                REQUIRE(pcp::intersections::classify(box, inner_sphere) == overlap_t::partial);
+                REQUIRE(pcp::intersections::classify(box, far_sphere) == overlap_t::disjoint);
+                REQUIRE(
+                    pcp::intersections::classify(kd_box, enclosing_sphere_a) ==
+                    overlap_t::contained);
+                REQUIRE(
+                    pcp::intersections::classify(kd_box, inner_sphere_a) == overlap_t::partial);
+                REQUIRE(pcp::intersections::classify(box, enclosing_box) == overlap_t::contained);
+                REQUIRE(pcp::intersections::classify(box, overlapping_box) == overlap_t::partial);
+                REQUIRE(pcp::intersections::classify(box, box) == overlap_t::contained);
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include <catch2/catch.hpp>
+#include <pcp/common/morton.hpp>
+
+SCENARIO("morton codes", "[morton]")
+{
+    GIVEN("3-dimensional grid cells")
+    {
+        THEN("the bits of x, y and z are interleaved like the octree octants")
+        {
+            REQUIRE(pcp::morton::encode(0u, 0u, 0u) == 0b000u);
+            REQUIRE(pcp::morton::encode(1u, 0u, 0u) == 0b100u);
+            REQUIRE(pcp::morton::encode(0u, 1u, 0u) == 0b010u);
+            REQUIRE(pcp::morton::encode(0u, 0u, 1u) == 0b001u);
+            REQUIRE(pcp::morton::encode(3u, 2u, 1u) == 0b110'101u);
+            REQUIRE(pcp::morton::encode(0x1fffffu, 0x1fffffu, 0x1fffffu) == (~0ull >> 1u));
+        }
+        THEN("the K-dimensional encoding matches the 3-dimensional encoding")
+        {
+            for (std::uint32_t x : {0u, 1u, 7u, 12'345u, 0x1fffffu})
+                for (std::uint32_t y : {0u, 3u, 999u, 0x1ffffeu})
+                    for (std::uint32_t z : {0u, 5u, 65'536u})
+                    {
+                        std::array<std::uint32_t, 3u> const cell{x, y, z};
+                        REQUIRE(pcp::morton::encode(cell) == pcp::morton::encode(x, y, z));
+                    }
+        }
+    }
+    GIVEN("2-dimensional grid cells")
+    {
+        THEN("the bits of the first dimension are the most significant")
+        {
+            REQUIRE(pcp::morton::encode(std::array<std::uint32_t, 2u>{1u, 0u}) == 0b10u);
+            REQUIRE(pcp::morton::encode(std::array<std::uint32_t, 2u>{0u, 1u}) == 0b01u);
+            REQUIRE(pcp::morton::encode(std::array<std::uint32_t, 2u>{2u, 3u}) == 0b1101u);
+        }
+    }
+    GIVEN("coordinates in a bounding box")
+    {
+        THEN("coordinates are quantized to grid cells and clamped to the box")
+        {
+            REQUIRE(pcp::morton::quantize(-1.f, -1.f, 1.f, 2u) == 0u);
+            REQUIRE(pcp::morton::quantize(-.4f, -1.f, 1.f, 2u) == 1u);
+            REQUIRE(pcp::morton::quantize(.1f, -1.f, 1.f, 2u) == 2u);
+            REQUIRE(pcp::morton::quantize(1.f, -1.f, 1.f, 2u) == 3u);
+            REQUIRE(pcp::morton::quantize(-5.f, -1.f, 1.f, 2u) == 0u);
+            REQUIRE(pcp::morton::quantize(5.f, -1.f, 1.f, 2u) == 3u);
+        }
+    }
+    GIVEN("a list of morton codes")
+    {
+        std::vector<std::uint64_t> const codes{5u, 1u, 3u, 1u, 0u};
+
+        THEN("the sorted order lists the codes in increasing order, keeping ties stable")
+        {
+            auto const order = pcp::morton::sorted_order(std::execution::seq, codes);
+            REQUIRE(order == std::vector<std::size_t>{4u, 1u, 3u, 2u, 0u});
+        }
+    }
+}
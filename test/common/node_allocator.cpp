@@ -0,0 +1,210 @@
+#include <catch2/catch.hpp>
+#include <cstring>
+#include <execution>
+#include <pcp/common/node_allocator.hpp>
+#include <pcp/kdtree/linked_kdtree.hpp>
+#include <pcp/octree/linked_octree.hpp>
+#include <random>
+#include <thread>
+
+SCENARIO("trees allocated from a node pool", "[node_allocator]")
+{
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+    auto const coordinate_map = [](pcp::point_t const& p) {
+        return std::array<float, 3u>{p.x(), p.y(), p.z()};
+    };
+    auto const are_equal = [](pcp::point_t const& p1, pcp::point_t const& p2) {
+        return pcp::common::are_vectors_equal(p1, p2);
+    };
+
+    using allocator_type = pcp::node_pool_allocator_t<pcp::point_t>;
+    using octree_type    = pcp::basic_linked_octree_t<
+        pcp::point_t,
+        pcp::octree_parameters_t<pcp::point_t>,
+        allocator_type>;
+    using kdtree_type =
+        pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(coordinate_map), allocator_type>;
+
+    GIVEN("kdtree nodes using stateless and stateful allocators")
+    {
+        using default_node_type = pcp::basic_linked_kdtree_node_t<pcp::point_t>;
+        using pool_node_type    = pcp::basic_linked_kdtree_node_t<pcp::point_t, allocator_type>;
+
+        THEN("only stateful allocators are stored in the nodes")
+        {
+            REQUIRE(
+                sizeof(default_node_type) ==
+                2u * sizeof(typename default_node_type::self_type_ptr) +
+                    sizeof(typename default_node_type::points_type));
+            REQUIRE(sizeof(pool_node_type) > sizeof(default_node_type));
+        }
+    }
+    GIVEN("a node pool used from several threads")
+    {
+        pcp::node_pool_t pool;
+        std::size_t const num_threads       = 4u;
+        std::size_t const blocks_per_thread = 10'000u;
+        std::array<std::size_t, 5u> const sizes{8u, 40u, 100u, 384u, 5'000u};
+
+        using blocks_type = std::vector<std::pair<unsigned char*, std::size_t>>;
+        std::vector<blocks_type> blocks(num_threads);
+
+        auto const allocate_blocks = [&](std::size_t t) {
+            for (std::size_t i = 0u; i < blocks_per_thread; ++i)
+            {
+                auto const bytes = sizes[i % sizes.size()];
+                auto* block      = static_cast<unsigned char*>(pool.allocate(bytes));
+                std::memset(block, static_cast<int>(t + 1u), bytes);
+                blocks[t].emplace_back(block, bytes);
+            }
+        };
+        auto const are_blocks_intact = [&]() {
+            for (std::size_t t = 0u; t < num_threads; ++t)
+                for (auto const& [block, bytes] : blocks[t])
+                    if (std::count(block, block + bytes, static_cast<unsigned char>(t + 1u)) !=
+                        static_cast<std::ptrdiff_t>(bytes))
+                        return false;
+            return true;
+        };
+        auto const run_threads = [&](auto const& f) {
+            std::vector<std::thread> threads;
+            for (std::size_t t = 0u; t < num_threads; ++t)
+                threads.emplace_back(f, t);
+            for (auto& thread : threads)
+                thread.join();
+        };
+
+        WHEN("threads allocate blocks and free the blocks allocated by other threads")
+        {
+            run_threads(allocate_blocks);
+            bool const are_first_blocks_intact = are_blocks_intact();
+
+            run_threads([&](std::size_t t) {
+                auto& other_blocks = blocks[(t + 1u) % num_threads];
+                for (auto const& [block, bytes] : other_blocks)
+                    pool.deallocate(block, bytes);
+                other_blocks.clear();
+            });
+            run_threads(allocate_blocks);
+            bool const are_second_blocks_intact = are_blocks_intact();
+
+            for (auto& thread_blocks : blocks)
+                for (auto const& [block, bytes] : thread_blocks)
+                    pool.deallocate(block, bytes);
+
+            THEN("no two live blocks overlap")
+            {
+                REQUIRE(are_first_blocks_intact);
+                REQUIRE(are_second_blocks_intact);
+                REQUIRE(pool.capacity() > 0u);
+            }
+        }
+    }
+    GIVEN("a node pool and a randomly generated point cloud")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 20'000u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        pcp::node_pool_t pool;
+        allocator_type const allocator(pool);
+
+        pcp::octree_parameters_t<pcp::point_t> params;
+        params.node_capacity = 4u;
+        params.voxel_grid =
+            pcp::axis_aligned_bounding_box_t<pcp::point_t>{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}};
+
+        WHEN("constructing an octree with the pool allocator")
+        {
+            pcp::linked_octree_t expected(points.cbegin(), points.cend(), point_map, params);
+            octree_type octree(
+                std::execution::par,
+                points.cbegin(),
+                points.cend(),
+                point_map,
+                params,
+                allocator);
+
+            THEN("the octree is identical to the octree using the default allocator")
+            {
+                REQUIRE(octree.get_allocator().pool() == &pool);
+                REQUIRE(octree.size() == expected.size());
+                REQUIRE(std::equal(
+                    octree.cbegin(),
+                    octree.cend(),
+                    expected.cbegin(),
+                    expected.cend(),
+                    are_equal));
+            }
+            THEN("clearing and rebuilding the octree reuses the pool's memory")
+            {
+                auto const capacity = pool.capacity();
+                REQUIRE(capacity > 0u);
+
+                octree.clear();
+                REQUIRE(octree.empty());
+                octree.insert(points.cbegin(), points.cend(), point_map);
+
+                REQUIRE(octree.size() == expected.size());
+                REQUIRE(pool.capacity() == capacity);
+            }
+        }
+        WHEN("resetting the pool after destroying an octree built from it")
+        {
+            {
+                octree_type octree(points.cbegin(), points.cend(), point_map, params, allocator);
+            }
+            auto const capacity = pool.capacity();
+            pool.reset();
+
+            THEN("rebuilding the octree reuses the pool's memory")
+            {
+                octree_type octree(points.cbegin(), points.cend(), point_map, params, allocator);
+
+                REQUIRE(octree.size() == points.size());
+                REQUIRE(pool.capacity() == capacity);
+            }
+        }
+        WHEN("constructing a kdtree with the pool allocator")
+        {
+            kdtree_type kdtree(
+                points.begin(),
+                points.end(),
+                coordinate_map,
+                pcp::kdtree::construction_params_t{},
+                allocator);
+
+            pcp::point_t const target{0.f, 0.f, 0.f};
+
+            THEN("queries are identical to the kdtree using the default allocator")
+            {
+                pcp::basic_linked_kdtree_t<pcp::point_t, 3u, decltype(coordinate_map)> expected(
+                    points.begin(),
+                    points.end(),
+                    coordinate_map);
+
+                REQUIRE(kdtree.get_allocator().pool() == &pool);
+                REQUIRE(kdtree.root()->get_allocator().pool() == &pool);
+                auto const neighbours          = kdtree.nearest_neighbours(target, 10u);
+                auto const expected_neighbours = expected.nearest_neighbours(target, 10u);
+                REQUIRE(std::equal(
+                    neighbours.cbegin(),
+                    neighbours.cend(),
+                    expected_neighbours.cbegin(),
+                    expected_neighbours.cend(),
+                    are_equal));
+            }
+        }
+    }
+}
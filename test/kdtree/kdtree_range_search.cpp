@@ -3,6 +3,7 @@
 #include <pcp/common/vector3d.hpp>
 #include <pcp/common/vector3d_queries.hpp>
 #include <pcp/kdtree/linked_kdtree.hpp>
+#include <random>
 
 SCENARIO("kdtree range search", "[kdtree]")
 {
@@ -119,5 +120,135 @@ SCENARIO("kdtree range search", "[kdtree]")
                         }) == 1u);
             }
         }
+        WHEN("searching for points in the queried aabb with a caller-provided buffer")
+        {
+            pcp::kd_axis_aligned_bounding_box_t<float, 3u> aabb;
+            aabb.min = {-2.f, -2.f, -2.f};
+            aabb.max = {0.f, 0.f, 0.f};
+
+            std::vector<pcp::point_t> points_in_range;
+            kdtree.range_search(aabb, std::back_inserter(points_in_range));
+
+            std::size_t visited_count = 0u;
+            kdtree.visit_range(aabb, [&](pcp::point_t const& p) {
+                REQUIRE(aabb.contains(coordinate_map(p)));
+                ++visited_count;
+            });
+
+            THEN("the points in the range are written to the buffer and visited")
+            {
+                REQUIRE(points_in_range.size() == 2u);
+                REQUIRE(visited_count == 2u);
+            }
+        }
+    }
+    GIVEN("a kdtree of randomly generated points")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+        std::uniform_real_distribution<float> radius_distribution(.1f, 1.5f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 4'096u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        pcp::kdtree::construction_params_t params;
+        params.construction = pcp::kdtree::construction_t::nth_element;
+        params.max_depth    = max_depth;
+
+        kdtree_type kdtree{points.begin(), points.end(), coordinate_map, params};
+
+        WHEN("searching for points in spheres and boxes enclosing whole cells")
+        {
+            pcp::sphere_a<float> const sphere{
+                {coordinate_distribution(gen),
+                 coordinate_distribution(gen),
+                 coordinate_distribution(gen)},
+                radius_distribution(gen)};
+            pcp::kd_axis_aligned_bounding_box_t<float, 3u> aabb;
+            aabb.min = {-.9f, -.6f, -.8f};
+            aabb.max = {.7f, .8f, .3f};
+
+            auto const points_in_sphere = kdtree.range_search(sphere);
+            auto const points_in_aabb   = kdtree.range_search(aabb);
+
+            THEN("the points found are exactly the points contained in the range")
+            {
+                auto const count_in = [&](auto const& range) {
+                    return static_cast<std::size_t>(
+                        std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                            return range.contains(coordinate_map(p));
+                        }));
+                };
+                auto const all_in = [&](auto const& found, auto const& range) {
+                    return std::all_of(found.cbegin(), found.cend(), [&](pcp::point_t const& p) {
+                        return range.contains(coordinate_map(p));
+                    });
+                };
+
+                REQUIRE(points_in_sphere.size() == count_in(sphere));
+                REQUIRE(all_in(points_in_sphere, sphere));
+                REQUIRE(points_in_aabb.size() == count_in(aabb));
+                REQUIRE(all_in(points_in_aabb, aabb));
+            }
+        }
+        WHEN("searching lazily for points in spheres and boxes")
+        {
+            pcp::sphere_a<float> const sphere{
+                {coordinate_distribution(gen),
+                 coordinate_distribution(gen),
+                 coordinate_distribution(gen)},
+                radius_distribution(gen)};
+            pcp::kd_axis_aligned_bounding_box_t<float, 3u> aabb;
+            aabb.min = {-.9f, -.6f, -.8f};
+            aabb.max = {.7f, .8f, .3f};
+            pcp::sphere_a<float> const outside{{3.f, 3.f, 3.f}, .5f};
+
+            auto const count_in = [&](auto const& range) {
+                return static_cast<std::size_t>(
+                    std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return range.contains(coordinate_map(p));
+                    }));
+            };
+            auto const all_in = [&](auto const& found, auto const& range) {
+                return std::all_of(found.cbegin(), found.cend(), [&](pcp::point_t const& p) {
+                    return range.contains(coordinate_map(p));
+                });
+            };
+
+            THEN("iterating the whole lazy range finds the points contained in the range")
+            {
+                std::vector<pcp::point_t> points_in_sphere;
+                for (auto const& p : kdtree.lazy_range_search(sphere))
+                    points_in_sphere.push_back(p);
+
+                REQUIRE(points_in_sphere.size() == count_in(sphere));
+                REQUIRE(all_in(points_in_sphere, sphere));
+                REQUIRE(kdtree.lazy_range_search(outside).empty());
+            }
+            THEN("capped searches and existence tests stop early with the right answer")
+            {
+                std::size_t const n           = 10u;
+                auto const first_in_aabb      = kdtree.range_search_first(aabb, n);
+                auto const first_in_sphere    = kdtree.range_search_first(sphere, n);
+                auto const expected_in_sphere = std::min(n, count_in(sphere));
+
+                REQUIRE(first_in_aabb.size() == n);
+                REQUIRE(all_in(first_in_aabb, aabb));
+                REQUIRE(first_in_sphere.size() == expected_in_sphere);
+                REQUIRE(all_in(first_in_sphere, sphere));
+                REQUIRE(kdtree.range_search_first(aabb, 0u).empty());
+
+                REQUIRE(kdtree.any_in_range(aabb));
+                REQUIRE(kdtree.any_in_range(sphere) == (count_in(sphere) > 0u));
+                REQUIRE_FALSE(kdtree.any_in_range(outside));
+            }
+        }
     }
 }
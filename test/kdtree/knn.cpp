@@ -1,6 +1,8 @@
 #include <catch2/catch.hpp>
 #include <pcp/common/points/point.hpp>
 #include <pcp/kdtree/linked_kdtree.hpp>
+#include <execution>
+#include <numeric>
 
 SCENARIO("KNN searches on linked kdtrees", "[kdtree]")
 {
@@ -242,5 +244,328 @@ SCENARIO("KNN searches on linked kdtrees", "[kdtree]")
                 REQUIRE(found_nearest_points);
             }
         }
+        WHEN("searching for approximate k nearest neighbours of a point in the kdtree")
+        {
+            kdtree_type kdtree{points.begin(), points.end(), coordinate_map, params};
+            pcp::point_t const target{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+            auto const k = k_distribution(gen);
+
+            std::vector<float> distances;
+            distances.reserve(points.size());
+            std::transform(
+                points.cbegin(),
+                points.cend(),
+                std::back_inserter(distances),
+                [&](pcp::point_t const& p) { return pcp::common::squared_distance(target, p); });
+            std::sort(distances.begin(), distances.end());
+
+            THEN("each neighbour is within the error bound of the exact neighbour of its rank")
+            {
+                for (double const epsilon : {0., .5, 2.})
+                {
+                    pcp::approximate_knn_parameters_t approximation;
+                    approximation.epsilon = epsilon;
+                    auto const nearest_neighbours = kdtree.approximate_nearest_neighbours(
+                        coordinate_map(target),
+                        k,
+                        approximation);
+
+                    REQUIRE(nearest_neighbours.size() == k);
+                    auto const factor = static_cast<float>((1. + epsilon) * (1. + epsilon));
+                    float previous_distance = 0.f;
+                    for (std::size_t i = 0u; i < k; ++i)
+                    {
+                        auto const d = pcp::common::squared_distance(target, nearest_neighbours[i]);
+                        REQUIRE(d >= previous_distance);
+                        REQUIRE(d <= Approx(factor * distances[i]));
+                        previous_distance = d;
+                    }
+                }
+            }
+            THEN("the search visits at most the budgeted leaves")
+            {
+                pcp::approximate_knn_parameters_t approximation;
+                approximation.max_visited_leaves = 0u;
+                REQUIRE(
+                    kdtree.approximate_nearest_neighbours(coordinate_map(target), k, approximation)
+                        .empty());
+
+                approximation.max_visited_leaves = 1u;
+                auto const nearest_neighbours =
+                    kdtree.approximate_nearest_neighbours(coordinate_map(target), k, approximation);
+                REQUIRE(nearest_neighbours.size() <= k);
+
+                typename kdtree_type::knn_scratch_type scratch;
+                std::vector<typename kdtree_type::neighbour_type> neighbours;
+                approximation.max_visited_leaves = points.size();
+                kdtree.approximate_nearest_neighbours(
+                    coordinate_map(target),
+                    k,
+                    approximation,
+                    scratch,
+                    std::back_inserter(neighbours));
+                REQUIRE(neighbours.size() == k);
+                for (std::size_t i = 0u; i < k; ++i)
+                    REQUIRE(neighbours[i].squared_distance == Approx(distances[i]));
+            }
+        }
+        WHEN("searching for at most k nearest neighbours within a radius of a point")
+        {
+            kdtree_type kdtree{points.begin(), points.end(), coordinate_map, params};
+            pcp::point_t const target{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+
+            std::vector<float> distances;
+            distances.reserve(points.size());
+            std::transform(
+                points.cbegin(),
+                points.cend(),
+                std::back_inserter(distances),
+                [&](pcp::point_t const& p) { return pcp::common::squared_distance(target, p); });
+            std::sort(distances.begin(), distances.end());
+
+            THEN("the neighbours are the k nearest points within the radius, sorted by distance")
+            {
+                kdtree_type::knn_scratch_type scratch;
+                std::vector<kdtree_type::neighbour_type> neighbours;
+                for (float const radius : {0.f, .05f, .2f, 4.f})
+                {
+                    for (std::size_t const k : {std::size_t{1u}, std::size_t{10u}, points.size()})
+                    {
+                        auto const num_in_radius = static_cast<std::size_t>(std::distance(
+                            distances.cbegin(),
+                            std::upper_bound(
+                                distances.cbegin(),
+                                distances.cend(),
+                                radius * radius)));
+                        auto const expected_size = std::min(k, num_in_radius);
+
+                        auto const nearest_neighbours = kdtree.radius_nearest_neighbours(
+                            coordinate_map(target),
+                            k,
+                            radius);
+                        REQUIRE(nearest_neighbours.size() == expected_size);
+                        for (std::size_t i = 0u; i < expected_size; ++i)
+                        {
+                            auto const d =
+                                pcp::common::squared_distance(target, nearest_neighbours[i]);
+                            REQUIRE(d == Approx(distances[i]));
+                        }
+
+                        neighbours.clear();
+                        kdtree.radius_nearest_neighbours(
+                            coordinate_map(target),
+                            k,
+                            radius,
+                            scratch,
+                            std::back_inserter(neighbours));
+                        REQUIRE(neighbours.size() == expected_size);
+                        for (std::size_t i = 0u; i < expected_size; ++i)
+                        {
+                            REQUIRE(neighbours[i].squared_distance == Approx(distances[i]));
+                            REQUIRE(neighbours[i].squared_distance <= radius * radius);
+                        }
+                    }
+                }
+            }
+        }
+        WHEN("searching a kdtree of 32-bit indices with cached coordinates")
+        {
+            auto const index_map = [&points](std::uint32_t i) {
+                return std::array<float, 3u>{points[i].x(), points[i].y(), points[i].z()};
+            };
+            using index_kdtree_type =
+                pcp::basic_linked_kdtree_t<std::uint32_t, 3u, decltype(index_map)>;
+
+            std::vector<std::uint32_t> indices(points.size());
+            std::iota(indices.begin(), indices.end(), 0u);
+
+            kdtree_type kdtree{points.begin(), points.end(), coordinate_map, params};
+            params.cache_coordinates = true;
+            index_kdtree_type index_kdtree{indices.begin(), indices.end(), index_map, params};
+
+            THEN("the cached coordinates are the coordinates of the indexed points")
+            {
+                REQUIRE(index_kdtree.has_coordinate_cache());
+                REQUIRE(!kdtree.has_coordinate_cache());
+                auto const& coordinates = index_kdtree.coordinate_cache();
+                std::size_t i           = 0u;
+                for (auto it = index_kdtree.cbegin(); it != index_kdtree.cend(); ++it, ++i)
+                {
+                    REQUIRE(coordinates[0][i] == Approx(points[*it].x()));
+                    REQUIRE(coordinates[1][i] == Approx(points[*it].y()));
+                    REQUIRE(coordinates[2][i] == Approx(points[*it].z()));
+                }
+            }
+            THEN("the kdtree finds the same nearest neighbours and points in ranges")
+            {
+                for (std::size_t i = 0u; i < 10u; ++i)
+                {
+                    pcp::point_t const target{
+                        coordinate_distribution(gen),
+                        coordinate_distribution(gen),
+                        coordinate_distribution(gen)};
+                    auto const k = k_distribution(gen);
+
+                    auto const expected = kdtree.nearest_neighbours(coordinate_map(target), k);
+                    auto const neighbours =
+                        index_kdtree.nearest_neighbours(coordinate_map(target), k);
+                    REQUIRE(neighbours.size() == expected.size());
+                    for (std::size_t j = 0u; j < neighbours.size(); ++j)
+                    {
+                        auto const d1 =
+                            pcp::common::squared_distance(target, points[neighbours[j]]);
+                        auto const d2 = pcp::common::squared_distance(target, expected[j]);
+                        REQUIRE(d1 == Approx(d2));
+                    }
+                }
+
+                pcp::kd_axis_aligned_bounding_box_t<float, 3u> const range{
+                    {-.3f, -.2f, -.5f},
+                    {.4f, .1f, .3f}};
+                auto const indices_in_range = index_kdtree.range_search(range);
+                REQUIRE(indices_in_range.size() == kdtree.range_search(range).size());
+                bool const all_in_range = std::all_of(
+                    indices_in_range.cbegin(),
+                    indices_in_range.cend(),
+                    [&](std::uint32_t j) { return range.contains(index_map(j)); });
+                REQUIRE(all_in_range);
+            }
+        }
+        WHEN("searching repeatedly for k nearest neighbours with a reusable scratch object")
+        {
+            kdtree_type kdtree{points.begin(), points.end(), coordinate_map, params};
+            typename kdtree_type::knn_scratch_type scratch;
+            std::vector<typename kdtree_type::neighbour_type> neighbours;
+
+            THEN("the neighbours and their squared distances match the allocating search")
+            {
+                for (std::size_t i = 0u; i < 10u; ++i)
+                {
+                    pcp::point_t const target{
+                        coordinate_distribution(gen),
+                        coordinate_distribution(gen),
+                        coordinate_distribution(gen)};
+                    auto const k = k_distribution(gen);
+
+                    auto const expected = kdtree.nearest_neighbours(target, k);
+                    neighbours.clear();
+                    kdtree.nearest_neighbours(
+                        coordinate_map(target),
+                        k,
+                        scratch,
+                        std::back_inserter(neighbours));
+
+                    REQUIRE(neighbours.size() == expected.size());
+                    for (std::size_t j = 0u; j < neighbours.size(); ++j)
+                    {
+                        auto const d = pcp::common::squared_distance(target, expected[j]);
+                        REQUIRE(neighbours[j].squared_distance == Approx(d));
+                        REQUIRE(
+                            pcp::common::squared_distance(target, *neighbours[j].element) ==
+                            Approx(d));
+                    }
+                }
+            }
+        }
+        WHEN("browsing the neighbours of a point incrementally")
+        {
+            kdtree_type kdtree{points.begin(), points.end(), coordinate_map, params};
+            pcp::point_t const target{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+
+            std::vector<float> distances;
+            distances.reserve(points.size());
+            std::transform(
+                points.cbegin(),
+                points.cend(),
+                std::back_inserter(distances),
+                [&](pcp::point_t const& p) { return pcp::common::squared_distance(target, p); });
+            std::sort(distances.begin(), distances.end());
+
+            THEN("the neighbours are visited from nearest to furthest, as many as requested")
+            {
+                std::size_t const k = 50u;
+                std::vector<typename kdtree_type::neighbour_type> neighbours;
+                auto browser = kdtree.incremental_nearest_neighbours(coordinate_map(target));
+                for (auto it = browser.begin(); it != browser.end() && neighbours.size() < k; ++it)
+                    neighbours.push_back(*it);
+
+                REQUIRE(neighbours.size() == k);
+                for (std::size_t i = 0u; i < k; ++i)
+                {
+                    REQUIRE(neighbours[i].squared_distance == Approx(distances[i]));
+                    REQUIRE(
+                        pcp::common::squared_distance(target, *neighbours[i].element) ==
+                        Approx(distances[i]));
+                }
+            }
+            THEN("browsing all neighbours visits every point once")
+            {
+                std::size_t count   = 0u;
+                float last_distance = 0.f;
+                bool is_sorted      = true;
+                for (auto const& neighbour : kdtree.incremental_nearest_neighbours(target))
+                {
+                    is_sorted     = is_sorted && last_distance <= neighbour.squared_distance;
+                    last_distance = neighbour.squared_distance;
+                    ++count;
+                }
+
+                REQUIRE(is_sorted);
+                REQUIRE(count == points.size());
+            }
+        }
+        WHEN("searching for k nearest neighbours of a batch of points")
+        {
+            kdtree_type kdtree{points.begin(), points.end(), coordinate_map, params};
+            auto const k = k_distribution(gen);
+
+            /*
+             * Half of the targets are points of the kdtree,
+             * which are not their own neighbours.
+             */
+            std::vector<std::array<float, 3u>> targets;
+            for (std::size_t i = 0u; i < 256u; ++i)
+            {
+                targets.push_back(coordinate_map(pcp::point_t{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)}));
+                targets.push_back(coordinate_map(points[i]));
+            }
+
+            std::vector<std::vector<pcp::point_t>> batch_neighbours(targets.size());
+            kdtree.batch_nearest_neighbours(
+                std::execution::par,
+                targets.cbegin(),
+                targets.cend(),
+                k,
+                batch_neighbours.begin());
+
+            THEN("each target's neighbours match the neighbours found by a single search")
+            {
+                for (std::size_t i = 0u; i < targets.size(); ++i)
+                {
+                    pcp::point_t const target{targets[i][0], targets[i][1], targets[i][2]};
+                    auto const expected = kdtree.nearest_neighbours(targets[i], k);
+                    REQUIRE(batch_neighbours[i].size() == expected.size());
+                    for (std::size_t j = 0u; j < expected.size(); ++j)
+                    {
+                        auto const d1 =
+                            pcp::common::squared_distance(target, batch_neighbours[i][j]);
+                        auto const d2 = pcp::common::squared_distance(target, expected[j]);
+                        REQUIRE(d1 == Approx(d2));
+                    }
+                }
+            }
+        }
     }
 }
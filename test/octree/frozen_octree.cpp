@@ -0,0 +1,221 @@
+#include <catch2/catch.hpp>
+#include <pcp/octree/frozen_octree.hpp>
+#include <pcp/octree/linked_octree.hpp>
+#include <numeric>
+#include <random>
+
+SCENARIO("frozen octree queries", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid    = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+
+    GIVEN("a linked octree of randomly generated points")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+        std::uniform_int_distribution<std::size_t> k_distribution(1u, 15u);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 2'048u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        pcp::linked_octree_t octree(points.cbegin(), points.cend(), point_map, params);
+
+        WHEN("freezing the octree")
+        {
+            auto const frozen = octree.freeze();
+
+            THEN("the frozen octree has the same elements")
+            {
+                REQUIRE(frozen.size() == octree.size());
+                bool const are_all_found =
+                    std::all_of(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        auto const it = frozen.find(p, point_map);
+                        return it != frozen.cend() && pcp::common::are_vectors_equal(*it, p);
+                    });
+                REQUIRE(are_all_found);
+                REQUIRE(frozen.find(pcp::point_t{2.f, 0.f, 0.f}, point_map) == frozen.cend());
+            }
+            THEN("every node's subtree is its bucket followed by its children's subtrees")
+            {
+                auto const& nodes = frozen.nodes();
+                for (auto const& node : nodes)
+                {
+                    REQUIRE(node.level < max_depth);
+                    std::uint32_t count = node.bucket_size;
+                    auto first          = node.first + node.bucket_size;
+                    auto c              = node.first_child;
+                    for (std::uint8_t o = 0u; o < 8u; ++o)
+                    {
+                        if (!node.has_child(o))
+                            continue;
+
+                        REQUIRE(node.child(o) == c);
+                        REQUIRE(nodes[c].first == first);
+                        REQUIRE(nodes[c].level == node.level + 1u);
+                        first += nodes[c].count;
+                        count += nodes[c].count;
+                        ++c;
+                    }
+                    REQUIRE(count == node.count);
+                }
+            }
+            THEN("the frozen octree finds the same nearest neighbours")
+            {
+                pcp::point_t const target{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)};
+                auto const k = k_distribution(gen);
+
+                auto const frozen_neighbours = frozen.nearest_neighbours(target, k, point_map);
+                auto const linked_neighbours = octree.nearest_neighbours(target, k, point_map);
+
+                REQUIRE(frozen_neighbours.size() == k);
+                REQUIRE(linked_neighbours.size() == k);
+                for (std::size_t i = 0u; i < k; ++i)
+                {
+                    auto const d1 = pcp::common::squared_distance(frozen_neighbours[i], target);
+                    auto const d2 = pcp::common::squared_distance(linked_neighbours[i], target);
+                    REQUIRE(d1 == Approx(d2));
+                }
+            }
+            THEN("the frozen octree finds the same points in ranges")
+            {
+                pcp::axis_aligned_bounding_box_t<pcp::point_t> const aabb{
+                    pcp::point_t{-.3f, -.2f, -.5f},
+                    pcp::point_t{.4f, .1f, .3f}};
+                pcp::sphere_t<pcp::point_t> const sphere{pcp::point_t{.2f, -.1f, .3f}, .5f};
+
+                auto const expected_in_aabb =
+                    std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return aabb.contains(p);
+                    });
+                auto const expected_in_sphere =
+                    std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return sphere.contains(p);
+                    });
+
+                auto const points_in_aabb = frozen.range_search(aabb, point_map);
+                REQUIRE(points_in_aabb.size() == static_cast<std::size_t>(expected_in_aabb));
+                bool const all_in_aabb = std::all_of(
+                    points_in_aabb.cbegin(),
+                    points_in_aabb.cend(),
+                    [&](pcp::point_t const& p) { return aabb.contains(p); });
+                REQUIRE(all_in_aabb);
+
+                REQUIRE(
+                    frozen.range_count(sphere, point_map) ==
+                    static_cast<std::size_t>(expected_in_sphere));
+                REQUIRE(
+                    frozen.range_count(sphere, point_map) == octree.range_count(sphere, point_map));
+            }
+        }
+        WHEN("freezing an octree of 32-bit indices with cached coordinates")
+        {
+            auto const index_map = [&points](std::uint32_t i) {
+                return points[i];
+            };
+
+            std::vector<std::uint32_t> indices(size);
+            std::iota(indices.begin(), indices.end(), 0u);
+            pcp::basic_linked_octree_t<std::uint32_t, pcp::octree_parameters_t<pcp::point_t>>
+                index_octree(indices.cbegin(), indices.cend(), index_map, params);
+            auto const frozen = index_octree.freeze(index_map);
+
+            THEN("the cached coordinates are the coordinates of the indexed points")
+            {
+                REQUIRE(frozen.size() == size);
+                REQUIRE(frozen.has_coordinate_cache());
+                auto const& coordinates = frozen.coordinate_cache();
+                std::size_t i           = 0u;
+                for (std::uint32_t const index : frozen)
+                {
+                    REQUIRE(coordinates[0][i] == Approx(points[index].x()));
+                    REQUIRE(coordinates[1][i] == Approx(points[index].y()));
+                    REQUIRE(coordinates[2][i] == Approx(points[index].z()));
+                    ++i;
+                }
+            }
+            THEN("the frozen octree finds the same nearest neighbours")
+            {
+                pcp::point_t const target{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)};
+                auto const k = k_distribution(gen);
+
+                auto const frozen_neighbours = frozen.nearest_neighbours(target, k, index_map);
+                auto const linked_neighbours = octree.nearest_neighbours(target, k, point_map);
+
+                REQUIRE(frozen_neighbours.size() == k);
+                REQUIRE(linked_neighbours.size() == k);
+                for (std::size_t i = 0u; i < k; ++i)
+                {
+                    auto const d1 =
+                        pcp::common::squared_distance(points[frozen_neighbours[i]], target);
+                    auto const d2 = pcp::common::squared_distance(linked_neighbours[i], target);
+                    REQUIRE(d1 == Approx(d2));
+                }
+            }
+            THEN("the frozen octree finds the same points in ranges")
+            {
+                pcp::axis_aligned_bounding_box_t<pcp::point_t> const aabb{
+                    pcp::point_t{-.3f, -.2f, -.5f},
+                    pcp::point_t{.4f, .1f, .3f}};
+                pcp::sphere_t<pcp::point_t> const sphere{pcp::point_t{.2f, -.1f, .3f}, .5f};
+
+                auto const indices_in_aabb = frozen.range_search(aabb, index_map);
+                REQUIRE(indices_in_aabb.size() == octree.range_count(aabb, point_map));
+                bool const all_in_aabb = std::all_of(
+                    indices_in_aabb.cbegin(),
+                    indices_in_aabb.cend(),
+                    [&](std::uint32_t i) { return aabb.contains(points[i]); });
+                REQUIRE(all_in_aabb);
+
+                REQUIRE(
+                    frozen.range_count(sphere, index_map) ==
+                    octree.range_count(sphere, point_map));
+            }
+        }
+        WHEN("erasing points before freezing the octree")
+        {
+            std::size_t const num_erased = size / 4u;
+            for (std::size_t i = 0u; i < num_erased; ++i)
+                octree.erase(octree.find(points[i], point_map));
+
+            auto const frozen = octree.freeze();
+
+            THEN("the frozen octree only has the remaining points")
+            {
+                REQUIRE(frozen.size() == size - num_erased);
+                for (std::size_t i = 0u; i < size; ++i)
+                {
+                    bool const is_found = frozen.find(points[i], point_map) != frozen.cend();
+                    REQUIRE(is_found == (i >= num_erased));
+                }
+
+                pcp::sphere_t<pcp::point_t> const sphere{pcp::point_t{0.f, 0.f, 0.f}, .8f};
+                REQUIRE(
+                    frozen.range_count(sphere, point_map) == octree.range_count(sphere, point_map));
+            }
+        }
+    }
+}
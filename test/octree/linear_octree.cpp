@@ -0,0 +1,188 @@
+#include <catch2/catch.hpp>
+#include <pcp/octree/linear_octree.hpp>
+#include <pcp/octree/linked_octree.hpp>
+#include <random>
+
+SCENARIO("linear octree construction and queries", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 2u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid    = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+
+    GIVEN("a range of points with some points outside of the voxel grid")
+    {
+        std::vector<pcp::point_t> points{
+            {-.5f, -.5f, -.5f},
+            {.5f, -.5f, -.5f},
+            {.5f, .5f, -.5f},
+            {-.5f, .5f, -.5f},
+            {-.5f, -.5f, .5f},
+            {.5f, -.5f, .5f},
+            {.5f, .5f, .5f},
+            {-.5f, .5f, .5f},
+            {2.f, 0.f, 0.f},
+            {0.f, -2.f, 0.f}};
+
+        pcp::linear_octree_t octree(points.cbegin(), points.cend(), point_map, params);
+
+        THEN("only the points inside the voxel grid are inserted")
+        {
+            REQUIRE(octree.size() == 8u);
+            REQUIRE(std::distance(octree.cbegin(), octree.cend()) == 8);
+        }
+        THEN("the elements are sorted in Morton order")
+        {
+            std::vector<pcp::point_t> const expected{
+                {-.5f, -.5f, -.5f}, // 000
+                {-.5f, -.5f, .5f},  // 001
+                {-.5f, .5f, -.5f},  // 010
+                {-.5f, .5f, .5f},   // 011
+                {.5f, -.5f, -.5f},  // 100
+                {.5f, -.5f, .5f},   // 101
+                {.5f, .5f, -.5f},   // 110
+                {.5f, .5f, .5f}};   // 111
+
+            if (node_capacity < 8u && max_depth > 1u)
+            {
+                bool const is_morton_ordered = std::equal(
+                    octree.cbegin(),
+                    octree.cend(),
+                    expected.cbegin(),
+                    [](pcp::point_t const& p1, pcp::point_t const& p2) {
+                        return pcp::common::are_vectors_equal(p1, p2);
+                    });
+                REQUIRE(is_morton_ordered);
+            }
+        }
+        THEN("every node's subtree is a contiguous range of its children's elements")
+        {
+            auto const& nodes = octree.nodes();
+            for (auto const& node : nodes)
+            {
+                REQUIRE(node.level < max_depth);
+                if (node.is_leaf())
+                {
+                    bool const is_within_capacity =
+                        node.count <= node_capacity || node.level + 1u == max_depth;
+                    REQUIRE(is_within_capacity);
+                    continue;
+                }
+
+                std::uint32_t count = 0u;
+                auto first          = node.first;
+                auto c              = node.first_child;
+                for (std::uint8_t o = 0u; o < 8u; ++o)
+                {
+                    if (!node.has_child(o))
+                        continue;
+
+                    REQUIRE(node.child(o) == c);
+                    REQUIRE(nodes[c].count > 0u);
+                    REQUIRE(nodes[c].first == first);
+                    REQUIRE(nodes[c].level == node.level + 1u);
+                    first += nodes[c].count;
+                    count += nodes[c].count;
+                    ++c;
+                }
+                REQUIRE(c - node.first_child == node.num_children());
+                REQUIRE(count == node.count);
+            }
+        }
+        THEN("the voxels derived from the child masks contain their nodes' elements")
+        {
+            auto const& nodes = octree.nodes();
+            auto const check  = [&](auto const& self,
+                                   pcp::linear_octree_node_t const& node,
+                                   pcp::axis_aligned_bounding_box_t<pcp::point_t> const& voxel)
+                -> void {
+                bool const contains_elements = std::all_of(
+                    octree.cbegin() + node.first,
+                    octree.cbegin() + node.first + node.count,
+                    [&](pcp::point_t const& p) { return voxel.contains(p); });
+                REQUIRE(contains_elements);
+                for (std::uint8_t o = 0u; o < 8u; ++o)
+                    if (node.has_child(o))
+                        self(self, nodes[node.child(o)], octree.octant_voxel(voxel, o));
+            };
+            check(check, nodes.front(), octree.voxel_grid());
+        }
+    }
+    GIVEN("a randomly generated point cloud")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+        std::uniform_int_distribution<std::size_t> k_distribution(1u, 15u);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 2'048u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        pcp::linear_octree_t linear_octree(points.cbegin(), points.cend(), point_map, params);
+        pcp::linked_octree_t linked_octree(points.cbegin(), points.cend(), point_map, params);
+
+        REQUIRE(linear_octree.size() == size);
+
+        WHEN("searching for the k nearest neighbours of a point")
+        {
+            pcp::point_t const target{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+            auto const k = k_distribution(gen);
+
+            auto const linear_neighbours = linear_octree.nearest_neighbours(target, k, point_map);
+            auto const linked_neighbours = linked_octree.nearest_neighbours(target, k, point_map);
+
+            THEN("the linear octree finds the same neighbours as the linked octree")
+            {
+                REQUIRE(linear_neighbours.size() == k);
+                REQUIRE(linked_neighbours.size() == k);
+                for (std::size_t i = 0u; i < k; ++i)
+                {
+                    auto const d1 = pcp::common::squared_distance(linear_neighbours[i], target);
+                    auto const d2 = pcp::common::squared_distance(linked_neighbours[i], target);
+                    REQUIRE(d1 == Approx(d2));
+                }
+            }
+        }
+        WHEN("searching for points in a range")
+        {
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const range{
+                pcp::point_t{-.3f, -.2f, -.5f},
+                pcp::point_t{.4f, .1f, .3f}};
+
+            auto const points_in_range = linear_octree.range_search(range, point_map);
+
+            THEN("the points found are exactly the points contained in the range")
+            {
+                auto const expected_count =
+                    std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return range.contains(p);
+                    });
+                REQUIRE(points_in_range.size() == static_cast<std::size_t>(expected_count));
+
+                bool const all_in_range = std::all_of(
+                    points_in_range.cbegin(),
+                    points_in_range.cend(),
+                    [&](pcp::point_t const& p) { return range.contains(p); });
+                REQUIRE(all_in_range);
+            }
+        }
+    }
+}
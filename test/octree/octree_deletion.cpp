@@ -1,5 +1,6 @@
 #include <catch2/catch.hpp>
 #include <pcp/octree/linked_octree.hpp>
+#include <random>
 
 SCENARIO("octree deletion", "[octree]")
 {
@@ -101,6 +102,80 @@ SCENARIO("octree deletion", "[octree]")
                 REQUIRE(next != octree.cend());
             }
         }
+        WHEN("removing points while iterating over the octree")
+        {
+            auto const is_point_to_remove = [](pcp::point_t const& p) {
+                return p.x() > 0.f;
+            };
+
+            for (auto it = octree.cbegin(); it != octree.cend();)
+            {
+                if (is_point_to_remove(*it))
+                    it = octree.erase(it);
+                else
+                    ++it;
+            }
+
+            THEN("only the matching points are removed")
+            {
+                auto const num_removed = static_cast<std::size_t>(
+                    std::count_if(points.cbegin(), points.cend(), is_point_to_remove));
+                REQUIRE(octree.size() == points.size() - num_removed);
+                REQUIRE(
+                    static_cast<std::size_t>(std::distance(octree.cbegin(), octree.cend())) ==
+                    octree.size());
+                REQUIRE(std::none_of(octree.cbegin(), octree.cend(), is_point_to_remove));
+            }
+        }
+        WHEN("removing points satisfying a predicate")
+        {
+            auto const is_point_to_remove = [](pcp::point_t const& p) {
+                return p.x() > 0.f;
+            };
+
+            auto const num_erased = octree.erase_if(is_point_to_remove, point_map);
+
+            THEN("only the matching points are removed")
+            {
+                auto const num_removed = static_cast<std::size_t>(
+                    std::count_if(points.cbegin(), points.cend(), is_point_to_remove));
+                REQUIRE(num_erased == num_removed);
+                REQUIRE(octree.size() == points.size() - num_removed);
+                REQUIRE(
+                    static_cast<std::size_t>(std::distance(octree.cbegin(), octree.cend())) ==
+                    octree.size());
+                REQUIRE(std::none_of(octree.cbegin(), octree.cend(), is_point_to_remove));
+                for (auto const& p : points)
+                {
+                    bool const is_found = octree.find(p, point_map) != octree.cend();
+                    REQUIRE(is_found == !is_point_to_remove(p));
+                }
+            }
+            THEN("subtrees fitting in their root node are collapsed")
+            {
+                auto const frozen = octree.freeze();
+                for (auto const& node : frozen.nodes())
+                {
+                    if (!node.is_leaf())
+                        REQUIRE(node.count > node_capacity);
+                    if (&node != &frozen.nodes().front())
+                        REQUIRE(node.count > 0u);
+                }
+            }
+        }
+        WHEN("removing all points with a predicate")
+        {
+            auto const num_erased =
+                octree.erase_if([](pcp::point_t const&) { return true; }, point_map);
+
+            THEN("octree is empty")
+            {
+                REQUIRE(num_erased == points.size());
+                REQUIRE(octree.empty());
+                REQUIRE(octree.cbegin() == octree.cend());
+                REQUIRE(octree.freeze().nodes().size() == 1u);
+            }
+        }
         WHEN("removing all points")
         {
             auto it = octree.cbegin();
@@ -121,3 +196,109 @@ SCENARIO("octree deletion", "[octree]")
         }
     }
 }
+
+SCENARIO("octree predicate deletion keeps subtree statistics exact", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 8u, 64u);
+    auto max_depth     = GENERATE(2u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    using params_type = pcp::aggregate_octree_parameters_t<pcp::point_t>;
+    using octree_type = pcp::basic_linked_octree_t<pcp::point_t, params_type>;
+
+    params_type params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}};
+
+    GIVEN("an octree of randomly generated points")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 5'000u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        octree_type octree(points.cbegin(), points.cend(), point_map, params);
+
+        WHEN("removing most points with a predicate")
+        {
+            auto const is_point_to_remove = [](pcp::point_t const& p) {
+                return p.x() > -.6f;
+            };
+            auto const num_erased = octree.erase_if(is_point_to_remove, point_map);
+
+            std::vector<pcp::point_t> remaining_points;
+            std::copy_if(
+                points.cbegin(),
+                points.cend(),
+                std::back_inserter(remaining_points),
+                [&](pcp::point_t const& p) { return !is_point_to_remove(p); });
+
+            THEN("the remaining points are the same as with single element erasure")
+            {
+                octree_type expected(points.cbegin(), points.cend(), point_map, params);
+                for (auto it = expected.cbegin(); it != expected.cend();)
+                {
+                    if (is_point_to_remove(*it))
+                        it = expected.erase(it);
+                    else
+                        ++it;
+                }
+
+                REQUIRE(num_erased == size - remaining_points.size());
+                REQUIRE(octree.size() == expected.size());
+                REQUIRE(std::is_permutation(
+                    octree.cbegin(),
+                    octree.cend(),
+                    expected.cbegin(),
+                    expected.cend(),
+                    [](pcp::point_t const& p1, pcp::point_t const& p2) {
+                        return pcp::common::are_vectors_equal(p1, p2);
+                    }));
+            }
+            THEN("count and aggregate range queries are exact")
+            {
+                pcp::axis_aligned_bounding_box_t<pcp::point_t> const range{
+                    pcp::point_t{-.9f, -.7f, -.1f},
+                    pcp::point_t{.6f, .2f, .9f}};
+
+                std::size_t count = 0u;
+                pcp::point_t coordinate_sum{0.f, 0.f, 0.f};
+                for (auto const& p : remaining_points)
+                {
+                    if (!range.contains(p))
+                        continue;
+
+                    ++count;
+                    coordinate_sum = coordinate_sum + p;
+                }
+
+                REQUIRE(octree.range_count(range, point_map) == count);
+                auto const aggregate = octree.range_aggregate(range, point_map);
+                REQUIRE(aggregate.count == count);
+                REQUIRE(aggregate.coordinate_sum.x() == Approx(coordinate_sum.x()).margin(5e-2));
+                REQUIRE(aggregate.coordinate_sum.y() == Approx(coordinate_sum.y()).margin(5e-2));
+                REQUIRE(aggregate.coordinate_sum.z() == Approx(coordinate_sum.z()).margin(5e-2));
+            }
+            THEN("nearest neighbours are only found among the remaining points")
+            {
+                pcp::point_t const target{0.f, 0.f, 0.f};
+                auto const neighbours = octree.nearest_neighbours(target, 5u, point_map);
+                REQUIRE(neighbours.size() == 5u);
+                REQUIRE(std::none_of(neighbours.cbegin(), neighbours.cend(), is_point_to_remove));
+            }
+        }
+    }
+}
@@ -1,5 +1,9 @@
+#include <atomic>
 #include <catch2/catch.hpp>
+#include <execution>
 #include <pcp/octree/linked_octree.hpp>
+#include <random>
+#include <thread>
 
 SCENARIO("octree insertion", "[octree]")
 {
@@ -132,3 +136,360 @@ SCENARIO("octree insertion", "[octree]")
         }
     }
 }
+
+SCENARIO("octree parallel bulk insertion", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 7u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}};
+
+    GIVEN("a range of points contained or not contained in the octree's voxel grid")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.2f, 1.2f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 10'000u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        auto const are_equal = [](pcp::linked_octree_t const& o1, pcp::linked_octree_t const& o2) {
+            return std::equal(
+                o1.cbegin(),
+                o1.cend(),
+                o2.cbegin(),
+                o2.cend(),
+                [](pcp::point_t const& p1, pcp::point_t const& p2) {
+                    return pcp::common::are_vectors_equal(p1, p2);
+                });
+        };
+
+        WHEN("constructing the octree in bulk with a parallel execution policy")
+        {
+            pcp::linked_octree_t incremental(points.cbegin(), points.cend(), point_map, params);
+            pcp::linked_octree_t bulk(
+                std::execution::par,
+                points.cbegin(),
+                points.cend(),
+                point_map,
+                params);
+
+            THEN("the octree is identical to the incrementally constructed octree")
+            {
+                REQUIRE(bulk.size() == incremental.size());
+                REQUIRE(are_equal(bulk, incremental));
+            }
+        }
+        WHEN("inserting in bulk in a non-empty octree")
+        {
+            auto const mid = points.cbegin() + static_cast<std::ptrdiff_t>(size / 3u);
+
+            pcp::linked_octree_t incremental(points.cbegin(), points.cend(), point_map, params);
+            pcp::linked_octree_t bulk(points.cbegin(), mid, point_map, params);
+            bulk.insert(std::execution::par, mid, points.cend(), point_map);
+
+            THEN("the octree is identical to the incrementally constructed octree")
+            {
+                REQUIRE(bulk.size() == incremental.size());
+                REQUIRE(are_equal(bulk, incremental));
+            }
+        }
+    }
+}
+
+SCENARIO("octree lazy subdivision", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 7u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    using lazy_params_type = pcp::lazy_octree_parameters_t<pcp::point_t>;
+    using lazy_octree_type = pcp::basic_linked_octree_t<pcp::point_t, lazy_params_type>;
+
+    lazy_params_type params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}};
+
+    GIVEN("a range of points contained or not contained in the octree's voxel grid")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.2f, 1.2f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 5'000u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        lazy_octree_type lazy(points.cbegin(), points.cend(), point_map, params);
+        pcp::linked_octree_t eager(points.cbegin(), points.cend(), point_map, params);
+
+        auto const num_buckets = [](auto const& octree) {
+            return std::distance(octree.bucket_begin(), octree.bucket_end());
+        };
+
+        THEN("the root holds all the points until the octree is queried")
+        {
+            REQUIRE(lazy.size() == eager.size());
+            REQUIRE(num_buckets(lazy) == 1);
+            REQUIRE(lazy.bucket_begin()->size() == eager.size());
+        }
+        WHEN("searching for points in a small region")
+        {
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const range{
+                pcp::point_t{.1f, .2f, -.3f},
+                pcp::point_t{.3f, .35f, -.1f}};
+
+            auto const points_in_range = lazy.range_search(range, point_map);
+
+            THEN("the points found are exactly the points contained in the region")
+            {
+                auto const expected_count =
+                    std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return range.contains(p);
+                    });
+                REQUIRE(points_in_range.size() == static_cast<std::size_t>(expected_count));
+                REQUIRE(lazy.range_count(range, point_map) == points_in_range.size());
+            }
+            THEN("only the nodes around the region are subdivided")
+            {
+                REQUIRE(lazy.size() == eager.size());
+                if (max_depth == 21u)
+                    REQUIRE(num_buckets(lazy) < num_buckets(eager));
+            }
+        }
+        WHEN("searching for points in the whole voxel grid")
+        {
+            auto const all_points = lazy.range_search(params.voxel_grid, point_map);
+
+            THEN("the octree is identical to the eagerly subdivided octree")
+            {
+                REQUIRE(all_points.size() == eager.size());
+                bool const are_equal = std::equal(
+                    lazy.cbegin(),
+                    lazy.cend(),
+                    eager.cbegin(),
+                    eager.cend(),
+                    [](pcp::point_t const& p1, pcp::point_t const& p2) {
+                        return pcp::common::are_vectors_equal(p1, p2);
+                    });
+                REQUIRE(are_equal);
+            }
+        }
+        WHEN("searching for nearest neighbours from many threads")
+        {
+            std::vector<pcp::point_t> const targets(points.cbegin(), points.cbegin() + 256);
+            std::size_t const k = 8u;
+            std::vector<std::vector<pcp::point_t>> lazy_neighbours(targets.size());
+            std::vector<std::vector<pcp::point_t>> eager_neighbours(targets.size());
+            lazy.batch_nearest_neighbours(
+                std::execution::par,
+                targets.cbegin(),
+                targets.cend(),
+                k,
+                point_map,
+                lazy_neighbours.begin());
+            eager.batch_nearest_neighbours(
+                targets.cbegin(),
+                targets.cend(),
+                k,
+                point_map,
+                eager_neighbours.begin());
+
+            THEN("the neighbours are the same as in the eagerly subdivided octree")
+            {
+                for (std::size_t i = 0u; i < targets.size(); ++i)
+                {
+                    REQUIRE(lazy_neighbours[i].size() == eager_neighbours[i].size());
+                    for (std::size_t j = 0u; j < lazy_neighbours[i].size(); ++j)
+                    {
+                        auto const d1 =
+                            pcp::common::squared_distance(lazy_neighbours[i][j], targets[i]);
+                        auto const d2 =
+                            pcp::common::squared_distance(eager_neighbours[i][j], targets[i]);
+                        REQUIRE(d1 == Approx(d2));
+                    }
+                }
+            }
+            THEN("every point can be found")
+            {
+                bool const are_all_found =
+                    std::all_of(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        bool const is_found = lazy.find(p, point_map) != lazy.cend();
+                        return is_found == params.voxel_grid.contains(p);
+                    });
+                REQUIRE(are_all_found);
+            }
+        }
+    }
+}
+
+SCENARIO("octree concurrent insertion", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 7u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    using params_type = pcp::aggregate_octree_parameters_t<pcp::point_t>;
+    using octree_type = pcp::basic_linked_octree_t<pcp::point_t, params_type>;
+
+    params_type params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}};
+
+    GIVEN("a range of points contained or not contained in the octree's voxel grid")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.2f, 1.2f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 10'000u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        auto const num_points_in_grid = static_cast<std::size_t>(
+            std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                return params.voxel_grid.contains(p);
+            }));
+
+        pcp::axis_aligned_bounding_box_t<pcp::point_t> const range{
+            pcp::point_t{-.5f, -.7f, -.1f},
+            pcp::point_t{.6f, .2f, .9f}};
+
+        std::vector<pcp::point_t> points_in_range;
+        pcp::point_t coordinate_sum{0.f, 0.f, 0.f};
+        for (auto const& p : points)
+        {
+            if (!range.contains(p))
+                continue;
+
+            points_in_range.push_back(p);
+            coordinate_sum = coordinate_sum + p;
+        }
+
+        WHEN("inserting the points from many threads while searching from another thread")
+        {
+            octree_type octree(params);
+
+            std::size_t const num_writers = 4u;
+            std::atomic<bool> are_writers_done{false};
+            std::atomic<bool> are_searches_valid{true};
+
+            std::thread reader([&]() {
+                while (!are_writers_done.load())
+                {
+                    auto const found = octree.concurrent_range_search(range, point_map);
+                    bool const are_found_points_in_range =
+                        std::all_of(found.cbegin(), found.cend(), [&](pcp::point_t const& p) {
+                            return range.contains(p);
+                        });
+                    if (!are_found_points_in_range || found.size() > points_in_range.size())
+                        are_searches_valid.store(false);
+                }
+            });
+
+            std::vector<std::thread> writers;
+            for (std::size_t w = 0u; w < num_writers; ++w)
+            {
+                writers.emplace_back([&, w]() {
+                    for (std::size_t i = w; i < points.size(); i += num_writers)
+                        octree.concurrent_insert(points[i], point_map);
+                });
+            }
+            for (auto& writer : writers)
+                writer.join();
+
+            are_writers_done.store(true);
+            reader.join();
+
+            THEN("all points in the voxel grid are inserted and can be found")
+            {
+                REQUIRE(are_searches_valid.load());
+                REQUIRE(octree.size() == num_points_in_grid);
+                REQUIRE(std::distance(octree.cbegin(), octree.cend()) == num_points_in_grid);
+                REQUIRE(
+                    octree.concurrent_range_search(range, point_map).size() ==
+                    points_in_range.size());
+
+                bool const are_all_found =
+                    std::all_of(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return !params.voxel_grid.contains(p) ||
+                               octree.find(p, point_map) != octree.cend();
+                    });
+                REQUIRE(are_all_found);
+            }
+            THEN("count and aggregate range queries are exact before and after refreshing")
+            {
+                auto const require_exact_aggregate = [&]() {
+                    REQUIRE(octree.range_count(range, point_map) == points_in_range.size());
+                    REQUIRE(
+                        octree.range_count(params.voxel_grid, point_map) == num_points_in_grid);
+
+                    auto const aggregate = octree.range_aggregate(range, point_map);
+                    REQUIRE(aggregate.count == points_in_range.size());
+                    REQUIRE(
+                        aggregate.coordinate_sum.x() == Approx(coordinate_sum.x()).margin(5e-2));
+                    REQUIRE(
+                        aggregate.coordinate_sum.y() == Approx(coordinate_sum.y()).margin(5e-2));
+                    REQUIRE(
+                        aggregate.coordinate_sum.z() == Approx(coordinate_sum.z()).margin(5e-2));
+                };
+
+                require_exact_aggregate();
+                octree.refresh_statistics(point_map);
+                require_exact_aggregate();
+            }
+        }
+        WHEN("inserting points from the visitor of a concurrent range search")
+        {
+            octree_type octree(points_in_range.cbegin(), points_in_range.cend(), point_map, params);
+
+            // the inserted points lie above the range, so they are not visited
+            octree.concurrent_visit_range(range, point_map, [&](pcp::point_t const& p) {
+                octree.concurrent_insert(pcp::point_t{p.x(), .5f, p.z()}, point_map);
+            });
+
+            THEN("the visited points and the inserted points are in the octree")
+            {
+                REQUIRE(octree.size() == 2u * points_in_range.size());
+                REQUIRE(
+                    octree.concurrent_range_search(range, point_map).size() ==
+                    points_in_range.size());
+                REQUIRE(octree.range_count(params.voxel_grid, point_map) == octree.size());
+            }
+        }
+    }
+}
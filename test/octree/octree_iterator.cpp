@@ -186,5 +186,57 @@ SCENARIO("octree iterators are valid LegacyForwardIterator types", "[octree]")
                         test_point) == test_point_count);
             }
         }
+        WHEN("using its bucket iterators")
+        {
+            std::vector<pcp::point_t> elements_of_buckets{};
+            std::size_t num_buckets = 0u;
+            for (auto it = octree.bucket_begin(); it != octree.bucket_end(); ++it)
+            {
+                REQUIRE_FALSE(it->empty());
+                elements_of_buckets.insert(elements_of_buckets.end(), it->cbegin(), it->cend());
+                ++num_buckets;
+            }
+
+            THEN("the buckets hold the octree's elements in iteration order")
+            {
+                REQUIRE(num_buckets > 0u);
+                REQUIRE(elements_of_buckets.size() == octree.size());
+                REQUIRE(std::equal(
+                    elements_of_buckets.cbegin(),
+                    elements_of_buckets.cend(),
+                    octree.cbegin(),
+                    [](pcp::point_t const& p1, pcp::point_t const& p2) {
+                        return pcp::common::are_vectors_equal(p1, p2);
+                    }));
+            }
+        }
+        WHEN("moving the octree")
+        {
+            std::vector<pcp::point_t> const elements_before_move(octree.cbegin(), octree.cend());
+            pcp::linked_octree_t moved_octree(std::move(octree));
+
+            THEN("iterators traverse the moved octree's elements in the same order")
+            {
+                REQUIRE(moved_octree.cbegin().root() != nullptr);
+                REQUIRE(std::equal(
+                    elements_before_move.cbegin(),
+                    elements_before_move.cend(),
+                    moved_octree.cbegin(),
+                    moved_octree.cend(),
+                    [](pcp::point_t const& p1, pcp::point_t const& p2) {
+                        return pcp::common::are_vectors_equal(p1, p2);
+                    }));
+            }
+        }
+        WHEN("clearing the octree")
+        {
+            octree.clear();
+
+            THEN("the begin iterator is the end iterator")
+            {
+                REQUIRE(octree.cbegin() == octree.cend());
+                REQUIRE(octree.bucket_begin() == octree.bucket_end());
+            }
+        }
     }
 }
\ No newline at end of file
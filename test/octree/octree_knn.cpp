@@ -1,5 +1,6 @@
 #include <catch2/catch.hpp>
 #include <pcp/octree/linked_octree.hpp>
+#include <execution>
 
 SCENARIO("KNN searches on the octree", "[octree]")
 {
@@ -251,5 +252,314 @@ SCENARIO("KNN searches on the octree", "[octree]")
                 REQUIRE(found_nearest_points);
             }
         }
+        WHEN("searching for k nearest neighbours of a point in the octree")
+        {
+            pcp::point_t const reference{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+            auto const k = k_distribution(gen);
+
+            std::vector<pcp::point_t> nearest_neighbours =
+                octree.nearest_neighbours(reference, k, point_map);
+
+            THEN("the neighbours are the k nearest points, sorted from nearest to furthest")
+            {
+                std::vector<float> distances;
+                distances.reserve(octree.size());
+                std::transform(
+                    octree.cbegin(),
+                    octree.cend(),
+                    std::back_inserter(distances),
+                    [&](pcp::point_t const& p) {
+                        return pcp::common::squared_distance(reference, p);
+                    });
+                std::sort(distances.begin(), distances.end());
+
+                REQUIRE(nearest_neighbours.size() == k);
+                for (std::size_t i = 0u; i < k; ++i)
+                {
+                    auto const d = pcp::common::squared_distance(reference, nearest_neighbours[i]);
+                    REQUIRE(d == Approx(distances[i]));
+                }
+            }
+        }
+        WHEN("searching for approximate k nearest neighbours of a point in the octree")
+        {
+            pcp::point_t const reference{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+            auto const k = k_distribution(gen);
+
+            std::vector<float> distances;
+            distances.reserve(octree.size());
+            std::transform(
+                octree.cbegin(),
+                octree.cend(),
+                std::back_inserter(distances),
+                [&](pcp::point_t const& p) {
+                    return pcp::common::squared_distance(reference, p);
+                });
+            std::sort(distances.begin(), distances.end());
+
+            THEN("each neighbour is within the error bound of the exact neighbour of its rank")
+            {
+                for (double const epsilon : {0., .5, 2.})
+                {
+                    pcp::approximate_knn_parameters_t approximation;
+                    approximation.epsilon = epsilon;
+                    auto const nearest_neighbours = octree.approximate_nearest_neighbours(
+                        reference,
+                        k,
+                        point_map,
+                        approximation);
+
+                    REQUIRE(nearest_neighbours.size() == k);
+                    auto const factor = static_cast<float>((1. + epsilon) * (1. + epsilon));
+                    float previous_distance = 0.f;
+                    for (std::size_t i = 0u; i < k; ++i)
+                    {
+                        auto const d =
+                            pcp::common::squared_distance(reference, nearest_neighbours[i]);
+                        REQUIRE(d >= previous_distance);
+                        REQUIRE(d <= Approx(factor * distances[i]));
+                        previous_distance = d;
+                    }
+                }
+            }
+            THEN("the search visits at most the budgeted leaves")
+            {
+                pcp::approximate_knn_parameters_t approximation;
+                approximation.max_visited_leaves = 0u;
+                REQUIRE(
+                    octree.approximate_nearest_neighbours(reference, k, point_map, approximation)
+                        .empty());
+
+                approximation.max_visited_leaves = 1u;
+                auto const nearest_neighbours =
+                    octree.approximate_nearest_neighbours(reference, k, point_map, approximation);
+                REQUIRE(nearest_neighbours.size() <= k);
+                REQUIRE(std::is_sorted(
+                    nearest_neighbours.cbegin(),
+                    nearest_neighbours.cend(),
+                    [&](pcp::point_t const& p1, pcp::point_t const& p2) {
+                        return pcp::common::squared_distance(reference, p1) <
+                               pcp::common::squared_distance(reference, p2);
+                    }));
+
+                pcp::linked_octree_t::knn_scratch_type scratch;
+                std::vector<pcp::linked_octree_t::neighbour_type> neighbours;
+                approximation.max_visited_leaves = octree.size();
+                octree.approximate_nearest_neighbours(
+                    reference,
+                    k,
+                    point_map,
+                    approximation,
+                    scratch,
+                    std::back_inserter(neighbours));
+                REQUIRE(neighbours.size() == k);
+                for (std::size_t i = 0u; i < k; ++i)
+                    REQUIRE(neighbours[i].squared_distance == Approx(distances[i]));
+            }
+        }
+        WHEN("searching for at most k nearest neighbours within a radius of a point in the octree")
+        {
+            pcp::point_t const reference{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+
+            std::vector<float> distances;
+            distances.reserve(octree.size());
+            std::transform(
+                octree.cbegin(),
+                octree.cend(),
+                std::back_inserter(distances),
+                [&](pcp::point_t const& p) {
+                    return pcp::common::squared_distance(reference, p);
+                });
+            std::sort(distances.begin(), distances.end());
+
+            THEN("the neighbours are the k nearest points within the radius, sorted by distance")
+            {
+                pcp::linked_octree_t::knn_scratch_type scratch;
+                std::vector<pcp::linked_octree_t::neighbour_type> neighbours;
+                for (float const radius : {0.f, .05f, .2f, 4.f})
+                {
+                    for (std::size_t const k : {std::size_t{1u}, std::size_t{10u}, octree.size()})
+                    {
+                        auto const num_in_radius = static_cast<std::size_t>(std::distance(
+                            distances.cbegin(),
+                            std::upper_bound(
+                                distances.cbegin(),
+                                distances.cend(),
+                                radius * radius)));
+                        auto const expected_size = std::min(k, num_in_radius);
+
+                        auto const nearest_neighbours =
+                            octree.radius_nearest_neighbours(reference, k, radius, point_map);
+                        REQUIRE(nearest_neighbours.size() == expected_size);
+                        for (std::size_t i = 0u; i < expected_size; ++i)
+                        {
+                            auto const d =
+                                pcp::common::squared_distance(reference, nearest_neighbours[i]);
+                            REQUIRE(d == Approx(distances[i]));
+                        }
+
+                        neighbours.clear();
+                        octree.radius_nearest_neighbours(
+                            reference,
+                            k,
+                            radius,
+                            point_map,
+                            scratch,
+                            std::back_inserter(neighbours));
+                        REQUIRE(neighbours.size() == expected_size);
+                        for (std::size_t i = 0u; i < expected_size; ++i)
+                        {
+                            REQUIRE(neighbours[i].squared_distance == Approx(distances[i]));
+                            REQUIRE(neighbours[i].squared_distance <= radius * radius);
+                        }
+                    }
+                }
+            }
+        }
+        WHEN("searching repeatedly for k nearest neighbours with a reusable scratch object")
+        {
+            pcp::linked_octree_t::knn_scratch_type scratch;
+            std::vector<pcp::linked_octree_t::neighbour_type> neighbours;
+
+            THEN("the neighbours and their squared distances match the allocating search")
+            {
+                for (std::size_t i = 0u; i < 10u; ++i)
+                {
+                    pcp::point_t const reference{
+                        coordinate_distribution(gen),
+                        coordinate_distribution(gen),
+                        coordinate_distribution(gen)};
+                    auto const k = k_distribution(gen);
+
+                    auto const expected = octree.nearest_neighbours(reference, k, point_map);
+                    neighbours.clear();
+                    octree.nearest_neighbours(
+                        reference,
+                        k,
+                        point_map,
+                        scratch,
+                        std::back_inserter(neighbours));
+
+                    REQUIRE(neighbours.size() == expected.size());
+                    for (std::size_t j = 0u; j < neighbours.size(); ++j)
+                    {
+                        auto const d = pcp::common::squared_distance(reference, expected[j]);
+                        REQUIRE(neighbours[j].squared_distance == Approx(d));
+                        REQUIRE(
+                            pcp::common::squared_distance(reference, *neighbours[j].element) ==
+                            Approx(d));
+                    }
+                }
+            }
+        }
+        WHEN("browsing the neighbours of a point incrementally")
+        {
+            pcp::point_t const reference{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+
+            std::vector<float> distances;
+            distances.reserve(octree.size());
+            std::transform(
+                octree.cbegin(),
+                octree.cend(),
+                std::back_inserter(distances),
+                [&](pcp::point_t const& p) { return pcp::common::squared_distance(reference, p); });
+            std::sort(distances.begin(), distances.end());
+
+            THEN("the neighbours are visited from nearest to furthest, as many as requested")
+            {
+                std::size_t const k = 50u;
+                std::vector<pcp::linked_octree_t::neighbour_type> neighbours;
+                auto browser = octree.incremental_nearest_neighbours(reference, point_map);
+                for (auto it = browser.begin(); it != browser.end() && neighbours.size() < k; ++it)
+                    neighbours.push_back(*it);
+
+                REQUIRE(neighbours.size() == k);
+                for (std::size_t i = 0u; i < k; ++i)
+                {
+                    REQUIRE(neighbours[i].squared_distance == Approx(distances[i]));
+                    REQUIRE(
+                        pcp::common::squared_distance(reference, *neighbours[i].element) ==
+                        Approx(distances[i]));
+                }
+
+                auto const expected = octree.nearest_neighbours(reference, k, point_map);
+                for (std::size_t i = 0u; i < k; ++i)
+                    REQUIRE(
+                        pcp::common::squared_distance(reference, expected[i]) ==
+                        Approx(neighbours[i].squared_distance));
+            }
+            THEN("browsing all neighbours visits every point once")
+            {
+                std::size_t count   = 0u;
+                float last_distance = 0.f;
+                bool is_sorted      = true;
+                for (auto const& neighbour :
+                     octree.incremental_nearest_neighbours(reference, point_map))
+                {
+                    is_sorted     = is_sorted && last_distance <= neighbour.squared_distance;
+                    last_distance = neighbour.squared_distance;
+                    ++count;
+                }
+
+                REQUIRE(is_sorted);
+                REQUIRE(count == octree.size());
+            }
+        }
+        WHEN("searching for k nearest neighbours of a batch of points")
+        {
+            auto const k = k_distribution(gen);
+
+            /*
+             * Half of the targets are points of the octree,
+             * which are not their own neighbours.
+             */
+            std::vector<pcp::point_t> targets{pcp::point_t{10.f, -10.f, 10.f}};
+            auto it = octree.cbegin();
+            for (std::size_t i = 0u; i < 256u; ++i, ++it)
+            {
+                targets.push_back(pcp::point_t{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)});
+                targets.push_back(*it);
+            }
+
+            std::vector<std::vector<pcp::point_t>> batch_neighbours(targets.size());
+            octree.batch_nearest_neighbours(
+                std::execution::par,
+                targets.cbegin(),
+                targets.cend(),
+                k,
+                point_map,
+                batch_neighbours.begin());
+
+            THEN("each target's neighbours match the neighbours found by a single search")
+            {
+                for (std::size_t i = 0u; i < targets.size(); ++i)
+                {
+                    auto const expected = octree.nearest_neighbours(targets[i], k, point_map);
+                    REQUIRE(batch_neighbours[i].size() == expected.size());
+                    for (std::size_t j = 0u; j < expected.size(); ++j)
+                    {
+                        auto const d1 =
+                            pcp::common::squared_distance(targets[i], batch_neighbours[i][j]);
+                        auto const d2 = pcp::common::squared_distance(targets[i], expected[j]);
+                        REQUIRE(d1 == Approx(d2));
+                    }
+                }
+            }
+        }
     }
 }
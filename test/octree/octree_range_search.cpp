@@ -1,5 +1,11 @@
 #include <catch2/catch.hpp>
+#include <pcp/common/plane3d.hpp>
 #include <pcp/octree/linked_octree.hpp>
+#include <cmath>
+#include <execution>
+#include <optional>
+#include <random>
+#include <tuple>
 
 SCENARIO("range searches on the octree", "[octree]")
 {
@@ -116,5 +122,617 @@ SCENARIO("range searches on the octree", "[octree]")
                         }) == 1u);
             }
         }
+        WHEN("searching for points in the queried aabb with a caller-provided buffer")
+        {
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> aabb;
+            aabb.min = {-2.f, -2.f, -2.f};
+            aabb.max = {0.f, 0.f, 0.f};
+
+            std::vector<pcp::point_t> points_in_range;
+            octree.range_search(aabb, point_map, std::back_inserter(points_in_range));
+
+            std::size_t visited_count = 0u;
+            octree.visit_range(aabb, point_map, [&](pcp::point_t const& p) {
+                REQUIRE(aabb.contains(p));
+                ++visited_count;
+            });
+
+            THEN("the points in the range are written to the buffer and visited")
+            {
+                REQUIRE(points_in_range.size() == 2u);
+                REQUIRE(visited_count == 2u);
+            }
+        }
+    }
+    GIVEN("an octree of randomly generated points")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+        std::uniform_real_distribution<float> radius_distribution(.1f, 1.5f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 4'096u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        pcp::octree_parameters_t<pcp::point_t> params;
+        params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+            pcp::point_t{-1.f, -1.f, -1.f},
+            pcp::point_t{1.f, 1.f, 1.f}};
+        params.node_capacity = node_capacity;
+        params.max_depth     = static_cast<std::uint8_t>(max_depth);
+
+        pcp::linked_octree_t octree(points.cbegin(), points.cend(), point_map, params);
+
+        WHEN("searching for points in spheres and boxes enclosing whole octants")
+        {
+            pcp::sphere_t<pcp::point_t> const sphere{
+                pcp::point_t{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)},
+                radius_distribution(gen)};
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const aabb{
+                pcp::point_t{-.9f, -.6f, -.8f},
+                pcp::point_t{.7f, .8f, .3f}};
+
+            auto const points_in_sphere = octree.range_search(sphere, point_map);
+            auto const points_in_aabb   = octree.range_search(aabb, point_map);
+
+            THEN("the points found are exactly the points contained in the range")
+            {
+                auto const count_in = [&points](auto const& range) {
+                    return static_cast<std::size_t>(
+                        std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                            return range.contains(p);
+                        }));
+                };
+                auto const all_in = [](auto const& found, auto const& range) {
+                    return std::all_of(found.cbegin(), found.cend(), [&](pcp::point_t const& p) {
+                        return range.contains(p);
+                    });
+                };
+
+                REQUIRE(points_in_sphere.size() == count_in(sphere));
+                REQUIRE(all_in(points_in_sphere, sphere));
+                REQUIRE(points_in_aabb.size() == count_in(aabb));
+                REQUIRE(all_in(points_in_aabb, aabb));
+            }
+        }
+        WHEN("searching lazily for points in spheres and boxes")
+        {
+            pcp::sphere_t<pcp::point_t> const sphere{
+                pcp::point_t{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)},
+                radius_distribution(gen)};
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const aabb{
+                pcp::point_t{-.9f, -.6f, -.8f},
+                pcp::point_t{.7f, .8f, .3f}};
+            pcp::sphere_t<pcp::point_t> const outside{pcp::point_t{3.f, 3.f, 3.f}, .5f};
+
+            auto const count_in = [&points](auto const& range) {
+                return static_cast<std::size_t>(
+                    std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return range.contains(p);
+                    }));
+            };
+            auto const all_in = [](auto const& found, auto const& range) {
+                return std::all_of(found.cbegin(), found.cend(), [&](pcp::point_t const& p) {
+                    return range.contains(p);
+                });
+            };
+
+            THEN("iterating the whole lazy range finds the points contained in the range")
+            {
+                std::vector<pcp::point_t> points_in_sphere;
+                for (auto const& p : octree.lazy_range_search(sphere, point_map))
+                    points_in_sphere.push_back(p);
+
+                REQUIRE(points_in_sphere.size() == count_in(sphere));
+                REQUIRE(all_in(points_in_sphere, sphere));
+                REQUIRE(octree.lazy_range_search(outside, point_map).empty());
+            }
+            THEN("capped searches and existence tests stop early with the right answer")
+            {
+                std::size_t const n           = 10u;
+                auto const first_in_aabb      = octree.range_search_first(aabb, n, point_map);
+                auto const first_in_sphere    = octree.range_search_first(sphere, n, point_map);
+                auto const expected_in_sphere = std::min(n, count_in(sphere));
+
+                REQUIRE(first_in_aabb.size() == n);
+                REQUIRE(all_in(first_in_aabb, aabb));
+                REQUIRE(first_in_sphere.size() == expected_in_sphere);
+                REQUIRE(all_in(first_in_sphere, sphere));
+                REQUIRE(octree.range_search_first(aabb, 0u, point_map).empty());
+
+                REQUIRE(octree.any_in_range(aabb, point_map));
+                REQUIRE(octree.any_in_range(sphere, point_map) == (count_in(sphere) > 0u));
+                REQUIRE_FALSE(octree.any_in_range(outside, point_map));
+            }
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE(
+    "count and aggregate range queries on the octree",
+    "[octree]",
+    pcp::octree_parameters_t<pcp::point_t>,
+    pcp::aggregate_octree_parameters_t<pcp::point_t>)
+{
+    using octree_type = pcp::basic_linked_octree_t<pcp::point_t, TestType>;
+
+    auto node_capacity = GENERATE(1u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+    std::uniform_real_distribution<float> radius_distribution(.1f, 1.5f);
+
+    std::vector<pcp::point_t> points;
+    std::size_t const size = 4'096u;
+    points.reserve(size);
+    for (std::size_t i = 0u; i < size; ++i)
+        points.push_back(pcp::point_t{
+            coordinate_distribution(gen),
+            coordinate_distribution(gen),
+            coordinate_distribution(gen)});
+
+    TestType params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+
+    pcp::sphere_t<pcp::point_t> const sphere{
+        pcp::point_t{
+            coordinate_distribution(gen),
+            coordinate_distribution(gen),
+            coordinate_distribution(gen)},
+        radius_distribution(gen)};
+    pcp::axis_aligned_bounding_box_t<pcp::point_t> const aabb{
+        pcp::point_t{-.9f, -.6f, -.8f},
+        pcp::point_t{.7f, .8f, .3f}};
+
+    auto const require_matches_brute_force = [&](octree_type const& octree,
+                                                 std::vector<pcp::point_t> const& remaining,
+                                                 auto const& range) {
+        std::size_t expected_count = 0u;
+        pcp::basic_point_t<double> expected_sum{0., 0., 0.};
+        for (auto const& p : remaining)
+        {
+            if (!range.contains(p))
+                continue;
+
+            ++expected_count;
+            expected_sum = expected_sum + pcp::basic_point_t<double>{p};
+        }
+
+        auto const aggregate = octree.range_aggregate(range, point_map);
+        REQUIRE(octree.range_count(range, point_map) == expected_count);
+        REQUIRE(aggregate.count == expected_count);
+        REQUIRE(aggregate.coordinate_sum.x() == Approx(expected_sum.x()).margin(1e-3));
+        REQUIRE(aggregate.coordinate_sum.y() == Approx(expected_sum.y()).margin(1e-3));
+        REQUIRE(aggregate.coordinate_sum.z() == Approx(expected_sum.z()).margin(1e-3));
+    };
+
+    GIVEN("an octree of randomly generated points")
+    {
+        octree_type octree(points.cbegin(), points.cend(), point_map, params);
+
+        WHEN("counting and aggregating the points in spheres and boxes")
+        {
+            THEN("the count and the coordinate sum match those of the points in the range")
+            {
+                require_matches_brute_force(octree, points, sphere);
+                require_matches_brute_force(octree, points, aabb);
+                REQUIRE(octree.range_count(params.voxel_grid, point_map) == points.size());
+            }
+        }
+        WHEN("erasing points before counting and aggregating")
+        {
+            std::vector<pcp::point_t> remaining;
+            remaining.reserve(size);
+            for (std::size_t i = 0u; i < size; ++i)
+            {
+                if (i % 3u == 0u)
+                    octree.erase(octree.find(points[i], point_map));
+                else
+                    remaining.push_back(points[i]);
+            }
+
+            THEN("the erased points are not counted nor aggregated")
+            {
+                REQUIRE(octree.size() == remaining.size());
+                require_matches_brute_force(octree, remaining, sphere);
+                require_matches_brute_force(octree, remaining, aabb);
+                REQUIRE(octree.range_count(params.voxel_grid, point_map) == remaining.size());
+            }
+        }
+    }
+    GIVEN("an octree of randomly generated points constructed in parallel")
+    {
+        octree_type
+            octree(std::execution::par, points.cbegin(), points.cend(), point_map, params);
+
+        THEN("the count and the coordinate sum match those of the points in the range")
+        {
+            require_matches_brute_force(octree, points, sphere);
+            require_matches_brute_force(octree, points, aabb);
+        }
+    }
+}
+
+SCENARIO("aggregate range queries over many points on the octree", "[octree]")
+{
+    using params_type = pcp::aggregate_octree_parameters_t<pcp::point_t>;
+    using octree_type = pcp::basic_linked_octree_t<pcp::point_t, params_type>;
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    params_type params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{0.f, 0.f, 0.f},
+        pcp::point_t{2.f, 2.f, 2.f}};
+    params.node_capacity = 32u;
+    params.max_depth     = 21u;
+
+    GIVEN("an octree of a million points away from the origin")
+    {
+        std::mt19937 gen(0u);
+        std::uniform_real_distribution<float> coordinate_distribution(1.f, 2.f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 1u << 20u;
+        points.reserve(size);
+        pcp::basic_point_t<double> sum{0., 0., 0.};
+        for (std::size_t i = 0u; i < size; ++i)
+        {
+            pcp::point_t const p{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+            points.push_back(p);
+            sum = sum + pcp::basic_point_t<double>{p};
+        }
+        auto const mean = sum / static_cast<double>(size);
+
+        octree_type octree(points.cbegin(), points.cend(), point_map, params);
+
+        WHEN("aggregating all the points")
+        {
+            auto const aggregate = octree.range_aggregate(params.voxel_grid, point_map);
+
+            THEN("the centroid matches the mean of the points")
+            {
+                auto const centroid = aggregate.centroid();
+                REQUIRE(aggregate.count == size);
+                REQUIRE(static_cast<double>(centroid.x()) == Approx(mean.x()).epsilon(1e-6));
+                REQUIRE(static_cast<double>(centroid.y()) == Approx(mean.y()).epsilon(1e-6));
+                REQUIRE(static_cast<double>(centroid.z()) == Approx(mean.z()).epsilon(1e-6));
+            }
+        }
+    }
+}
+
+SCENARIO("ray casting and frustum culling on the octree", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+
+    std::size_t const size = 2'000u;
+    std::vector<pcp::point_t> points;
+    points.reserve(size);
+    for (std::size_t i = 0u; i < size; ++i)
+        points.push_back(pcp::point_t{
+            coordinate_distribution(gen),
+            coordinate_distribution(gen),
+            coordinate_distribution(gen)});
+
+    auto const require_same_ray_casts = [&](auto const& octree) {
+        float const radius = .05f;
+        for (std::size_t i = 0u; i < 32u; ++i)
+        {
+            pcp::point_t const origin{
+                1.5f * coordinate_distribution(gen),
+                1.5f * coordinate_distribution(gen),
+                1.5f * coordinate_distribution(gen)};
+            pcp::point_t const to = i % 2u == 0u ? points[i] :
+                                                   pcp::point_t{
+                                                       coordinate_distribution(gen),
+                                                       coordinate_distribution(gen),
+                                                       coordinate_distribution(gen)};
+            pcp::common::basic_vector3d_t<float> const direction = to - origin;
+            auto const unit_direction = direction / pcp::common::norm(direction);
+
+            /*
+             * Points at the radius from the ray may be picked by either
+             * search, so we compare the picked points' distances along the
+             * ray and find the nearest points within a slightly smaller and
+             * a slightly greater radius by brute force.
+             */
+            auto const nearest_hit = [&](float r) {
+                std::optional<float> hit_t;
+                for (auto const& p : points)
+                {
+                    pcp::common::basic_vector3d_t<float> const v = p - origin;
+                    float const t = pcp::common::inner_product(v, unit_direction);
+                    if (t >= 0.f && pcp::common::inner_product(v, v) - t * t <= r * r)
+                        hit_t = hit_t.has_value() ? std::min(*hit_t, t) : t;
+                }
+                return hit_t;
+            };
+            auto const inner_hit_t = nearest_hit(radius - 1e-3f);
+            auto const outer_hit_t = nearest_hit(radius + 1e-3f);
+
+            auto const hit = octree.ray_cast(origin, direction, radius, point_map);
+            if (i % 2u == 0u)
+                REQUIRE(hit.has_value());
+            if (!hit.has_value())
+            {
+                REQUIRE(!inner_hit_t.has_value());
+                continue;
+            }
+
+            pcp::common::basic_vector3d_t<float> const v = *hit - origin;
+            float const t = pcp::common::inner_product(v, unit_direction);
+            REQUIRE(t >= 0.f);
+            REQUIRE(pcp::common::inner_product(v, v) - t * t <= radius * radius + 1e-4f);
+            REQUIRE(outer_hit_t.has_value());
+            REQUIRE(t >= *outer_hit_t - 1e-4f);
+            if (inner_hit_t.has_value())
+                REQUIRE(t <= *inner_hit_t + 1e-4f);
+        }
+
+        pcp::point_t const outside_origin{2.f, 2.f, 2.f};
+        pcp::point_t const outside_direction{1.f, 0.f, 0.f};
+        auto const miss = octree.ray_cast(outside_origin, outside_direction, .1f, point_map);
+        REQUIRE_FALSE(miss.has_value());
+    };
+
+    /*
+     * A view frustum looking down the z axis, whose first plane is its near plane
+     */
+    float const inverse_sqrt2 = 1.f / std::sqrt(2.f);
+    std::vector<pcp::common::plane3d_t> const frustum{
+        {pcp::point_t{0.f, 0.f, -.8f}, pcp::normal_t{0.f, 0.f, 1.f}},
+        {pcp::point_t{0.f, 0.f, .9f}, pcp::normal_t{0.f, 0.f, -1.f}},
+        {pcp::point_t{0.f, 0.f, -1.5f}, pcp::normal_t{inverse_sqrt2, 0.f, inverse_sqrt2}},
+        {pcp::point_t{0.f, 0.f, -1.5f}, pcp::normal_t{-inverse_sqrt2, 0.f, inverse_sqrt2}},
+        {pcp::point_t{0.f, 0.f, -1.5f}, pcp::normal_t{0.f, inverse_sqrt2, inverse_sqrt2}},
+        {pcp::point_t{0.f, 0.f, -1.5f}, pcp::normal_t{0.f, -inverse_sqrt2, inverse_sqrt2}}};
+
+    auto const require_same_frustum_search = [&](auto const& octree) {
+        std::vector<pcp::point_t> expected;
+        std::copy_if(
+            points.cbegin(),
+            points.cend(),
+            std::back_inserter(expected),
+            [&](pcp::point_t const& p) {
+                return std::all_of(frustum.cbegin(), frustum.cend(), [&](auto const& plane) {
+                    return plane.signed_distance_to(p) >= 0.f;
+                });
+            });
+
+        auto found = octree.frustum_search(frustum, point_map);
+        REQUIRE(!expected.empty());
+        REQUIRE(found.size() == expected.size());
+
+        auto const less = [](pcp::point_t const& p1, pcp::point_t const& p2) {
+            return std::tie(p1.x(), p1.y(), p1.z()) < std::tie(p2.x(), p2.y(), p2.z());
+        };
+        std::sort(expected.begin(), expected.end(), less);
+        std::sort(found.begin(), found.end(), less);
+        REQUIRE(std::equal(
+            found.cbegin(),
+            found.cend(),
+            expected.cbegin(),
+            [](pcp::point_t const& p1, pcp::point_t const& p2) {
+                return pcp::common::are_vectors_equal(p1, p2);
+            }));
+
+        std::array<pcp::common::plane3d_t, 1> const half_space{frustum.front()};
+        std::size_t count = 0u;
+        octree.visit_frustum(half_space, point_map, [&count](pcp::point_t const&) { ++count; });
+        REQUIRE(count == static_cast<std::size_t>(
+                             std::count_if(points.cbegin(), points.cend(), [&](auto const& p) {
+                                 return frustum.front().signed_distance_to(p) >= 0.f;
+                             })));
+    };
+
+    GIVEN("an octree of randomly generated points")
+    {
+        pcp::octree_parameters_t<pcp::point_t> params;
+        params.node_capacity = node_capacity;
+        params.max_depth     = static_cast<std::uint8_t>(max_depth);
+        params.voxel_grid    = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+            pcp::point_t{-1.f, -1.f, -1.f},
+            pcp::point_t{1.f, 1.f, 1.f}};
+
+        pcp::linked_octree_t octree(points.cbegin(), points.cend(), point_map, params);
+
+        WHEN("casting rays through the octree")
+        {
+            THEN("the nearest point along the ray within the radius is picked")
+            {
+                require_same_ray_casts(octree);
+            }
+        }
+        WHEN("searching for points in a view frustum")
+        {
+            THEN("the points found are exactly the points inside the frustum")
+            {
+                require_same_frustum_search(octree);
+            }
+        }
+    }
+    GIVEN("a lazily subdivided octree of randomly generated points")
+    {
+        using lazy_params_type = pcp::lazy_octree_parameters_t<pcp::point_t>;
+        lazy_params_type params;
+        params.node_capacity = node_capacity;
+        params.max_depth     = static_cast<std::uint8_t>(max_depth);
+        params.voxel_grid    = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+            pcp::point_t{-1.f, -1.f, -1.f},
+            pcp::point_t{1.f, 1.f, 1.f}};
+
+        pcp::basic_linked_octree_t<pcp::point_t, lazy_params_type>
+            octree(points.cbegin(), points.cend(), point_map, params);
+
+        THEN("ray casts and frustum searches match those of the points")
+        {
+            require_same_ray_casts(octree);
+            require_same_frustum_search(octree);
+        }
+    }
+}
+
+SCENARIO("level-of-detail queries on the octree", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    using params_type = pcp::lod_octree_parameters_t<pcp::point_t>;
+    params_type params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid    = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+
+    std::size_t const size = 5'000u;
+    std::vector<pcp::point_t> points;
+    points.reserve(size);
+    for (std::size_t i = 0u; i < size; ++i)
+        points.push_back(pcp::point_t{
+            coordinate_distribution(gen),
+            coordinate_distribution(gen),
+            coordinate_distribution(gen)});
+
+    auto const less = [](pcp::point_t const& p1, pcp::point_t const& p2) {
+        return std::tie(p1.x(), p1.y(), p1.z()) < std::tie(p2.x(), p2.y(), p2.z());
+    };
+    auto sorted_points = points;
+    std::sort(sorted_points.begin(), sorted_points.end(), less);
+
+    auto const require_distinct_points_of_the_octree = [&](std::vector<pcp::point_t> found) {
+        std::sort(found.begin(), found.end(), less);
+        auto const is_duplicate = [&](pcp::point_t const& p1, pcp::point_t const& p2) {
+            return !less(p1, p2);
+        };
+        REQUIRE(std::adjacent_find(found.cbegin(), found.cend(), is_duplicate) == found.cend());
+        REQUIRE(std::includes(
+            sorted_points.cbegin(),
+            sorted_points.cend(),
+            found.cbegin(),
+            found.cend(),
+            less));
+    };
+
+    GIVEN("an octree of randomly generated points with level-of-detail representatives")
+    {
+        pcp::basic_linked_octree_t<pcp::point_t, params_type>
+            octree(points.cbegin(), points.cend(), point_map, params);
+        octree.build_representatives(point_map);
+
+        auto const representatives_per_node = params_type::representatives_per_node;
+
+        WHEN("getting the points at increasing depths")
+        {
+            THEN("the points are distinct points of the octree, bounded by the depth")
+            {
+                std::size_t max_size = representatives_per_node;
+                for (std::size_t depth = 0u; depth < 4u; ++depth)
+                {
+                    auto const representatives = octree.points_at_depth(depth);
+                    REQUIRE(!representatives.empty());
+                    REQUIRE(representatives.size() <= max_size);
+                    require_distinct_points_of_the_octree(representatives);
+                    max_size *= 8u;
+                }
+            }
+            THEN("the root's representatives are spread over its octants")
+            {
+                auto const representatives = octree.points_at_depth(0u);
+                REQUIRE(representatives.size() == representatives_per_node);
+
+                if (max_depth > 1u)
+                {
+                    std::array<bool, 8u> is_octant_represented{};
+                    for (auto const& p : representatives)
+                    {
+                        std::size_t const octant = (p.x() > 0.f ? 4u : 0u) +
+                                                   (p.y() > 0.f ? 2u : 0u) +
+                                                   (p.z() > 0.f ? 1u : 0u);
+                        is_octant_represented[octant] = true;
+                    }
+                    REQUIRE(std::all_of(
+                        is_octant_represented.cbegin(),
+                        is_octant_represented.cend(),
+                        [](bool is_represented) { return is_represented; }));
+                }
+            }
+        }
+        WHEN("querying bounded numbers of points in ranges")
+        {
+            pcp::sphere_t<pcp::point_t> const sphere{pcp::point_t{.1f, -.1f, .2f}, .6f};
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const outside{
+                pcp::point_t{2.f, 2.f, 2.f},
+                pcp::point_t{3.f, 3.f, 3.f}};
+
+            THEN("at most the requested number of points in the range are returned")
+            {
+                for (std::size_t max_points : {1u, 8u, 64u, 512u, 10'000u})
+                {
+                    auto const found = octree.lod_query(sphere, max_points, point_map);
+                    REQUIRE(!found.empty());
+                    REQUIRE(found.size() <= max_points);
+                    REQUIRE(std::all_of(found.cbegin(), found.cend(), [&](auto const& p) {
+                        return sphere.contains(p);
+                    }));
+                    require_distinct_points_of_the_octree(found);
+                }
+
+                REQUIRE(octree.lod_query(outside, 64u, point_map).empty());
+            }
+            THEN("all the points in the range are returned when they fit")
+            {
+                auto const expected = static_cast<std::size_t>(
+                    std::count_if(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return sphere.contains(p);
+                    }));
+                REQUIRE(octree.lod_query(sphere, size, point_map).size() == expected);
+            }
+        }
     }
 }
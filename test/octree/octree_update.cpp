@@ -0,0 +1,348 @@
+#include <catch2/catch.hpp>
+#include <pcp/common/points/point_view.hpp>
+#include <pcp/octree/linked_octree.hpp>
+#include <random>
+
+SCENARIO("octree point position updates", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    using params_type = pcp::aggregate_octree_parameters_t<pcp::point_t>;
+    using octree_type = pcp::basic_linked_octree_t<pcp::point_t, params_type>;
+
+    params_type params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid =
+        pcp::axis_aligned_bounding_box_t<pcp::point_t>{{-1.f, -1.f, -1.f}, {1.f, 1.f, 1.f}};
+
+    GIVEN("an octree of randomly generated points")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+        std::uniform_real_distribution<float> displacement_distribution(-.05f, .05f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 2'000u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        octree_type octree(points.cbegin(), points.cend(), point_map, params);
+
+        auto const require_same_points = [&](std::vector<pcp::point_t> const& expected) {
+            REQUIRE(octree.size() == expected.size());
+            REQUIRE(
+                static_cast<std::size_t>(std::distance(octree.cbegin(), octree.cend())) ==
+                expected.size());
+            bool const are_all_found =
+                std::all_of(expected.cbegin(), expected.cend(), [&](pcp::point_t const& p) {
+                    return octree.find(p, point_map) != octree.cend();
+                });
+            REQUIRE(are_all_found);
+
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const range{
+                pcp::point_t{-.5f, -.7f, -.1f},
+                pcp::point_t{.6f, .2f, .9f}};
+
+            std::size_t count = 0u;
+            pcp::point_t coordinate_sum{0.f, 0.f, 0.f};
+            for (auto const& p : expected)
+            {
+                if (!range.contains(p))
+                    continue;
+
+                ++count;
+                coordinate_sum = coordinate_sum + p;
+            }
+
+            REQUIRE(octree.range_count(range, point_map) == count);
+            auto const aggregate = octree.range_aggregate(range, point_map);
+            REQUIRE(aggregate.count == count);
+            REQUIRE(aggregate.coordinate_sum.x() == Approx(coordinate_sum.x()).margin(5e-2));
+            REQUIRE(aggregate.coordinate_sum.y() == Approx(coordinate_sum.y()).margin(5e-2));
+            REQUIRE(aggregate.coordinate_sum.z() == Approx(coordinate_sum.z()).margin(5e-2));
+        };
+
+        WHEN("moving points by small displacements")
+        {
+            auto moved_points = points;
+            for (std::size_t i = 0u; i < size; ++i)
+            {
+                auto& p = moved_points[i];
+                p.x(std::clamp(p.x() + displacement_distribution(gen), -1.f, 1.f));
+                p.y(std::clamp(p.y() + displacement_distribution(gen), -1.f, 1.f));
+                p.z(std::clamp(p.z() + displacement_distribution(gen), -1.f, 1.f));
+                REQUIRE(octree.update(p, points[i], point_map));
+            }
+
+            THEN("the octree holds the points at their new positions")
+            {
+                require_same_points(moved_points);
+            }
+        }
+        WHEN("moving points anywhere in the voxel grid")
+        {
+            std::vector<pcp::point_t> moved_points;
+            for (std::size_t i = 0u; i < size; i += 2u)
+            {
+                pcp::point_t const p{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)};
+                REQUIRE(octree.update(p, points[i], point_map));
+                moved_points.push_back(p);
+                moved_points.push_back(points[i + 1u]);
+            }
+
+            THEN("the octree holds the points at their new positions")
+            {
+                require_same_points(moved_points);
+            }
+        }
+        WHEN("moving points out of the voxel grid")
+        {
+            std::vector<pcp::point_t> remaining_points;
+            for (std::size_t i = 0u; i < size; ++i)
+            {
+                if (i % 3u == 0u)
+                    REQUIRE(octree.update(pcp::point_t{2.f, 0.f, 0.f}, points[i], point_map));
+                else
+                    remaining_points.push_back(points[i]);
+            }
+
+            THEN("the points are removed from the octree")
+            {
+                require_same_points(remaining_points);
+            }
+        }
+        WHEN("updating a point that is not in the octree")
+        {
+            bool const is_found = octree.update(
+                pcp::point_t{0.f, 0.f, 0.f},
+                pcp::point_t{2.f, 0.f, 0.f},
+                point_map);
+
+            THEN("nothing changes")
+            {
+                REQUIRE_FALSE(is_found);
+                require_same_points(points);
+            }
+        }
+    }
+    GIVEN("an octree with a point higher up the path at another point's new position")
+    {
+        pcp::point_t const b{.5f, .5f, .5f};
+        pcp::point_t const a{-.5f, -.5f, -.5f};
+
+        // b is inserted first, so that it stays in the root's bucket
+        octree_type octree(params);
+        octree.insert(b, point_map);
+        octree.insert(a, point_map);
+
+        WHEN("moving the other point onto it")
+        {
+            bool const is_found = octree.update(b, a, point_map);
+
+            THEN("the moved point leaves its old position")
+            {
+                REQUIRE(is_found);
+                REQUIRE(octree.size() == 2u);
+                REQUIRE(octree.find(a, point_map) == octree.cend());
+                REQUIRE(
+                    std::count_if(octree.cbegin(), octree.cend(), [&](pcp::point_t const& p) {
+                        return pcp::common::are_vectors_equal(p, b);
+                    }) == 2);
+
+                auto const aggregate = octree.range_aggregate(params.voxel_grid, point_map);
+                REQUIRE(aggregate.count == 2u);
+                REQUIRE(aggregate.coordinate_sum.x() == Approx(2.f * b.x()));
+                REQUIRE(aggregate.coordinate_sum.y() == Approx(2.f * b.y()));
+                REQUIRE(aggregate.coordinate_sum.z() == Approx(2.f * b.z()));
+            }
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE(
+    "octree refit after points moved",
+    "[octree]",
+    pcp::aggregate_octree_parameters_t<pcp::point_t>,
+    pcp::lazy_octree_parameters_t<pcp::point_t>)
+{
+    using octree_type = pcp::basic_linked_octree_t<pcp::point_view_t, TestType>;
+
+    auto node_capacity = GENERATE(1u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_view_t const& p) {
+        return p;
+    };
+
+    TestType params;
+    params.voxel_grid = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+
+    GIVEN("an octree of views to randomly generated points")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+        std::uniform_real_distribution<float> displacement_distribution(-.2f, .2f);
+
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 2'000u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        std::vector<pcp::point_view_t> views;
+        views.reserve(size);
+        for (auto& p : points)
+            views.push_back(pcp::point_view_t{&p});
+
+        octree_type octree(views.cbegin(), views.cend(), point_map, params);
+
+        auto const require_same_points = [&]() {
+            std::vector<pcp::point_t> expected;
+            std::copy_if(
+                points.cbegin(),
+                points.cend(),
+                std::back_inserter(expected),
+                [&](pcp::point_t const& p) { return params.voxel_grid.contains(p); });
+
+            REQUIRE(octree.size() == expected.size());
+            REQUIRE(
+                static_cast<std::size_t>(std::distance(octree.cbegin(), octree.cend())) ==
+                expected.size());
+
+            pcp::sphere_t<pcp::point_t> const sphere{pcp::point_t{.2f, -.1f, .3f}, .5f};
+            auto const expected_in_sphere = static_cast<std::size_t>(
+                std::count_if(expected.cbegin(), expected.cend(), [&](pcp::point_t const& p) {
+                    return sphere.contains(p);
+                }));
+            REQUIRE(octree.range_search(sphere, point_map).size() == expected_in_sphere);
+            REQUIRE(octree.range_count(sphere, point_map) == expected_in_sphere);
+
+            pcp::point_t const target{0.f, 0.f, 0.f};
+            std::size_t const k = 8u;
+            auto const neighbours = octree.nearest_neighbours(target, k, point_map);
+            std::partial_sort(
+                expected.begin(),
+                expected.begin() + static_cast<std::ptrdiff_t>(k),
+                expected.end(),
+                [&](pcp::point_t const& p1, pcp::point_t const& p2) {
+                    return pcp::common::squared_distance(p1, target) <
+                           pcp::common::squared_distance(p2, target);
+                });
+            REQUIRE(neighbours.size() == k);
+            for (std::size_t i = 0u; i < k; ++i)
+            {
+                auto const d1 = pcp::common::squared_distance(neighbours[i], target);
+                auto const d2 = pcp::common::squared_distance(expected[i], target);
+                REQUIRE(d1 == Approx(d2));
+            }
+        };
+
+        WHEN("moving the points and refitting the octree")
+        {
+            for (auto& p : points)
+            {
+                p.x(p.x() + displacement_distribution(gen));
+                p.y(p.y() + displacement_distribution(gen));
+                p.z(p.z() + displacement_distribution(gen));
+            }
+
+            auto const num_moved = octree.refit(point_map);
+
+            THEN("the octree holds the points in the voxel grid at their new positions")
+            {
+                REQUIRE(num_moved <= size);
+                require_same_points();
+            }
+            THEN("refitting again moves nothing")
+            {
+                REQUIRE(octree.refit(point_map) == 0u);
+                require_same_points();
+            }
+        }
+        WHEN("moving one point at a time")
+        {
+            for (std::size_t i = 0u; i < size; i += 3u)
+            {
+                auto const old_position = points[i];
+                points[i] = pcp::point_t{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)};
+                REQUIRE(octree.update(views[i], old_position, point_map));
+            }
+
+            THEN("the octree holds the points at their new positions")
+            {
+                require_same_points();
+            }
+        }
+    }
+    GIVEN("an octree of views to points at coinciding positions")
+    {
+        std::vector<pcp::point_t> points;
+        std::size_t const size = 64u;
+        points.reserve(size);
+        for (std::size_t i = 0u; i < size; ++i)
+        {
+            // groups of 4 points share a position
+            auto const group = static_cast<float>(i / 4u);
+            points.push_back(pcp::point_t{-.9f + .1f * group, .05f * group, .5f - .05f * group});
+        }
+
+        std::vector<pcp::point_view_t> views;
+        views.reserve(size);
+        for (auto& p : points)
+            views.push_back(pcp::point_view_t{&p});
+
+        octree_type octree(views.cbegin(), views.cend(), point_map, params);
+
+        WHEN("moving points which share their old position with other points")
+        {
+            for (std::size_t i = 1u; i < size; i += 2u)
+            {
+                auto const old_position = points[i];
+                points[i] = pcp::point_t{-old_position.x(), old_position.y(), old_position.z()};
+                REQUIRE(octree.update(views[i], old_position, point_map));
+            }
+
+            THEN("the octree holds every view once")
+            {
+                std::vector<pcp::point_t const*> viewed_points;
+                for (auto const& view : octree)
+                    viewed_points.push_back(view.point());
+                std::sort(viewed_points.begin(), viewed_points.end());
+
+                std::vector<pcp::point_t const*> expected;
+                for (auto const& view : views)
+                    expected.push_back(view.point());
+                std::sort(expected.begin(), expected.end());
+
+                REQUIRE(octree.size() == size);
+                REQUIRE(viewed_points == expected);
+                REQUIRE(octree.range_count(params.voxel_grid, point_map) == size);
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+#include <catch2/catch.hpp>
+#include <pcp/octree/out_of_core_octree.hpp>
+#include <random>
+
+SCENARIO("out-of-core octree with a bounded page cache", "[octree]")
+{
+    auto node_capacity    = GENERATE(1u, 4u, 32u);
+    auto max_depth        = GENERATE(1u, 3u, 21u);
+    auto max_cached_pages = GENERATE(1u, 8u, 1'024u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    pcp::out_of_core_octree_parameters_t<pcp::point_t> params;
+    params.node_capacity    = node_capacity;
+    params.max_depth        = static_cast<std::uint8_t>(max_depth);
+    params.max_cached_pages = max_cached_pages;
+    params.voxel_grid       = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+
+    std::size_t const size = 1'000u;
+    std::vector<pcp::point_t> points;
+    points.reserve(size);
+    for (std::size_t i = 0u; i < size; ++i)
+        points.push_back(pcp::point_t{
+            coordinate_distribution(gen),
+            coordinate_distribution(gen),
+            coordinate_distribution(gen)});
+
+    std::vector<pcp::point_t> outside{pcp::point_t{2.f, 0.f, 0.f}, pcp::point_t{0.f, -3.f, 0.f}};
+
+    GIVEN("an out-of-core octree of randomly generated points")
+    {
+        pcp::out_of_core_octree_t octree(points.cbegin(), points.cend(), point_map, params);
+        REQUIRE(octree.is_open());
+        REQUIRE(octree.insert(outside.cbegin(), outside.cend(), point_map) == 0u);
+        REQUIRE(octree.size() == size);
+        REQUIRE(octree.cached_page_count() <= max_cached_pages);
+
+        WHEN("searching for points in spheres and boxes")
+        {
+            pcp::sphere_t<pcp::point_t> const sphere{pcp::point_t{.1f, -.1f, .2f}, .4f};
+            pcp::axis_aligned_bounding_box_t<pcp::point_t> const aabb{
+                pcp::point_t{-.9f, -.6f, -.8f},
+                pcp::point_t{.7f, .8f, .3f}};
+
+            THEN("the points found are the points in the range and few pages are cached")
+            {
+                auto const require_same_points_in_range = [&](auto const& range) {
+                    auto const expected = static_cast<std::size_t>(
+                        std::count_if(points.cbegin(), points.cend(), [&](auto const& p) {
+                            return range.contains(p);
+                        }));
+
+                    auto const found = octree.range_search(range, point_map);
+                    REQUIRE(found.size() == expected);
+                    REQUIRE(std::all_of(found.cbegin(), found.cend(), [&](auto const& p) {
+                        return range.contains(p);
+                    }));
+                    REQUIRE(octree.range_count(range, point_map) == expected);
+                    REQUIRE(octree.cached_page_count() <= max_cached_pages);
+                };
+
+                require_same_points_in_range(sphere);
+                require_same_points_in_range(aabb);
+                REQUIRE(octree.range_count(params.voxel_grid, point_map) == size);
+
+                auto const page_faults = octree.page_faults();
+                std::size_t count      = 0u;
+                octree.for_each([&count](pcp::point_t const&) { ++count; });
+                REQUIRE(count == size);
+                if (octree.page_count() > max_cached_pages)
+                    REQUIRE(octree.page_faults() > page_faults);
+            }
+        }
+        WHEN("searching for the nearest neighbours of points")
+        {
+            THEN("the nearest neighbours are the same as those found by brute force")
+            {
+                std::size_t const k = 8u;
+                for (std::size_t i = 0u; i < 16u; ++i)
+                {
+                    pcp::point_t const target{
+                        coordinate_distribution(gen),
+                        coordinate_distribution(gen),
+                        coordinate_distribution(gen)};
+
+                    auto sorted_points = points;
+                    std::partial_sort(
+                        sorted_points.begin(),
+                        sorted_points.begin() + static_cast<std::ptrdiff_t>(k),
+                        sorted_points.end(),
+                        [&](pcp::point_t const& p1, pcp::point_t const& p2) {
+                            return pcp::common::squared_distance(p1, target) <
+                                   pcp::common::squared_distance(p2, target);
+                        });
+
+                    auto const neighbours = octree.nearest_neighbours(target, k, point_map);
+                    REQUIRE(neighbours.size() == k);
+                    for (std::size_t j = 0u; j < k; ++j)
+                    {
+                        auto const d1 = pcp::common::squared_distance(neighbours[j], target);
+                        auto const d2 = pcp::common::squared_distance(sorted_points[j], target);
+                        REQUIRE(d1 == Approx(d2));
+                    }
+                }
+                REQUIRE(octree.cached_page_count() <= max_cached_pages);
+            }
+        }
+        WHEN("flushing and clearing the octree")
+        {
+            octree.flush();
+            REQUIRE(octree.size() == size);
+            REQUIRE(octree.range_search(params.voxel_grid, point_map).size() == size);
+
+            octree.clear();
+
+            THEN("the octree is empty and can be reused")
+            {
+                REQUIRE(octree.empty());
+                REQUIRE(octree.page_count() == 0u);
+                REQUIRE(octree.nearest_neighbours(pcp::point_t{}, 4u, point_map).empty());
+
+                octree.insert(points.cbegin(), points.cend(), point_map);
+                REQUIRE(octree.size() == size);
+                REQUIRE(octree.range_count(params.voxel_grid, point_map) == size);
+            }
+        }
+    }
+    GIVEN("a page file which cannot be created")
+    {
+        params.page_file = std::filesystem::temp_directory_path() / "pcp-missing-directory" /
+                           "out_of_core_octree.pages";
+
+        THEN("constructing the octree throws")
+        {
+            REQUIRE_THROWS_AS(pcp::out_of_core_octree_t(params), std::ios_base::failure);
+        }
+    }
+}
@@ -0,0 +1,239 @@
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <pcp/octree/linked_octree.hpp>
+#include <pcp/octree/persistent_octree.hpp>
+#include <random>
+#include <thread>
+
+SCENARIO("persistent octree snapshots", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid    = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+
+    GIVEN("a persistent octree of randomly generated points")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+
+        auto const make_points = [&](std::size_t size) {
+            std::vector<pcp::point_t> points;
+            points.reserve(size);
+            for (std::size_t i = 0u; i < size; ++i)
+                points.push_back(pcp::point_t{
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen),
+                    coordinate_distribution(gen)});
+            return points;
+        };
+
+        std::size_t const size = 2'048u;
+        auto const points      = make_points(size);
+
+        pcp::persistent_octree_t octree(points.cbegin(), points.cend(), point_map, params);
+        pcp::linked_octree_t linked_octree(points.cbegin(), points.cend(), point_map, params);
+
+        pcp::sphere_t<pcp::point_t> const sphere{pcp::point_t{.2f, -.1f, .3f}, .5f};
+        pcp::axis_aligned_bounding_box_t<pcp::point_t> const aabb{
+            pcp::point_t{-.3f, -.2f, -.5f},
+            pcp::point_t{.4f, .1f, .3f}};
+
+        auto const require_same_queries = [&](auto const& snapshot, auto const& expected) {
+            REQUIRE(snapshot.size() == expected.size());
+            REQUIRE(
+                snapshot.range_count(sphere, point_map) == expected.range_count(sphere, point_map));
+            REQUIRE(
+                snapshot.range_search(aabb, point_map).size() ==
+                expected.range_search(aabb, point_map).size());
+
+            pcp::point_t const target{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)};
+            auto const neighbours          = snapshot.nearest_neighbours(target, 8u, point_map);
+            auto const expected_neighbours = expected.nearest_neighbours(target, 8u, point_map);
+            REQUIRE(neighbours.size() == expected_neighbours.size());
+            for (std::size_t i = 0u; i < neighbours.size(); ++i)
+            {
+                auto const d1 = pcp::common::squared_distance(neighbours[i], target);
+                auto const d2 = pcp::common::squared_distance(expected_neighbours[i], target);
+                REQUIRE(d1 == Approx(d2));
+            }
+        };
+
+        WHEN("taking a snapshot")
+        {
+            auto const snapshot = octree.snapshot();
+
+            THEN("the snapshot answers the same queries as a linked octree")
+            {
+                REQUIRE(snapshot.version() == 0u);
+                REQUIRE(octree.version() == 1u);
+                bool const are_all_found =
+                    std::all_of(points.cbegin(), points.cend(), [&](pcp::point_t const& p) {
+                        return snapshot.contains(p, point_map);
+                    });
+                REQUIRE(are_all_found);
+                REQUIRE_FALSE(snapshot.contains(pcp::point_t{2.f, 0.f, 0.f}, point_map));
+                require_same_queries(snapshot, linked_octree);
+
+                std::size_t count = 0u;
+                snapshot.for_each([&count](pcp::point_t const&) { ++count; });
+                REQUIRE(count == size);
+            }
+        }
+        WHEN("modifying the octree after taking a snapshot")
+        {
+            auto const old_snapshot = octree.snapshot();
+            pcp::linked_octree_t old_linked_octree(
+                points.cbegin(),
+                points.cend(),
+                point_map,
+                params);
+
+            auto const new_points = make_points(size / 2u);
+            octree.insert(new_points.cbegin(), new_points.cend(), point_map);
+            linked_octree.insert(new_points.cbegin(), new_points.cend(), point_map);
+
+            std::size_t const num_erased = size / 4u;
+            for (std::size_t i = 0u; i < num_erased; ++i)
+            {
+                REQUIRE(octree.erase(points[i], point_map));
+                linked_octree.erase(linked_octree.find(points[i], point_map));
+            }
+
+            THEN("snapshots only see the published modifications")
+            {
+                REQUIRE(octree.size() == linked_octree.size());
+                REQUIRE(octree.snapshot().version() == old_snapshot.version());
+                require_same_queries(octree.snapshot(), old_linked_octree);
+
+                octree.publish();
+                auto const new_snapshot = octree.snapshot();
+                REQUIRE(new_snapshot.version() == old_snapshot.version() + 1u);
+                require_same_queries(new_snapshot, linked_octree);
+                require_same_queries(old_snapshot, old_linked_octree);
+
+                for (std::size_t i = 0u; i < size; ++i)
+                {
+                    REQUIRE(old_snapshot.contains(points[i], point_map));
+                    REQUIRE(new_snapshot.contains(points[i], point_map) == (i >= num_erased));
+                }
+            }
+            THEN("erasing a missing element changes nothing")
+            {
+                REQUIRE_FALSE(octree.erase(pcp::point_t{2.f, 0.f, 0.f}, point_map));
+                REQUIRE_FALSE(octree.erase(points.front(), point_map));
+                REQUIRE(octree.size() == linked_octree.size());
+            }
+        }
+        WHEN("clearing the octree")
+        {
+            auto const old_snapshot = octree.snapshot();
+            octree.clear();
+            octree.publish();
+
+            THEN("only the new snapshots are empty")
+            {
+                REQUIRE(octree.empty());
+                REQUIRE(octree.snapshot().empty());
+                REQUIRE(octree.snapshot().range_count(sphere, point_map) == 0u);
+                auto const neighbours =
+                    octree.snapshot().nearest_neighbours(sphere.center(), 4u, point_map);
+                REQUIRE(neighbours.empty());
+                require_same_queries(old_snapshot, linked_octree);
+            }
+        }
+    }
+}
+
+SCENARIO("persistent octree concurrent readers", "[octree]")
+{
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    pcp::octree_parameters_t<pcp::point_t> params;
+    params.node_capacity = 4u;
+    params.max_depth     = 21u;
+    params.voxel_grid    = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+
+    GIVEN("a writer inserting batches of points in a persistent octree")
+    {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+
+        std::size_t const num_batches = 32u;
+        std::size_t const batch_size  = 256u;
+        std::vector<pcp::point_t> points;
+        points.reserve(num_batches * batch_size);
+        for (std::size_t i = 0u; i < num_batches * batch_size; ++i)
+            points.push_back(pcp::point_t{
+                coordinate_distribution(gen),
+                coordinate_distribution(gen),
+                coordinate_distribution(gen)});
+
+        pcp::persistent_octree_t octree(params);
+
+        WHEN("readers query snapshots while the writer publishes")
+        {
+            std::atomic<bool> is_writing{true};
+            std::atomic<bool> are_snapshots_consistent{true};
+            auto const read = [&]() {
+                std::uint64_t last_version = 0u;
+                while (is_writing.load())
+                {
+                    auto const snapshot = octree.snapshot();
+                    auto const count    = snapshot.range_count(params.voxel_grid, point_map);
+                    auto const neighbours =
+                        snapshot.nearest_neighbours(pcp::point_t{0.f, 0.f, 0.f}, 4u, point_map);
+                    bool const is_consistent =
+                        snapshot.version() >= last_version &&
+                        snapshot.size() == snapshot.version() * batch_size &&
+                        count == snapshot.size() &&
+                        neighbours.size() == std::min<std::size_t>(4u, snapshot.size());
+                    if (!is_consistent)
+                        are_snapshots_consistent.store(false);
+
+                    last_version = snapshot.version();
+                }
+            };
+
+            std::vector<std::thread> readers;
+            for (std::size_t t = 0u; t < 3u; ++t)
+                readers.emplace_back(read);
+
+            for (std::size_t b = 0u; b < num_batches; ++b)
+            {
+                auto const begin = points.cbegin() + static_cast<std::ptrdiff_t>(b * batch_size);
+                octree.insert(begin, begin + static_cast<std::ptrdiff_t>(batch_size), point_map);
+                octree.publish();
+            }
+            is_writing.store(false);
+
+            for (auto& reader : readers)
+                reader.join();
+
+            THEN("every snapshot is a complete published version")
+            {
+                REQUIRE(are_snapshots_consistent.load());
+                REQUIRE(octree.snapshot().size() == points.size());
+                REQUIRE(octree.snapshot().version() == num_batches);
+            }
+        }
+    }
+}
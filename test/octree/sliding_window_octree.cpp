@@ -0,0 +1,174 @@
+#include <catch2/catch.hpp>
+#include <pcp/octree/sliding_window_octree.hpp>
+#include <random>
+
+SCENARIO("sliding window octree of streamed frames", "[octree]")
+{
+    auto node_capacity = GENERATE(1u, 4u, 32u);
+    auto max_depth     = GENERATE(1u, 3u, 21u);
+
+    auto const point_map = [](pcp::point_t const& p) {
+        return p;
+    };
+
+    pcp::sliding_window_octree_parameters_t<pcp::point_t> params;
+    params.node_capacity = node_capacity;
+    params.max_depth     = static_cast<std::uint8_t>(max_depth);
+    params.voxel_grid    = pcp::axis_aligned_bounding_box_t<pcp::point_t>{
+        pcp::point_t{-1.f, -1.f, -1.f},
+        pcp::point_t{1.f, 1.f, 1.f}};
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_real_distribution<float> coordinate_distribution(-1.f, 1.f);
+
+    std::size_t const num_frames = 24u;
+    std::size_t const frame_size = 200u;
+    std::vector<std::vector<pcp::point_t>> frames(num_frames);
+    for (std::size_t f = 0u; f < num_frames; ++f)
+    {
+        // frames alternate between the whole grid and a corner of it, so that
+        // evictions leave sparse subtrees behind
+        float const scale = f % 2u == 0u ? 1.f : .25f;
+        frames[f].reserve(frame_size);
+        for (std::size_t i = 0u; i < frame_size; ++i)
+            frames[f].push_back(pcp::point_t{
+                scale * coordinate_distribution(gen),
+                scale * coordinate_distribution(gen),
+                scale * coordinate_distribution(gen)});
+    }
+
+    auto const require_same_points = [&](auto const& octree,
+                                         std::vector<pcp::point_t> const& expected) {
+        REQUIRE(octree.size() == expected.size());
+
+        std::size_t count = 0u;
+        octree.for_each([&count](pcp::point_t const&) { ++count; });
+        REQUIRE(count == expected.size());
+
+        pcp::sphere_t<pcp::point_t> const sphere{pcp::point_t{.1f, -.1f, .2f}, .4f};
+        auto const expected_in_sphere = static_cast<std::size_t>(
+            std::count_if(expected.cbegin(), expected.cend(), [&](pcp::point_t const& p) {
+                return sphere.contains(p);
+            }));
+        REQUIRE(octree.range_count(sphere, point_map) == expected_in_sphere);
+        REQUIRE(octree.range_search(sphere, point_map).size() == expected_in_sphere);
+
+        pcp::point_t const target{
+            coordinate_distribution(gen),
+            coordinate_distribution(gen),
+            coordinate_distribution(gen)};
+        std::size_t const k   = std::min<std::size_t>(8u, expected.size());
+        auto const neighbours = octree.nearest_neighbours(target, 8u, point_map);
+        auto sorted_expected  = expected;
+        std::partial_sort(
+            sorted_expected.begin(),
+            sorted_expected.begin() + static_cast<std::ptrdiff_t>(k),
+            sorted_expected.end(),
+            [&](pcp::point_t const& p1, pcp::point_t const& p2) {
+                return pcp::common::squared_distance(p1, target) <
+                       pcp::common::squared_distance(p2, target);
+            });
+        REQUIRE(neighbours.size() == k);
+        for (std::size_t i = 0u; i < k; ++i)
+        {
+            auto const d1 = pcp::common::squared_distance(neighbours[i], target);
+            auto const d2 = pcp::common::squared_distance(sorted_expected[i], target);
+            REQUIRE(d1 == Approx(d2));
+        }
+    };
+
+    auto const window_points = [&](std::size_t first, std::size_t last) {
+        std::vector<pcp::point_t> points;
+        for (std::size_t f = first; f < last; ++f)
+            points.insert(points.end(), frames[f].cbegin(), frames[f].cend());
+        return points;
+    };
+
+    GIVEN("a sliding window octree keeping a number of frames")
+    {
+        std::size_t const window_size = 5u;
+        params.max_frames             = window_size;
+        pcp::sliding_window_octree_t octree(params);
+
+        WHEN("streaming frames through the window")
+        {
+            THEN("the octree only holds the points of the last frames")
+            {
+                for (std::size_t f = 0u; f < num_frames; ++f)
+                {
+                    auto const inserted = octree.push_frame(
+                        frames[f].cbegin(),
+                        frames[f].cend(),
+                        point_map,
+                        static_cast<double>(f));
+                    REQUIRE(inserted == frame_size);
+
+                    auto const first = f + 1u > window_size ? f + 1u - window_size : 0u;
+                    REQUIRE(octree.frames().size() == f + 1u - first);
+                    REQUIRE(
+                        octree.frames().front().timestamp == Approx(static_cast<double>(first)));
+                    require_same_points(octree, window_points(first, f + 1u));
+                }
+            }
+        }
+        WHEN("evicting frames explicitly")
+        {
+            for (std::size_t f = 0u; f < window_size; ++f)
+                octree.push_frame(
+                    frames[f].cbegin(),
+                    frames[f].cend(),
+                    point_map,
+                    static_cast<double>(f));
+
+            auto const evicted_by_count     = octree.evict_oldest_frames(2u);
+            auto const evicted_by_timestamp = octree.evict_frames_before(3.5);
+
+            THEN("the octree only holds the points of the remaining frames")
+            {
+                REQUIRE(evicted_by_count == 2u * frame_size);
+                REQUIRE(evicted_by_timestamp == 2u * frame_size);
+                REQUIRE(octree.frames().size() == 1u);
+                require_same_points(octree, window_points(4u, 5u));
+
+                REQUIRE(octree.evict_oldest_frames(2u) == frame_size);
+                REQUIRE(octree.empty());
+                REQUIRE(octree.frames().empty());
+                REQUIRE(octree.nearest_neighbours(pcp::point_t{}, 4u, point_map).empty());
+            }
+        }
+    }
+    GIVEN("a sliding window octree keeping frames up to an age")
+    {
+        params.max_age = 2.5;
+        pcp::sliding_window_octree_t octree(params);
+
+        WHEN("streaming frames with points outside the voxel grid")
+        {
+            std::vector<pcp::point_t> outside{
+                pcp::point_t{2.f, 0.f, 0.f},
+                pcp::point_t{0.f, -3.f, 0.f}};
+
+            THEN("the octree only holds the points of the recent frames in the grid")
+            {
+                for (std::size_t f = 0u; f < num_frames; ++f)
+                {
+                    auto frame = frames[f];
+                    frame.insert(frame.end(), outside.cbegin(), outside.cend());
+                    double const timestamp = .5 * static_cast<double>(f);
+                    auto const inserted =
+                        octree.push_frame(frame.cbegin(), frame.cend(), point_map, timestamp);
+                    REQUIRE(inserted == frame_size);
+
+                    auto const first = f > 5u ? f - 5u : 0u;
+                    REQUIRE(octree.frames().back().size == frame_size);
+                    require_same_points(octree, window_points(first, f + 1u));
+                }
+
+                octree.clear();
+                REQUIRE(octree.empty());
+                REQUIRE(octree.frames().empty());
+            }
+        }
+    }
+}